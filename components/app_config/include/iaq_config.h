@@ -19,24 +19,34 @@
  * Based on project summary architecture
  */
 #define TASK_PRIORITY_SENSOR_COORDINATOR    5
+#define TASK_PRIORITY_PROCESSING            4  /* Fusion, history append, metrics */
 #define TASK_PRIORITY_POWER_POLL            4
+#define TASK_PRIORITY_S8_MODBUS             4  /* Owns the S8 UART; mostly blocked on RX */
 #define TASK_PRIORITY_OTA_VALIDATION        4
 #define TASK_PRIORITY_MQTT_MANAGER          3
+#define TASK_PRIORITY_WEB_ASYNC             3  /* Below httpd (5) so the server stays responsive */
 #define TASK_PRIORITY_WC_LOG_BCAST          2  /* tskIDLE_PRIORITY + 2 */
+#define TASK_PRIORITY_WC_CMD                2  /* Web console command workers */
 #define TASK_PRIORITY_DISPLAY               2
 #define TASK_PRIORITY_STATUS_LED            1
+#define TASK_PRIORITY_HISTORY_FLASH         1  /* Hourly flash appends; never urgent */
 
 /**
  * Task stack sizes (bytes)
  */
 #define TASK_STACK_SENSOR_COORDINATOR   4096
+#define TASK_STACK_PROCESSING           4096
 #define TASK_STACK_MQTT_MANAGER         4096  /* Increased from 3072 due to cJSON stack usage */
 #define TASK_STACK_POWER_POLL           3072
+#define TASK_STACK_S8_MODBUS            3072
 #define TASK_STACK_DISPLAY              3072
 #define TASK_STACK_STATUS_LED           2048
 #define TASK_STACK_WEB_SERVER           6144
+#define TASK_STACK_WEB_ASYNC            6144  /* Runs the same handlers as httpd */
 #define TASK_STACK_OTA_VALIDATION       4096
 #define TASK_STACK_WC_LOG_BCAST         4096
+#define TASK_STACK_WC_CMD               6144  /* Runs console commands (printf-heavy) */
+#define TASK_STACK_HISTORY_FLASH        3072
 
 /**
  * Task core affinity (ESP32-S3 is dual-core)
@@ -44,13 +54,17 @@
  * Core 1 (APP_CPU): Network/MQTT
  */
 #define TASK_CORE_SENSOR_COORDINATOR    0
+#define TASK_CORE_PROCESSING            1  /* Off the sensor core */
 #define TASK_CORE_MQTT_MANAGER          1
 #define TASK_CORE_OTA_VALIDATION        1
 #define TASK_CORE_WC_LOG_BCAST          1
+#define TASK_CORE_WC_CMD                1
 #define TASK_CORE_POWER_POLL            0
 #define TASK_CORE_PMS5003_RX            0
+#define TASK_CORE_S8_MODBUS             0
 #define TASK_CORE_DISPLAY               0
 #define TASK_CORE_STATUS_LED            0
+#define TASK_CORE_HISTORY_FLASH         1
 #define TASK_CORE_WEB_SERVER            1
 
 /**
@@ -69,4 +83,19 @@
  */
 #define STATUS_PUBLISH_INTERVAL_MS  30000  /* 30 seconds */
 
+/**
+ * Periodic work slack (milliseconds): how late a job may run so that
+ * periodic_sched can fold it into a wake-up that is already happening.
+ * Anything >= 1000 ms rides on the 1 Hz fusion tick.
+ */
+#define SLACK_MS_FUSION             50
+#define SLACK_MS_METRICS            1000
+#define SLACK_MS_WS_PUSH            900   /* 1 s pushes follow the fusion tick */
+#define SLACK_MS_WS_METRICS         1000
+#define SLACK_MS_MQTT_PUBLISH       2000
+#define SLACK_MS_MQTT_DIAGNOSTICS   10000
+#define SLACK_MS_SYSTEM_STATUS      2000
+#define SLACK_MS_WIFI_PS            1000
+#define SLACK_MS_LOG_SUMMARY        5000
+
 #endif /* IAQ_CONFIG_H */
@@ -0,0 +1,322 @@
+/* components/blackbox/blackbox.c */
+#include "blackbox.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "BLACKBOX";
+
+#ifndef CONFIG_IAQ_BLACKBOX_LOG_SLOTS
+#define CONFIG_IAQ_BLACKBOX_LOG_SLOTS 48
+#endif
+#ifndef CONFIG_IAQ_BLACKBOX_LOG_LEVEL
+#define CONFIG_IAQ_BLACKBOX_LOG_LEVEL 3
+#endif
+#ifndef CONFIG_IAQ_BLACKBOX_SPAN_MIN_US
+#define CONFIG_IAQ_BLACKBOX_SPAN_MIN_US 1000
+#endif
+
+#define BB_LOG_SLOTS    CONFIG_IAQ_BLACKBOX_LOG_SLOTS
+#define BB_EVENT_SLOTS  32
+#define BB_SPAN_SLOTS   64
+#define BB_MAGIC        0x4242584BUL    /* "KXBB" */
+/* Changes whenever the region layout changes, so stale images are ignored */
+#define BB_LAYOUT       ((1UL << 24) | ((uint32_t)BB_LOG_SLOTS << 16) | (BB_EVENT_SLOTS << 8) | BB_SPAN_SLOTS)
+#define BB_LINE_MAX     96              /* Formatting buffer for log lines */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t layout;
+    uint32_t boot_count;
+    uint32_t log_head;                  /* Records written; slot = head % slots */
+    uint32_t event_head;
+    uint32_t span_head;
+    uint32_t last_ms;
+    uint32_t wall_ms;                   /* Uptime when wall_s was sampled */
+    int64_t wall_s;
+    blackbox_log_t logs[BB_LOG_SLOTS];
+    blackbox_event_t events[BB_EVENT_SLOTS];
+    blackbox_span_t spans[BB_SPAN_SLOTS];
+    uint32_t magic_end;
+} bb_region_t;
+
+#if CONFIG_IAQ_BLACKBOX_ENABLE
+static RTC_NOINIT_ATTR bb_region_t s_bb;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_ready = false;
+static vprintf_like_t s_prev_vprintf = NULL;
+#endif
+static blackbox_dump_t *s_previous = NULL;
+
+static inline uint32_t uptime_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static inline size_t ring_count(uint32_t head, size_t slots)
+{
+    return head < slots ? head : slots;
+}
+
+#if CONFIG_IAQ_BLACKBOX_ENABLE
+static blackbox_dump_t *dump_alloc(void)
+{
+    size_t size = sizeof(blackbox_dump_t) + sizeof(blackbox_log_t) * BB_LOG_SLOTS +
+                  sizeof(blackbox_event_t) * BB_EVENT_SLOTS + sizeof(blackbox_span_t) * BB_SPAN_SLOTS;
+    blackbox_dump_t *d = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!d) d = calloc(1, size);
+    return d;
+}
+
+/* Copy the rings oldest-first into a buffer from dump_alloc() */
+static void dump_fill(blackbox_dump_t *d, const bb_region_t *r)
+{
+    blackbox_log_t *logs = (blackbox_log_t *)(d + 1);
+    blackbox_event_t *events = (blackbox_event_t *)(logs + BB_LOG_SLOTS);
+    blackbox_span_t *spans = (blackbox_span_t *)(events + BB_EVENT_SLOTS);
+
+    d->boot_count = r->boot_count;
+    d->last_ms = r->last_ms;
+    d->wall_s = r->wall_s ? r->wall_s + (int64_t)(r->last_ms - r->wall_ms) / 1000 : 0;
+
+    d->log_count = ring_count(r->log_head, BB_LOG_SLOTS);
+    for (size_t i = 0; i < d->log_count; i++) {
+        logs[i] = r->logs[(r->log_head - d->log_count + i) % BB_LOG_SLOTS];
+        logs[i].text[BLACKBOX_LOG_TEXT_LEN - 1] = '\0';
+    }
+    d->event_count = ring_count(r->event_head, BB_EVENT_SLOTS);
+    for (size_t i = 0; i < d->event_count; i++) {
+        events[i] = r->events[(r->event_head - d->event_count + i) % BB_EVENT_SLOTS];
+    }
+    d->span_count = ring_count(r->span_head, BB_SPAN_SLOTS);
+    for (size_t i = 0; i < d->span_count; i++) {
+        spans[i] = r->spans[(r->span_head - d->span_count + i) % BB_SPAN_SLOTS];
+    }
+    d->logs = logs;
+    d->events = events;
+    d->spans = spans;
+}
+
+/* Cheap wall-clock sample so the dump can be placed in time */
+static void sample_wall_clock(uint32_t now_ms)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec < 1600000000) return; /* Not synced yet */
+    s_bb.wall_s = tv.tv_sec;
+    s_bb.wall_ms = now_ms;
+}
+
+static int level_rank(char c)
+{
+    switch (c) {
+        case 'E': return 1;
+        case 'W': return 2;
+        case 'I': return 3;
+        case 'D': return 4;
+        case 'V': return 5;
+        default:  return 0;
+    }
+}
+
+static const char *skip_color(const char *s)
+{
+    while (s[0] == '\033' && s[1] == '[') {
+        s += 2;
+        while (*s && *s != 'm') s++;
+        if (*s) s++;
+    }
+    return s;
+}
+
+/* "<color>W (1234) TAG: message<reset>\n" -> level 'W', "TAG: message" */
+static void record_log_line(const char *line)
+{
+    const char *p = skip_color(line);
+    int rank = level_rank(p[0]);
+    if (rank == 0 || rank > CONFIG_IAQ_BLACKBOX_LOG_LEVEL) return;
+
+    blackbox_log_t rec = { .t_ms = uptime_ms(), .level = p[0] };
+    const char *text = strstr(p, ") ");
+    text = text ? text + 2 : p + 1;
+    size_t n = 0;
+    while (text[n] && text[n] != '\033' && text[n] != '\n' && n < BLACKBOX_LOG_TEXT_LEN - 1) {
+        rec.text[n] = text[n];
+        n++;
+    }
+    rec.text[n] = '\0';
+
+    portENTER_CRITICAL_SAFE(&s_lock);
+    sample_wall_clock(rec.t_ms);
+    s_bb.logs[s_bb.log_head % BB_LOG_SLOTS] = rec;
+    s_bb.log_head++;
+    s_bb.last_ms = rec.t_ms;
+    portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+static int blackbox_vprintf(const char *fmt, va_list args)
+{
+    /* ESP_LOGx formats start with the level letter, so lines above the
+     * threshold are skipped without formatting them twice */
+    const char *p = skip_color(fmt);
+    int rank = level_rank(p[0]);
+    bool prefixed = rank > 0 && p[1] == ' ' && p[2] == '(';
+    if (!prefixed || rank <= CONFIG_IAQ_BLACKBOX_LOG_LEVEL) {
+        char line[BB_LINE_MAX];
+        va_list copy;
+        va_copy(copy, args);
+        vsnprintf(line, sizeof(line), fmt, copy);
+        va_end(copy);
+        record_log_line(line);
+    }
+    return s_prev_vprintf ? s_prev_vprintf(fmt, args) : vprintf(fmt, args);
+}
+
+static bool region_valid(const bb_region_t *r)
+{
+    return r->magic == BB_MAGIC && r->magic_end == BB_MAGIC && r->layout == BB_LAYOUT;
+}
+#endif /* CONFIG_IAQ_BLACKBOX_ENABLE */
+
+esp_err_t blackbox_init(void)
+{
+#if CONFIG_IAQ_BLACKBOX_ENABLE
+    if (s_ready) return ESP_OK;
+
+    esp_reset_reason_t reason = esp_reset_reason();
+    uint32_t boots = 1;
+    /* RTC memory is undefined after power loss, whatever the magic says */
+    bool retained = reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT && reason != ESP_RST_UNKNOWN;
+    if (retained && region_valid(&s_bb)) {
+        boots = s_bb.boot_count + 1;
+        blackbox_dump_t *prev = dump_alloc();
+        if (prev) {
+            dump_fill(prev, &s_bb);
+            prev->reset_reason = reason;
+            s_previous = prev;
+        }
+    }
+
+    memset(&s_bb, 0, sizeof(s_bb));
+    s_bb.magic = BB_MAGIC;
+    s_bb.layout = BB_LAYOUT;
+    s_bb.magic_end = BB_MAGIC;
+    s_bb.boot_count = boots;
+    s_ready = true;
+
+    s_prev_vprintf = esp_log_set_vprintf(blackbox_vprintf);
+    blackbox_record_event(BLACKBOX_EVENT_BOOT, (uint8_t)reason, 0, 0, boots);
+
+    if (s_previous) {
+        ESP_LOGW(TAG, "Recovered previous boot (reset: %s): %u logs, %u events, %u spans",
+                 blackbox_reset_reason_name(reason), (unsigned)s_previous->log_count,
+                 (unsigned)s_previous->event_count, (unsigned)s_previous->span_count);
+    }
+#endif
+    return ESP_OK;
+}
+
+void blackbox_record_event(blackbox_event_kind_t kind, uint8_t a, uint8_t b, uint8_t c, uint32_t value)
+{
+#if CONFIG_IAQ_BLACKBOX_ENABLE
+    if (!s_ready) return;
+    blackbox_event_t rec = { .t_ms = uptime_ms(), .kind = (uint8_t)kind, .a = a, .b = b, .c = c, .value = value };
+    portENTER_CRITICAL_SAFE(&s_lock);
+    sample_wall_clock(rec.t_ms);
+    s_bb.events[s_bb.event_head % BB_EVENT_SLOTS] = rec;
+    s_bb.event_head++;
+    s_bb.last_ms = rec.t_ms;
+    portEXIT_CRITICAL_SAFE(&s_lock);
+#else
+    (void)kind; (void)a; (void)b; (void)c; (void)value;
+#endif
+}
+
+void blackbox_record_span(int metric, uint32_t value)
+{
+#if CONFIG_IAQ_BLACKBOX_ENABLE
+    if (!s_ready || value < CONFIG_IAQ_BLACKBOX_SPAN_MIN_US) return;
+    blackbox_span_t rec = { .t_ms = uptime_ms(), .metric = (uint16_t)metric, .value = value };
+    portENTER_CRITICAL_SAFE(&s_lock);
+    s_bb.spans[s_bb.span_head % BB_SPAN_SLOTS] = rec;
+    s_bb.span_head++;
+    s_bb.last_ms = rec.t_ms;
+    portEXIT_CRITICAL_SAFE(&s_lock);
+#else
+    (void)metric; (void)value;
+#endif
+}
+
+bool blackbox_get_previous(const blackbox_dump_t **out)
+{
+    if (out) *out = s_previous;
+    return s_previous != NULL;
+}
+
+esp_err_t blackbox_capture_current(blackbox_dump_t **out)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+#if CONFIG_IAQ_BLACKBOX_ENABLE
+    if (!s_ready) return ESP_ERR_INVALID_STATE;
+    blackbox_dump_t *d = dump_alloc();
+    if (!d) return ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&s_lock);
+    dump_fill(d, &s_bb);
+    portEXIT_CRITICAL(&s_lock);
+    d->reset_reason = esp_reset_reason();
+    *out = d;
+    return ESP_OK;
+#else
+    *out = NULL;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void blackbox_free_dump(blackbox_dump_t *dump)
+{
+    if (dump && dump != s_previous) free(dump);
+}
+
+const char *blackbox_reset_reason_name(int reason)
+{
+    switch (reason) {
+        case ESP_RST_POWERON:   return "poweron";
+        case ESP_RST_EXT:       return "external";
+        case ESP_RST_SW:        return "software";
+        case ESP_RST_PANIC:     return "panic";
+        case ESP_RST_INT_WDT:   return "int_wdt";
+        case ESP_RST_TASK_WDT:  return "task_wdt";
+        case ESP_RST_WDT:       return "wdt";
+        case ESP_RST_DEEPSLEEP: return "deepsleep";
+        case ESP_RST_BROWNOUT:  return "brownout";
+        case ESP_RST_SDIO:      return "sdio";
+        case ESP_RST_USB:       return "usb";
+        case ESP_RST_JTAG:      return "jtag";
+        case ESP_RST_EFUSE:     return "efuse";
+        case ESP_RST_PWR_GLITCH:return "power_glitch";
+        case ESP_RST_CPU_LOCKUP:return "cpu_lockup";
+        default:                return "unknown";
+    }
+}
+
+const char *blackbox_event_kind_name(uint8_t kind)
+{
+    switch (kind) {
+        case BLACKBOX_EVENT_BOOT:         return "boot";
+        case BLACKBOX_EVENT_SENSOR_STATE: return "sensor_state";
+        case BLACKBOX_EVENT_WIFI:         return "wifi";
+        case BLACKBOX_EVENT_MQTT:         return "mqtt";
+        default:                          return "unknown";
+    }
+}
@@ -0,0 +1,93 @@
+/* components/blackbox/include/blackbox.h */
+#ifndef BLACKBOX_H
+#define BLACKBOX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Crash-surviving recorder in RTC no-init memory. Keeps the most recent
+ * log lines, system events and profiler spans in fixed-size rings that
+ * survive panics, watchdog and software resets (not power loss). On boot
+ * the previous contents are copied out and the rings start over.
+ */
+
+#define BLACKBOX_LOG_TEXT_LEN   39      /* "TAG: message", truncated */
+
+typedef enum {
+    BLACKBOX_EVENT_BOOT = 1,            /* a = esp_reset_reason_t, value = boot count */
+    BLACKBOX_EVENT_SENSOR_STATE,        /* a = sensor id, b = old state, c = new state */
+    BLACKBOX_EVENT_WIFI,                /* a = 1 connected / 0 disconnected */
+    BLACKBOX_EVENT_MQTT,                /* a = 1 connected / 0 disconnected */
+} blackbox_event_kind_t;
+
+typedef struct {
+    uint32_t t_ms;                      /* Uptime */
+    char level;                         /* 'E', 'W', 'I', 'D', 'V' */
+    char text[BLACKBOX_LOG_TEXT_LEN];
+} blackbox_log_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t kind;                       /* blackbox_event_kind_t */
+    uint8_t a, b, c;
+    uint32_t value;
+} blackbox_event_t;
+
+typedef struct {
+    uint32_t t_ms;                      /* Uptime at the end of the span */
+    uint16_t metric;                    /* iaq_metric_id_t */
+    uint16_t reserved;
+    uint32_t value;                     /* Duration in us (or the metric's unit) */
+} blackbox_span_t;
+
+/** Linearized copy of the rings, oldest record first. */
+typedef struct {
+    uint32_t boot_count;
+    int reset_reason;                   /* esp_reset_reason_t of the boot that followed */
+    uint32_t last_ms;                   /* Uptime of the newest record */
+    int64_t wall_s;                     /* Wall clock at last_ms, 0 if time was never set */
+    size_t log_count;
+    size_t event_count;
+    size_t span_count;
+    const blackbox_log_t *logs;
+    const blackbox_event_t *events;
+    const blackbox_span_t *spans;
+} blackbox_dump_t;
+
+/**
+ * Recover the previous boot's rings, reset them and start recording.
+ * Call first thing in app_main so early logs are captured.
+ */
+esp_err_t blackbox_init(void);
+
+/** Record a system event. Safe from any task. */
+void blackbox_record_event(blackbox_event_kind_t kind, uint8_t a, uint8_t b, uint8_t c, uint32_t value);
+
+/** Record a profiler span (skipped below CONFIG_IAQ_BLACKBOX_SPAN_MIN_US). */
+void blackbox_record_span(int metric, uint32_t value);
+
+/** Rings recovered from before the last reset; false after power-on. */
+bool blackbox_get_previous(const blackbox_dump_t **out);
+
+/** Snapshot of the current boot (free with blackbox_free_dump). */
+esp_err_t blackbox_capture_current(blackbox_dump_t **out);
+void blackbox_free_dump(blackbox_dump_t *dump);
+
+/** Short name for an esp_reset_reason_t ("panic", "task_wdt", ...). */
+const char *blackbox_reset_reason_name(int reason);
+
+/** Short name for an event kind ("boot", "sensor_state", ...). */
+const char *blackbox_event_kind_name(uint8_t kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLACKBOX_H */
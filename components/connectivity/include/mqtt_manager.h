@@ -85,6 +85,29 @@ esp_err_t mqtt_publish_power(void);
  */
 bool mqtt_manager_is_connected(void);
 
+/**
+ * Broker connection setup statistics (TCP + TLS handshake + MQTT CONNECT).
+ */
+typedef struct {
+    uint32_t attempts;      /* Connection attempts started */
+    uint32_t connects;      /* Attempts that reached MQTT_EVENT_CONNECTED */
+    uint32_t failures;      /* Attempts that ended in an error */
+    uint32_t last_ms;       /* Duration of the most recent successful setup */
+    uint32_t max_ms;
+    uint64_t total_ms;      /* Sum over successful setups (avg = total_ms / connects) */
+} mqtt_connect_stats_t;
+
+/**
+ * Copy the current connection setup statistics.
+ */
+void mqtt_manager_get_connect_stats(mqtt_connect_stats_t *out);
+
+/**
+ * Publish backlog: events waiting for the publish worker and bytes held in
+ * the client outbox (QoS > 0 messages not yet acknowledged). Never blocks.
+ */
+void mqtt_manager_get_backlog(uint32_t *queued_events, uint32_t *outbox_bytes);
+
 /**
  * Set MQTT broker configuration and save to NVS.
  * MQTT client will need to be restarted for changes to take effect.
@@ -0,0 +1,81 @@
+/* components/connectivity/include/wifi_ps_policy.h */
+#ifndef WIFI_PS_POLICY_H
+#define WIFI_PS_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Demand-driven station power save (CONFIG_IAQ_WIFI_PS_ADAPTIVE).
+ *
+ * Once a second the policy samples who needs the radio and picks a level:
+ *
+ *   IDLE         WIFI_PS_MAX_MODEM, wakes every CONFIG_IAQ_WIFI_LISTEN_INTERVAL DTIMs
+ *   INTERACTIVE  WIFI_PS_MIN_MODEM, wakes every DTIM (dashboard/console open)
+ *   BULK         WIFI_PS_NONE (OTA upload, MQTT backlog, slow round trips)
+ *
+ * More demand takes effect at the next sample; less demand only after it has
+ * lasted CONFIG_IAQ_WIFI_PS_HOLD_S, so short gaps do not flap the radio.
+ */
+
+typedef enum {
+    WIFI_PS_LEVEL_IDLE = 0,
+    WIFI_PS_LEVEL_INTERACTIVE,
+    WIFI_PS_LEVEL_BULK,
+    WIFI_PS_LEVEL_COUNT
+} wifi_ps_level_t;
+
+/* Demand sources reported by other components through probes */
+typedef enum {
+    WIFI_PS_DEMAND_DASHBOARD = 0,   /* Live dashboard WebSocket open -> INTERACTIVE */
+    WIFI_PS_DEMAND_CONSOLE,         /* Web console or log viewer open -> INTERACTIVE */
+    WIFI_PS_DEMAND_OTA,             /* Firmware/frontend upload running -> BULK */
+    WIFI_PS_DEMAND_COUNT
+} wifi_ps_demand_t;
+
+/* Reason bits in wifi_ps_policy_stats_t.reasons: (1 << wifi_ps_demand_t), plus */
+#define WIFI_PS_REASON_MQTT_BACKLOG     (1u << WIFI_PS_DEMAND_COUNT)
+#define WIFI_PS_REASON_LATENCY          (1u << (WIFI_PS_DEMAND_COUNT + 1))
+
+/* Must be cheap and non-blocking: called from the esp_timer task */
+typedef bool (*wifi_ps_probe_t)(void);
+
+typedef struct {
+    bool running;                   /* Policy in control of the radio (STA up, adaptive mode) */
+    wifi_ps_level_t level;
+    uint32_t reasons;               /* Demand seen at the last sample */
+    uint32_t transitions;
+    uint32_t rtt_ms;                /* Smoothed round trip, 0 = no recent sample */
+    uint64_t residency_ms[WIFI_PS_LEVEL_COUNT];  /* Time spent per level since boot */
+} wifi_ps_policy_stats_t;
+
+/** Register (or replace, or clear with NULL) the probe for a demand source. */
+void wifi_ps_policy_register_probe(wifi_ps_demand_t source, wifi_ps_probe_t probe);
+
+/** Feed a measured client round trip (e.g. WebSocket PING -> PONG). */
+void wifi_ps_policy_note_rtt(uint32_t rtt_ms);
+
+/** Take control of station power save (wifi_manager, after STA start). */
+esp_err_t wifi_ps_policy_start(void);
+
+/** Release control; residency stops accumulating until the next start. */
+void wifi_ps_policy_stop(void);
+
+void wifi_ps_policy_get_stats(wifi_ps_policy_stats_t *out);
+
+const char *wifi_ps_level_name(wifi_ps_level_t level);
+
+/** Stats as a JSON object for /api/v1/health and MQTT diagnostics (NULL on OOM). */
+cJSON *wifi_ps_policy_build_json(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIFI_PS_POLICY_H */
@@ -12,6 +12,7 @@
 #include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_random.h"
 #include "mqtt_client.h"
 #include "esp_tls.h"
 #ifdef CONFIG_IAQ_MQTT_TLS_TRUST_BUNDLE
@@ -30,20 +31,23 @@
 #include "time_sync.h"
 #include "power_board.h"
 #include "iaq_profiler.h"
+#include "blackbox.h"
 #include "iaq_json.h"
 #include "pm_guard.h"
+#include "periodic_sched.h"
+#include "wifi_ps_policy.h"
 
 static const char *TAG = "MQTT_MGR";
 
 static iaq_system_context_t *s_system_ctx = NULL;
-static esp_timer_handle_t s_health_timer = NULL;
-static esp_timer_handle_t s_state_timer = NULL;
-static esp_timer_handle_t s_metrics_timer = NULL;
+static periodic_work_handle_t s_health_timer = NULL;
+static periodic_work_handle_t s_state_timer = NULL;
+static periodic_work_handle_t s_metrics_timer = NULL;
 #ifdef CONFIG_MQTT_PUBLISH_DIAGNOSTICS
-static esp_timer_handle_t s_diagnostics_timer = NULL;
+static periodic_work_handle_t s_diagnostics_timer = NULL;
 #endif
 #ifdef CONFIG_IAQ_MQTT_PUBLISH_POWER
-static esp_timer_handle_t s_power_timer = NULL;
+static periodic_work_handle_t s_power_timer = NULL;
 #endif
 
 typedef enum {
@@ -75,6 +79,17 @@ static char s_broker_url[128] = {0};
 static char s_username[64] = {0};
 static char s_password[64] = {0};
 
+#define MQTT_RECONNECT_BASE_MS      10000
+#define MQTT_RECONNECT_JITTER_MS    5000   /* Spreads fleet reconnects after broker failover */
+
+/* Connection setup cost (TCP + TLS + MQTT CONNECT), guarded by s_conn_stats_lock */
+static mqtt_connect_stats_t s_conn_stats = {0};
+static uint64_t s_connect_start_us = 0;
+static portMUX_TYPE s_conn_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+#if CONFIG_IAQ_MQTT_TLS_TRUST_CA_PEM && defined(IAQ_HAS_CA_PEM)
+static bool s_global_ca_ready = false;
+#endif
+
 /* Topic definitions */
 #define TOPIC_PREFIX    "iaq/" CONFIG_IAQ_DEVICE_ID
 #define TOPIC_STATUS    TOPIC_PREFIX "/status"
@@ -104,7 +119,8 @@ static void mqtt_publish_worker_task(void *arg);
 static esp_err_t ensure_publish_timers_started(void);
 static void stop_publish_timers(void);
 static bool enqueue_publish_event(mqtt_publish_event_t event);
-static esp_err_t start_periodic_timer(esp_timer_handle_t *handle, const esp_timer_create_args_t *args, uint64_t period_us);
+static esp_err_t start_periodic_timer(periodic_work_handle_t *handle, const periodic_work_args_t *args,
+                                      uint64_t first_delay_us, uint64_t period_us);
 static bool parse_co2_calibration_payload(const char *payload, int *ppm_out);
 static esp_err_t publish_json(const char *topic, cJSON *obj);
 /* Public publish functions declared in mqtt_manager.h */
@@ -213,7 +229,10 @@ static esp_err_t create_mqtt_client(void)
             .disable_clean_session = 0,
             .protocol_ver = MQTT_PROTOCOL_V_5,
         },
-        .network = { .reconnect_timeout_ms = 10000, .timeout_ms = 10000 },
+        .network = {
+            .reconnect_timeout_ms = MQTT_RECONNECT_BASE_MS + (int)(esp_random() % MQTT_RECONNECT_JITTER_MS),
+            .timeout_ms = 10000,
+        },
         .buffer = { .size = 2048, .out_size = 2048 },
     };
 
@@ -229,8 +248,20 @@ static esp_err_t create_mqtt_client(void)
         mqtt_cfg.broker.verification.crt_bundle_attach = esp_crt_bundle_attach;
 #elif CONFIG_IAQ_MQTT_TLS_TRUST_CA_PEM
 #ifdef IAQ_HAS_CA_PEM
-        ESP_LOGI(TAG, "MQTTS using embedded Root CA PEM");
-        mqtt_cfg.broker.verification.certificate = (const char *)_binary_components_connectivity_certs_ca_pem_start;
+        /* Parse the CA chain once into the global store; every reconnect reuses it */
+        if (!s_global_ca_ready) {
+            const size_t ca_len = (size_t)(_binary_components_connectivity_certs_ca_pem_end -
+                                           _binary_components_connectivity_certs_ca_pem_start);
+            s_global_ca_ready = esp_tls_init_global_ca_store() == ESP_OK &&
+                                esp_tls_set_global_ca_store(_binary_components_connectivity_certs_ca_pem_start, ca_len) == ESP_OK;
+        }
+        if (s_global_ca_ready) {
+            ESP_LOGI(TAG, "MQTTS using embedded Root CA PEM (global CA store)");
+            mqtt_cfg.broker.verification.use_global_ca_store = true;
+        } else {
+            ESP_LOGW(TAG, "Global CA store unavailable; CA PEM parsed on each connect");
+            mqtt_cfg.broker.verification.certificate = (const char *)_binary_components_connectivity_certs_ca_pem_start;
+        }
 #else
         ESP_LOGW(TAG, "IAQ_MQTT_TLS_TRUST_CA_PEM enabled but no ca.pem embedded; TLS verify may fail");
 #endif
@@ -694,6 +725,41 @@ esp_err_t mqtt_publish_diagnostics(const iaq_data_t *data)
         cJSON_AddItemToObject(root, "s8_diag", s8j);
     }
 
+    /* Per-sensor fault monitor results */
+    cJSON *health = cJSON_CreateObject();
+    if (!health) { cJSON_Delete(root); return ESP_ERR_NO_MEM; }
+    for (int i = 0; i < SENSOR_ID_MAX; ++i) {
+        sensor_runtime_info_t info;
+        if (sensor_coordinator_get_runtime_info((sensor_id_t)i, &info) != ESP_OK) continue;
+        cJSON *hj = cJSON_CreateObject();
+        if (!hj) continue;
+        cJSON_AddNumberToObject(hj, "score", info.health_score);
+        cJSON_AddNumberToObject(hj, "fault_flags", info.fault_flags);
+        cJSON *stats = iaq_json_build_sensor_stats(&info);
+        if (stats) cJSON_AddItemToObject(hj, "stats", stats);
+        cJSON_AddItemToObject(health, sensor_coordinator_id_to_name((sensor_id_t)i), hj);
+    }
+    cJSON_AddItemToObject(root, "sensor_health", health);
+
+    /* Broker connection setup cost */
+    mqtt_connect_stats_t cs;
+    mqtt_manager_get_connect_stats(&cs);
+    cJSON *link = cJSON_CreateObject();
+    if (!link) { cJSON_Delete(root); return ESP_ERR_NO_MEM; }
+    cJSON_AddBoolToObject(link, "tls", strncmp(s_broker_url, "mqtts://", 8) == 0);
+    cJSON_AddNumberToObject(link, "connects", cs.connects);
+    cJSON_AddNumberToObject(link, "failures", cs.failures);
+    cJSON_AddNumberToObject(link, "last_connect_ms", cs.last_ms);
+    cJSON_AddNumberToObject(link, "max_connect_ms", cs.max_ms);
+    if (cs.connects > 0) {
+        cJSON_AddNumberToObject(link, "avg_connect_ms", (double)(cs.total_ms / cs.connects));
+    }
+    cJSON_AddItemToObject(root, "mqtt_link", link);
+
+    /* Radio power-save level and residency */
+    cJSON *ps = wifi_ps_policy_build_json();
+    if (ps) cJSON_AddItemToObject(root, "wifi_ps", ps);
+
     return publish_json(TOPIC_DIAGNOSTICS, root);
 }
 #endif /* CONFIG_MQTT_PUBLISH_DIAGNOSTICS */
@@ -703,6 +769,30 @@ bool mqtt_manager_is_connected(void)
     return s_mqtt_connected;
 }
 
+void mqtt_manager_get_connect_stats(mqtt_connect_stats_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_conn_stats_lock);
+    *out = s_conn_stats;
+    portEXIT_CRITICAL(&s_conn_stats_lock);
+}
+
+void mqtt_manager_get_backlog(uint32_t *queued_events, uint32_t *outbox_bytes)
+{
+    uint32_t queued = s_publish_queue ? (uint32_t)uxQueueMessagesWaiting(s_publish_queue) : 0;
+    uint32_t outbox = 0;
+    /* Never wait: the lock is held across client stop/destroy */
+    if (s_mqtt_client_lock && xSemaphoreTake(s_mqtt_client_lock, 0) == pdTRUE) {
+        if (s_mqtt_client) {
+            int size = esp_mqtt_client_get_outbox_size(s_mqtt_client);
+            outbox = size > 0 ? (uint32_t)size : 0;
+        }
+        xSemaphoreGive(s_mqtt_client_lock);
+    }
+    if (queued_events) *queued_events = queued;
+    if (outbox_bytes) *outbox_bytes = outbox;
+}
+
 esp_err_t mqtt_manager_set_broker(const char *broker_url, const char *username, const char *password)
 {
     if (!broker_url) return ESP_ERR_INVALID_ARG;
@@ -776,8 +866,28 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     esp_mqtt_client_handle_t client = event->client;
 
     switch ((esp_mqtt_event_id_t)event_id) {
-        case MQTT_EVENT_CONNECTED:
-            ESP_LOGI(TAG, "MQTT connected");
+        case MQTT_EVENT_BEFORE_CONNECT:
+            portENTER_CRITICAL(&s_conn_stats_lock);
+            s_connect_start_us = (uint64_t)esp_timer_get_time();
+            s_conn_stats.attempts++;
+            portEXIT_CRITICAL(&s_conn_stats_lock);
+            break;
+        case MQTT_EVENT_CONNECTED: {
+            uint32_t connect_ms = 0;
+            portENTER_CRITICAL(&s_conn_stats_lock);
+            if (s_connect_start_us) {
+                uint64_t dt_us = (uint64_t)esp_timer_get_time() - s_connect_start_us;
+                connect_ms = (uint32_t)(dt_us / 1000ULL);
+                s_conn_stats.last_ms = connect_ms;
+                if (connect_ms > s_conn_stats.max_ms) s_conn_stats.max_ms = connect_ms;
+                s_conn_stats.total_ms += connect_ms;
+                s_conn_stats.connects++;
+                s_connect_start_us = 0;
+            }
+            portEXIT_CRITICAL(&s_conn_stats_lock);
+            iaq_profiler_record(IAQ_METRIC_MQTT_CONNECT, connect_ms * 1000U);
+            ESP_LOGI(TAG, "MQTT connected (%lu ms)", (unsigned long)connect_ms);
+            blackbox_record_event(BLACKBOX_EVENT_MQTT, 1, 0, 0, connect_ms);
             s_mqtt_connected = true;
             IAQ_DATA_WITH_LOCK() { iaq_data_get()->system.mqtt_connected = true; }
             xEventGroupSetBits(s_system_ctx->event_group, MQTT_CONNECTED_BIT);
@@ -794,8 +904,10 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             esp_mqtt_client_enqueue(client, TOPIC_STATUS, "online", 0, CONFIG_IAQ_MQTT_CRITICAL_QOS, 1, true);
             mqtt_publish_ha_discovery();
             break;
+        }
         case MQTT_EVENT_DISCONNECTED:
             ESP_LOGI(TAG, "MQTT disconnected");
+            blackbox_record_event(BLACKBOX_EVENT_MQTT, 0, 0, 0, 0);
             s_mqtt_connected = false;
             IAQ_DATA_WITH_LOCK() { iaq_data_get()->system.mqtt_connected = false; }
             xEventGroupClearBits(s_system_ctx->event_group, MQTT_CONNECTED_BIT);
@@ -842,6 +954,12 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         }
         case MQTT_EVENT_ERROR:
             ESP_LOGE(TAG, "MQTT error");
+            portENTER_CRITICAL(&s_conn_stats_lock);
+            if (s_connect_start_us) {
+                s_conn_stats.failures++;
+                s_connect_start_us = 0;
+            }
+            portEXIT_CRITICAL(&s_conn_stats_lock);
             if (event->error_handle && event->error_handle->error_type == MQTT_ERROR_TYPE_TCP_TRANSPORT) {
                 ESP_LOGE(TAG, "Last error code: 0x%x", event->error_handle->esp_tls_last_esp_err);
                 ESP_LOGE(TAG, "Last tls error: 0x%x", event->error_handle->esp_tls_stack_err);
@@ -873,11 +991,6 @@ static void mqtt_state_timer_callback(void *arg)
 {
     (void)arg;
     enqueue_publish_event(MQTT_PUBLISH_EVENT_STATE);
-
-    /* After first one-shot trigger, switch to periodic mode */
-    if (mqtt_manager_is_connected() && s_state_timer && !esp_timer_is_active(s_state_timer)) {
-        esp_timer_start_periodic(s_state_timer, CONFIG_MQTT_STATE_PUBLISH_INTERVAL_SEC * 1000000ULL);
-    }
 }
 
 /**
@@ -889,11 +1002,6 @@ static void mqtt_metrics_timer_callback(void *arg)
 {
     (void)arg;
     enqueue_publish_event(MQTT_PUBLISH_EVENT_METRICS);
-
-    /* After first one-shot trigger, switch to periodic mode */
-    if (mqtt_manager_is_connected() && s_metrics_timer && !esp_timer_is_active(s_metrics_timer)) {
-        esp_timer_start_periodic(s_metrics_timer, CONFIG_MQTT_METRICS_PUBLISH_INTERVAL_SEC * 1000000ULL);
-    }
 }
 
 #ifdef CONFIG_MQTT_PUBLISH_DIAGNOSTICS
@@ -906,11 +1014,6 @@ static void mqtt_diagnostics_timer_callback(void *arg)
 {
     (void)arg;
     enqueue_publish_event(MQTT_PUBLISH_EVENT_DIAGNOSTICS);
-
-    /* After first one-shot trigger, switch to periodic mode */
-    if (mqtt_manager_is_connected() && s_diagnostics_timer && !esp_timer_is_active(s_diagnostics_timer)) {
-        esp_timer_start_periodic(s_diagnostics_timer, CONFIG_MQTT_DIAGNOSTICS_PUBLISH_INTERVAL_SEC * 1000000ULL);
-    }
 }
 #endif /* CONFIG_MQTT_PUBLISH_DIAGNOSTICS */
 
@@ -923,10 +1026,6 @@ static void mqtt_power_timer_callback(void *arg)
 {
     (void)arg;
     enqueue_publish_event(MQTT_PUBLISH_EVENT_POWER);
-
-    if (mqtt_manager_is_connected() && s_power_timer && !esp_timer_is_active(s_power_timer)) {
-        esp_timer_start_periodic(s_power_timer, CONFIG_MQTT_STATE_PUBLISH_INTERVAL_SEC * 1000000ULL);
-    }
 }
 #endif /* CONFIG_IAQ_MQTT_PUBLISH_POWER */
 
@@ -980,22 +1079,20 @@ static bool parse_co2_calibration_payload(const char *payload, int *ppm_out)
     return true;
 }
 
-static esp_err_t start_periodic_timer(esp_timer_handle_t *handle,
-                                      const esp_timer_create_args_t *args,
+static esp_err_t start_periodic_timer(periodic_work_handle_t *handle,
+                                      const periodic_work_args_t *args,
+                                      uint64_t first_delay_us,
                                       uint64_t period_us)
 {
     if (*handle == NULL) {
-        esp_err_t ret = esp_timer_create(args, handle);
+        esp_err_t ret = periodic_sched_create(args, handle);
         if (ret != ESP_OK) {
             return ret;
         }
     }
 
-    if (!esp_timer_is_active(*handle)) {
-        esp_err_t ret = esp_timer_start_periodic(*handle, period_us);
-        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-            return ret;
-        }
+    if (!periodic_sched_is_active(*handle)) {
+        return periodic_sched_start(*handle, first_delay_us, period_us);
     }
 
     return ESP_OK;
@@ -1004,95 +1101,76 @@ static esp_err_t start_periodic_timer(esp_timer_handle_t *handle,
 static esp_err_t ensure_publish_timers_started(void)
 {
     /* Start publish timers only while MQTT is connected.
-     * Stagger topic timers to flatten CPU/network bursts after connect. */
+     * Stagger topic timers to flatten CPU/network bursts after connect;
+     * the slack lets each publish ride on an existing wake-up. */
 
     esp_err_t ret;
 
     /* Health timer - starts immediately */
-    const esp_timer_create_args_t health_args = {
+    const periodic_work_args_t health_args = {
         .callback = &mqtt_health_timer_callback,
-        .name = "mqtt_health"
+        .name = "mqtt_health",
+        .subsystem = "mqtt",
+        .slack_ms = SLACK_MS_MQTT_PUBLISH,
     };
-    ret = start_periodic_timer(&s_health_timer, &health_args, STATUS_PUBLISH_INTERVAL_MS * 1000ULL);
+    ret = start_periodic_timer(&s_health_timer, &health_args,
+                               STATUS_PUBLISH_INTERVAL_MS * 1000ULL, STATUS_PUBLISH_INTERVAL_MS * 1000ULL);
     if (ret != ESP_OK) {
         return ret;
     }
 
     /* State timer - stagger by 5 seconds */
-    if (s_state_timer == NULL) {
-        const esp_timer_create_args_t state_args = {
-            .callback = &mqtt_state_timer_callback,
-            .name = "mqtt_state"
-        };
-        ret = esp_timer_create(&state_args, &s_state_timer);
-        if (ret != ESP_OK) {
-            return ret;
-        }
-    }
-    if (!esp_timer_is_active(s_state_timer)) {
-        /* Start with 5 second initial delay, then periodic */
-        ret = esp_timer_start_once(s_state_timer, 5000000ULL);
-        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-            return ret;
-        }
+    const periodic_work_args_t state_args = {
+        .callback = &mqtt_state_timer_callback,
+        .name = "mqtt_state",
+        .subsystem = "mqtt",
+        .slack_ms = SLACK_MS_MQTT_PUBLISH,
+    };
+    ret = start_periodic_timer(&s_state_timer, &state_args,
+                               5000000ULL, CONFIG_MQTT_STATE_PUBLISH_INTERVAL_SEC * 1000000ULL);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
     /* Metrics timer - stagger by 10 seconds */
-    if (s_metrics_timer == NULL) {
-        const esp_timer_create_args_t metrics_args = {
-            .callback = &mqtt_metrics_timer_callback,
-            .name = "mqtt_metrics"
-        };
-        ret = esp_timer_create(&metrics_args, &s_metrics_timer);
-        if (ret != ESP_OK) {
-            return ret;
-        }
-    }
-    if (!esp_timer_is_active(s_metrics_timer)) {
-        /* Start with 10 second initial delay, then periodic */
-        ret = esp_timer_start_once(s_metrics_timer, 10000000ULL);
-        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-            return ret;
-        }
+    const periodic_work_args_t metrics_args = {
+        .callback = &mqtt_metrics_timer_callback,
+        .name = "mqtt_metrics",
+        .subsystem = "mqtt",
+        .slack_ms = SLACK_MS_MQTT_PUBLISH,
+    };
+    ret = start_periodic_timer(&s_metrics_timer, &metrics_args,
+                               10000000ULL, CONFIG_MQTT_METRICS_PUBLISH_INTERVAL_SEC * 1000000ULL);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
 #ifdef CONFIG_MQTT_PUBLISH_DIAGNOSTICS
     /* Diagnostics timer - stagger by 15 seconds */
-    if (s_diagnostics_timer == NULL) {
-        const esp_timer_create_args_t diag_args = {
-            .callback = &mqtt_diagnostics_timer_callback,
-            .name = "mqtt_diag"
-        };
-        ret = esp_timer_create(&diag_args, &s_diagnostics_timer);
-        if (ret != ESP_OK) {
-            return ret;
-        }
-    }
-    if (!esp_timer_is_active(s_diagnostics_timer)) {
-        /* Start with 15 second initial delay, then periodic */
-        ret = esp_timer_start_once(s_diagnostics_timer, 15000000ULL);
-        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-            return ret;
-        }
+    const periodic_work_args_t diag_args = {
+        .callback = &mqtt_diagnostics_timer_callback,
+        .name = "mqtt_diag",
+        .subsystem = "mqtt",
+        .slack_ms = SLACK_MS_MQTT_DIAGNOSTICS,
+    };
+    ret = start_periodic_timer(&s_diagnostics_timer, &diag_args,
+                               15000000ULL, CONFIG_MQTT_DIAGNOSTICS_PUBLISH_INTERVAL_SEC * 1000000ULL);
+    if (ret != ESP_OK) {
+        return ret;
     }
 #endif
 #ifdef CONFIG_IAQ_MQTT_PUBLISH_POWER
     /* Power timer - share state cadence (starts after 5s) */
-    if (s_power_timer == NULL) {
-        const esp_timer_create_args_t power_args = {
-            .callback = &mqtt_power_timer_callback,
-            .name = "mqtt_power"
-        };
-        ret = esp_timer_create(&power_args, &s_power_timer);
-        if (ret != ESP_OK) {
-            return ret;
-        }
-    }
-    if (!esp_timer_is_active(s_power_timer)) {
-        ret = esp_timer_start_once(s_power_timer, 5000000ULL);
-        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-            return ret;
-        }
+    const periodic_work_args_t power_args = {
+        .callback = &mqtt_power_timer_callback,
+        .name = "mqtt_power",
+        .subsystem = "mqtt",
+        .slack_ms = SLACK_MS_MQTT_PUBLISH,
+    };
+    ret = start_periodic_timer(&s_power_timer, &power_args,
+                               5000000ULL, CONFIG_MQTT_STATE_PUBLISH_INTERVAL_SEC * 1000000ULL);
+    if (ret != ESP_OK) {
+        return ret;
     }
 #endif
 
@@ -1102,22 +1180,22 @@ static esp_err_t ensure_publish_timers_started(void)
 static void stop_publish_timers(void)
 {
     if (s_health_timer) {
-        (void)esp_timer_stop(s_health_timer);
+        (void)periodic_sched_stop(s_health_timer);
     }
     if (s_state_timer) {
-        (void)esp_timer_stop(s_state_timer);
+        (void)periodic_sched_stop(s_state_timer);
     }
     if (s_metrics_timer) {
-        (void)esp_timer_stop(s_metrics_timer);
+        (void)periodic_sched_stop(s_metrics_timer);
     }
 #ifdef CONFIG_MQTT_PUBLISH_DIAGNOSTICS
     if (s_diagnostics_timer) {
-        (void)esp_timer_stop(s_diagnostics_timer);
+        (void)periodic_sched_stop(s_diagnostics_timer);
     }
 #endif
 #ifdef CONFIG_IAQ_MQTT_PUBLISH_POWER
     if (s_power_timer) {
-        (void)esp_timer_stop(s_power_timer);
+        (void)periodic_sched_stop(s_power_timer);
     }
 #endif
 }
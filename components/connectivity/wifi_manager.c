@@ -13,6 +13,7 @@
 #include "nvs.h"
 
 #include "wifi_manager.h"
+#include "wifi_ps_policy.h"
 #include "iaq_data.h"
 #include "iaq_config.h"
 
@@ -70,6 +71,7 @@ static void wifi_manager_apply_ps(wifi_mode_t mode)
 {
     /* Only applies to STA/APSTA */
     if (mode != WIFI_MODE_STA && mode != WIFI_MODE_APSTA) {
+        wifi_ps_policy_stop();
         (void)esp_wifi_set_ps(WIFI_PS_NONE);
         return;
     }
@@ -81,6 +83,15 @@ static void wifi_manager_apply_ps(wifi_mode_t mode)
     return;
 #endif
 
+#ifdef CONFIG_IAQ_WIFI_PS_ADAPTIVE
+    if (wifi_ps_policy_start() == ESP_OK) {
+        return;
+    }
+    ESP_LOGW(TAG, "Adaptive power save unavailable; using modem sleep (min)");
+    (void)esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+    return;
+#endif
+
     wifi_ps_type_t ps = WIFI_PS_NONE;
 #ifdef CONFIG_IAQ_WIFI_PS_MODEM_MIN
     ps = WIFI_PS_MIN_MODEM;
@@ -487,6 +498,7 @@ esp_err_t wifi_manager_stop(void)
     s_reconnect_allowed = false;
     s_reconnect_backoff_attempt = 0;
     wifi_cancel_reconnect();
+    wifi_ps_policy_stop();
     esp_err_t ret = esp_wifi_stop();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to stop WiFi: %s", esp_err_to_name(ret));
@@ -0,0 +1,267 @@
+/* components/connectivity/wifi_ps_policy.c */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_wifi.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "wifi_ps_policy.h"
+#include "mqtt_manager.h"
+#include "periodic_sched.h"
+#include "iaq_config.h"
+
+static const char *TAG = "WIFI_PS";
+
+#ifndef CONFIG_IAQ_WIFI_PS_HOLD_S
+#define CONFIG_IAQ_WIFI_PS_HOLD_S 30
+#endif
+#ifndef CONFIG_IAQ_WIFI_PS_RTT_HIGH_MS
+#define CONFIG_IAQ_WIFI_PS_RTT_HIGH_MS 300
+#endif
+
+#define POLICY_TICK_US          1000000ULL
+#define HOLD_US                 ((int64_t)CONFIG_IAQ_WIFI_PS_HOLD_S * 1000000LL)
+#define MQTT_BACKLOG_EVENTS     4       /* Publish events waiting for the worker */
+#define MQTT_BACKLOG_BYTES      4096    /* Unacknowledged bytes in the client outbox */
+#define RTT_STALE_US            (90LL * 1000000LL)
+
+static const wifi_ps_level_t k_demand_level[WIFI_PS_DEMAND_COUNT] = {
+    [WIFI_PS_DEMAND_DASHBOARD] = WIFI_PS_LEVEL_INTERACTIVE,
+    [WIFI_PS_DEMAND_CONSOLE]   = WIFI_PS_LEVEL_INTERACTIVE,
+    [WIFI_PS_DEMAND_OTA]       = WIFI_PS_LEVEL_BULK,
+};
+
+static const wifi_ps_type_t k_level_ps[WIFI_PS_LEVEL_COUNT] = {
+    [WIFI_PS_LEVEL_IDLE]        = WIFI_PS_MAX_MODEM,
+    [WIFI_PS_LEVEL_INTERACTIVE] = WIFI_PS_MIN_MODEM,
+    [WIFI_PS_LEVEL_BULK]        = WIFI_PS_NONE,
+};
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static wifi_ps_probe_t s_probes[WIFI_PS_DEMAND_COUNT];
+static periodic_work_handle_t s_tick = NULL;
+
+/* Guarded by s_lock */
+static bool s_running = false;
+static wifi_ps_level_t s_level = WIFI_PS_LEVEL_INTERACTIVE;
+static int64_t s_level_since_us = 0;
+static int64_t s_below_since_us = 0;    /* Demand below s_level since (0 = it is not) */
+static uint64_t s_residency_us[WIFI_PS_LEVEL_COUNT];
+static uint32_t s_transitions = 0;
+static uint32_t s_reasons = 0;
+static uint32_t s_rtt_ms = 0;           /* EWMA, 1/4 weight per sample */
+static int64_t s_rtt_at_us = 0;
+static bool s_rtt_escalated = false;    /* Latched until interactive demand ends */
+
+const char *wifi_ps_level_name(wifi_ps_level_t level)
+{
+    switch (level) {
+        case WIFI_PS_LEVEL_IDLE:        return "idle";
+        case WIFI_PS_LEVEL_INTERACTIVE: return "interactive";
+        case WIFI_PS_LEVEL_BULK:        return "bulk";
+        default:                        return "unknown";
+    }
+}
+
+static void apply_level(wifi_ps_level_t level, uint32_t reasons)
+{
+    esp_err_t ret = esp_wifi_set_ps(k_level_ps[level]);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "WiFi power save -> %s (demand 0x%02lx)",
+                 wifi_ps_level_name(level), (unsigned long)reasons);
+    } else {
+        ESP_LOGW(TAG, "Failed to set WiFi power save: %s", esp_err_to_name(ret));
+    }
+}
+
+/* Caller holds s_lock */
+static void enter_level_locked(wifi_ps_level_t level, int64_t now_us)
+{
+    s_residency_us[s_level] += (uint64_t)(now_us - s_level_since_us);
+    s_level_since_us = now_us;
+    s_level = level;
+    s_below_since_us = 0;
+    s_transitions++;
+}
+
+static void policy_tick(void *arg)
+{
+    (void)arg;
+
+    /* Sample demand outside the lock; probes may take their own locks */
+    uint32_t reasons = 0;
+    wifi_ps_level_t want = WIFI_PS_LEVEL_IDLE;
+    for (int i = 0; i < WIFI_PS_DEMAND_COUNT; i++) {
+        wifi_ps_probe_t probe = s_probes[i];
+        if (probe && probe()) {
+            reasons |= 1u << i;
+            if (k_demand_level[i] > want) want = k_demand_level[i];
+        }
+    }
+    uint32_t queued = 0, outbox = 0;
+    mqtt_manager_get_backlog(&queued, &outbox);
+    if (queued >= MQTT_BACKLOG_EVENTS || outbox >= MQTT_BACKLOG_BYTES) {
+        reasons |= WIFI_PS_REASON_MQTT_BACKLOG;
+        want = WIFI_PS_LEVEL_BULK;
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool changed = false;
+    wifi_ps_level_t level;
+    portENTER_CRITICAL(&s_lock);
+    if (!s_running) {
+        portEXIT_CRITICAL(&s_lock);
+        return;
+    }
+
+    /* Slow round trips while someone is watching: keep the radio awake
+     * until they leave, rather than bouncing as the RTT recovers */
+    if (want == WIFI_PS_LEVEL_IDLE) {
+        s_rtt_escalated = false;
+        s_rtt_ms = 0;
+    } else if (s_rtt_ms >= CONFIG_IAQ_WIFI_PS_RTT_HIGH_MS && (now - s_rtt_at_us) < RTT_STALE_US) {
+        s_rtt_escalated = true;
+    }
+    if (s_rtt_escalated) {
+        reasons |= WIFI_PS_REASON_LATENCY;
+        want = WIFI_PS_LEVEL_BULK;
+    }
+
+    if (want > s_level) {
+        enter_level_locked(want, now);
+        changed = true;
+    } else if (want < s_level) {
+        if (s_below_since_us == 0) {
+            s_below_since_us = now;
+        } else if (now - s_below_since_us >= HOLD_US) {
+            enter_level_locked(want, now);
+            changed = true;
+        }
+    } else {
+        s_below_since_us = 0;
+    }
+    s_reasons = reasons;
+    level = s_level;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (changed) {
+        apply_level(level, reasons);
+    }
+}
+
+void wifi_ps_policy_register_probe(wifi_ps_demand_t source, wifi_ps_probe_t probe)
+{
+    if ((unsigned)source >= WIFI_PS_DEMAND_COUNT) return;
+    s_probes[source] = probe;
+}
+
+void wifi_ps_policy_note_rtt(uint32_t rtt_ms)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_rtt_ms = s_rtt_ms ? (s_rtt_ms * 3 + rtt_ms) / 4 : rtt_ms;
+    s_rtt_at_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t wifi_ps_policy_start(void)
+{
+    if (!s_tick) {
+        const periodic_work_args_t args = {
+            .callback = policy_tick,
+            .name = "wifi_ps",
+            .subsystem = "wifi",
+            .slack_ms = SLACK_MS_WIFI_PS,
+        };
+        esp_err_t err = periodic_sched_create(&args, &s_tick);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create policy tick: %s", esp_err_to_name(err));
+            return err;
+        }
+    }
+
+    /* Connection setup (DHCP, SNTP, MQTT/TLS) benefits from a responsive
+     * radio; the hold time then walks it down to idle */
+    portENTER_CRITICAL(&s_lock);
+    bool was_running = s_running;
+    if (!was_running) {
+        s_running = true;
+        s_level = WIFI_PS_LEVEL_INTERACTIVE;
+        s_level_since_us = esp_timer_get_time();
+        s_below_since_us = 0;
+        s_rtt_escalated = false;
+    }
+    wifi_ps_level_t level = s_level;
+    portEXIT_CRITICAL(&s_lock);
+
+    apply_level(level, 0);
+    if (!was_running) {
+        return periodic_sched_start(s_tick, POLICY_TICK_US, POLICY_TICK_US);
+    }
+    return ESP_OK;
+}
+
+void wifi_ps_policy_stop(void)
+{
+    if (s_tick) {
+        (void)periodic_sched_stop(s_tick);
+    }
+    portENTER_CRITICAL(&s_lock);
+    if (s_running) {
+        s_residency_us[s_level] += (uint64_t)(esp_timer_get_time() - s_level_since_us);
+        s_running = false;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void wifi_ps_policy_get_stats(wifi_ps_policy_stats_t *out)
+{
+    if (!out) return;
+    uint64_t residency_us[WIFI_PS_LEVEL_COUNT];
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_lock);
+    memcpy(residency_us, s_residency_us, sizeof(residency_us));
+    if (s_running) {
+        residency_us[s_level] += (uint64_t)(now - s_level_since_us);
+    }
+    out->running = s_running;
+    out->level = s_level;
+    out->reasons = s_reasons;
+    out->transitions = s_transitions;
+    out->rtt_ms = (now - s_rtt_at_us) < RTT_STALE_US ? s_rtt_ms : 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    for (int i = 0; i < WIFI_PS_LEVEL_COUNT; i++) {
+        out->residency_ms[i] = residency_us[i] / 1000ULL;
+    }
+}
+
+cJSON *wifi_ps_policy_build_json(void)
+{
+    static const char *const reason_names[] = {
+        "dashboard", "console", "ota", "mqtt_backlog", "latency",
+    };
+    wifi_ps_policy_stats_t st;
+    wifi_ps_policy_get_stats(&st);
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return NULL;
+    cJSON_AddBoolToObject(root, "adaptive", st.running);
+    cJSON_AddStringToObject(root, "level", wifi_ps_level_name(st.level));
+    cJSON *demand = cJSON_AddArrayToObject(root, "demand");
+    for (size_t i = 0; demand && i < sizeof(reason_names) / sizeof(reason_names[0]); i++) {
+        if (st.reasons & (1u << i)) {
+            cJSON_AddItemToArray(demand, cJSON_CreateString(reason_names[i]));
+        }
+    }
+    cJSON_AddNumberToObject(root, "transitions", st.transitions);
+    if (st.rtt_ms > 0) {
+        cJSON_AddNumberToObject(root, "rtt_ms", st.rtt_ms);
+    }
+    cJSON *res = cJSON_AddObjectToObject(root, "residency_s");
+    for (int i = 0; res && i < WIFI_PS_LEVEL_COUNT; i++) {
+        cJSON_AddNumberToObject(res, wifi_ps_level_name((wifi_ps_level_t)i), (double)(st.residency_ms[i] / 1000ULL));
+    }
+    return root;
+}
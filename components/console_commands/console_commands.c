@@ -2,11 +2,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <strings.h>
 #include <ctype.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_console.h"
 #include "esp_system.h"
@@ -20,11 +22,15 @@
 #include "iaq_data.h"
 #include "iaq_config.h"
 #include "wifi_manager.h"
+#include "wifi_ps_policy.h"
 #include "mqtt_manager.h"
 #include "sensor_coordinator.h"
 #include "s8_driver.h"
 #include "power_board.h"
 #include "log_control.h"
+#include "blackbox.h"
+#include "iaq_profiler.h"
+#include "periodic_sched.h"
 /* SGP41 baseline ops removed; no direct console hooks needed */
 
 static const char *TAG = "CONSOLE_CMD";
@@ -190,18 +196,107 @@ static void print_log_help(void)
     printf("  log app <level>\n");
     printf("  log sys <level>\n");
     printf("  log reset\n");
+    printf("  log limit [show|on|off|reset]\n");
+    printf("  log limit site|tag <lines/min> [burst]\n");
+    printf("  log limit summary <seconds>\n");
     printf("Levels: none, error, warn, info, debug, verbose (or 0-5)\n");
 }
 
+static void print_log_limit_status(void)
+{
+    log_ratelimit_cfg_t cfg;
+    log_ratelimit_stats_t st;
+    log_control_get_ratelimit(&cfg);
+    log_control_get_ratelimit_stats(&st);
+
+    printf("Rate limit: %s\n", cfg.enabled ? "on" : "off");
+    printf("  site: %u lines/min, burst %u\n", cfg.site_per_min, cfg.site_burst);
+    printf("  tag:  %u lines/min, burst %u\n", cfg.tag_per_min, cfg.tag_burst);
+    printf("  summary every %us\n", cfg.summary_s);
+    printf("  passed %lu, suppressed %lu, untracked %lu (%u sites, %u tags)\n",
+           (unsigned long)st.passed, (unsigned long)st.suppressed, (unsigned long)st.untracked,
+           st.sites, st.tags);
+
+    log_ratelimit_tag_stats_t tags[8];
+    size_t n = log_control_get_ratelimit_tags(tags, sizeof(tags) / sizeof(tags[0]));
+    for (size_t i = 0; i < n; ++i) {
+        printf("  %-16s %8lu suppressed (%lu pending)\n", tags[i].tag,
+               (unsigned long)tags[i].suppressed, (unsigned long)tags[i].pending);
+    }
+}
+
+static bool parse_u16_arg(const char *arg, uint16_t min, uint16_t max, uint16_t *out)
+{
+    char *end = NULL;
+    long v = strtol(arg, &end, 10);
+    if (!end || *end != '\0' || v < min || v > max) return false;
+    *out = (uint16_t)v;
+    return true;
+}
+
+static int cmd_log_limit(int argc, char **argv)
+{
+    if (argc == 1 || strcmp(argv[1], "show") == 0) {
+        print_log_limit_status();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "reset") == 0) {
+        esp_err_t err = log_control_reset_ratelimit(true);
+        if (err != ESP_OK) {
+            printf("Error: failed to reset rate limits: %s\n", esp_err_to_name(err));
+            return 1;
+        }
+        printf("Log rate limits reset to defaults\n");
+        return 0;
+    }
+
+    log_ratelimit_cfg_t cfg;
+    log_control_get_ratelimit(&cfg);
+    if (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0) {
+        cfg.enabled = strcmp(argv[1], "on") == 0;
+    } else if ((strcmp(argv[1], "site") == 0 || strcmp(argv[1], "tag") == 0) && argc >= 3) {
+        bool site = strcmp(argv[1], "site") == 0;
+        uint16_t *per_min = site ? &cfg.site_per_min : &cfg.tag_per_min;
+        uint16_t *burst = site ? &cfg.site_burst : &cfg.tag_burst;
+        if (!parse_u16_arg(argv[2], 1, 60000, per_min) ||
+            (argc >= 4 && !parse_u16_arg(argv[3], 1, 1000, burst))) {
+            printf("Error: expected <lines/min 1-60000> [burst 1-1000]\n");
+            return 1;
+        }
+    } else if (strcmp(argv[1], "summary") == 0 && argc >= 3) {
+        if (!parse_u16_arg(argv[2], 5, 3600, &cfg.summary_s)) {
+            printf("Error: summary period must be 5-3600 seconds\n");
+            return 1;
+        }
+    } else {
+        print_log_help();
+        return 1;
+    }
+
+    esp_err_t err = log_control_set_ratelimit(&cfg, true);
+    if (err != ESP_OK) {
+        printf("Error: failed to set rate limits: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    print_log_limit_status();
+    return 0;
+}
+
 /* ==================== LOG COMMAND ==================== */
 static int cmd_log(int argc, char **argv)
 {
+    if (argc >= 2 && strcmp(argv[1], "limit") == 0) {
+        return cmd_log_limit(argc - 1, argv + 1);
+    }
+
 #if !CONFIG_LOG_DYNAMIC_LEVEL_CONTROL
     printf("Error: dynamic log control is disabled in Kconfig\n");
     return 1;
 #else
     if (argc == 1 || (argc >= 2 && strcmp(argv[1], "show") == 0)) {
         print_log_status();
+        print_log_limit_status();
         return 0;
     }
 
@@ -344,6 +439,17 @@ static int cmd_status(int argc, char **argv)
         printf("Overall IAQ Score: %u/100\n", data->metrics.overall_iaq_score);
     }
 
+    /* Periodic work wake-ups (last complete minute) */
+    periodic_sched_subsys_stats_t wake[PERIODIC_SCHED_MAX_SUBSYSTEMS];
+    uint32_t wake_total = 0;
+    int wake_n = periodic_sched_get_stats(wake, PERIODIC_SCHED_MAX_SUBSYSTEMS, &wake_total);
+    printf("\n--- Wake-ups (last minute) ---\n");
+    printf("Total: %lu\n", (unsigned long)wake_total);
+    for (int i = 0; i < wake_n; i++) {
+        printf("%-8s %lu wakes, %lu runs\n", wake[i].subsystem,
+               (unsigned long)wake[i].wakeups, (unsigned long)wake[i].runs);
+    }
+
     printf("\n");
     return 0;
 }
@@ -402,6 +508,23 @@ static int cmd_wifi_status(int argc, char **argv)
         }
     }
 
+    /* Adaptive power save */
+    wifi_ps_policy_stats_t ps;
+    wifi_ps_policy_get_stats(&ps);
+    uint64_t total_ms = 0;
+    for (int i = 0; i < WIFI_PS_LEVEL_COUNT; i++) total_ms += ps.residency_ms[i];
+    if (ps.running || total_ms > 0) {
+        printf("Power save: %s%s", ps.running ? "" : "(inactive) ", wifi_ps_level_name(ps.level));
+        if (ps.reasons) printf(" (demand 0x%02lx)", (unsigned long)ps.reasons);
+        if (ps.rtt_ms) printf(", RTT %lu ms", (unsigned long)ps.rtt_ms);
+        printf(", %lu transitions\n", (unsigned long)ps.transitions);
+        for (int i = 0; i < WIFI_PS_LEVEL_COUNT && total_ms > 0; i++) {
+            printf("  %-12s %6llu s  %5.1f%%\n", wifi_ps_level_name((wifi_ps_level_t)i),
+                   (unsigned long long)(ps.residency_ms[i] / 1000ULL),
+                   100.0 * (double)ps.residency_ms[i] / (double)total_ms);
+        }
+    }
+
     printf("\n");
     return 0;
 }
@@ -1041,6 +1164,83 @@ static int cmd_version(int argc, char **argv)
     return 0;
 }
 
+/* ==================== BLACKBOX COMMAND ==================== */
+static void blackbox_print_event(const blackbox_event_t *ev)
+{
+    printf("  %8lu ms  %-12s ", (unsigned long)ev->t_ms, blackbox_event_kind_name(ev->kind));
+    switch (ev->kind) {
+        case BLACKBOX_EVENT_BOOT:
+            printf("reset=%s boot=%lu\n", blackbox_reset_reason_name(ev->a), (unsigned long)ev->value);
+            break;
+        case BLACKBOX_EVENT_SENSOR_STATE:
+            printf("%s %s -> %s\n", sensor_coordinator_id_to_name((sensor_id_t)ev->a),
+                   sensor_coordinator_state_to_string((sensor_state_t)ev->b),
+                   sensor_coordinator_state_to_string((sensor_state_t)ev->c));
+            break;
+        case BLACKBOX_EVENT_WIFI:
+        case BLACKBOX_EVENT_MQTT:
+            printf("%s\n", ev->a ? "connected" : "disconnected");
+            break;
+        default:
+            printf("a=%u b=%u c=%u value=%lu\n", ev->a, ev->b, ev->c, (unsigned long)ev->value);
+            break;
+    }
+}
+
+static int cmd_blackbox(int argc, char **argv)
+{
+    bool current = argc >= 2 && strcmp(argv[1], "current") == 0;
+    if (argc >= 2 && !current && strcmp(argv[1], "show") != 0) {
+        printf("Usage: blackbox [show|current]\n");
+        return 1;
+    }
+
+    const blackbox_dump_t *d = NULL;
+    blackbox_dump_t *owned = NULL;
+    if (current) {
+        esp_err_t err = blackbox_capture_current(&owned);
+        if (err != ESP_OK) {
+            printf("Black box unavailable: %s\n", esp_err_to_name(err));
+            return 1;
+        }
+        d = owned;
+    } else if (!blackbox_get_previous(&d)) {
+        printf("No black box from a previous boot (power-on reset or recorder disabled)\n");
+        return 0;
+    }
+
+    printf("\n=== Black Box (%s boot #%lu, reset: %s) ===\n", current ? "current" : "previous",
+           (unsigned long)d->boot_count, blackbox_reset_reason_name(d->reset_reason));
+    printf("Last record at %lu ms uptime", (unsigned long)d->last_ms);
+    if (d->wall_s > 0) {
+        time_t t = (time_t)d->wall_s;
+        struct tm tm;
+        char buf[32];
+        gmtime_r(&t, &tm);
+        strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S UTC", &tm);
+        printf(" (%s)", buf);
+    }
+    printf("\n\nEvents (%u):\n", (unsigned)d->event_count);
+    for (size_t i = 0; i < d->event_count; i++) blackbox_print_event(&d->events[i]);
+
+    printf("\nSpans (%u):\n", (unsigned)d->span_count);
+    for (size_t i = 0; i < d->span_count; i++) {
+        const char *name = iaq_profiler_metric_name(d->spans[i].metric);
+        printf("  %8lu ms  ", (unsigned long)d->spans[i].t_ms);
+        if (name) printf("%-24s", name);
+        else printf("metric %-17u", d->spans[i].metric);
+        printf(" %lu\n", (unsigned long)d->spans[i].value);
+    }
+
+    printf("\nLogs (%u):\n", (unsigned)d->log_count);
+    for (size_t i = 0; i < d->log_count; i++) {
+        printf("  %8lu ms  %c %s\n", (unsigned long)d->logs[i].t_ms, d->logs[i].level, d->logs[i].text);
+    }
+    printf("\n");
+    blackbox_free_dump(owned);
+    return 0;
+}
+
 /* ==================== POWER COMMAND (PowerFeather) ==================== */
 static bool power_parse_on_off(const char *arg, bool *out)
 {
@@ -1388,6 +1588,105 @@ static int cmd_display(int argc, char **argv)
 #endif /* CONFIG_IAQ_OLED_ENABLE */
 
 /* ==================== INITIALIZATION ==================== */
+static const esp_console_cmd_t s_commands[] = {
+    { .command = "log",     .help = "Log levels and rate limiting",         .hint = NULL, .func = &cmd_log },
+    { .command = "status",  .help = "Show comprehensive system status",     .hint = NULL, .func = &cmd_status },
+    { .command = "restart", .help = "Restart the system",                   .hint = NULL, .func = &cmd_restart },
+    { .command = "wifi",    .help = "WiFi management commands",             .hint = NULL, .func = &cmd_wifi },
+    { .command = "mqtt",    .help = "MQTT management commands",             .hint = NULL, .func = &cmd_mqtt },
+    { .command = "sensor",  .help = "Sensor control commands",              .hint = NULL, .func = &cmd_sensor },
+    { .command = "power",   .help = "PowerFeather power status/control",    .hint = NULL, .func = &cmd_power },
+    { .command = "free",    .help = "Show memory information",              .hint = NULL, .func = &cmd_free },
+    { .command = "version", .help = "Show version and system information",  .hint = NULL, .func = &cmd_version },
+    { .command = "blackbox",.help = "Show the crash black box (previous or current boot)", .hint = "[show|current]", .func = &cmd_blackbox },
+#if CONFIG_IAQ_OLED_ENABLE
+    { .command = "display", .help = "Display control commands",             .hint = NULL, .func = &cmd_display },
+#endif
+};
+
+/* Commands that only report state. sub == NULL matches the bare command;
+ * max_argc == 0 means any argument count. */
+typedef struct {
+    const char *command;
+    const char *sub;
+    int max_argc;
+    const char *arg;        /* Required third word (NULL = not checked) */
+} readonly_cmd_t;
+
+static const readonly_cmd_t s_readonly_cmds[] = {
+    { "help",    NULL,      0 },
+    { "status",  NULL,      0 },
+    { "free",    NULL,      0 },
+    { "version", NULL,      0 },
+    { "blackbox", NULL,     0 },
+    { "log",     NULL,      1 },
+    { "log",     "show",    0 },
+    { "log",     "limit",   2 },
+    { "log",     "limit",   3, "show" },
+    { "wifi",    NULL,      1 },
+    { "wifi",    "status",  0 },
+    { "wifi",    "scan",    0 },
+    { "mqtt",    NULL,      1 },
+    { "mqtt",    "status",  0 },
+    { "sensor",  NULL,      1 },
+    { "sensor",  "status",  0 },
+    { "sensor",  "read",    0 },
+    { "sensor",  "cadence", 2 },
+    { "power",   NULL,      1 },
+    { "power",   "status",  0 },
+    { "display", NULL,      1 },
+    { "display", "status",  0 },
+};
+
+#define CONSOLE_MAX_CMDLINE 256
+#define CONSOLE_MAX_ARGS    16
+
+/* esp_console_run() parses into a shared static buffer; only `help` (owned
+ * by esp_console) still goes through it */
+static SemaphoreHandle_t s_help_lock = NULL;
+
+static bool command_is_readonly(int argc, char **argv)
+{
+    for (size_t i = 0; i < sizeof(s_readonly_cmds) / sizeof(s_readonly_cmds[0]); ++i) {
+        const readonly_cmd_t *r = &s_readonly_cmds[i];
+        if (strcmp(argv[0], r->command) != 0) continue;
+        if (r->max_argc > 0 && argc > r->max_argc) continue;
+        if (r->arg && (argc < 3 || strcmp(argv[2], r->arg) != 0)) continue;
+        if (!r->sub || (argc >= 2 && strcmp(argv[1], r->sub) == 0)) return true;
+    }
+    return false;
+}
+
+esp_err_t console_commands_run(const char *cmdline, bool read_only, int *cmd_ret)
+{
+#if CONFIG_IAQ_ENABLE_CONSOLE_COMMANDS
+    if (!cmdline || !cmd_ret) return ESP_ERR_INVALID_ARG;
+    if (strlen(cmdline) >= CONSOLE_MAX_CMDLINE) return ESP_ERR_INVALID_SIZE;
+
+    char line[CONSOLE_MAX_CMDLINE];
+    char *argv[CONSOLE_MAX_ARGS] = {0};
+    strlcpy(line, cmdline, sizeof(line));
+    int argc = (int)esp_console_split_argv(line, argv, CONSOLE_MAX_ARGS);
+    if (argc == 0) return ESP_ERR_INVALID_ARG;
+    if (read_only && !command_is_readonly(argc, argv)) return ESP_ERR_NOT_ALLOWED;
+
+    for (size_t i = 0; i < sizeof(s_commands) / sizeof(s_commands[0]); ++i) {
+        if (strcmp(argv[0], s_commands[i].command) == 0) {
+            *cmd_ret = s_commands[i].func(argc, argv);
+            return ESP_OK;
+        }
+    }
+
+    if (s_help_lock) xSemaphoreTake(s_help_lock, portMAX_DELAY);
+    esp_err_t err = esp_console_run(cmdline, cmd_ret);
+    if (s_help_lock) xSemaphoreGive(s_help_lock);
+    return err;
+#else
+    (void)cmdline; (void)read_only; (void)cmd_ret;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 esp_err_t console_commands_init(void)
 {
 #if CONFIG_IAQ_ENABLE_CONSOLE_COMMANDS
@@ -1402,97 +1701,11 @@ esp_err_t console_commands_init(void)
     /* Register help command */
     esp_console_register_help_command();
 
-    /* Register log command */
-    const esp_console_cmd_t log_cmd = {
-        .command = "log",
-        .help = "Log level control (app/sys)",
-        .hint = NULL,
-        .func = &cmd_log,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&log_cmd));
-
-    /* Register status command */
-    const esp_console_cmd_t status_cmd = {
-        .command = "status",
-        .help = "Show comprehensive system status",
-        .hint = NULL,
-        .func = &cmd_status,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&status_cmd));
-
-    /* Register restart command */
-    const esp_console_cmd_t restart_cmd = {
-        .command = "restart",
-        .help = "Restart the system",
-        .hint = NULL,
-        .func = &cmd_restart,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&restart_cmd));
-
-    /* Register WiFi commands */
-    const esp_console_cmd_t wifi_cmd = {
-        .command = "wifi",
-        .help = "WiFi management commands",
-        .hint = NULL,
-        .func = &cmd_wifi,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&wifi_cmd));
-
-    /* Register MQTT commands */
-    const esp_console_cmd_t mqtt_cmd = {
-        .command = "mqtt",
-        .help = "MQTT management commands",
-        .hint = NULL,
-        .func = &cmd_mqtt,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&mqtt_cmd));
-
-    /* Register sensor commands */
-    const esp_console_cmd_t sensor_cmd = {
-        .command = "sensor",
-        .help = "Sensor control commands",
-        .hint = NULL,
-        .func = &cmd_sensor,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&sensor_cmd));
-
-    /* Register power command (PowerFeather) */
-    const esp_console_cmd_t power_cmd = {
-        .command = "power",
-        .help = "PowerFeather power status/control",
-        .hint = NULL,
-        .func = &cmd_power,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&power_cmd));
-
-    /* Register free command */
-    const esp_console_cmd_t free_cmd = {
-        .command = "free",
-        .help = "Show memory information",
-        .hint = NULL,
-        .func = &cmd_free,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&free_cmd));
-
-    /* Register version command */
-    const esp_console_cmd_t version_cmd = {
-        .command = "version",
-        .help = "Show version and system information",
-        .hint = NULL,
-        .func = &cmd_version,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&version_cmd));
+    for (size_t i = 0; i < sizeof(s_commands) / sizeof(s_commands[0]); ++i) {
+        ESP_ERROR_CHECK(esp_console_cmd_register(&s_commands[i]));
+    }
 
-#if CONFIG_IAQ_OLED_ENABLE
-    /* Register display command */
-    const esp_console_cmd_t display_cmd = {
-        .command = "display",
-        .help = "Display control commands",
-        .hint = NULL,
-        .func = &cmd_display,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&display_cmd));
-#endif
+    s_help_lock = xSemaphoreCreateMutex();
 
     /* Start console REPL on the selected console backend */
 #if CONFIG_LIBC_PICOLIBC && !CONFIG_LIBC_PICOLIBC_NEWLIB_COMPATIBILITY
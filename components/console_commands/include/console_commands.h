@@ -2,6 +2,7 @@
 #ifndef CONSOLE_COMMANDS_H
 #define CONSOLE_COMMANDS_H
 
+#include <stdbool.h>
 #include "esp_err.h"
 
 /**
@@ -12,4 +13,16 @@
  */
 esp_err_t console_commands_init(void);
 
+/**
+ * Run one command line from any task (the web console workers).
+ * Parses into a local buffer, so several commands may run concurrently,
+ * unlike esp_console_run(). Output goes to stdout.
+ *
+ * @param read_only Reject commands that change state (status, show, scan
+ *                  and read subcommands are allowed)
+ * @return ESP_OK with *cmd_ret set, ESP_ERR_NOT_ALLOWED for a state-changing
+ *         command in read-only mode, ESP_ERR_NOT_FOUND for an unknown command
+ */
+esp_err_t console_commands_run(const char *cmdline, bool read_only, int *cmd_ret);
+
 #endif /* CONSOLE_COMMANDS_H */
\ No newline at end of file
@@ -191,6 +191,20 @@ typedef struct {
         bool nox_index;         // SGP41 NOx index valid
     } valid;
 
+    /* Suspect flags - true while a fault monitor flags the source sensor
+     * (flatline, stuck-at, step, disagreement). Values remain valid. */
+    struct {
+        bool temp_c;            // SHT45
+        bool rh_pct;            // SHT45
+        bool pressure_pa;       // BMP280
+        bool co2_ppm;           // S8
+        bool pm1_ugm3;          // PMS5003
+        bool pm25_ugm3;         // PMS5003
+        bool pm10_ugm3;         // PMS5003
+        bool voc_index;         // SGP41
+        bool nox_index;         // SGP41
+    } suspect;
+
     /* System status */
     struct {
         bool wifi_connected;
@@ -0,0 +1,637 @@
+/* components/iaq_history/history_flash.c */
+#include "history_flash.h"
+
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "esp_log.h"
+
+#if CONFIG_IAQ_HISTORY_FLASH_ENABLE
+
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "iaq_config.h"
+#include "iaq_record.h"
+
+static const char *TAG = "HIST_FLASH";
+
+/*
+ * Flash layout: a ring of erase sectors, written strictly in sequence.
+ *
+ *   sector:  header | iaq_record schema | block | block | ... | erased (0xFF)
+ *   block:   header (time span, payload CRC, commit map) | iaq_record records
+ *
+ * Each block is one delta chain (its first record is absolute), so blocks
+ * decode independently. A block is opened by writing its header with only the
+ * magic set; every record is then appended in place and committed by clearing
+ * its bit in the commit map, so no bucket waits in RAM for the block to fill.
+ * A full block is sealed by programming its length, span and CRC into the
+ * still-erased header fields. After a reset the open block of the head sector
+ * is picked up again from its commit map. A torn sealed payload fails its CRC
+ * and is skipped, a torn header ends the sector. When the ring is full the
+ * oldest sector is erased, dropping its blocks.
+ */
+#define HIST_FLASH_SECTOR_SIZE      4096
+#define HIST_FLASH_SECTOR_MAGIC     0x34485149u     /* "IQH4" */
+#define HIST_FLASH_BLOCK_MAGIC      0xB10Cu
+#define HIST_FLASH_COLUMNS          (HISTORY_METRIC_COUNT * 3)
+#define HIST_FLASH_BLOCK_RECORDS    CONFIG_IAQ_HISTORY_FLASH_BLOCK_RECORDS
+#define HIST_FLASH_BLOCK_MAX        (HIST_FLASH_BLOCK_RECORDS * IAQ_RECORD_MAX_SIZE(HIST_FLASH_COLUMNS))
+#define HIST_FLASH_QUEUE_LEN        12      /* Buckets waiting for the writer (or for SNTP) */
+#define HIST_FLASH_CLOCK_WAIT_MS    10000   /* Re-check interval while the wall clock is unknown */
+#define HIST_FLASH_LEN_OPEN         0xFFFFu /* Block length of a block that is not sealed yet */
+#define HIST_FLASH_COMMIT(records)  (UINT32_MAX << (records))   /* Commit map after n records */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;           /* Ring order, never 0 or 0xFFFFFFFF once written */
+    uint16_t schema_len;    /* Serialized schema follows the header */
+    uint16_t reserved;
+    uint32_t reserved2;
+} hist_sector_hdr_t;
+
+typedef struct {
+    uint16_t magic;
+    uint16_t len;           /* Payload bytes */
+    uint32_t min_s;         /* Wall-time span of the records */
+    uint32_t max_s;
+    uint32_t crc;           /* CRC-32 of the payload */
+    uint32_t commit;        /* Bit n cleared once record n is on flash */
+} hist_block_hdr_t;
+
+_Static_assert(sizeof(hist_sector_hdr_t) == 16 && sizeof(hist_block_hdr_t) == 20, "Flash header layout");
+_Static_assert(HIST_FLASH_BLOCK_RECORDS < 32, "Commit map holds one bit per record");
+_Static_assert(sizeof(hist_sector_hdr_t) + IAQ_RECORD_SCHEMA_MAX_SIZE(HIST_FLASH_COLUMNS) +
+               sizeof(hist_block_hdr_t) + HIST_FLASH_BLOCK_MAX <= HIST_FLASH_SECTOR_SIZE,
+               "A full block must fit into an empty sector");
+_Static_assert(HISTORY_FLASH_RES_S % CONFIG_IAQ_HISTORY_TIER3_RES_S == 0,
+               "Flash tier resolution must be a multiple of the Tier 3 resolution");
+
+/* In-RAM index: one entry per sector */
+typedef struct {
+    uint32_t seq;           /* 0 = empty or unusable (erase before use) */
+    uint32_t min_s;
+    uint32_t max_s;
+    uint16_t used;          /* Next write offset; HIST_FLASH_SECTOR_SIZE = sealed */
+    uint16_t schema_len;
+} hist_sector_info_t;
+
+typedef struct {
+    int64_t mono_s;
+    history_bucket_wire_t values[HISTORY_METRIC_COUNT];
+    uint8_t flags[HISTORY_METRIC_COUNT];
+} hist_flash_item_t;
+
+/* Reader scratch, heap-allocated per query to keep it off handler stacks */
+typedef struct {
+    iaq_record_schema_t schema;
+    iaq_record_state_t state;
+    int16_t q[IAQ_RECORD_MAX_COLUMNS];
+    uint8_t suspect[IAQ_RECORD_BITMAP_LEN(IAQ_RECORD_MAX_COLUMNS)];
+    history_bucket_wire_t values[HISTORY_METRIC_COUNT];
+    uint8_t flags[HISTORY_METRIC_COUNT];
+    uint8_t schema_buf[IAQ_RECORD_SCHEMA_MAX_SIZE(IAQ_RECORD_MAX_COLUMNS)];
+    uint8_t block[HIST_FLASH_BLOCK_MAX];
+} hist_flash_reader_t;
+
+static const esp_partition_t *s_part = NULL;
+static hist_sector_info_t *s_sectors = NULL;
+static uint32_t s_sector_count = 0;
+static uint32_t s_head = 0;             /* Sector being appended */
+static uint32_t s_seq = 0;              /* Highest sector sequence written */
+static SemaphoreHandle_t s_lock = NULL; /* Index, flash writes and the pending block */
+static QueueHandle_t s_queue = NULL;
+static volatile bool s_ready = false;
+static uint32_t s_dropped = 0;          /* Writer context only */
+
+static iaq_record_schema_t s_schema;
+static uint8_t s_schema_bytes[IAQ_RECORD_SCHEMA_MAX_SIZE(HIST_FLASH_COLUMNS)];
+static uint16_t s_schema_len = 0;
+
+/* Open block at s_sectors[s_head].used; s_block mirrors its committed records */
+static bool s_block_open = false;
+static uint8_t s_block[HIST_FLASH_BLOCK_MAX];
+static uint16_t s_block_len = 0;
+static uint8_t s_block_records = 0;
+static uint32_t s_block_min_s = 0;
+static uint32_t s_block_max_s = 0;
+static iaq_record_state_t s_block_state;
+
+static inline size_t sector_addr(uint32_t idx)
+{
+    return (size_t)idx * HIST_FLASH_SECTOR_SIZE;
+}
+
+static bool is_erased(const void *p, size_t len)
+{
+    const uint8_t *b = p;
+    for (size_t i = 0; i < len; i++) {
+        if (b[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+/* Rebuild one index entry from flash (init only) */
+static void scan_sector(uint32_t idx)
+{
+    hist_sector_info_t *info = &s_sectors[idx];
+    memset(info, 0, sizeof(*info));
+
+    hist_sector_hdr_t hdr;
+    if (esp_partition_read(s_part, sector_addr(idx), &hdr, sizeof(hdr)) != ESP_OK) return;
+    if (hdr.magic != HIST_FLASH_SECTOR_MAGIC || hdr.seq == 0 || hdr.seq == UINT32_MAX ||
+        hdr.schema_len == 0 || sizeof(hdr) + hdr.schema_len > HIST_FLASH_SECTOR_SIZE) {
+        return;
+    }
+
+    info->seq = hdr.seq;
+    info->schema_len = hdr.schema_len;
+    info->min_s = UINT32_MAX;
+    uint32_t off = sizeof(hdr) + hdr.schema_len;
+    while (off + sizeof(hist_block_hdr_t) <= HIST_FLASH_SECTOR_SIZE) {
+        hist_block_hdr_t blk;
+        if (esp_partition_read(s_part, sector_addr(idx) + off, &blk, sizeof(blk)) != ESP_OK) break;
+        if (is_erased(&blk, sizeof(blk))) {
+            info->used = (uint16_t)off;
+            break;
+        }
+        if (blk.magic == HIST_FLASH_BLOCK_MAGIC && blk.len == HIST_FLASH_LEN_OPEN) {
+            info->used = (uint16_t)off; /* Open block: resumed in the head sector, ends any other */
+            break;
+        }
+        if (blk.magic != HIST_FLASH_BLOCK_MAGIC || blk.len == 0 ||
+            off + sizeof(blk) + blk.len > HIST_FLASH_SECTOR_SIZE) {
+            break; /* Torn header: nothing after it can be trusted */
+        }
+        if (blk.min_s < info->min_s) info->min_s = blk.min_s;
+        if (blk.max_s > info->max_s) info->max_s = blk.max_s;
+        off += sizeof(blk) + blk.len;
+    }
+    if (info->used == 0) info->used = HIST_FLASH_SECTOR_SIZE; /* Full or torn: sealed */
+    if (info->min_s == UINT32_MAX) info->min_s = 0;
+}
+
+/* Erase the next sector and stamp it with a header and the schema (lock held) */
+static esp_err_t open_next_sector(void)
+{
+    uint32_t idx = (s_seq == 0) ? 0 : (s_head + 1) % s_sector_count;
+    s_sectors[idx].seq = 0; /* Readers skip it from here on */
+
+    esp_err_t r = esp_partition_erase_range(s_part, sector_addr(idx), HIST_FLASH_SECTOR_SIZE);
+    if (r != ESP_OK) return r;
+
+    hist_sector_hdr_t hdr = {
+        .magic = HIST_FLASH_SECTOR_MAGIC,
+        .seq = s_seq + 1,
+        .schema_len = s_schema_len,
+    };
+    r = esp_partition_write(s_part, sector_addr(idx) + sizeof(hdr), s_schema_bytes, s_schema_len);
+    if (r == ESP_OK) r = esp_partition_write(s_part, sector_addr(idx), &hdr, sizeof(hdr));
+    if (r != ESP_OK) return r;
+
+    s_seq = hdr.seq;
+    s_head = idx;
+    s_sectors[idx] = (hist_sector_info_t){
+        .seq = hdr.seq,
+        .used = (uint16_t)(sizeof(hdr) + s_schema_len),
+        .schema_len = s_schema_len,
+    };
+    return ESP_OK;
+}
+
+static void reset_block(void)
+{
+    s_block_open = false;
+    s_block_len = 0;
+    s_block_records = 0;
+    iaq_record_state_reset(&s_block_state);
+}
+
+/* A write failed: the head sector is in an unknown state, seal it (lock held) */
+static void abandon_block(esp_err_t r)
+{
+    ESP_LOGW(TAG, "Block write failed (%s), %u records lost", esp_err_to_name(r),
+             (unsigned)s_block_records);
+    s_sectors[s_head].used = HIST_FLASH_SECTOR_SIZE;
+    reset_block();
+}
+
+/* Write a header with only the magic set, in a sector with room for a first
+ * record of first_len bytes (lock held) */
+static esp_err_t open_block(size_t first_len)
+{
+    hist_sector_info_t *head = &s_sectors[s_head];
+    if (s_seq == 0 || head->seq == 0 ||
+        head->used + sizeof(hist_block_hdr_t) + first_len > HIST_FLASH_SECTOR_SIZE) {
+        esp_err_t r = open_next_sector();
+        if (r != ESP_OK) return r;
+        head = &s_sectors[s_head];
+    }
+    hist_block_hdr_t blk;
+    memset(&blk, 0xFF, sizeof(blk));
+    blk.magic = HIST_FLASH_BLOCK_MAGIC;
+    esp_err_t r = esp_partition_write(s_part, sector_addr(s_head) + head->used, &blk, sizeof(blk));
+    if (r == ESP_OK) s_block_open = true;
+    return r;
+}
+
+/* Append the last n encoded bytes of s_block to the open block and commit them (lock held) */
+static esp_err_t write_record(size_t n)
+{
+    size_t addr = sector_addr(s_head) + s_sectors[s_head].used;
+    uint32_t commit = HIST_FLASH_COMMIT(s_block_records + 1);
+    esp_err_t r = esp_partition_write(s_part, addr + sizeof(hist_block_hdr_t) + s_block_len,
+                                      &s_block[s_block_len], n);
+    if (r == ESP_OK) {
+        r = esp_partition_write(s_part, addr + offsetof(hist_block_hdr_t, commit), &commit, sizeof(commit));
+    }
+    return r;
+}
+
+/* Seal the open block: program length, time span and CRC (lock held) */
+static void flush_block(void)
+{
+    if (!s_block_open || s_block_records == 0) return;
+
+    hist_sector_info_t *head = &s_sectors[s_head];
+    hist_block_hdr_t blk = {
+        .magic = HIST_FLASH_BLOCK_MAGIC,
+        .len = s_block_len,
+        .min_s = s_block_min_s,
+        .max_s = s_block_max_s,
+        .crc = esp_rom_crc32_le(0, s_block, s_block_len),
+    };
+    esp_err_t r = esp_partition_write(s_part, sector_addr(s_head) + head->used + offsetof(hist_block_hdr_t, len),
+                                      &blk.len, offsetof(hist_block_hdr_t, commit) - offsetof(hist_block_hdr_t, len));
+    if (r != ESP_OK) {
+        abandon_block(r);
+        return;
+    }
+    if (head->used == sizeof(hist_sector_hdr_t) + head->schema_len || blk.min_s < head->min_s) {
+        head->min_s = blk.min_s;
+    }
+    if (blk.max_s > head->max_s) head->max_s = blk.max_s;
+    head->used += sizeof(blk) + s_block_len;
+    reset_block();
+}
+
+static void append_record(int64_t wall_s, const hist_flash_item_t *item)
+{
+    int16_t q[HIST_FLASH_COLUMNS];
+    uint8_t suspect[IAQ_RECORD_BITMAP_LEN(HIST_FLASH_COLUMNS)] = {0};
+    for (int m = 0; m < HISTORY_METRIC_COUNT; m++) {
+        /* Column order follows iaq_record_field_t: avg, min, max */
+        q[3 * m] = item->values[m].avg;
+        q[3 * m + 1] = item->values[m].min;
+        q[3 * m + 2] = item->values[m].max;
+        if (item->flags[m] & HISTORY_BUCKET_FLAG_SUSPECT) {
+            for (int c = 3 * m; c < 3 * m + 3; c++) suspect[c >> 3] |= (uint8_t)(1u << (c & 7));
+        }
+    }
+    uint32_t t = wall_s < 0 ? 0 : (wall_s > UINT32_MAX ? UINT32_MAX : (uint32_t)wall_s);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    iaq_record_state_t prev = s_block_state;
+    size_t n = iaq_record_encode(&s_schema, &s_block_state, t, q, suspect,
+                                 &s_block[s_block_len], sizeof(s_block) - s_block_len);
+    if (n > 0 && s_block_open &&
+        s_sectors[s_head].used + sizeof(hist_block_hdr_t) + s_block_len + n > HIST_FLASH_SECTOR_SIZE) {
+        /* No room behind the open block: seal it early and start over in the next sector */
+        s_block_state = prev;
+        if (s_block_records > 0) {
+            flush_block();
+        } else {
+            s_sectors[s_head].used = HIST_FLASH_SECTOR_SIZE;
+            reset_block();
+        }
+        n = iaq_record_encode(&s_schema, &s_block_state, t, q, suspect, s_block, sizeof(s_block));
+    }
+    if (n > 0) {
+        esp_err_t r = s_block_open ? ESP_OK : open_block(n);
+        if (r == ESP_OK) r = write_record(n);
+        if (r == ESP_OK) {
+            if (s_block_records == 0 || t < s_block_min_s) s_block_min_s = t;
+            if (s_block_records == 0 || t > s_block_max_s) s_block_max_s = t;
+            s_block_len += (uint16_t)n;
+            s_block_records++;
+        } else {
+            abandon_block(r);
+        }
+    }
+    if (s_block_records >= HIST_FLASH_BLOCK_RECORDS) flush_block();
+    xSemaphoreGive(s_lock);
+}
+
+/* Resume the head sector after a reset (init only). A sector written with
+ * another schema is sealed; an open block is reloaded from its commit map and
+ * extended in place while the rest of the sector is still erased. */
+static void resume_head_sector(void)
+{
+    hist_sector_info_t *head = &s_sectors[s_head];
+    if (s_seq == 0 || head->seq == 0 || head->used >= HIST_FLASH_SECTOR_SIZE) return;
+
+    uint8_t buf[64];
+    size_t base = sector_addr(s_head);
+    bool same_schema = head->schema_len == s_schema_len;
+    for (size_t off = 0; same_schema && off < s_schema_len; off += sizeof(buf)) {
+        size_t len = s_schema_len - off < sizeof(buf) ? s_schema_len - off : sizeof(buf);
+        same_schema = esp_partition_read(s_part, base + sizeof(hist_sector_hdr_t) + off, buf, len) == ESP_OK &&
+                      memcmp(buf, &s_schema_bytes[off], len) == 0;
+    }
+    if (!same_schema) {
+        head->used = HIST_FLASH_SECTOR_SIZE; /* Written by another firmware: never append to it */
+        return;
+    }
+
+    hist_block_hdr_t blk;
+    if (head->used + sizeof(blk) > HIST_FLASH_SECTOR_SIZE ||
+        esp_partition_read(s_part, base + head->used, &blk, sizeof(blk)) != ESP_OK ||
+        blk.magic != HIST_FLASH_BLOCK_MAGIC || blk.len != HIST_FLASH_LEN_OPEN) {
+        return;
+    }
+
+    uint8_t committed = 0;
+    while (committed < HIST_FLASH_BLOCK_RECORDS && !((blk.commit >> committed) & 1u)) committed++;
+    size_t cap = HIST_FLASH_SECTOR_SIZE - head->used - sizeof(blk);
+    if (cap > sizeof(s_block)) cap = sizeof(s_block);
+    if (esp_partition_read(s_part, base + head->used + sizeof(blk), s_block, cap) != ESP_OK) {
+        head->used = HIST_FLASH_SECTOR_SIZE;
+        return;
+    }
+
+    int16_t q[HIST_FLASH_COLUMNS];
+    iaq_record_state_reset(&s_block_state);
+    s_block_open = true;
+    while (s_block_records < committed) {
+        int64_t t = 0;
+        size_t n = iaq_record_decode(&s_schema, &s_block_state, &s_block[s_block_len], cap - s_block_len,
+                                     &t, q, NULL);
+        if (n == 0) break;
+        uint32_t ts = (uint32_t)t;
+        if (s_block_records == 0 || ts < s_block_min_s) s_block_min_s = ts;
+        if (s_block_records == 0 || ts > s_block_max_s) s_block_max_s = ts;
+        s_block_len += (uint16_t)n;
+        s_block_records++;
+    }
+
+    /* Bytes behind the last commit mean a torn record: keep what was committed, stop here */
+    bool clean = s_block_records == committed;
+    for (size_t off = head->used + sizeof(blk) + s_block_len; clean && off < HIST_FLASH_SECTOR_SIZE; off += sizeof(buf)) {
+        size_t len = HIST_FLASH_SECTOR_SIZE - off < sizeof(buf) ? HIST_FLASH_SECTOR_SIZE - off : sizeof(buf);
+        clean = esp_partition_read(s_part, base + off, buf, len) == ESP_OK && is_erased(buf, len);
+    }
+    if (s_block_records > 0) {
+        ESP_LOGI(TAG, "Resumed open block with %u buckets", (unsigned)s_block_records);
+    }
+    if (!clean) {
+        flush_block();
+        head->used = HIST_FLASH_SECTOR_SIZE;
+        reset_block();
+    }
+}
+
+static void hist_flash_task(void *arg)
+{
+    hist_flash_item_t item;
+    for (;;) {
+        if (xQueueReceive(s_queue, &item, portMAX_DELAY) != pdTRUE) continue;
+        /* Buckets sealed before the first SNTP sync wait here for a wall-clock label */
+        int64_t wall_s;
+        while (!history_mono_to_wall(item.mono_s, &wall_s)) {
+            vTaskDelay(pdMS_TO_TICKS(HIST_FLASH_CLOCK_WAIT_MS));
+        }
+        append_record(wall_s, &item);
+    }
+}
+
+esp_err_t history_flash_init(void)
+{
+    if (s_ready) return ESP_OK;
+
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                      CONFIG_IAQ_HISTORY_FLASH_PARTITION);
+    if (!s_part) {
+        ESP_LOGW(TAG, "Partition '%s' not found, long-term history disabled",
+                 CONFIG_IAQ_HISTORY_FLASH_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_sector_count = s_part->size / HIST_FLASH_SECTOR_SIZE;
+    if (s_sector_count < 2) return ESP_ERR_INVALID_SIZE;
+
+    /* Every column of every metric: avg/min/max plus suspect bits */
+    history_metric_id_t metrics[HISTORY_METRIC_COUNT];
+    for (int m = 0; m < HISTORY_METRIC_COUNT; m++) metrics[m] = (history_metric_id_t)m;
+    esp_err_t r = iaq_record_schema_init(&s_schema, metrics, HISTORY_METRIC_COUNT, IAQ_RECORD_FIELDS_BUCKET,
+                                         IAQ_RECORD_FLAG_SUSPECT, HISTORY_FLASH_RES_S);
+    if (r != ESP_OK) return r;
+    s_schema_len = (uint16_t)iaq_record_schema_write(&s_schema, s_schema_bytes, sizeof(s_schema_bytes));
+    if (s_schema_len == 0) return ESP_ERR_INVALID_SIZE;
+    iaq_record_state_reset(&s_block_state);
+
+    s_sectors = heap_caps_calloc(s_sector_count, sizeof(*s_sectors), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_lock = xSemaphoreCreateMutex();
+    s_queue = xQueueCreate(HIST_FLASH_QUEUE_LEN, sizeof(hist_flash_item_t));
+    if (!s_sectors || !s_lock || !s_queue) goto fail;
+
+    uint32_t blocks_bytes = 0;
+    for (uint32_t i = 0; i < s_sector_count; i++) {
+        scan_sector(i);
+        if (s_sectors[i].seq > s_seq) {
+            s_seq = s_sectors[i].seq;
+            s_head = i;
+        }
+        if (s_sectors[i].seq) blocks_bytes += s_sectors[i].used;
+    }
+    resume_head_sector();
+
+    if (xTaskCreatePinnedToCore(hist_flash_task, "hist_flash", TASK_STACK_HISTORY_FLASH, NULL,
+                                TASK_PRIORITY_HISTORY_FLASH, NULL, TASK_CORE_HISTORY_FLASH) != pdPASS) {
+        goto fail;
+    }
+
+    s_ready = true;
+    ESP_LOGI(TAG, "Long-term history on '%s': %u sectors, %u bytes used, %u s buckets",
+             s_part->label, (unsigned)s_sector_count, (unsigned)blocks_bytes, (unsigned)HISTORY_FLASH_RES_S);
+    return ESP_OK;
+
+fail:
+    free(s_sectors);
+    s_sectors = NULL;
+    if (s_lock) vSemaphoreDelete(s_lock);
+    if (s_queue) vQueueDelete(s_queue);
+    s_lock = NULL;
+    s_queue = NULL;
+    s_part = NULL;
+    return ESP_ERR_NO_MEM;
+}
+
+bool history_flash_available(void)
+{
+    return s_ready;
+}
+
+void history_flash_submit(int64_t mono_start_s, const history_bucket_wire_t *values, const uint8_t *flags)
+{
+    if (!s_ready || !values || !flags) return;
+    hist_flash_item_t item = { .mono_s = mono_start_s };
+    memcpy(item.values, values, sizeof(item.values));
+    memcpy(item.flags, flags, sizeof(item.flags));
+    if (xQueueSend(s_queue, &item, 0) != pdTRUE) {
+        s_dropped++;
+        ESP_LOGW(TAG, "Writer queue full, bucket dropped (%u total)", (unsigned)s_dropped);
+    }
+}
+
+/* Decode one block and hand in-range rows to cb; false if cb aborted */
+static bool decode_block(hist_flash_reader_t *rd, size_t len, int64_t start_s, int64_t end_s,
+                         history_flash_row_cb_t cb, void *ctx)
+{
+    iaq_record_state_reset(&rd->state);
+    size_t pos = 0;
+    while (pos < len) {
+        int64_t t = 0;
+        size_t n = iaq_record_decode(&rd->schema, &rd->state, &rd->block[pos], len - pos,
+                                     &t, rd->q, rd->suspect);
+        if (n == 0) break;
+        pos += n;
+        if (t < start_s || t > end_s) continue;
+
+        for (int m = 0; m < HISTORY_METRIC_COUNT; m++) {
+            rd->values[m] = (history_bucket_wire_t){ HISTORY_SENTINEL, HISTORY_SENTINEL, HISTORY_SENTINEL };
+            rd->flags[m] = 0;
+        }
+        for (int c = 0; c < rd->schema.column_count; c++) {
+            const iaq_record_column_t *col = &rd->schema.columns[c];
+            history_metric_scale_t scale;
+            /* Columns quantized differently from the current table are left out */
+            if (!iaq_history_metric_scale((history_metric_id_t)col->metric, &scale) ||
+                scale.scale != col->scale || scale.offset != col->offset) {
+                continue;
+            }
+            history_bucket_wire_t *v = &rd->values[col->metric];
+            if (col->field == IAQ_RECORD_FIELD_AVG) v->avg = rd->q[c];
+            else if (col->field == IAQ_RECORD_FIELD_MIN) v->min = rd->q[c];
+            else if (col->field == IAQ_RECORD_FIELD_MAX) v->max = rd->q[c];
+            if ((rd->suspect[c >> 3] >> (c & 7)) & 1u) rd->flags[col->metric] |= HISTORY_BUCKET_FLAG_SUSPECT;
+        }
+        if (!cb(t, rd->values, rd->flags, ctx)) return false;
+    }
+    return true;
+}
+
+/* Stream the blocks of one sector; false if cb aborted */
+static bool read_sector(hist_flash_reader_t *rd, uint32_t idx, int64_t start_s, int64_t end_s,
+                        history_flash_row_cb_t cb, void *ctx)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    hist_sector_info_t info = s_sectors[idx];
+    bool ok = info.seq != 0 && info.schema_len <= sizeof(rd->schema_buf) &&
+              esp_partition_read(s_part, sector_addr(idx) + sizeof(hist_sector_hdr_t),
+                                 rd->schema_buf, info.schema_len) == ESP_OK;
+    xSemaphoreGive(s_lock);
+    if (!ok || (int64_t)info.max_s < start_s || (int64_t)info.min_s > end_s) return true;
+    if (iaq_record_schema_read(&rd->schema, rd->schema_buf, info.schema_len) == 0) return true;
+
+    uint32_t off = sizeof(hist_sector_hdr_t) + info.schema_len;
+    while (off + sizeof(hist_block_hdr_t) <= info.used) {
+        hist_block_hdr_t blk;
+        bool have = false;
+        /* Under the lock so the writer cannot recycle the sector mid-read */
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (s_sectors[idx].seq == info.seq &&
+            esp_partition_read(s_part, sector_addr(idx) + off, &blk, sizeof(blk)) == ESP_OK &&
+            blk.magic == HIST_FLASH_BLOCK_MAGIC && blk.len > 0 && blk.len <= sizeof(rd->block) &&
+            off + sizeof(blk) + blk.len <= info.used) {
+            have = (int64_t)blk.max_s < start_s || (int64_t)blk.min_s > end_s ||
+                   esp_partition_read(s_part, sector_addr(idx) + off + sizeof(blk), rd->block, blk.len) == ESP_OK;
+        }
+        xSemaphoreGive(s_lock);
+        if (!have) break;
+        off += sizeof(blk) + blk.len;
+
+        if ((int64_t)blk.max_s < start_s || (int64_t)blk.min_s > end_s) continue;
+        if (esp_rom_crc32_le(0, rd->block, blk.len) != blk.crc) continue; /* Torn payload */
+        if (!decode_block(rd, blk.len, start_s, end_s, cb, ctx)) return false;
+    }
+    return true;
+}
+
+esp_err_t history_flash_read(int64_t start_s, int64_t end_s, history_flash_row_cb_t cb, void *ctx)
+{
+    if (!s_ready) return ESP_ERR_INVALID_STATE;
+    if (!cb) return ESP_ERR_INVALID_ARG;
+
+    hist_flash_reader_t *rd = heap_caps_malloc(sizeof(*rd), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!rd) rd = malloc(sizeof(*rd));
+    if (!rd) return ESP_ERR_NO_MEM;
+
+    /* Oldest sector first: the ring is written in index order */
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint32_t head = s_head;
+    xSemaphoreGive(s_lock);
+    esp_err_t ret = ESP_OK;
+    for (uint32_t k = 1; k <= s_sector_count && ret == ESP_OK; k++) {
+        if (!read_sector(rd, (head + k) % s_sector_count, start_s, end_s, cb, ctx)) ret = ESP_FAIL;
+    }
+
+    /* Then the open block, from its RAM mirror */
+    if (ret == ESP_OK) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        size_t len = s_block_len;
+        memcpy(rd->block, s_block, len);
+        xSemaphoreGive(s_lock);
+        rd->schema = s_schema;
+        if (len > 0 && !decode_block(rd, len, start_s, end_s, cb, ctx)) ret = ESP_FAIL;
+    }
+
+    free(rd);
+    return ret;
+}
+
+void history_flash_get_stats(uint32_t *used_bytes, uint32_t *total_bytes)
+{
+    uint32_t used = 0;
+    if (s_ready) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (uint32_t i = 0; i < s_sector_count; i++) {
+            if (s_sectors[i].seq) used += s_sectors[i].used;
+        }
+        xSemaphoreGive(s_lock);
+    }
+    if (used_bytes) *used_bytes = used;
+    if (total_bytes) *total_bytes = s_ready ? s_part->size : 0;
+}
+
+#else /* !CONFIG_IAQ_HISTORY_FLASH_ENABLE */
+
+esp_err_t history_flash_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool history_flash_available(void)
+{
+    return false;
+}
+
+void history_flash_submit(int64_t mono_start_s, const history_bucket_wire_t *values, const uint8_t *flags)
+{
+}
+
+esp_err_t history_flash_read(int64_t start_s, int64_t end_s, history_flash_row_cb_t cb, void *ctx)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+void history_flash_get_stats(uint32_t *used_bytes, uint32_t *total_bytes)
+{
+    if (used_bytes) *used_bytes = 0;
+    if (total_bytes) *total_bytes = 0;
+}
+
+#endif /* CONFIG_IAQ_HISTORY_FLASH_ENABLE */
@@ -0,0 +1,63 @@
+/* components/iaq_history/history_flash.h */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "iaq_history.h"
+
+/*
+ * Tier 4: long-term buckets in a flash partition (internal to iaq_history).
+ *
+ * Sealed Tier 3 buckets are rolled up to CONFIG_IAQ_HISTORY_FLASH_RES_S and
+ * handed to a low-priority task that packs them into iaq_record blocks and
+ * appends those to a ring of flash sectors. Only a per-sector time span is
+ * kept in RAM; queries stream blocks straight from flash. Stored times are
+ * wall-clock seconds, so the tier survives reboots.
+ */
+
+#define HISTORY_FLASH_TIER      3       /* Tier index in the stream/export APIs */
+
+#ifdef CONFIG_IAQ_HISTORY_FLASH_RES_S
+#define HISTORY_FLASH_RES_S     CONFIG_IAQ_HISTORY_FLASH_RES_S
+#else
+#define HISTORY_FLASH_RES_S     3600
+#endif
+
+/* One bucket per metric in table order, as stored on flash */
+typedef bool (*history_flash_row_cb_t)(
+    int64_t time_s,
+    const history_bucket_wire_t *values,
+    const uint8_t *flags,
+    void *ctx
+);
+
+/** Scan the partition and start the writer task. ESP_ERR_NOT_SUPPORTED if disabled. */
+esp_err_t history_flash_init(void);
+
+/** True once the partition is scanned and the tier can be queried. */
+bool history_flash_available(void);
+
+/**
+ * Queue one sealed bucket (HISTORY_METRIC_COUNT values/flags) that started at
+ * monotonic second mono_start_s. History writer context; never blocks, drops
+ * the bucket if the queue is full.
+ */
+void history_flash_submit(int64_t mono_start_s, const history_bucket_wire_t *values, const uint8_t *flags);
+
+/**
+ * Visit buckets with wall time in [start_s, end_s], oldest block first, then
+ * the block that is still open. Times are ascending except
+ * around wall-clock steps.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if unavailable, ESP_ERR_NO_MEM,
+ *         ESP_FAIL if cb returned false
+ */
+esp_err_t history_flash_read(int64_t start_s, int64_t end_s, history_flash_row_cb_t cb, void *ctx);
+
+/** Flash bytes holding data and partition size (0/0 if unavailable). */
+void history_flash_get_stats(uint32_t *used_bytes, uint32_t *total_bytes);
+
+/* Provided by iaq_history.c: false until the wall clock has been mapped */
+bool history_mono_to_wall(int64_t mono_s, int64_t *wall_s);
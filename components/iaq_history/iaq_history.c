@@ -5,12 +5,16 @@
 #include <string.h>
 #include <time.h>
 #include <stdlib.h>
+#include <stdatomic.h>
+#include <sys/time.h>
 #include "sdkconfig.h"
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "time_sync.h"
+#include "history_flash.h"
 
 #define HISTORY_TIER_COUNT 3
 
@@ -20,9 +24,18 @@ typedef struct {
     int16_t max;
     int32_t sum;
     uint16_t count;
-    uint16_t _pad;
+    uint16_t suspect;   /* Samples taken while the source sensor was flagged by fault monitors */
 } history_bucket_t;
 
+/* Optional accumulators for metrics listed in CONFIG_IAQ_HISTORY_EXT_STATS_METRICS */
+typedef struct {
+    int64_t sum_sq;     /* Sum of squared quantized values (variance) */
+    int64_t tw_sum;     /* Sum of value x weight_ms (time-weighted mean) */
+    uint32_t tw_ms;     /* Total weight */
+    int16_t first;      /* First and last sample, valid while count > 0 */
+    int16_t last;
+} history_bucket_ext_t;
+
 #define HISTORY_TIER1_RES_S CONFIG_IAQ_HISTORY_TIER1_RES_S
 #define HISTORY_TIER2_RES_S CONFIG_IAQ_HISTORY_TIER2_RES_S
 #define HISTORY_TIER3_RES_S CONFIG_IAQ_HISTORY_TIER3_RES_S
@@ -32,6 +45,12 @@ typedef struct {
 #define HISTORY_TIER3_CAPACITY (CONFIG_IAQ_HISTORY_TIER3_WINDOW_S / HISTORY_TIER3_RES_S)
 
 #define HISTORY_MAX_POINTS HISTORY_TIER3_CAPACITY
+#define HISTORY_FLASH_MAX_POINTS 8784   /* One leap year of hourly buckets */
+#define HISTORY_FLASH_ROLLUP_RATIO (HISTORY_FLASH_RES_S / HISTORY_TIER3_RES_S)
+/* A sample is weighted by the time since the previous one, capped across outages */
+#define HISTORY_EXT_MAX_WEIGHT_MS 60000
+
+_Static_assert(HISTORY_METRIC_COUNT <= 16, "ext_mask holds one bit per metric");
 
 typedef struct {
     uint16_t head;
@@ -42,6 +61,7 @@ typedef struct {
 
 typedef struct {
     history_bucket_t *tiers[HISTORY_TIER_COUNT];
+    history_bucket_ext_t *ext[HISTORY_TIER_COUNT];  /* NULL = no extended stats */
 } history_metric_store_t;
 
 static const char *TAG = "IAQ_HISTORY";
@@ -65,27 +85,206 @@ static const uint16_t s_tier_rollup_ratio[HISTORY_TIER_COUNT] = {
 };
 
 static const history_metric_scale_t s_metric_scale[HISTORY_METRIC_COUNT] = {
-    [HIST_METRIC_TEMP] = { .scale = 100, .offset = 4000 },
-    [HIST_METRIC_HUMIDITY] = { .scale = 100, .offset = 0 },
-    [HIST_METRIC_CO2] = { .scale = 1, .offset = 0 },
-    [HIST_METRIC_PRESSURE] = { .scale = 20, .offset = 0 },
-    [HIST_METRIC_PM1] = { .scale = 10, .offset = 0 },
-    [HIST_METRIC_PM25] = { .scale = 10, .offset = 0 },
-    [HIST_METRIC_PM10] = { .scale = 10, .offset = 0 },
-    [HIST_METRIC_VOC] = { .scale = 1, .offset = 0 },
-    [HIST_METRIC_NOX] = { .scale = 1, .offset = 0 },
-    [HIST_METRIC_MOLD_RISK] = { .scale = 1, .offset = 0 },
-    [HIST_METRIC_AQI] = { .scale = 1, .offset = 0 },
-    [HIST_METRIC_COMFORT] = { .scale = 1, .offset = 0 },
-    [HIST_METRIC_IAQ_SCORE] = { .scale = 1, .offset = 0 },
+#define HISTORY_METRIC_SCALE(id, key, sc, off) [id] = { .scale = sc, .offset = off },
+    HISTORY_METRIC_TABLE(HISTORY_METRIC_SCALE)
+#undef HISTORY_METRIC_SCALE
+};
+
+static const char *const s_metric_key[HISTORY_METRIC_COUNT] = {
+#define HISTORY_METRIC_KEY(id, k, sc, off) [id] = k,
+    HISTORY_METRIC_TABLE(HISTORY_METRIC_KEY)
+#undef HISTORY_METRIC_KEY
 };
 
+#define HISTORY_METRIC_ONE(id, k, sc, off) + 1
+_Static_assert(0 HISTORY_METRIC_TABLE(HISTORY_METRIC_ONE) == HISTORY_METRIC_COUNT,
+               "HISTORY_METRIC_COUNT must match HISTORY_METRIC_TABLE");
+#undef HISTORY_METRIC_ONE
+
 static history_metric_store_t s_metrics[HISTORY_METRIC_COUNT];
 static history_tier_state_t s_tier_state[HISTORY_TIER_COUNT];
-static SemaphoreHandle_t s_history_mutex = NULL;
+static int64_t s_ext_last_ms[HISTORY_METRIC_COUNT];    /* Writer-private: previous valid sample */
 static bool s_initialized = false;
 static uint32_t s_total_bytes = 0;
 
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Per-tier sequence locks
+ *
+ * iaq_history_append() is the only writer. It runs on the sensor coordinator's
+ * processing task (iaq_proc, fusion stage), once per fusion tick, and must
+ * never wait on an HTTP reader: a stalled append would delay fusion. The
+ * writer-private state below relies on appends coming from that one task;
+ * calls from any other task are rejected. Each tier carries a sequence counter
+ * that is odd while the writer mutates that tier's state or buckets. Readers
+ * copy what they need, then re-check the counter and retry on change. A tier
+ * is only opened when the append actually touches it, so long Tier 2/3 queries
+ * are disturbed by rollups only, not by every 1 Hz sample.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* After this many failed read attempts, sleep a tick between retries */
+#define HISTORY_READ_SPIN_LIMIT 4
+
+static _Atomic uint32_t s_tier_seq[HISTORY_TIER_COUNT];
+static uint8_t s_write_open_mask = 0;   /* Writer-private: tiers opened in this append */
+static TaskHandle_t s_writer_task = NULL;   /* Bound on the first append */
+
+static void tier_write_begin(uint8_t tier)
+{
+    if (s_write_open_mask & (1u << tier)) return;
+    s_write_open_mask |= (uint8_t)(1u << tier);
+    atomic_fetch_add_explicit(&s_tier_seq[tier], 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+static void tier_writes_end(void)
+{
+    if (s_write_open_mask == 0) return;
+    atomic_thread_fence(memory_order_seq_cst);
+    for (uint8_t tier = 0; tier < HISTORY_TIER_COUNT; tier++) {
+        if (s_write_open_mask & (1u << tier)) {
+            atomic_fetch_add_explicit(&s_tier_seq[tier], 1, memory_order_relaxed);
+        }
+    }
+    s_write_open_mask = 0;
+}
+
+/* Wait (without blocking the writer) for a stable sequence value */
+static uint32_t tier_read_begin(uint8_t tier, uint32_t *attempts)
+{
+    for (;;) {
+        uint32_t seq = atomic_load_explicit(&s_tier_seq[tier], memory_order_acquire);
+        if ((seq & 1u) == 0) {
+            atomic_thread_fence(memory_order_seq_cst);
+            return seq;
+        }
+        if (++(*attempts) > HISTORY_READ_SPIN_LIMIT) {
+            vTaskDelay(1);
+        }
+    }
+}
+
+/* True if the copy made since tier_read_begin() may be torn */
+static bool tier_read_retry(uint8_t tier, uint32_t seq, uint32_t *attempts)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&s_tier_seq[tier], memory_order_relaxed) == seq) {
+        return false;
+    }
+    if (++(*attempts) > HISTORY_READ_SPIN_LIMIT) {
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Monotonic timeline and wall-clock mapping
+ *
+ * Buckets are keyed on esp_timer seconds since boot, which never jumps. The
+ * writer records (monotonic, wall - monotonic) anchors whenever the system
+ * clock becomes valid or is stepped, and readers label buckets with the anchor
+ * in effect at that monotonic time. Buckets recorded before the first SNTP sync
+ * borrow the earliest anchor, so they are re-labelled instead of dropped.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define HISTORY_CLOCK_MAP_LEN   8
+/* Offset changes below this are timer/SNTP jitter, not a clock step */
+#define HISTORY_CLOCK_STEP_MS   1000
+
+typedef struct {
+    int64_t mono_s;     /* First monotonic second the offset applies to */
+    int64_t offset_ms;  /* wall_ms - mono_ms */
+} history_clock_anchor_t;
+
+typedef struct {
+    history_clock_anchor_t anchors[HISTORY_CLOCK_MAP_LEN];
+    uint8_t len;
+} history_clock_map_t;
+
+static history_clock_map_t s_clock_map;
+static portMUX_TYPE s_clock_map_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int64_t mono_now_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+static int64_t wall_now_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/* Writer context only: record a new anchor if the wall clock moved */
+static void update_clock_map(int64_t mono_ms)
+{
+    int64_t offset_ms = wall_now_ms() - mono_ms;
+    int64_t mono_s = mono_ms / 1000;
+    history_clock_map_t *map = &s_clock_map;
+
+    if (map->len > 0) {
+        int64_t step_ms = offset_ms - map->anchors[map->len - 1].offset_ms;
+        if (llabs(step_ms) < HISTORY_CLOCK_STEP_MS) return;
+
+        portENTER_CRITICAL(&s_clock_map_lock);
+        if (llabs(step_ms) > (int64_t)CONFIG_IAQ_HISTORY_TIME_JUMP_TOLERANCE_S * 1000) {
+            /* Clock was wrong before (manual set, bad RTC): relabel everything */
+            map->len = 0;
+        } else if (map->len == HISTORY_CLOCK_MAP_LEN) {
+            memmove(&map->anchors[0], &map->anchors[1],
+                    (HISTORY_CLOCK_MAP_LEN - 1) * sizeof(map->anchors[0]));
+            map->len--;
+        }
+        map->anchors[map->len++] = (history_clock_anchor_t){ mono_s, offset_ms };
+        portEXIT_CRITICAL(&s_clock_map_lock);
+
+        ESP_LOGW(TAG, "Wall clock stepped by %lld ms; history relabelled",
+                 (long long)step_ms);
+        return;
+    }
+
+    portENTER_CRITICAL(&s_clock_map_lock);
+    map->anchors[0] = (history_clock_anchor_t){ mono_s, offset_ms };
+    map->len = 1;
+    portEXIT_CRITICAL(&s_clock_map_lock);
+    ESP_LOGI(TAG, "Wall clock mapped at uptime %lld s", (long long)mono_s);
+}
+
+static void clock_map_snapshot(history_clock_map_t *out)
+{
+    portENTER_CRITICAL(&s_clock_map_lock);
+    *out = s_clock_map;
+    portEXIT_CRITICAL(&s_clock_map_lock);
+
+    /* No valid wall clock yet: label with the system clock as-is */
+    if (out->len == 0) {
+        int64_t mono_ms = mono_now_ms();
+        out->anchors[0] = (history_clock_anchor_t){ mono_ms / 1000, wall_now_ms() - mono_ms };
+        out->len = 1;
+    }
+}
+
+static int64_t mono_to_wall_s(const history_clock_map_t *map, int64_t mono_s)
+{
+    int64_t offset_ms = map->anchors[0].offset_ms;
+    for (uint8_t i = 1; i < map->len && map->anchors[i].mono_s <= mono_s; i++) {
+        offset_ms = map->anchors[i].offset_ms;
+    }
+    int64_t wall_ms = mono_s * 1000 + offset_ms;
+    return wall_ms >= 0 ? wall_ms / 1000 : -((999 - wall_ms) / 1000);
+}
+
+bool history_mono_to_wall(int64_t mono_s, int64_t *wall_s)
+{
+    history_clock_map_t map;
+    portENTER_CRITICAL(&s_clock_map_lock);
+    map = s_clock_map;
+    portEXIT_CRITICAL(&s_clock_map_lock);
+    if (map.len == 0) return false;
+    *wall_s = mono_to_wall_s(&map, mono_s);
+    return true;
+}
+
 static int64_t align_time(int64_t now_s, uint32_t resolution_s)
 {
     if (resolution_s == 0) return now_s;
@@ -98,12 +297,13 @@ static void bucket_reset(history_bucket_t *bucket)
     bucket->max = INT16_MIN;
     bucket->sum = 0;
     bucket->count = 0;
-    bucket->_pad = 0;
+    bucket->suspect = 0;
 }
 
-static void bucket_add_value(history_bucket_t *bucket, int16_t value)
+static void bucket_add_value(history_bucket_t *bucket, int16_t value, bool suspect)
 {
     if (value == HISTORY_SENTINEL) return;
+    if (suspect && bucket->suspect < UINT16_MAX) bucket->suspect++;
     if (bucket->count == 0) {
         bucket->min = value;
         bucket->max = value;
@@ -123,24 +323,110 @@ static void bucket_merge(history_bucket_t *dst, const history_bucket_t *src)
         dst->max = src->max;
         dst->sum = src->sum;
         dst->count = src->count;
+        dst->suspect = src->suspect;
         return;
     }
     if (src->min < dst->min) dst->min = src->min;
     if (src->max > dst->max) dst->max = src->max;
     dst->sum += src->sum;
     dst->count += src->count;
+    uint32_t suspect = (uint32_t)dst->suspect + src->suspect;
+    dst->suspect = suspect > UINT16_MAX ? UINT16_MAX : (uint16_t)suspect;
+}
+
+/* After bucket_add_value(bucket, value): count already includes this sample */
+static void bucket_ext_add(history_bucket_ext_t *ext, const history_bucket_t *bucket,
+                           int16_t value, uint32_t weight_ms)
+{
+    if (value == HISTORY_SENTINEL) return;
+    if (bucket->count == 1) ext->first = value;
+    ext->last = value;
+    ext->sum_sq += (int32_t)value * value;
+    ext->tw_sum += (int64_t)value * weight_ms;
+    ext->tw_ms += weight_ms;
+}
+
+/* Before bucket_merge(): counts are those of the buckets being merged */
+static void bucket_ext_merge(history_bucket_ext_t *dst, uint16_t dst_count,
+                             const history_bucket_ext_t *src, uint16_t src_count)
+{
+    if (src_count == 0) return;
+    if (dst_count == 0) {
+        *dst = *src;
+        return;
+    }
+    dst->sum_sq += src->sum_sq;
+    dst->tw_sum += src->tw_sum;
+    dst->tw_ms += src->tw_ms;
+    dst->last = src->last;
+}
+
+static inline int16_t bucket_avg(const history_bucket_t *b)
+{
+    if (!b || b->count == 0) return HISTORY_SENTINEL;
+    int32_t sum = b->sum;
+    int32_t count = b->count;
+    if (sum >= 0) return (int16_t)((sum + count / 2) / count);
+    return (int16_t)((sum - count / 2) / count);
+}
+
+static void bucket_to_wire(const history_bucket_t *b, history_bucket_wire_t *wire, uint8_t *flags)
+{
+    *flags = b->suspect ? HISTORY_BUCKET_FLAG_SUSPECT : 0;
+    if (b->count == 0) {
+        wire->min = HISTORY_SENTINEL;
+        wire->max = HISTORY_SENTINEL;
+        wire->avg = HISTORY_SENTINEL;
+    } else {
+        wire->min = b->min;
+        wire->max = b->max;
+        wire->avg = bucket_avg(b);
+    }
+}
+
+static void bucket_ext_to_wire(const history_bucket_t *b, const history_bucket_ext_t *ext,
+                               history_bucket_ext_wire_t *wire)
+{
+    if (b->count == 0) {
+        *wire = (history_bucket_ext_wire_t){ HISTORY_SENTINEL, HISTORY_SENTINEL, HISTORY_SENTINEL, HISTORY_SENTINEL };
+        return;
+    }
+    double mean = (double)b->sum / b->count;
+    double var = (double)ext->sum_sq / b->count - mean * mean;
+    double sd = var > 0 ? sqrt(var) : 0;
+    wire->stddev = sd >= INT16_MAX ? INT16_MAX : (int16_t)lround(sd);
+    wire->first = ext->first;
+    wire->last = ext->last;
+    /* Samples without a predecessor carry no weight: fall back to the plain mean */
+    wire->tw_avg = ext->tw_ms ? (int16_t)llround((double)ext->tw_sum / ext->tw_ms) : bucket_avg(b);
 }
 
 static void reset_tier_bucket(uint8_t tier, uint16_t index)
 {
     for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
         bucket_reset(&s_metrics[metric].tiers[tier][index]);
+        if (s_metrics[metric].ext[tier]) {
+            memset(&s_metrics[metric].ext[tier][index], 0, sizeof(history_bucket_ext_t));
+        }
+    }
+}
+
+/* Merge one bucket of a finer tier into the open bucket of the next tier */
+static void rollup_bucket(int metric, uint8_t dst_tier, uint16_t dst_idx, uint8_t src_tier, uint16_t src_idx)
+{
+    history_bucket_t *dst = &s_metrics[metric].tiers[dst_tier][dst_idx];
+    const history_bucket_t *src = &s_metrics[metric].tiers[src_tier][src_idx];
+    if (s_metrics[metric].ext[dst_tier]) {
+        bucket_ext_merge(&s_metrics[metric].ext[dst_tier][dst_idx], dst->count,
+                         &s_metrics[metric].ext[src_tier][src_idx], src->count);
     }
+    bucket_merge(dst, src);
 }
 
 static void reset_history(int64_t now_s)
 {
     for (int tier = 0; tier < HISTORY_TIER_COUNT; tier++) {
+        tier_write_begin(tier);
         s_tier_state[tier].head = 0;
         s_tier_state[tier].size = 0;
         s_tier_state[tier].progress = 0;
@@ -152,24 +438,6 @@ static void reset_history(int64_t now_s)
     s_tier_state[0].size = 1;
 }
 
-/**
- * Shift all tier bucket_start_s by a delta to handle small time jumps.
- * Must be called with s_history_mutex held.
- */
-static void shift_tier_timestamps(int64_t delta_s)
-{
-    for (int tier = 0; tier < HISTORY_TIER_COUNT; tier++) {
-        if (s_tier_state[tier].bucket_start_s > 0) {
-            s_tier_state[tier].bucket_start_s += delta_s;
-            if (s_tier_state[tier].bucket_start_s < 0) {
-                s_tier_state[tier].bucket_start_s = 0;
-            }
-        }
-    }
-    ESP_LOGW(TAG, "Time adjusted: shifted history timestamps by %lld s",
-             (long long)delta_s);
-}
-
 static int16_t quantize_value(float value, const history_metric_scale_t *scale)
 {
     if (!isfinite(value)) return HISTORY_SENTINEL;
@@ -227,22 +495,81 @@ static float metric_value_from_data(const iaq_data_t *data, history_metric_id_t
     }
 }
 
+/* Derived metrics inherit the suspect state of every input they are computed from */
+static bool metric_suspect_from_data(const iaq_data_t *data, history_metric_id_t metric)
+{
+    if (!data) return false;
+    switch (metric) {
+        case HIST_METRIC_TEMP:      return data->suspect.temp_c;
+        case HIST_METRIC_HUMIDITY:  return data->suspect.rh_pct;
+        case HIST_METRIC_CO2:       return data->suspect.co2_ppm;
+        case HIST_METRIC_PRESSURE:  return data->suspect.pressure_pa;
+        case HIST_METRIC_PM1:       return data->suspect.pm1_ugm3;
+        case HIST_METRIC_PM25:      return data->suspect.pm25_ugm3;
+        case HIST_METRIC_PM10:      return data->suspect.pm10_ugm3;
+        case HIST_METRIC_VOC:       return data->suspect.voc_index;
+        case HIST_METRIC_NOX:       return data->suspect.nox_index;
+        case HIST_METRIC_MOLD_RISK:
+        case HIST_METRIC_COMFORT:
+            return data->suspect.temp_c || data->suspect.rh_pct;
+        case HIST_METRIC_AQI:
+            return data->suspect.pm25_ugm3 || data->suspect.pm10_ugm3;
+        case HIST_METRIC_IAQ_SCORE:
+            return data->suspect.temp_c || data->suspect.rh_pct || data->suspect.co2_ppm ||
+                   data->suspect.pm25_ugm3 || data->suspect.pm10_ugm3 ||
+                   data->suspect.voc_index || data->suspect.nox_index;
+        default:
+            return false;
+    }
+}
+
+/* Writer-private: Tier 3 buckets merged toward the next flash bucket */
+static history_bucket_t s_flash_acc[HISTORY_METRIC_COUNT];
+static uint16_t s_flash_progress = 0;
+static int64_t s_flash_start_s = 0;
+
+/* Called with each sealed Tier 3 bucket; hands full flash buckets to the flash writer */
+static void rollup_tier3(int64_t bucket_start_s, uint16_t index)
+{
+    if (!history_flash_available()) return;
+    if (s_flash_progress == 0) {
+        s_flash_start_s = bucket_start_s;
+        for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
+            bucket_reset(&s_flash_acc[metric]);
+        }
+    }
+
+    for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
+        bucket_merge(&s_flash_acc[metric], &s_metrics[metric].tiers[2][index]);
+    }
+
+    if (++s_flash_progress >= HISTORY_FLASH_ROLLUP_RATIO) {
+        history_bucket_wire_t values[HISTORY_METRIC_COUNT];
+        uint8_t flags[HISTORY_METRIC_COUNT];
+        for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
+            bucket_to_wire(&s_flash_acc[metric], &values[metric], &flags[metric]);
+        }
+        history_flash_submit(s_flash_start_s, values, flags);
+        s_flash_progress = 0;
+    }
+}
+
 static void rollup_tier2(int64_t bucket_start_s)
 {
     history_tier_state_t *tier3 = &s_tier_state[2];
+    tier_write_begin(2);
     if (tier3->progress == 0) {
         tier3->bucket_start_s = bucket_start_s;
         reset_tier_bucket(2, tier3->head);
     }
 
     for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
-        history_bucket_t *dst = &s_metrics[metric].tiers[2][tier3->head];
-        history_bucket_t *src = &s_metrics[metric].tiers[1][s_tier_state[1].head];
-        bucket_merge(dst, src);
+        rollup_bucket(metric, 2, tier3->head, 1, s_tier_state[1].head);
     }
 
     tier3->progress++;
     if (tier3->progress >= s_tier_rollup_ratio[2]) {
+        rollup_tier3(tier3->bucket_start_s, tier3->head);
         tier3->progress = 0;
         tier3->head = (tier3->head + 1) % s_tier_capacity[2];
         if (tier3->size < s_tier_capacity[2]) tier3->size++;
@@ -254,15 +581,14 @@ static void rollup_tier2(int64_t bucket_start_s)
 static void rollup_tier1(int64_t bucket_start_s)
 {
     history_tier_state_t *tier2 = &s_tier_state[1];
+    tier_write_begin(1);
     if (tier2->progress == 0) {
         tier2->bucket_start_s = bucket_start_s;
         reset_tier_bucket(1, tier2->head);
     }
 
     for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
-        history_bucket_t *dst = &s_metrics[metric].tiers[1][tier2->head];
-        history_bucket_t *src = &s_metrics[metric].tiers[0][s_tier_state[0].head];
-        bucket_merge(dst, src);
+        rollup_bucket(metric, 1, tier2->head, 0, s_tier_state[0].head);
     }
 
     tier2->progress++;
@@ -290,15 +616,41 @@ static void advance_tier1(int64_t now_s)
     }
 }
 
-esp_err_t iaq_history_init(void)
+/* Optional, so a failed allocation only drops the extended stats of that metric */
+static void alloc_ext_stats(void)
 {
-    if (s_initialized) return ESP_OK;
+    char keys[] = CONFIG_IAQ_HISTORY_EXT_STATS_METRICS;
+    char *saveptr = NULL;
+    for (char *tok = strtok_r(keys, ", ", &saveptr); tok; tok = strtok_r(NULL, ", ", &saveptr)) {
+        history_metric_id_t metric;
+        if (!iaq_history_metric_from_key(tok, &metric)) {
+            ESP_LOGW(TAG, "Unknown metric '%s' in extended stats list", tok);
+            continue;
+        }
+        if (s_metrics[metric].ext[0]) continue;
 
-    s_history_mutex = xSemaphoreCreateMutex();
-    if (!s_history_mutex) {
-        ESP_LOGE(TAG, "Failed to create history mutex");
-        return ESP_ERR_NO_MEM;
+        size_t total = 0;
+        for (int tier = 0; tier < HISTORY_TIER_COUNT; tier++) {
+            size_t bytes = s_tier_capacity[tier] * sizeof(history_bucket_ext_t);
+            s_metrics[metric].ext[tier] = heap_caps_calloc(1, bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            if (!s_metrics[metric].ext[tier]) {
+                ESP_LOGW(TAG, "No PSRAM for extended stats of %s", tok);
+                for (int t = 0; t <= tier; t++) {
+                    free(s_metrics[metric].ext[t]);
+                    s_metrics[metric].ext[t] = NULL;
+                }
+                total = 0;
+                break;
+            }
+            total += bytes;
+        }
+        s_total_bytes += total;
     }
+}
+
+esp_err_t iaq_history_init(void)
+{
+    if (s_initialized) return ESP_OK;
 
     s_total_bytes = 0;
     for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
@@ -313,74 +665,77 @@ esp_err_t iaq_history_init(void)
                         s_metrics[m].tiers[t] = NULL;
                     }
                 }
-                vSemaphoreDelete(s_history_mutex);
-                s_history_mutex = NULL;
                 return ESP_ERR_NO_MEM;
             }
             memset(s_metrics[metric].tiers[tier], 0, bytes);
             s_total_bytes += bytes;
         }
     }
+    alloc_ext_stats();
 
-    reset_history(time(NULL));
+    reset_history(mono_now_ms() / 1000);
+    tier_writes_end();
     s_initialized = true;
     ESP_LOGI(TAG, "History initialized (%lu bytes)", (unsigned long)s_total_bytes);
+
+    /* RAM tiers work without it; ranges beyond Tier 3 just stay unavailable */
+    esp_err_t flash_ret = history_flash_init();
+    if (flash_ret != ESP_OK && flash_ret != ESP_ERR_NOT_SUPPORTED && flash_ret != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Long-term history unavailable: %s", esp_err_to_name(flash_ret));
+    }
     return ESP_OK;
 }
 
 void iaq_history_append(const iaq_data_t *data)
 {
     if (!s_initialized || !data) return;
-    if (!time_sync_is_set()) return;
-
-    int64_t now_s = time(NULL);
-    if (now_s <= 0) return;
-
-    if (!s_history_mutex) return;
-    xSemaphoreTake(s_history_mutex, portMAX_DELAY);
-
-    /* Handle uninitialized state */
-    if (s_tier_state[0].bucket_start_s == 0) {
-        reset_history(now_s);
-        goto append_data;
-    }
-
-    /* Detect backward time jump */
-    if (now_s < s_tier_state[0].bucket_start_s) {
-        int64_t jump_s = s_tier_state[0].bucket_start_s - now_s;
-
-        if (jump_s <= CONFIG_IAQ_HISTORY_TIME_JUMP_TOLERANCE_S) {
-            /* Small jump: shift timestamps to preserve data */
-            int64_t delta = now_s - s_tier_state[0].bucket_start_s;
-            shift_tier_timestamps(delta);
-            s_tier_state[0].bucket_start_s = align_time(now_s, s_tier_resolution_s[0]);
-        } else {
-            /* Large jump: reset to avoid corruption */
-            ESP_LOGW(TAG, "Large time jump (%lld s), resetting history",
-                     (long long)jump_s);
-            reset_history(now_s);
-            goto append_data;
-        }
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (!s_writer_task) {
+        s_writer_task = self;
+    } else if (self != s_writer_task) {
+        ESP_LOGE(TAG, "Append from %s ignored: history has a single writer (%s)",
+                 pcTaskGetName(self), pcTaskGetName(s_writer_task));
+        return;
     }
 
-append_data:
+    /* Buckets follow the monotonic clock; wall time only updates the mapping */
+    int64_t mono_ms = mono_now_ms();
+    int64_t now_s = mono_ms / 1000;
+    if (time_sync_is_set()) {
+        update_clock_map(mono_ms);
+    }
+
+    /* Single writer: no lock. Tiers are opened for readers as they are touched. */
+    tier_write_begin(0);
     advance_tier1(now_s);
 
     uint16_t head = s_tier_state[0].head;
     for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
         float value = metric_value_from_data(data, (history_metric_id_t)metric);
         int16_t q = quantize_value(value, &s_metric_scale[metric]);
-        bucket_add_value(&s_metrics[metric].tiers[0][head], q);
+        bool suspect = metric_suspect_from_data(data, (history_metric_id_t)metric);
+        history_bucket_t *bucket = &s_metrics[metric].tiers[0][head];
+        bucket_add_value(bucket, q, suspect);
+
+        if (s_metrics[metric].ext[0] && q != HISTORY_SENTINEL) {
+            int64_t gap_ms = s_ext_last_ms[metric] ? mono_ms - s_ext_last_ms[metric] : 0;
+            uint32_t weight_ms = gap_ms > HISTORY_EXT_MAX_WEIGHT_MS ? HISTORY_EXT_MAX_WEIGHT_MS :
+                                 (gap_ms < 0 ? 0 : (uint32_t)gap_ms);
+            bucket_ext_add(&s_metrics[metric].ext[0][head], bucket, q, weight_ms);
+            s_ext_last_ms[metric] = mono_ms;
+        }
     }
 
-    xSemaphoreGive(s_history_mutex);
+    tier_writes_end();
 }
 
 static uint8_t select_tier_for_range(int64_t range_s)
 {
     if (range_s <= 3600) return 0;
     if (range_s <= 86400) return 1;
-    return 2;
+    if (range_s <= CONFIG_IAQ_HISTORY_TIER3_WINDOW_S || !history_flash_available()) return 2;
+    return HISTORY_FLASH_TIER;
 }
 
 bool iaq_history_metric_scale(history_metric_id_t metric, history_metric_scale_t *out)
@@ -390,23 +745,174 @@ bool iaq_history_metric_scale(history_metric_id_t metric, history_metric_scale_t
     return true;
 }
 
+const char *iaq_history_metric_key(history_metric_id_t metric)
+{
+    if (metric < 0 || metric >= HISTORY_METRIC_COUNT) return NULL;
+    return s_metric_key[metric];
+}
+
+bool iaq_history_metric_from_key(const char *key, history_metric_id_t *out)
+{
+    if (!key || !out) return false;
+    for (int i = 0; i < HISTORY_METRIC_COUNT; i++) {
+        if (strcmp(key, s_metric_key[i]) == 0) {
+            *out = (history_metric_id_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void iaq_history_quantize(const iaq_data_t *data, int16_t out[HISTORY_METRIC_COUNT])
+{
+    if (!out) return;
+    for (int metric = 0; metric < HISTORY_METRIC_COUNT; metric++) {
+        float value = metric_value_from_data(data, (history_metric_id_t)metric);
+        out[metric] = quantize_value(value, &s_metric_scale[metric]);
+    }
+}
+
 void iaq_history_get_stats(uint32_t *used_bytes, uint32_t *total_bytes)
 {
     if (used_bytes) *used_bytes = s_total_bytes;
     if (total_bytes) *total_bytes = s_total_bytes;
 }
 
+bool iaq_history_metric_has_ext_stats(history_metric_id_t metric)
+{
+    if (metric < 0 || metric >= HISTORY_METRIC_COUNT) return false;
+    return s_metrics[metric].ext[0] != NULL;
+}
+
+bool iaq_history_long_term_available(void)
+{
+    return history_flash_available();
+}
+
 /* ═══════════════════════════════════════════════════════════════════════════
  * STREAMING API
  * ═══════════════════════════════════════════════════════════════════════════ */
 
-static inline int16_t bucket_avg(const history_bucket_t *b)
+/* Flash tier: output buckets are laid on a fixed grid from the range start and
+ * filled as records stream past; slots without records go out empty. */
+typedef struct {
+    history_metric_id_t metric;
+    int64_t base_s;
+    uint32_t resolution_s;      /* Raw flash resolution */
+    uint16_t group;
+    uint16_t bucket_count;
+    uint16_t next_out;          /* Output bucket being aggregated */
+    history_bucket_t agg;
+    history_bucket_wire_t *scratch;
+    uint8_t *flags_scratch;
+    uint16_t scratch_len;
+    uint16_t batch_count;
+    history_bucket_batch_cb_t bucket_cb;
+    void *user_ctx;
+} flash_stream_ctx_t;
+
+static bool flash_stream_flush(flash_stream_ctx_t *fs)
 {
-    if (!b || b->count == 0) return HISTORY_SENTINEL;
-    int32_t sum = b->sum;
-    int32_t count = b->count;
-    if (sum >= 0) return (int16_t)((sum + count / 2) / count);
-    return (int16_t)((sum - count / 2) / count);
+    if (fs->batch_count == 0) return true;
+    uint16_t start = (uint16_t)(fs->next_out - fs->batch_count);
+    bool ok = fs->bucket_cb(fs->metric, start, fs->scratch, fs->flags_scratch, NULL, fs->batch_count, fs->user_ctx);
+    fs->batch_count = 0;
+    return ok;
+}
+
+/* Emit the bucket at next_out and move on to the next one */
+static bool flash_stream_advance(flash_stream_ctx_t *fs)
+{
+    bucket_to_wire(&fs->agg, &fs->scratch[fs->batch_count], &fs->flags_scratch[fs->batch_count]);
+    fs->batch_count++;
+    fs->next_out++;
+    bucket_reset(&fs->agg);
+    return fs->batch_count < fs->scratch_len || flash_stream_flush(fs);
+}
+
+static bool flash_stream_row(int64_t time_s, const history_bucket_wire_t *values, const uint8_t *flags, void *ctx)
+{
+    flash_stream_ctx_t *fs = ctx;
+    if (time_s < fs->base_s) return true;
+    int64_t out = (time_s - fs->base_s) / fs->resolution_s / fs->group;
+    /* Out-of-order records (wall-clock steps) land in an already emitted bucket */
+    if (out < fs->next_out || out >= fs->bucket_count) return true;
+    while (fs->next_out < out) {
+        if (!flash_stream_advance(fs)) return false;
+    }
+
+    const history_bucket_wire_t *v = &values[fs->metric];
+    if (v->avg == HISTORY_SENTINEL) return true;
+    history_bucket_t rec = {
+        .min = v->min != HISTORY_SENTINEL ? v->min : v->avg,
+        .max = v->max != HISTORY_SENTINEL ? v->max : v->avg,
+        .sum = v->avg,
+        .count = 1,
+        .suspect = (flags[fs->metric] & HISTORY_BUCKET_FLAG_SUSPECT) ? 1 : 0,
+    };
+    bucket_merge(&fs->agg, &rec);
+    return true;
+}
+
+static esp_err_t stream_flash(
+    const history_metric_id_t *metrics,
+    int metric_count,
+    int64_t start_s,
+    int64_t end_s,
+    uint16_t max_points,
+    history_bucket_wire_t *scratch,
+    uint8_t *flags_scratch,
+    uint16_t scratch_len,
+    history_header_cb_t header_cb,
+    history_bucket_batch_cb_t bucket_cb,
+    void *user_ctx)
+{
+    const uint32_t resolution = HISTORY_FLASH_RES_S;
+    int64_t base_s = align_time(start_s, resolution);
+    int64_t slots = (end_s - base_s) / resolution + 1;
+    uint16_t raw_count = slots > UINT16_MAX ? UINT16_MAX : (uint16_t)slots;
+
+    uint16_t target = max_points ? max_points : HISTORY_FLASH_MAX_POINTS;
+    if (target > raw_count) target = raw_count;
+    uint16_t group = (raw_count + target - 1) / target;
+    uint16_t bucket_count = (raw_count + group - 1) / group;
+
+    history_stream_params_t params = {
+        .resolution_s = resolution * group,
+        .end_time = base_s + (int64_t)(bucket_count - 1) * group * resolution,
+        .bucket_count = bucket_count,
+        .tier = HISTORY_FLASH_TIER,
+        .group_factor = group,
+    };
+    if (!header_cb(&params, metrics, metric_count, user_ctx)) {
+        return ESP_FAIL;
+    }
+
+    /* One pass over the range per metric, like the RAM tiers */
+    for (int m = 0; m < metric_count; m++) {
+        if (metrics[m] < 0 || metrics[m] >= HISTORY_METRIC_COUNT) continue;
+        flash_stream_ctx_t fs = {
+            .metric = metrics[m],
+            .base_s = base_s,
+            .resolution_s = resolution,
+            .group = group,
+            .bucket_count = bucket_count,
+            .scratch = scratch,
+            .flags_scratch = flags_scratch,
+            .scratch_len = scratch_len,
+            .bucket_cb = bucket_cb,
+            .user_ctx = user_ctx,
+        };
+        bucket_reset(&fs.agg);
+
+        esp_err_t ret = history_flash_read(base_s, end_s, flash_stream_row, &fs);
+        if (ret != ESP_OK) return ret;
+        while (fs.next_out < fs.bucket_count) {
+            if (!flash_stream_advance(&fs)) return ESP_FAIL;
+        }
+        if (!flash_stream_flush(&fs)) return ESP_FAIL;
+    }
+    return ESP_OK;
 }
 
 esp_err_t iaq_history_stream(
@@ -416,16 +922,18 @@ esp_err_t iaq_history_stream(
     int64_t end_s,
     uint16_t max_points,
     history_bucket_wire_t *scratch,
+    uint8_t *flags_scratch,
+    history_bucket_ext_wire_t *ext_scratch,
     uint16_t scratch_len,
     history_header_cb_t header_cb,
     history_bucket_batch_cb_t bucket_cb,
     void *user_ctx)
 {
-    if (!s_initialized || !s_history_mutex) return ESP_ERR_INVALID_STATE;
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
     if (!metrics || metric_count <= 0 || metric_count > HISTORY_METRIC_COUNT) {
         return ESP_ERR_INVALID_ARG;
     }
-    if (!scratch || scratch_len == 0 || !header_cb || !bucket_cb) {
+    if (!scratch || !flags_scratch || scratch_len == 0 || !header_cb || !bucket_cb) {
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -436,18 +944,30 @@ esp_err_t iaq_history_stream(
     }
     int64_t range_s = end_s - start_s;
 
-    /* Select tier and capture state under lock */
+    /* Select tier and capture a consistent state snapshot */
     uint8_t tier = select_tier_for_range(range_s);
-    xSemaphoreTake(s_history_mutex, portMAX_DELAY);
-    history_tier_state_t state = s_tier_state[tier];
+    if (tier == HISTORY_FLASH_TIER) {
+        return stream_flash(metrics, metric_count, start_s, end_s, max_points,
+                            scratch, flags_scratch, scratch_len, header_cb, bucket_cb, user_ctx);
+    }
+
+    history_clock_map_t clock_map;
+    clock_map_snapshot(&clock_map);
+
+    uint32_t attempts = 0;
+    history_tier_state_t state;
+    uint32_t seq;
+    do {
+        seq = tier_read_begin(tier, &attempts);
+        state = s_tier_state[tier];
+    } while (tier_read_retry(tier, seq, &attempts));
     uint32_t resolution = s_tier_resolution_s[tier];
     uint16_t capacity = s_tier_capacity[tier];
-    int64_t tier_end_time = state.bucket_start_s; /* match iaq_history_query */
+    int64_t tier_end_time = state.bucket_start_s; /* monotonic */
     uint16_t oldest = (state.head + capacity - state.size + 1) % capacity;
-    xSemaphoreGive(s_history_mutex);
 
     /* Handle empty tier */
-    if (state.size == 0 || state.bucket_start_s == 0) {
+    if (state.size == 0) {
         history_stream_params_t params = {
             .resolution_s = resolution,
             .end_time = 0,
@@ -458,11 +978,12 @@ esp_err_t iaq_history_stream(
         return header_cb(&params, metrics, metric_count, user_ctx) ? ESP_OK : ESP_FAIL;
     }
 
-    /* First pass: count buckets in range (time math identical to iaq_history_query) */
+    /* First pass: count buckets in range (requested range is wall-clock) */
     uint16_t raw_count = 0;
     int64_t actual_end_time = 0;
     for (uint16_t i = 0; i < state.size; i++) {
-        int64_t t = tier_end_time - (int64_t)(state.size - i - 1) * resolution;
+        int64_t t = mono_to_wall_s(&clock_map,
+                                   tier_end_time - (int64_t)(state.size - i - 1) * resolution);
         if (t >= start_s && t <= end_s) {
             raw_count++;
             actual_end_time = t;
@@ -486,76 +1007,92 @@ esp_err_t iaq_history_stream(
     uint16_t group = (raw_count + target - 1) / target;
     uint16_t bucket_count = (raw_count + group - 1) / group;
 
+    uint16_t ext_mask = 0;
+    for (int m = 0; ext_scratch && m < metric_count; m++) {
+        if (metrics[m] >= 0 && metrics[m] < HISTORY_METRIC_COUNT && s_metrics[metrics[m]].ext[tier]) {
+            ext_mask |= (uint16_t)(1u << metrics[m]);
+        }
+    }
+
     history_stream_params_t params = {
         .resolution_s = resolution * group,
         .end_time = actual_end_time,
         .bucket_count = bucket_count,
         .tier = tier,
         .group_factor = group,
+        .ext_mask = ext_mask,
     };
 
     if (!header_cb(&params, metrics, metric_count, user_ctx)) {
         return ESP_FAIL;
     }
 
-    /* Stream buckets for each metric (aggregate under lock, send unlocked) */
+    /* Stream buckets for each metric. Each batch is aggregated optimistically and
+     * re-done if the writer touched this tier meanwhile; callbacks run outside. */
     for (int m = 0; m < metric_count; m++) {
         history_metric_id_t metric = metrics[m];
         if (metric < 0 || metric >= HISTORY_METRIC_COUNT) continue;
 
+        const history_bucket_ext_t *tier_ext = (ext_mask & (1u << metric)) ? s_metrics[metric].ext[tier] : NULL;
         uint16_t out_idx = 0;
         uint16_t group_count = 0;
         history_bucket_t agg = {0};
+        history_bucket_ext_t agg_ext = {0};
 
         uint16_t i = 0;
         while (i < state.size) {
             uint16_t batch_count = 0;
 
-            xSemaphoreTake(s_history_mutex, portMAX_DELAY);
+            /* Saved so a torn batch can be re-aggregated from the same point */
+            const uint16_t batch_i = i;
+            const uint16_t batch_group_count = group_count;
+            const history_bucket_t batch_agg = agg;
+            const history_bucket_ext_t batch_agg_ext = agg_ext;
+            seq = tier_read_begin(tier, &attempts);
+
             history_bucket_t *tier_data = s_metrics[metric].tiers[tier];
             for (; i < state.size && batch_count < scratch_len; i++) {
-                int64_t t = tier_end_time - (int64_t)(state.size - i - 1) * resolution;
+                int64_t t = mono_to_wall_s(&clock_map,
+                                           tier_end_time - (int64_t)(state.size - i - 1) * resolution);
                 if (t < start_s || t > end_s) continue;
 
+                const uint16_t idx = (oldest + i) % capacity;
                 if (group_count == 0) bucket_reset(&agg);
-                bucket_merge(&agg, &tier_data[(oldest + i) % capacity]);
+                if (tier_ext) bucket_ext_merge(&agg_ext, agg.count, &tier_ext[idx], tier_data[idx].count);
+                bucket_merge(&agg, &tier_data[idx]);
                 group_count++;
 
                 if (group_count >= group) {
-                    history_bucket_wire_t *wire = &scratch[batch_count++];
-                    if (agg.count == 0) {
-                        wire->min = HISTORY_SENTINEL;
-                        wire->max = HISTORY_SENTINEL;
-                        wire->avg = HISTORY_SENTINEL;
-                    } else {
-                        wire->min = agg.min;
-                        wire->max = agg.max;
-                        wire->avg = bucket_avg(&agg);
-                    }
+                    bucket_to_wire(&agg, &scratch[batch_count], &flags_scratch[batch_count]);
+                    if (tier_ext) bucket_ext_to_wire(&agg, &agg_ext, &ext_scratch[batch_count]);
+                    batch_count++;
                     group_count = 0;
                 }
             }
-            xSemaphoreGive(s_history_mutex);
+            if (tier_read_retry(tier, seq, &attempts)) {
+                i = batch_i;
+                group_count = batch_group_count;
+                agg = batch_agg;
+                agg_ext = batch_agg_ext;
+                continue;
+            }
+            attempts = 0;
 
             if (batch_count == 0) continue;
-            if (!bucket_cb(metric, out_idx, scratch, batch_count, user_ctx)) {
+            if (!bucket_cb(metric, out_idx, scratch, flags_scratch, tier_ext ? ext_scratch : NULL,
+                           batch_count, user_ctx)) {
                 return ESP_FAIL;
             }
             out_idx += batch_count;
         }
 
         if (group_count > 0) {
+            uint8_t flags;
             history_bucket_wire_t wire;
-            if (agg.count == 0) {
-                wire.min = HISTORY_SENTINEL;
-                wire.max = HISTORY_SENTINEL;
-                wire.avg = HISTORY_SENTINEL;
-            } else {
-                wire.min = agg.min;
-                wire.max = agg.max;
-                wire.avg = bucket_avg(&agg);
-            }
-            if (!bucket_cb(metric, out_idx, &wire, 1, user_ctx)) {
+            history_bucket_ext_wire_t ext_wire;
+            bucket_to_wire(&agg, &wire, &flags);
+            if (tier_ext) bucket_ext_to_wire(&agg, &agg_ext, &ext_wire);
+            if (!bucket_cb(metric, out_idx, &wire, &flags, tier_ext ? &ext_wire : NULL, 1, user_ctx)) {
                 return ESP_FAIL;
             }
         }
@@ -563,3 +1100,101 @@ esp_err_t iaq_history_stream(
 
     return ESP_OK;
 }
+
+typedef struct {
+    const history_metric_id_t *metrics;
+    int metric_count;
+    history_row_cb_t row_cb;
+    void *user_ctx;
+    history_bucket_wire_t values[HISTORY_METRIC_COUNT];
+    uint8_t flags[HISTORY_METRIC_COUNT];
+} flash_export_ctx_t;
+
+static bool flash_export_row(int64_t time_s, const history_bucket_wire_t *values, const uint8_t *flags, void *ctx)
+{
+    flash_export_ctx_t *fx = ctx;
+    for (int m = 0; m < fx->metric_count; m++) {
+        fx->values[m] = values[fx->metrics[m]];
+        fx->flags[m] = flags[fx->metrics[m]];
+    }
+    return fx->row_cb(time_s, HISTORY_FLASH_RES_S, fx->values, fx->flags, fx->metric_count, fx->user_ctx);
+}
+
+esp_err_t iaq_history_export_rows(
+    const history_metric_id_t *metrics,
+    int metric_count,
+    int tier_hint,
+    int64_t start_s,
+    int64_t end_s,
+    history_row_cb_t row_cb,
+    void *user_ctx)
+{
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
+    if (!metrics || metric_count <= 0 || metric_count > HISTORY_METRIC_COUNT || !row_cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int m = 0; m < metric_count; m++) {
+        if (metrics[m] < 0 || metrics[m] >= HISTORY_METRIC_COUNT) return ESP_ERR_INVALID_ARG;
+    }
+    if (tier_hint > HISTORY_FLASH_TIER) return ESP_ERR_INVALID_ARG;
+    if (tier_hint == HISTORY_FLASH_TIER && !history_flash_available()) return ESP_ERR_NOT_SUPPORTED;
+
+    if (end_s <= 0) end_s = time(NULL);
+    if (start_s <= 0 || start_s >= end_s) {
+        start_s = end_s - 3600;
+    }
+    uint8_t tier = tier_hint < 0 ? select_tier_for_range(end_s - start_s) : (uint8_t)tier_hint;
+    if (tier == HISTORY_FLASH_TIER) {
+        flash_export_ctx_t fx = {
+            .metrics = metrics,
+            .metric_count = metric_count,
+            .row_cb = row_cb,
+            .user_ctx = user_ctx,
+        };
+        return history_flash_read(start_s, end_s, flash_export_row, &fx);
+    }
+
+    history_clock_map_t clock_map;
+    clock_map_snapshot(&clock_map);
+
+    uint32_t attempts = 0;
+    history_tier_state_t state;
+    uint32_t seq;
+    do {
+        seq = tier_read_begin(tier, &attempts);
+        state = s_tier_state[tier];
+    } while (tier_read_retry(tier, seq, &attempts));
+    if (state.size == 0) return ESP_OK;
+
+    const uint32_t resolution = s_tier_resolution_s[tier];
+    const uint16_t capacity = s_tier_capacity[tier];
+    const uint16_t oldest = (state.head + capacity - state.size + 1) % capacity;
+
+    /* One row = the same bucket index across all requested metrics */
+    history_bucket_t row[HISTORY_METRIC_COUNT];
+    history_bucket_wire_t values[HISTORY_METRIC_COUNT];
+    uint8_t flags[HISTORY_METRIC_COUNT];
+
+    for (uint16_t i = 0; i < state.size; i++) {
+        int64_t t = mono_to_wall_s(&clock_map,
+                                   state.bucket_start_s - (int64_t)(state.size - i - 1) * resolution);
+        if (t < start_s || t > end_s) continue;
+
+        uint16_t idx = (oldest + i) % capacity;
+        do {
+            seq = tier_read_begin(tier, &attempts);
+            for (int m = 0; m < metric_count; m++) {
+                row[m] = s_metrics[metrics[m]].tiers[tier][idx];
+            }
+        } while (tier_read_retry(tier, seq, &attempts));
+        attempts = 0;
+
+        for (int m = 0; m < metric_count; m++) {
+            bucket_to_wire(&row[m], &values[m], &flags[m]);
+        }
+        if (!row_cb(t, resolution, values, flags, metric_count, user_ctx)) {
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
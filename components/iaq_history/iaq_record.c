@@ -0,0 +1,228 @@
+/* components/iaq_history/iaq_record.c */
+#include "iaq_record.h"
+
+#include <string.h>
+
+static const uint8_t s_magic[3] = { 'I', 'Q', 'R' };
+
+/* ===== Varint / zig-zag primitives ===== */
+
+static inline uint64_t zigzag_encode(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t zigzag_decode(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/* Returns bytes written, 0 if it does not fit */
+static size_t varint_put(uint8_t *buf, size_t cap, uint64_t v)
+{
+    size_t n = 0;
+    do {
+        if (n >= cap) return 0;
+        uint8_t b = (uint8_t)(v & 0x7F);
+        v >>= 7;
+        buf[n++] = v ? (uint8_t)(b | 0x80) : b;
+    } while (v);
+    return n;
+}
+
+/* Returns bytes consumed, 0 if truncated or longer than 10 bytes */
+static size_t varint_get(const uint8_t *buf, size_t len, uint64_t *out)
+{
+    uint64_t v = 0;
+    for (size_t n = 0; n < len && n < 10; n++) {
+        v |= (uint64_t)(buf[n] & 0x7F) << (7 * n);
+        if (!(buf[n] & 0x80)) {
+            *out = v;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static inline bool bit_get(const uint8_t *bits, int i)
+{
+    return (bits[i >> 3] >> (i & 7)) & 1u;
+}
+
+/* ===== Schema ===== */
+
+esp_err_t iaq_record_schema_init(iaq_record_schema_t *schema,
+                                 const history_metric_id_t *metrics, int metric_count,
+                                 uint32_t fields_mask, uint8_t flags, uint32_t period_s)
+{
+    if (!schema || !metrics || metric_count <= 0) return ESP_ERR_INVALID_ARG;
+    fields_mask &= (1u << IAQ_RECORD_FIELD_COUNT) - 1;
+    if (fields_mask == 0) return ESP_ERR_INVALID_ARG;
+
+    memset(schema, 0, sizeof(*schema));
+    schema->flags = flags;
+    schema->period_s = period_s;
+    for (int m = 0; m < metric_count; m++) {
+        history_metric_scale_t scale;
+        if (!iaq_history_metric_scale(metrics[m], &scale)) return ESP_ERR_INVALID_ARG;
+        for (int f = 0; f < IAQ_RECORD_FIELD_COUNT; f++) {
+            if (!(fields_mask & (1u << f))) continue;
+            if (schema->column_count >= IAQ_RECORD_MAX_COLUMNS) return ESP_ERR_INVALID_ARG;
+            schema->columns[schema->column_count++] = (iaq_record_column_t){
+                .metric = (uint8_t)metrics[m],
+                .field = (uint8_t)f,
+                .scale = scale.scale,
+                .offset = scale.offset,
+            };
+        }
+    }
+    return ESP_OK;
+}
+
+size_t iaq_record_schema_write(const iaq_record_schema_t *schema, uint8_t *buf, size_t cap)
+{
+    if (!schema || !buf || cap < 6) return 0;
+    memcpy(buf, s_magic, sizeof(s_magic));
+    buf[3] = IAQ_RECORD_VERSION;
+    buf[4] = schema->flags;
+    buf[5] = schema->column_count;
+    size_t n = 6;
+    size_t v = varint_put(&buf[n], cap - n, schema->period_s);
+    if (v == 0) return 0;
+    n += v;
+    if (cap - n < (size_t)schema->column_count * 6) return 0;
+    for (int c = 0; c < schema->column_count; c++) {
+        const iaq_record_column_t *col = &schema->columns[c];
+        buf[n++] = col->metric;
+        buf[n++] = col->field;
+        buf[n++] = (uint8_t)((uint16_t)col->scale & 0xFF);
+        buf[n++] = (uint8_t)((uint16_t)col->scale >> 8);
+        buf[n++] = (uint8_t)((uint16_t)col->offset & 0xFF);
+        buf[n++] = (uint8_t)((uint16_t)col->offset >> 8);
+    }
+    return n;
+}
+
+size_t iaq_record_schema_read(iaq_record_schema_t *schema, const uint8_t *buf, size_t len)
+{
+    if (!schema || !buf || len < 6) return 0;
+    if (memcmp(buf, s_magic, sizeof(s_magic)) != 0) return 0;
+    if (buf[3] == 0 || buf[3] > IAQ_RECORD_VERSION) return 0;
+    if (buf[4] & ~IAQ_RECORD_FLAG_SUSPECT) return 0;
+    if (buf[5] == 0 || buf[5] > IAQ_RECORD_MAX_COLUMNS) return 0;
+
+    memset(schema, 0, sizeof(*schema));
+    schema->flags = buf[4];
+    schema->column_count = buf[5];
+    size_t n = 6;
+    uint64_t period = 0;
+    size_t v = varint_get(&buf[n], len - n, &period);
+    if (v == 0 || period > UINT32_MAX) return 0;
+    schema->period_s = (uint32_t)period;
+    n += v;
+    if (len - n < (size_t)schema->column_count * 6) return 0;
+    for (int c = 0; c < schema->column_count; c++) {
+        iaq_record_column_t *col = &schema->columns[c];
+        col->metric = buf[n];
+        col->field = buf[n + 1];
+        col->scale = (int16_t)(buf[n + 2] | (buf[n + 3] << 8));
+        col->offset = (int16_t)(buf[n + 4] | (buf[n + 5] << 8));
+        n += 6;
+        if (col->metric >= HISTORY_METRIC_COUNT || col->field >= IAQ_RECORD_FIELD_COUNT ||
+            col->scale <= 0) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+/* ===== Records ===== */
+
+void iaq_record_state_reset(iaq_record_state_t *state)
+{
+    if (state) memset(state, 0, sizeof(*state));
+}
+
+size_t iaq_record_encode(const iaq_record_schema_t *schema, iaq_record_state_t *state,
+                         int64_t time_s, const int16_t *q, const uint8_t *suspect,
+                         uint8_t *buf, size_t cap)
+{
+    if (!schema || !state || !q || !buf) return 0;
+    const int cols = schema->column_count;
+    const size_t bitmap_len = IAQ_RECORD_BITMAP_LEN(cols);
+    const bool with_suspect = (schema->flags & IAQ_RECORD_FLAG_SUSPECT) != 0;
+
+    size_t n = varint_put(buf, cap, zigzag_encode(time_s - state->time_s));
+    if (n == 0) return 0;
+
+    if (cap - n < bitmap_len * (with_suspect ? 2 : 1)) return 0;
+    uint8_t *present = &buf[n];
+    memset(present, 0, bitmap_len);
+    for (int c = 0; c < cols; c++) {
+        if (q[c] != HISTORY_SENTINEL) present[c >> 3] |= (uint8_t)(1u << (c & 7));
+    }
+    n += bitmap_len;
+    if (with_suspect) {
+        if (suspect) memcpy(&buf[n], suspect, bitmap_len);
+        else memset(&buf[n], 0, bitmap_len);
+        n += bitmap_len;
+    }
+
+    for (int c = 0; c < cols; c++) {
+        if (q[c] == HISTORY_SENTINEL) continue;
+        size_t v = varint_put(&buf[n], cap - n, zigzag_encode((int64_t)q[c] - state->last[c]));
+        if (v == 0) return 0;
+        n += v;
+    }
+
+    /* Commit the delta reference only once the whole record fit */
+    state->time_s = time_s;
+    for (int c = 0; c < cols; c++) {
+        if (q[c] != HISTORY_SENTINEL) state->last[c] = q[c];
+    }
+    return n;
+}
+
+size_t iaq_record_decode(const iaq_record_schema_t *schema, iaq_record_state_t *state,
+                         const uint8_t *buf, size_t len,
+                         int64_t *time_s, int16_t *q, uint8_t *suspect)
+{
+    if (!schema || !state || !buf || !q) return 0;
+    const int cols = schema->column_count;
+    const size_t bitmap_len = IAQ_RECORD_BITMAP_LEN(cols);
+    const bool with_suspect = (schema->flags & IAQ_RECORD_FLAG_SUSPECT) != 0;
+
+    uint64_t raw = 0;
+    size_t n = varint_get(buf, len, &raw);
+    if (n == 0) return 0;
+    int64_t t = state->time_s + zigzag_decode(raw);
+
+    if (len - n < bitmap_len * (with_suspect ? 2 : 1)) return 0;
+    const uint8_t *present = &buf[n];
+    n += bitmap_len;
+    if (suspect) {
+        if (with_suspect) memcpy(suspect, &buf[n], bitmap_len);
+        else memset(suspect, 0, bitmap_len);
+    }
+    if (with_suspect) n += bitmap_len;
+
+    for (int c = 0; c < cols; c++) {
+        if (!bit_get(present, c)) {
+            q[c] = HISTORY_SENTINEL;
+            continue;
+        }
+        size_t v = varint_get(&buf[n], len - n, &raw);
+        if (v == 0) return 0;
+        int64_t value = state->last[c] + zigzag_decode(raw);
+        if (value <= INT16_MIN || value > INT16_MAX) return 0;
+        q[c] = (int16_t)value;
+        n += v;
+    }
+
+    state->time_s = t;
+    for (int c = 0; c < cols; c++) {
+        if (q[c] != HISTORY_SENTINEL) state->last[c] = q[c];
+    }
+    if (time_s) *time_s = t;
+    return n;
+}
@@ -8,20 +8,31 @@
 #define HISTORY_SENTINEL INT16_MIN
 #define HISTORY_METRIC_COUNT 13
 
+/*
+ * Single metric table: id, wire key, quantization (q = value * scale + offset).
+ * The enum, the history quantizer, the HTTP key map and the iaq_record schema
+ * are generated from it. Ids are on the wire: append only, never reorder
+ * (frontend mirror: utils/metricKeys.ts METRIC_KEYS).
+ */
+#define HISTORY_METRIC_TABLE(X) \
+    X(HIST_METRIC_TEMP,       "temp_c",        100, 4000) \
+    X(HIST_METRIC_HUMIDITY,   "rh_pct",        100, 0)    \
+    X(HIST_METRIC_CO2,        "co2_ppm",       1,   0)    \
+    X(HIST_METRIC_PRESSURE,   "pressure_hpa",  20,  0)    \
+    X(HIST_METRIC_PM1,        "pm1_ugm3",      10,  0)    \
+    X(HIST_METRIC_PM25,       "pm25_ugm3",     10,  0)    \
+    X(HIST_METRIC_PM10,       "pm10_ugm3",     10,  0)    \
+    X(HIST_METRIC_VOC,        "voc_index",     1,   0)    \
+    X(HIST_METRIC_NOX,        "nox_index",     1,   0)    \
+    X(HIST_METRIC_MOLD_RISK,  "mold_risk",     1,   0)    \
+    X(HIST_METRIC_AQI,        "aqi",           1,   0)    \
+    X(HIST_METRIC_COMFORT,    "comfort_score", 1,   0)    \
+    X(HIST_METRIC_IAQ_SCORE,  "iaq_score",     1,   0)
+
 typedef enum {
-    HIST_METRIC_TEMP = 0,
-    HIST_METRIC_HUMIDITY,
-    HIST_METRIC_CO2,
-    HIST_METRIC_PRESSURE,
-    HIST_METRIC_PM1,
-    HIST_METRIC_PM25,
-    HIST_METRIC_PM10,
-    HIST_METRIC_VOC,
-    HIST_METRIC_NOX,
-    HIST_METRIC_MOLD_RISK,
-    HIST_METRIC_AQI,
-    HIST_METRIC_COMFORT,
-    HIST_METRIC_IAQ_SCORE,
+#define HISTORY_METRIC_ENUM(id, key, scale, offset) id,
+    HISTORY_METRIC_TABLE(HISTORY_METRIC_ENUM)
+#undef HISTORY_METRIC_ENUM
 } history_metric_id_t;
 
 typedef struct {
@@ -30,10 +41,35 @@ typedef struct {
 } history_metric_scale_t;
 
 esp_err_t iaq_history_init(void);
+
+/**
+ * Append one sample to Tier 1. Buckets are keyed on the monotonic clock, so
+ * samples are kept before SNTP sync and across wall-clock steps; wall time is
+ * only sampled to maintain the mapping used to label buckets at query time.
+ *
+ * Single writer: call from one task only (the sensor coordinator's iaq_proc
+ * task). Appends never block; readers synchronize through per-tier sequence
+ * counters.
+ */
 void iaq_history_append(const iaq_data_t *data);
 bool iaq_history_metric_scale(history_metric_id_t metric, history_metric_scale_t *out);
+
+/** Wire key of a metric ("temp_c", ...), NULL if out of range. */
+const char *iaq_history_metric_key(history_metric_id_t metric);
+
+/** Look up a metric by wire key. */
+bool iaq_history_metric_from_key(const char *key, history_metric_id_t *out);
+
+/** Quantize a snapshot the way Tier 1 stores it; HISTORY_SENTINEL where invalid. */
+void iaq_history_quantize(const iaq_data_t *data, int16_t out[HISTORY_METRIC_COUNT]);
 void iaq_history_get_stats(uint32_t *used_bytes, uint32_t *total_bytes);
 
+/** True if the metric keeps extended bucket stats (stddev, first/last, time-weighted mean). */
+bool iaq_history_metric_has_ext_stats(history_metric_id_t metric);
+
+/** True if the flash-resident tier (tier 3) is mounted and can be queried. */
+bool iaq_history_long_term_available(void);
+
 /* ═══════════════════════════════════════════════════════════════════════════
  * STREAMING API - Zero-allocation binary history export
  * ═══════════════════════════════════════════════════════════════════════════ */
@@ -43,8 +79,9 @@ typedef struct {
     uint32_t resolution_s;    /* Effective resolution after grouping */
     int64_t  end_time;        /* Timestamp of last bucket */
     uint16_t bucket_count;    /* Number of output buckets */
-    uint8_t  tier;            /* Selected tier (0-2) */
+    uint8_t  tier;            /* Selected tier (0-2 RAM, 3 flash) */
     uint16_t group_factor;    /* Raw buckets per output bucket */
+    uint16_t ext_mask;        /* Bit per metric id whose batches carry extended stats */
 } history_stream_params_t;
 
 /* Compact wire format for buckets (6 bytes, packed) */
@@ -54,6 +91,22 @@ typedef struct __attribute__((packed)) {
     int16_t avg;
 } history_bucket_wire_t;
 
+/*
+ * Extended statistics (8 bytes, packed) for metrics listed in
+ * CONFIG_IAQ_HISTORY_EXT_STATS_METRICS, in the metric's quantized units.
+ * stddev is a spread, so only the scale applies to it, not the offset.
+ * tw_avg weights each sample by the time since the previous one.
+ */
+typedef struct __attribute__((packed)) {
+    int16_t stddev;
+    int16_t first;
+    int16_t last;
+    int16_t tw_avg;
+} history_bucket_ext_wire_t;
+
+/* Per-bucket flags passed alongside the wire buckets */
+#define HISTORY_BUCKET_FLAG_SUSPECT 0x01   /* Bucket contains samples flagged by sensor fault monitors */
+
 /* Header callback - invoked once before bucket streaming */
 typedef bool (*history_header_cb_t)(
     const history_stream_params_t *params,
@@ -62,11 +115,15 @@ typedef bool (*history_header_cb_t)(
     void *user_ctx
 );
 
-/* Bucket callback - invoked for each batch of aggregated buckets */
+/* Bucket callback - invoked for each batch of aggregated buckets.
+ * flags[i] holds HISTORY_BUCKET_FLAG_* bits for buckets[i]; ext[i] their
+ * extended stats, or ext is NULL if the metric has none in this stream. */
 typedef bool (*history_bucket_batch_cb_t)(
     history_metric_id_t metric,
     uint16_t start_bucket,
     const history_bucket_wire_t *buckets,
+    const uint8_t *flags,
+    const history_bucket_ext_wire_t *ext,
     uint16_t bucket_count,
     void *user_ctx
 );
@@ -74,10 +131,19 @@ typedef bool (*history_bucket_batch_cb_t)(
 /**
  * Stream history data via callbacks (zero heap allocation).
  *
- * Computes tier/grouping once, iterates all metrics.
- * Aggregates under lock into a caller-provided scratch buffer, then releases
- * the mutex before invoking callbacks (better throughput, slight inconsistency
- * is acceptable).
+ * Computes tier/grouping once, iterates all metrics. Ranges longer than the
+ * Tier 3 window are served from the flash tier when it is available; those
+ * buckets are laid on a fixed grid from the range start and empty where no
+ * data was recorded.
+ * Aggregates into a caller-provided scratch buffer without taking any lock:
+ * each batch is validated against the tier's sequence counter and redone if
+ * the writer touched that tier meanwhile, so appends never wait on readers.
+ * Callbacks run between batches; the tier may advance across batches (slight
+ * inconsistency at the window edges is acceptable).
+ *
+ * Bucket times are mapped from the monotonic timeline to wall-clock seconds
+ * using the offset in effect when each bucket was recorded (or the earliest
+ * known offset for buckets recorded before the first sync).
  *
  * @param metrics       Array of metric IDs to stream
  * @param metric_count  Number of metrics
@@ -85,6 +151,9 @@ typedef bool (*history_bucket_batch_cb_t)(
  * @param end_s         End time (unix seconds), 0 = now
  * @param max_points    Maximum output buckets, 0 = tier default
  * @param scratch       Caller-provided batch buffer (history_bucket_wire_t[])
+ * @param flags_scratch Caller-provided per-bucket flag buffer (scratch_len bytes)
+ * @param ext_scratch   Caller-provided extended stats buffer (scratch_len entries),
+ *                      NULL to stream without extended stats
  * @param scratch_len   Number of buckets in scratch buffer
  * @param header_cb     Called once with params before streaming
  * @param bucket_cb     Called for each batch (return false to abort)
@@ -99,8 +168,47 @@ esp_err_t iaq_history_stream(
     int64_t end_s,
     uint16_t max_points,
     history_bucket_wire_t *scratch,
+    uint8_t *flags_scratch,
+    history_bucket_ext_wire_t *ext_scratch,
     uint16_t scratch_len,
     history_header_cb_t header_cb,
     history_bucket_batch_cb_t bucket_cb,
     void *user_ctx
 );
+
+/* Row callback - one call per raw bucket; values[i]/flags[i] belong to metrics[i] */
+typedef bool (*history_row_cb_t)(
+    int64_t time_s,
+    uint32_t resolution_s,
+    const history_bucket_wire_t *values,
+    const uint8_t *flags,
+    int metric_count,
+    void *user_ctx
+);
+
+/**
+ * Walk raw (ungrouped) buckets of one tier in time order, one row per bucket.
+ *
+ * Intended for bulk export: each row is copied under the tier's sequence
+ * counter and handed to row_cb, so memory use is independent of the range.
+ *
+ * @param metrics       Array of metric IDs (column order)
+ * @param metric_count  Number of metrics
+ * @param tier_hint     Tier 0-3 (3 = flash), or -1 to select by range like iaq_history_stream()
+ * @param start_s       Start time (unix seconds), 0 = end - 1 hour
+ * @param end_s         End time (unix seconds), 0 = now
+ * @param row_cb        Called for each bucket in range (return false to abort)
+ * @param user_ctx      Passed to row_cb
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on bad input,
+ *         ESP_ERR_NOT_SUPPORTED if tier 3 is requested but unavailable,
+ *         ESP_FAIL if callback aborted
+ */
+esp_err_t iaq_history_export_rows(
+    const history_metric_id_t *metrics,
+    int metric_count,
+    int tier_hint,
+    int64_t start_s,
+    int64_t end_s,
+    history_row_cb_t row_cb,
+    void *user_ctx
+);
@@ -0,0 +1,116 @@
+/* components/iaq_history/include/iaq_record.h */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "iaq_history.h"
+
+/*
+ * Compact telemetry records, one format for storage and transport.
+ *
+ * A stream starts with a schema that names each column (metric id + field)
+ * and its quantization, taken from HISTORY_METRIC_TABLE, so a decoder needs
+ * no out-of-band knowledge. Each record then carries:
+ *
+ *   varint   zig-zag time delta in seconds (first record: absolute)
+ *   bitmap   presence, one bit per column, LSB first
+ *   bitmap   suspect, same layout (only with IAQ_RECORD_FLAG_SUSPECT)
+ *   varint   zig-zag delta to the column's previous present value,
+ *            for each present column in schema order
+ *
+ * Deltas are kept per stream in iaq_record_state_t; a fresh state makes a
+ * record self-contained (absolute values), which suits single messages.
+ * Values are the int16 quantized units used by history buckets.
+ *
+ * Schema layout (little-endian):
+ *   "IQR" version:u8 flags:u8 column_count:u8 period_s:varint
+ *   column_count x { metric:u8 field:u8 scale:i16 offset:i16 }
+ *
+ * Consumers outside the firmware: history export (?format=rec).
+ */
+
+#define IAQ_RECORD_VERSION      1
+#define IAQ_RECORD_MAX_COLUMNS  (HISTORY_METRIC_COUNT * 3)
+
+/* Schema flags */
+#define IAQ_RECORD_FLAG_SUSPECT 0x01    /* Records carry a suspect bitmap */
+
+typedef enum {
+    IAQ_RECORD_FIELD_SAMPLE = 0,        /* Instantaneous value */
+    IAQ_RECORD_FIELD_AVG,
+    IAQ_RECORD_FIELD_MIN,
+    IAQ_RECORD_FIELD_MAX,
+    IAQ_RECORD_FIELD_COUNT
+} iaq_record_field_t;
+
+#define IAQ_RECORD_FIELDS_SAMPLE    (1u << IAQ_RECORD_FIELD_SAMPLE)
+#define IAQ_RECORD_FIELDS_BUCKET    ((1u << IAQ_RECORD_FIELD_AVG) | (1u << IAQ_RECORD_FIELD_MIN) | \
+                                     (1u << IAQ_RECORD_FIELD_MAX))
+
+/* Worst-case sizes, for sizing caller buffers */
+#define IAQ_RECORD_BITMAP_LEN(cols)     (((cols) + 7) / 8)
+#define IAQ_RECORD_SCHEMA_MAX_SIZE(cols) (6 + 5 + 6 * (cols))
+#define IAQ_RECORD_MAX_SIZE(cols)       (10 + 2 * IAQ_RECORD_BITMAP_LEN(cols) + 3 * (cols))
+
+typedef struct {
+    uint8_t metric;                     /* history_metric_id_t */
+    uint8_t field;                      /* iaq_record_field_t */
+    int16_t scale;
+    int16_t offset;
+} iaq_record_column_t;
+
+typedef struct {
+    uint8_t flags;                      /* IAQ_RECORD_FLAG_* */
+    uint8_t column_count;
+    uint32_t period_s;                  /* Nominal record spacing, 0 = irregular */
+    iaq_record_column_t columns[IAQ_RECORD_MAX_COLUMNS];
+} iaq_record_schema_t;
+
+/** Delta reference of one stream (encoder or decoder side). */
+typedef struct {
+    int64_t time_s;
+    int16_t last[IAQ_RECORD_MAX_COLUMNS];
+} iaq_record_state_t;
+
+/**
+ * Build a schema with one column per (metric, field) pair, metric-major:
+ * for each metric, every field set in fields_mask in iaq_record_field_t order.
+ *
+ * @return ESP_ERR_INVALID_ARG on an unknown metric, empty mask or too many columns
+ */
+esp_err_t iaq_record_schema_init(iaq_record_schema_t *schema,
+                                 const history_metric_id_t *metrics, int metric_count,
+                                 uint32_t fields_mask, uint8_t flags, uint32_t period_s);
+
+/** Serialize a schema. @return bytes written, 0 if cap is too small */
+size_t iaq_record_schema_write(const iaq_record_schema_t *schema, uint8_t *buf, size_t cap);
+
+/** Parse a schema. @return bytes consumed, 0 if malformed, truncated or a newer version */
+size_t iaq_record_schema_read(iaq_record_schema_t *schema, const uint8_t *buf, size_t len);
+
+/** Start a new delta chain (next record is absolute). */
+void iaq_record_state_reset(iaq_record_state_t *state);
+
+/**
+ * Encode one record.
+ *
+ * @param q        One value per schema column, HISTORY_SENTINEL = absent
+ * @param suspect  Suspect bitmap (IAQ_RECORD_BITMAP_LEN bytes), NULL = none;
+ *                 ignored unless the schema has IAQ_RECORD_FLAG_SUSPECT
+ * @return bytes written, 0 if cap is too small (state is left unchanged)
+ */
+size_t iaq_record_encode(const iaq_record_schema_t *schema, iaq_record_state_t *state,
+                         int64_t time_s, const int16_t *q, const uint8_t *suspect,
+                         uint8_t *buf, size_t cap);
+
+/**
+ * Decode one record. Absent columns are returned as HISTORY_SENTINEL.
+ *
+ * @param suspect  Receives the suspect bitmap (zeroed without the flag), may be NULL
+ * @return bytes consumed, 0 if malformed or truncated (state is left unchanged)
+ */
+size_t iaq_record_decode(const iaq_record_schema_t *schema, iaq_record_state_t *state,
+                         const uint8_t *buf, size_t len,
+                         int64_t *time_s, int16_t *q, uint8_t *suspect);
@@ -5,6 +5,7 @@
 #include "cJSON.h"
 #include "iaq_json.h"
 #include "sensor_coordinator.h"
+#include "sensor_health.h"
 #include "time_sync.h"
 #include "power_board.h"
 #include <time.h>
@@ -432,6 +433,19 @@ cJSON* iaq_json_build_health(const iaq_data_t *data)
         }
         cJSON_AddBoolToObject(sj, "stale", stale);
 
+        /* Streaming fault monitors (flatline/stuck/step/disagree) */
+        cJSON_AddNumberToObject(sj, "health_score", info.health_score);
+        cJSON *faults = cJSON_CreateArray();
+        if (faults) {
+            for (uint8_t bit = 0; bit < 8; ++bit) {
+                const char *fault = sensor_health_fault_to_string((uint8_t)(1u << bit));
+                if (fault && (info.fault_flags & (1u << bit))) {
+                    cJSON_AddItemToArray(faults, cJSON_CreateString(fault));
+                }
+            }
+            cJSON_AddItemToObject(sj, "faults", faults);
+        }
+
         cJSON_AddItemToObject(sensors, sensor_coordinator_id_to_name((sensor_id_t)i), sj);
     }
     cJSON_AddItemToObject(root, "sensors", sensors);
@@ -439,6 +453,54 @@ cJSON* iaq_json_build_health(const iaq_data_t *data)
     return root;
 }
 
+cJSON* iaq_json_build_sensor_stats(const sensor_runtime_info_t *info)
+{
+    if (!info) return NULL;
+    const sensor_stats_t *st = &info->stats;
+    static const uint32_t bounds_ms[SENSOR_LATENCY_BUCKETS - 1] = SENSOR_LATENCY_BOUNDS_MS;
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return NULL;
+    cJSON_AddNumberToObject(root, "reads", st->reads);
+    cJSON_AddNumberToObject(root, "ok", st->ok);
+    cJSON_AddNumberToObject(root, "timeouts", st->err_timeout);
+    cJSON_AddNumberToObject(root, "crc_errors", st->err_crc);
+    cJSON_AddNumberToObject(root, "other_errors", st->err_other);
+    cJSON_AddNumberToObject(root, "retries", st->retries);
+
+    cJSON *lat = cJSON_CreateObject();
+    if (lat) {
+        cJSON_AddNumberToObject(lat, "last", round_to_2dp(st->latency_last_us / 1000.0));
+        cJSON_AddNumberToObject(lat, "max", round_to_2dp(st->latency_max_us / 1000.0));
+        cJSON *hist = cJSON_CreateArray();
+        cJSON *bounds = cJSON_CreateArray();
+        if (hist && bounds) {
+            for (int b = 0; b < SENSOR_LATENCY_BUCKETS; ++b) {
+                cJSON_AddItemToArray(hist, cJSON_CreateNumber(st->latency_hist[b]));
+            }
+            for (int b = 0; b < SENSOR_LATENCY_BUCKETS - 1; ++b) {
+                cJSON_AddItemToArray(bounds, cJSON_CreateNumber(bounds_ms[b]));
+            }
+        }
+        if (hist) cJSON_AddItemToObject(lat, "hist", hist);
+        if (bounds) cJSON_AddItemToObject(lat, "bounds", bounds);
+        cJSON_AddItemToObject(root, "latency_ms", lat);
+    }
+
+    /* Configured vs achieved cadence; interval is an EWMA over good reads */
+    cJSON_AddNumberToObject(root, "cadence_ms", info->cadence_ms);
+    if (st->interval_avg_ms > 0) cJSON_AddNumberToObject(root, "interval_ms", st->interval_avg_ms);
+    else cJSON_AddNullToObject(root, "interval_ms");
+
+    cJSON *jit = cJSON_CreateObject();
+    if (jit) {
+        cJSON_AddNumberToObject(jit, "avg", st->jitter_avg_ms);
+        cJSON_AddNumberToObject(jit, "max", st->jitter_max_ms);
+        cJSON_AddItemToObject(root, "jitter_ms", jit);
+    }
+    return root;
+}
+
 cJSON* iaq_json_build_power(void)
 {
     cJSON *root = cJSON_CreateObject();
@@ -4,6 +4,7 @@
 
 #include "cJSON.h"
 #include "iaq_data.h"
+#include "sensor_coordinator.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +21,9 @@ cJSON* iaq_json_build_metrics(const iaq_data_t *data);
 /* /health payload: system health + per-sensor runtime info */
 cJSON* iaq_json_build_health(const iaq_data_t *data);
 
+/* Per-sensor read statistics (latency histogram, error causes, cadence, jitter) */
+cJSON* iaq_json_build_sensor_stats(const sensor_runtime_info_t *info);
+
 /* /power payload: board power/charger/fuel-gauge snapshot (optional) */
 cJSON* iaq_json_build_power(void);
 
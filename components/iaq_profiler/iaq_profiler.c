@@ -12,6 +12,8 @@
 #include "freertos/queue.h"
 #include "iaq_profiler.h"
 #include "iaq_data.h"
+#include "blackbox.h"
+#include "periodic_sched.h"
 #include "esp_wifi.h"
 #include "esp_pm.h"
 
@@ -97,6 +99,7 @@ void iaq_profiler_record(int metric_id, uint32_t duration_us)
     if (m->max_us < duration_us) m->max_us = duration_us;
     if (m->min_us == 0 || m->min_us > duration_us) m->min_us = duration_us;
     portEXIT_CRITICAL(&s_metrics_lock);
+    blackbox_record_span(metric_id, duration_us);
 #else
     (void)metric_id; (void)duration_us;
 #endif
@@ -114,12 +117,17 @@ static const char* metric_name(int id)
         case IAQ_METRIC_SENSOR_PMS5003_READ: return "sensor/pms5003";
         case IAQ_METRIC_SENSOR_PMS5003_RX:   return "sensor/pms5003_rx";
         case IAQ_METRIC_SENSOR_S8_READ:      return "sensor/s8";
+        case IAQ_METRIC_SENSOR_S8_MODBUS:    return "sensor/s8_modbus";
         case IAQ_METRIC_FUSION_TICK:         return "fusion/tick";
         case IAQ_METRIC_METRICS_TICK:        return "metrics/tick";
+        case IAQ_METRIC_FUSION_APPLY:        return "fusion/apply";
+        case IAQ_METRIC_HISTORY_APPEND:      return "history/append";
+        case IAQ_METRIC_PROC_LATENCY:        return "proc/latency";
         case IAQ_METRIC_MQTT_HEALTH:         return "mqtt/health";
         case IAQ_METRIC_MQTT_STATE:          return "mqtt/state";
         case IAQ_METRIC_MQTT_METRICS:        return "mqtt/metrics";
         case IAQ_METRIC_MQTT_DIAG:           return "mqtt/diag";
+        case IAQ_METRIC_MQTT_CONNECT:        return "mqtt/connect";
         case IAQ_METRIC_DISPLAY_FRAME:       return "display/frame";
         case IAQ_METRIC_WEB_STATIC:          return "web/static";
         case IAQ_METRIC_WEB_API_STATE:       return "web/api_state";
@@ -135,12 +143,28 @@ static const char* metric_name(int id)
         case IAQ_METRIC_WEB_CONSOLE_LOG_BROADCAST: return "web/console_log_bcast";
         case IAQ_METRIC_WEB_CONSOLE_LOG_HISTORY:   return "web/console_log_history";
         case IAQ_METRIC_WEB_CONSOLE_CMD:           return "web/console_cmd";
+        case IAQ_METRIC_WEB_TLS_HANDSHAKE:         return "web/tls_handshake";
+        case IAQ_METRIC_WEB_TLS_SESSION_RAM:       return "web/tls_sess_bytes";
+        case IAQ_METRIC_WEB_WS_DEFLATE:            return "web/ws_deflate";
+        case IAQ_METRIC_WEB_WS_DEFLATE_PCT:        return "web/ws_deflate_pct";
+        case IAQ_METRIC_WEB_RATE_LIMITED:          return "web/rate_limited";
         case IAQ_METRIC_POWER_POLL:          return "power/poll";
         default: return "unknown";
     }
 }
 #endif
 
+const char *iaq_profiler_metric_name(int metric_id)
+{
+#if CONFIG_IAQ_PROFILING
+    if (metric_id < 0 || metric_id >= IAQ_METRIC_MAX) return NULL;
+    return metric_name(metric_id);
+#else
+    (void)metric_id;
+    return NULL;
+#endif
+}
+
 /* WiFi helpers used in both simple and comprehensive reports */
 static const char* wifi_mode_to_str(wifi_mode_t m)
 {
@@ -327,6 +351,16 @@ void iaq_status_report(void)
     }
 #endif
 
+    /* Periodic work: distinct wake-ups per subsystem, last complete minute */
+    periodic_sched_subsys_stats_t wake[PERIODIC_SCHED_MAX_SUBSYSTEMS];
+    uint32_t wake_total = 0;
+    int wake_n = periodic_sched_get_stats(wake, PERIODIC_SCHED_MAX_SUBSYSTEMS, &wake_total);
+    ESP_LOGI(TAG, "  -- Wake-ups/min: %lu --", (unsigned long)wake_total);
+    for (int i = 0; i < wake_n; ++i) {
+        ESP_LOGI(TAG, "  %-16s : wakes=%-4lu runs=%-4lu",
+                 wake[i].subsystem, (unsigned long)wake[i].wakeups, (unsigned long)wake[i].runs);
+    }
+
 #if CONFIG_IAQ_PROFILING_PM_LOCKS
     /* PM lock profiling (esp_pm_dump_locks) */
     ESP_LOGI(TAG, "  -- PM Locks --");
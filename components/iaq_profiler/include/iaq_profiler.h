@@ -18,14 +18,19 @@ typedef enum {
     IAQ_METRIC_SENSOR_PMS5003_READ,
     IAQ_METRIC_SENSOR_S8_READ,
     IAQ_METRIC_SENSOR_PMS5003_RX,  /* Background RX parse time */
+    IAQ_METRIC_SENSOR_S8_MODBUS,   /* One Modbus round-trip (merged reads count once) */
 
-    IAQ_METRIC_FUSION_TICK,
+    IAQ_METRIC_FUSION_TICK,           /* Whole fusion stage of the processing task */
     IAQ_METRIC_METRICS_TICK,
+    IAQ_METRIC_FUSION_APPLY,          /* fusion_apply + snapshot copy, under the data lock */
+    IAQ_METRIC_HISTORY_APPEND,
+    IAQ_METRIC_PROC_LATENCY,          /* Timer post until the processing task picks it up */
 
     IAQ_METRIC_MQTT_HEALTH,
     IAQ_METRIC_MQTT_STATE,
     IAQ_METRIC_MQTT_METRICS,
     IAQ_METRIC_MQTT_DIAG,
+    IAQ_METRIC_MQTT_CONNECT,          /* TCP + TLS + CONNECT until broker ack */
 
     IAQ_METRIC_DISPLAY_FRAME,
 
@@ -44,6 +49,11 @@ typedef enum {
     IAQ_METRIC_WEB_CONSOLE_LOG_BROADCAST,
     IAQ_METRIC_WEB_CONSOLE_LOG_HISTORY,
     IAQ_METRIC_WEB_CONSOLE_CMD,
+    IAQ_METRIC_WEB_TLS_HANDSHAKE,     /* ClientHello -> session established */
+    IAQ_METRIC_WEB_TLS_SESSION_RAM,   /* Bytes (not us): heap held by a new session */
+    IAQ_METRIC_WEB_WS_DEFLATE,        /* Compressing one WS message */
+    IAQ_METRIC_WEB_WS_DEFLATE_PCT,    /* Percent (not us): compressed/plain size */
+    IAQ_METRIC_WEB_RATE_LIMITED,      /* Rejected request; value is Retry-After in ms (not us) */
     IAQ_METRIC_POWER_POLL,
 
     IAQ_METRIC_MAX
@@ -74,6 +84,9 @@ void iaq_profiler_unregister_task(TaskHandle_t handle);
 /* Record a duration for a metric (microseconds). */
 void iaq_profiler_record(int metric_id, uint32_t duration_us);
 
+/* Short metric name ("sensor/s8"), or NULL if unknown or profiling is disabled. */
+const char *iaq_profiler_metric_name(int metric_id);
+
 /* Helpers for easy timing at call sites */
 static inline iaq_prof_ctx_t iaq_prof_start(int id)
 {
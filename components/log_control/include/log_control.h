@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "esp_err.h"
 #include "esp_log_level.h"
 
@@ -18,6 +19,47 @@ esp_log_level_t log_control_get_app_level(void);
 esp_log_level_t log_control_get_system_level(void);
 void log_control_get_system_tags(const char ***tags, size_t *count);
 
+/*
+ * Log rate limiting (CONFIG_IAQ_LOG_RATELIMIT_ENABLE).
+ *
+ * A vprintf hook keeps a token bucket per call site (format string) and per
+ * tag. A line passes only if both buckets have a token; otherwise it is
+ * dropped before formatting, so it never reaches the console, the web log
+ * ring or the black box. Every summary_s a "Suppressed N messages from TAG"
+ * line is logged for each tag that lost lines. log_control_apply_from_nvs()
+ * installs the hook and must run after other vprintf hooks (blackbox_init).
+ */
+typedef struct {
+    bool enabled;
+    uint16_t site_per_min;      /* Refill rate per call site, lines/minute */
+    uint16_t site_burst;        /* Bucket size per call site, lines */
+    uint16_t tag_per_min;       /* Refill rate per tag, lines/minute */
+    uint16_t tag_burst;
+    uint16_t summary_s;         /* Suppression summary period */
+} log_ratelimit_cfg_t;
+
+typedef struct {
+    uint32_t passed;
+    uint32_t suppressed;
+    uint32_t untracked;         /* Lines passed because the site/tag tables were full */
+    uint16_t sites;             /* Call sites tracked */
+    uint16_t tags;
+} log_ratelimit_stats_t;
+
+typedef struct {
+    const char *tag;
+    uint32_t suppressed;        /* Since boot */
+    uint32_t pending;           /* Not yet reported in a summary */
+} log_ratelimit_tag_stats_t;
+
+void log_control_get_ratelimit(log_ratelimit_cfg_t *out);
+esp_err_t log_control_set_ratelimit(const log_ratelimit_cfg_t *cfg, bool persist);
+esp_err_t log_control_reset_ratelimit(bool persist);
+void log_control_get_ratelimit_stats(log_ratelimit_stats_t *out);
+
+/** Tags that lost lines, most suppressed first. Returns the number written. */
+size_t log_control_get_ratelimit_tags(log_ratelimit_tag_stats_t *out, size_t max);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,10 +1,10 @@
 /* components/log_control/log_control.c */
 #include "log_control.h"
+#include "log_control_internal.h"
 #include "nvs.h"
 #include "esp_log.h"
 #include "sdkconfig.h"
 
-#define LOG_CTRL_NVS_NS  "log_cfg"
 #define LOG_CTRL_KEY_APP "app_level"
 #define LOG_CTRL_KEY_SYS "sys_level"
 
@@ -113,6 +113,8 @@ static esp_err_t erase_level(const char *key)
 
 esp_err_t log_control_apply_from_nvs(void)
 {
+    log_ratelimit_init();
+
 #if !CONFIG_LOG_DYNAMIC_LEVEL_CONTROL
     return ESP_ERR_NOT_SUPPORTED;
 #else
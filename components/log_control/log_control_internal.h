@@ -0,0 +1,10 @@
+/* components/log_control/log_control_internal.h */
+#ifndef LOG_CONTROL_INTERNAL_H
+#define LOG_CONTROL_INTERNAL_H
+
+#define LOG_CTRL_NVS_NS  "log_cfg"
+
+/* Load the rate-limit settings and install the vprintf hook (idempotent) */
+void log_ratelimit_init(void);
+
+#endif /* LOG_CONTROL_INTERNAL_H */
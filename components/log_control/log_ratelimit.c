@@ -0,0 +1,436 @@
+/* components/log_control/log_ratelimit.c */
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+
+#include "log_control.h"
+#include "log_control_internal.h"
+#include "periodic_sched.h"
+#include "iaq_config.h"
+
+/* Summary lines use this pointer and are never limited themselves */
+static const char *TAG = "LOG_CTRL";
+
+#ifndef CONFIG_IAQ_LOG_RATELIMIT_SITE_PER_MIN
+#define CONFIG_IAQ_LOG_RATELIMIT_SITE_PER_MIN 60
+#endif
+#ifndef CONFIG_IAQ_LOG_RATELIMIT_SITE_BURST
+#define CONFIG_IAQ_LOG_RATELIMIT_SITE_BURST 10
+#endif
+#ifndef CONFIG_IAQ_LOG_RATELIMIT_TAG_PER_MIN
+#define CONFIG_IAQ_LOG_RATELIMIT_TAG_PER_MIN 600
+#endif
+#ifndef CONFIG_IAQ_LOG_RATELIMIT_TAG_BURST
+#define CONFIG_IAQ_LOG_RATELIMIT_TAG_BURST 50
+#endif
+#ifndef CONFIG_IAQ_LOG_RATELIMIT_SUMMARY_S
+#define CONFIG_IAQ_LOG_RATELIMIT_SUMMARY_S 30
+#endif
+
+#define LOG_RL_KEY_CFG      "rl_cfg"
+#define LOG_RL_SITES        64
+#define LOG_RL_TAGS         32
+#define LOG_RL_PROBE        8       /* Slots searched per lookup */
+#define LOG_RL_MILLI        1000u   /* Buckets count milli-tokens */
+
+#define LOG_RL_SUMMARY_MIN_S    5
+#define LOG_RL_SUMMARY_MAX_S    3600
+
+static const log_ratelimit_cfg_t k_defaults = {
+    .enabled = true,
+    .site_per_min = CONFIG_IAQ_LOG_RATELIMIT_SITE_PER_MIN,
+    .site_burst = CONFIG_IAQ_LOG_RATELIMIT_SITE_BURST,
+    .tag_per_min = CONFIG_IAQ_LOG_RATELIMIT_TAG_PER_MIN,
+    .tag_burst = CONFIG_IAQ_LOG_RATELIMIT_TAG_BURST,
+    .summary_s = CONFIG_IAQ_LOG_RATELIMIT_SUMMARY_S,
+};
+
+#if CONFIG_IAQ_LOG_RATELIMIT_ENABLE
+/* Call sites are keyed by format string: every ESP_LOGx has its own literal */
+typedef struct {
+    const char *fmt;
+    uint32_t tokens_m;
+    uint32_t last_ms;
+} rl_site_t;
+
+typedef struct {
+    const char *tag;
+    uint32_t hash;
+    uint32_t tokens_m;
+    uint32_t last_ms;
+    uint32_t pending;
+    uint32_t total;
+} rl_tag_t;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_installed = false;
+static vprintf_like_t s_prev_vprintf = NULL;
+static periodic_work_handle_t s_summary_work = NULL;
+
+/* Guarded by s_lock */
+static log_ratelimit_cfg_t s_cfg;
+static rl_site_t s_sites[LOG_RL_SITES];
+static rl_tag_t s_tags[LOG_RL_TAGS];
+static uint16_t s_site_count = 0;
+static uint16_t s_tag_count = 0;
+static uint32_t s_passed = 0;
+static uint32_t s_suppressed = 0;
+static uint32_t s_untracked = 0;
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static uint32_t bucket_refill(uint32_t tokens_m, uint32_t last_ms, uint32_t now,
+                              uint16_t per_min, uint16_t burst)
+{
+    /* per_min lines per 60000 ms = per_min / 60 milli-tokens per ms */
+    uint64_t t = tokens_m + (uint64_t)(now - last_ms) * per_min / 60;
+    uint32_t cap = (uint32_t)burst * LOG_RL_MILLI;
+    return t > cap ? cap : (uint32_t)t;
+}
+
+/* Caller holds s_lock. Idle entries (bucket refilled, nothing pending) are
+ * recycled so one-off boot messages do not pin the tables. */
+static rl_site_t *site_lookup(const char *fmt, uint32_t now)
+{
+    uint32_t start = (((uint32_t)(uintptr_t)fmt >> 2) * 2654435761u) % LOG_RL_SITES;
+    uint32_t cap = (uint32_t)s_cfg.site_burst * LOG_RL_MILLI;
+    rl_site_t *spare = NULL;
+    for (int i = 0; i < LOG_RL_PROBE; i++) {
+        rl_site_t *e = &s_sites[(start + i) % LOG_RL_SITES];
+        if (e->fmt == fmt) return e;
+        if (!e->fmt) {
+            spare = e;
+            s_site_count++;
+            break;
+        }
+        if (!spare && bucket_refill(e->tokens_m, e->last_ms, now, s_cfg.site_per_min, s_cfg.site_burst) == cap) {
+            spare = e;
+        }
+    }
+    if (spare) {
+        *spare = (rl_site_t){ .fmt = fmt, .tokens_m = cap, .last_ms = now };
+    }
+    return spare;
+}
+
+static uint32_t tag_hash(const char *tag)
+{
+    uint32_t h = 2166136261u;
+    while (*tag) {
+        h = (h ^ (uint8_t)*tag++) * 16777619u;
+    }
+    return h;
+}
+
+/* Caller holds s_lock. Tags are matched by name: several files share "WIFI". */
+static rl_tag_t *tag_lookup(const char *tag, uint32_t now)
+{
+    uint32_t h = tag_hash(tag);
+    uint32_t cap = (uint32_t)s_cfg.tag_burst * LOG_RL_MILLI;
+    rl_tag_t *spare = NULL;
+    for (int i = 0; i < LOG_RL_PROBE; i++) {
+        rl_tag_t *e = &s_tags[(h + i) % LOG_RL_TAGS];
+        if (e->tag && e->hash == h && (e->tag == tag || strcmp(e->tag, tag) == 0)) return e;
+        if (!e->tag) {
+            spare = e;
+            s_tag_count++;
+            break;
+        }
+        if (!spare && e->pending == 0 &&
+            bucket_refill(e->tokens_m, e->last_ms, now, s_cfg.tag_per_min, s_cfg.tag_burst) == cap) {
+            spare = e;
+        }
+    }
+    if (spare) {
+        *spare = (rl_tag_t){ .tag = tag, .hash = h, .tokens_m = cap, .last_ms = now };
+    }
+    return spare;
+}
+
+static bool admit(const char *fmt, const char *tag)
+{
+    uint32_t now = now_ms();
+    bool pass = true;
+
+    portENTER_CRITICAL_SAFE(&s_lock);
+    rl_tag_t *t = tag_lookup(tag, now);
+    rl_site_t *site = t ? site_lookup(fmt, now) : NULL;
+    if (!t) {
+        s_untracked++;
+    } else {
+        t->tokens_m = bucket_refill(t->tokens_m, t->last_ms, now, s_cfg.tag_per_min, s_cfg.tag_burst);
+        t->last_ms = now;
+        if (site) {
+            site->tokens_m = bucket_refill(site->tokens_m, site->last_ms, now, s_cfg.site_per_min, s_cfg.site_burst);
+            site->last_ms = now;
+        } else {
+            s_untracked++;
+        }
+        pass = t->tokens_m >= LOG_RL_MILLI && (!site || site->tokens_m >= LOG_RL_MILLI);
+        if (pass) {
+            t->tokens_m -= LOG_RL_MILLI;
+            if (site) site->tokens_m -= LOG_RL_MILLI;
+            s_passed++;
+        } else {
+            t->pending++;
+            t->total++;
+            s_suppressed++;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&s_lock);
+    return pass;
+}
+
+static const char *skip_color(const char *s)
+{
+    while (s[0] == '\033' && s[1] == '[') {
+        s += 2;
+        while (*s && *s != 'm') s++;
+        if (*s) s++;
+    }
+    return s;
+}
+
+/* ESP_LOGx passes "<color>W (%" PRIu32 ") %s: <fmt>" with the timestamp and
+ * tag as the first two arguments ("(%s)" for the system-time timestamp).
+ * Anything else (raw esp_log_write) has no tag and is never limited. */
+static const char *line_tag(const char *fmt, va_list args)
+{
+    const char *p = skip_color(fmt);
+    if (!strchr("EWIDV", p[0]) || p[0] == '\0' || p[1] != ' ' || p[2] != '(' || p[3] != '%') {
+        return NULL;
+    }
+    va_list copy;
+    va_copy(copy, args);
+    if (p[4] == 's') {
+        (void)va_arg(copy, const char *);
+    } else {
+        (void)va_arg(copy, uint32_t);
+    }
+    const char *tag = va_arg(copy, const char *);
+    va_end(copy);
+    return tag;
+}
+
+static int ratelimit_vprintf(const char *fmt, va_list args)
+{
+    if (s_cfg.enabled) {
+        const char *tag = line_tag(fmt, args);
+        if (tag && tag != TAG && !admit(fmt, tag)) {
+            return 0;
+        }
+    }
+    return s_prev_vprintf ? s_prev_vprintf(fmt, args) : vprintf(fmt, args);
+}
+
+static void summary_cb(void *arg)
+{
+    (void)arg;
+    struct {
+        const char *tag;
+        uint32_t count;
+    } report[LOG_RL_TAGS];
+    size_t n = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    uint16_t period_s = s_cfg.summary_s;
+    for (int i = 0; i < LOG_RL_TAGS; i++) {
+        if (s_tags[i].tag && s_tags[i].pending > 0) {
+            report[n].tag = s_tags[i].tag;
+            report[n].count = s_tags[i].pending;
+            s_tags[i].pending = 0;
+            n++;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    for (size_t i = 0; i < n; i++) {
+        ESP_LOGW(TAG, "Suppressed %lu messages from %s in the last %us",
+                 (unsigned long)report[i].count, report[i].tag, (unsigned)period_s);
+    }
+}
+
+static esp_err_t load_cfg(log_ratelimit_cfg_t *out)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(LOG_CTRL_NVS_NS, NVS_READONLY, &h);
+    if (err != ESP_OK) return err;
+
+    log_ratelimit_cfg_t cfg;
+    size_t len = sizeof(cfg);
+    err = nvs_get_blob(h, LOG_RL_KEY_CFG, &cfg, &len);
+    nvs_close(h);
+    if (err != ESP_OK) return err;
+    if (len != sizeof(cfg)) return ESP_ERR_INVALID_SIZE;
+    *out = cfg;
+    return ESP_OK;
+}
+
+static esp_err_t save_cfg(const log_ratelimit_cfg_t *cfg)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(LOG_CTRL_NVS_NS, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+
+    err = nvs_set_blob(h, LOG_RL_KEY_CFG, cfg, sizeof(*cfg));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+static esp_err_t erase_cfg(void)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(LOG_CTRL_NVS_NS, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+
+    err = nvs_erase_key(h, LOG_RL_KEY_CFG);
+    if (err == ESP_ERR_NVS_NOT_FOUND) err = ESP_OK;
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+static bool cfg_valid(const log_ratelimit_cfg_t *cfg)
+{
+    return cfg->site_per_min > 0 && cfg->site_burst > 0 &&
+           cfg->tag_per_min > 0 && cfg->tag_burst > 0 &&
+           cfg->summary_s >= LOG_RL_SUMMARY_MIN_S && cfg->summary_s <= LOG_RL_SUMMARY_MAX_S;
+}
+
+static void apply_cfg(const log_ratelimit_cfg_t *cfg)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool period_changed = s_cfg.summary_s != cfg->summary_s;
+    s_cfg = *cfg;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (s_summary_work && (period_changed || !periodic_sched_is_active(s_summary_work))) {
+        uint64_t period_us = (uint64_t)cfg->summary_s * 1000000ULL;
+        (void)periodic_sched_start(s_summary_work, period_us, period_us);
+    }
+}
+#endif /* CONFIG_IAQ_LOG_RATELIMIT_ENABLE */
+
+void log_ratelimit_init(void)
+{
+#if CONFIG_IAQ_LOG_RATELIMIT_ENABLE
+    if (s_installed) return;
+
+    log_ratelimit_cfg_t cfg = k_defaults;
+    esp_err_t err = load_cfg(&cfg);
+    if (err == ESP_OK && !cfg_valid(&cfg)) {
+        cfg = k_defaults;
+        err = ESP_ERR_INVALID_ARG;
+    }
+    s_cfg = cfg;
+
+    const periodic_work_args_t args = {
+        .callback = summary_cb,
+        .name = "log_summary",
+        .subsystem = "log",
+        .slack_ms = SLACK_MS_LOG_SUMMARY,
+    };
+    if (periodic_sched_create(&args, &s_summary_work) != ESP_OK) {
+        s_summary_work = NULL;
+    }
+    apply_cfg(&cfg);
+
+    s_prev_vprintf = esp_log_set_vprintf(ratelimit_vprintf);
+    s_installed = true;
+
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Failed to load log rate limits: %s", esp_err_to_name(err));
+    }
+    if (!s_summary_work) {
+        ESP_LOGW(TAG, "Log suppression summaries unavailable");
+    }
+#endif
+}
+
+void log_control_get_ratelimit(log_ratelimit_cfg_t *out)
+{
+    if (!out) return;
+#if CONFIG_IAQ_LOG_RATELIMIT_ENABLE
+    portENTER_CRITICAL(&s_lock);
+    *out = s_installed ? s_cfg : k_defaults;
+    portEXIT_CRITICAL(&s_lock);
+#else
+    *out = k_defaults;
+    out->enabled = false;
+#endif
+}
+
+esp_err_t log_control_set_ratelimit(const log_ratelimit_cfg_t *cfg, bool persist)
+{
+#if !CONFIG_IAQ_LOG_RATELIMIT_ENABLE
+    (void)cfg;
+    (void)persist;
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (!cfg || !cfg_valid(cfg)) return ESP_ERR_INVALID_ARG;
+    if (!s_installed) return ESP_ERR_INVALID_STATE;
+    apply_cfg(cfg);
+    if (!persist) return ESP_OK;
+    return save_cfg(cfg);
+#endif
+}
+
+esp_err_t log_control_reset_ratelimit(bool persist)
+{
+#if !CONFIG_IAQ_LOG_RATELIMIT_ENABLE
+    (void)persist;
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (!s_installed) return ESP_ERR_INVALID_STATE;
+    apply_cfg(&k_defaults);
+    if (!persist) return ESP_OK;
+    return erase_cfg();
+#endif
+}
+
+void log_control_get_ratelimit_stats(log_ratelimit_stats_t *out)
+{
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+#if CONFIG_IAQ_LOG_RATELIMIT_ENABLE
+    portENTER_CRITICAL(&s_lock);
+    out->passed = s_passed;
+    out->suppressed = s_suppressed;
+    out->untracked = s_untracked;
+    out->sites = s_site_count;
+    out->tags = s_tag_count;
+    portEXIT_CRITICAL(&s_lock);
+#endif
+}
+
+size_t log_control_get_ratelimit_tags(log_ratelimit_tag_stats_t *out, size_t max)
+{
+    size_t n = 0;
+    if (!out || max == 0) return 0;
+#if CONFIG_IAQ_LOG_RATELIMIT_ENABLE
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < LOG_RL_TAGS; i++) {
+        const rl_tag_t *e = &s_tags[i];
+        if (!e->tag || e->total == 0) continue;
+        /* Insertion by total, keeping the top `max` */
+        size_t pos = n < max ? n : max;
+        while (pos > 0 && out[pos - 1].suppressed < e->total) pos--;
+        if (pos >= max) continue;
+        size_t last = n < max ? n : max - 1;
+        memmove(&out[pos + 1], &out[pos], (last - pos) * sizeof(out[0]));
+        out[pos] = (log_ratelimit_tag_stats_t){ .tag = e->tag, .suppressed = e->total, .pending = e->pending };
+        if (n < max) n++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+#endif
+    return n;
+}
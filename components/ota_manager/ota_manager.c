@@ -11,6 +11,7 @@
 #include "esp_partition.h"
 #include "esp_system.h"
 #include "esp_littlefs.h"
+#include "www_pack.h"
 
 #include "ota_manager.h"
 
@@ -244,10 +245,12 @@ esp_err_t ota_manager_get_version_info(ota_version_info_t *info)
         strlcpy(info->firmware.idf_version, desc.idf_ver, sizeof(info->firmware.idf_version));
     }
 
-    /* Frontend version: best effort read from mounted filesystem */
+    /* Frontend version: best effort read from the asset pack or mounted filesystem */
     strlcpy(info->frontend.version, "-", sizeof(info->frontend.version));
-    FILE *vf = fopen(CONFIG_IAQ_OTA_WWW_MOUNT_POINT "/version.txt", "r");
-    if (vf) {
+    FILE *vf = NULL;
+    if (www_pack_read_file("/version.txt", info->frontend.version, sizeof(info->frontend.version), NULL) == ESP_OK) {
+        info->frontend.version[strcspn(info->frontend.version, "\r\n")] = '\0';
+    } else if ((vf = fopen(CONFIG_IAQ_OTA_WWW_MOUNT_POINT "/version.txt", "r")) != NULL) {
         if (fgets(info->frontend.version, sizeof(info->frontend.version), vf)) {
             size_t l = strlen(info->frontend.version);
             if (l && info->frontend.version[l - 1] == '\n') {
@@ -506,6 +509,14 @@ esp_err_t ota_firmware_abort(void)
 
 static esp_err_t frontend_remount(bool format_on_fail)
 {
+    /* A packed asset image is mapped directly; anything else must be LittleFS */
+    esp_err_t pr = www_pack_mount(CONFIG_IAQ_OTA_WWW_PARTITION_LABEL);
+    if (pr == ESP_OK || pr == ESP_ERR_INVALID_STATE) return ESP_OK;
+    if (pr != ESP_ERR_NOT_SUPPORTED && !format_on_fail) {
+        ESP_LOGE(TAG, "Asset pack invalid: %s", esp_err_to_name(pr));
+        return pr;
+    }
+
     esp_vfs_littlefs_conf_t conf = {
         .base_path = CONFIG_IAQ_OTA_WWW_MOUNT_POINT,
         .partition_label = CONFIG_IAQ_OTA_WWW_PARTITION_LABEL,
@@ -547,6 +558,13 @@ esp_err_t ota_frontend_begin(size_t total_size, ota_progress_cb_t cb)
         return ESP_ERR_INVALID_SIZE;
     }
 
+    /* Drop the asset pack mapping once in-flight responses are sent */
+    esp_err_t pr = www_pack_unmount();
+    if (pr != ESP_OK) {
+        ESP_LOGE(TAG, "Asset pack still in use: %s", esp_err_to_name(pr));
+        return pr;
+    }
+
     /* Unmount if currently mounted */
     bool was_mounted = false;
     if (esp_littlefs_info(part->label, NULL, NULL) == ESP_OK) {
@@ -665,7 +683,10 @@ esp_err_t ota_frontend_end(void)
     ota_emit_progress(true, NULL);
 
     size_t total = 0, used = 0;
-    if (esp_littlefs_info(part->label, &total, &used) == ESP_OK) {
+    uint32_t assets = 0;
+    if (www_pack_get_info(&used, &assets) == ESP_OK) {
+        ESP_LOGI(TAG, "Asset pack mapped (%u assets, %u/%u bytes)", (unsigned)assets, (unsigned)used, (unsigned)part->size);
+    } else if (esp_littlefs_info(part->label, &total, &used) == ESP_OK) {
         ESP_LOGI(TAG, "LittleFS remounted (%u/%u bytes used)", (unsigned)used, (unsigned)total);
     }
     ESP_LOGI(TAG, "Frontend OTA complete (no reboot required)");
@@ -82,11 +82,36 @@ typedef enum {
     SENSOR_STATE_DISABLED
 } sensor_state_t;
 
+/* Read latency histogram: bucket i counts reads below SENSOR_LATENCY_BOUNDS_MS[i],
+ * the last bucket everything slower. */
+#define SENSOR_LATENCY_BOUNDS_MS    { 2, 5, 10, 20, 50, 100, 200, 500, 1000 }
+#define SENSOR_LATENCY_BUCKETS      10
+
+/* Cumulative per-sensor read statistics since boot */
+typedef struct {
+    uint32_t reads;                     /* Read attempts that reached the driver */
+    uint32_t ok;
+    uint32_t err_timeout;               /* ESP_ERR_TIMEOUT (no or short response) */
+    uint32_t err_crc;                   /* ESP_ERR_INVALID_CRC / ESP_ERR_INVALID_RESPONSE */
+    uint32_t err_other;
+    uint32_t retries;                   /* Retries inside the driver (e.g. SGP41 one-shot) */
+    uint32_t latency_hist[SENSOR_LATENCY_BUCKETS];
+    uint32_t latency_last_us;
+    uint32_t latency_max_us;
+    uint32_t interval_avg_ms;           /* Achieved time between good reads (EWMA), 0 until two */
+    uint32_t jitter_avg_ms;             /* Scheduled read start vs. due time (EWMA) */
+    uint32_t jitter_max_ms;
+} sensor_stats_t;
+
 typedef struct {
     sensor_state_t state;
     int64_t warmup_deadline_us;
     int64_t last_read_us;
     uint32_t error_count;
+    uint8_t fault_flags;        /* SENSOR_FAULT_* bitmask (see sensor_health.h) */
+    uint8_t health_score;       /* 0-100, 100 = no active fault monitors */
+    uint32_t cadence_ms;        /* Configured read interval (0 = periodic reads off) */
+    sensor_stats_t stats;
 } sensor_runtime_info_t;
 
 /**
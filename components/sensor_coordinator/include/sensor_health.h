@@ -0,0 +1,76 @@
+/* components/sensor_coordinator/include/sensor_health.h */
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_coordinator.h"
+
+/* Per-sensor fault flags (bitmask, see sensor_runtime_info_t.fault_flags) */
+#define SENSOR_FAULT_FLATLINE   (1u << 0)   /* Variance collapsed below the channel noise floor */
+#define SENSOR_FAULT_STUCK      (1u << 1)   /* Bit-identical value repeated too many times */
+#define SENSOR_FAULT_STEP       (1u << 2)   /* Implausible rate of change between samples */
+#define SENSOR_FAULT_DISAGREE   (1u << 3)   /* Cross-sensor disagreement (SHT45 vs BMP280 temp) */
+
+#define SENSOR_HEALTH_SCORE_MAX 100
+
+/**
+ * Raw channels fed to the online fault monitors.
+ * Each channel belongs to exactly one sensor; flags are OR-ed per sensor.
+ */
+typedef enum {
+    HEALTH_CH_MCU_TEMP = 0,
+    HEALTH_CH_SHT45_TEMP,
+    HEALTH_CH_SHT45_RH,
+    HEALTH_CH_BMP280_PRESSURE,
+    HEALTH_CH_BMP280_TEMP,
+    HEALTH_CH_SGP41_VOC,
+    HEALTH_CH_SGP41_NOX,
+    HEALTH_CH_PM1,
+    HEALTH_CH_PM25,
+    HEALTH_CH_PM10,
+    HEALTH_CH_CO2,
+    HEALTH_CH_MAX
+} sensor_health_channel_t;
+
+/**
+ * Initialize fault monitor state (all sensors healthy).
+ * Must be called before any other sensor_health function.
+ */
+void sensor_health_init(void);
+
+/**
+ * Clear monitor state for every channel of a sensor.
+ * Called on state transitions that invalidate the signal history
+ * (ERROR, DISABLED, re-warm-up). Resetting SHT45 or BMP280 also clears
+ * their shared temperature disagreement, i.e. DISAGREE on both sensors.
+ */
+void sensor_health_reset(sensor_id_t id);
+
+/**
+ * Feed one raw sample to a channel monitor. O(1) time and memory.
+ * Not thread-safe: call only from the sensor coordinator task.
+ *
+ * @param ch      Channel
+ * @param value   Raw sample (non-finite values are ignored)
+ * @param now_us  esp_timer_get_time() at sample time
+ */
+void sensor_health_observe(sensor_health_channel_t ch, float value, int64_t now_us);
+
+/**
+ * Current fault flags for a sensor (SENSOR_FAULT_* bitmask).
+ */
+uint8_t sensor_health_get_flags(sensor_id_t id);
+
+/**
+ * Current health score for a sensor (0-100, 100 = no active faults).
+ */
+uint8_t sensor_health_get_score(sensor_id_t id);
+
+/**
+ * Convert a single SENSOR_FAULT_* flag to a short lowercase name
+ * ("flatline", "stuck", "step", "disagree"). Returns NULL for unknown bits.
+ */
+const char* sensor_health_fault_to_string(uint8_t flag);
+
+#endif /* SENSOR_HEALTH_H */
@@ -26,10 +26,13 @@
 /* Fusion and metrics */
 #include "sensor_fusion.h"
 #include "metrics_calc.h"
+#include "sensor_health.h"
 #include "iaq_history.h"
 #include "esp_task_wdt.h"
 #include "iaq_profiler.h"
+#include "blackbox.h"
 #include "pm_guard.h"
+#include "periodic_sched.h"
 #include <stdatomic.h>
 
 /* ===== Configuration Constants ===== */
@@ -72,6 +75,8 @@ typedef struct {
     int64_t warmup_deadline_us;
     int64_t last_read_us;
     uint32_t error_count;
+    uint8_t fault_flags;
+    uint8_t health_score;
 } sensor_runtime_t;
 
 /**
@@ -93,6 +98,8 @@ typedef struct {
     esp_err_t (*disable)(void);
     esp_err_t (*reset)(void);        /* NULL if not supported (e.g., MCU) */
     esp_err_t (*read)(void);         /* Read wrapper that stores to iaq_data */
+    esp_err_t (*read_async)(void);   /* Non-blocking scheduled read (NULL: use read) */
+    uint32_t (*retry_count)(void);   /* Cumulative driver-level retries (NULL if none) */
     const char *name;                /* "MCU" for logs (uppercase) */
     const char *id_name;             /* "mcu" for API (lowercase) */
     const char *nvs_cadence_key;     /* NVS key for cadence storage */
@@ -105,6 +112,8 @@ static esp_err_t read_sensor_bmp280(void);
 static esp_err_t read_sensor_sgp41(void);
 static esp_err_t read_sensor_pms5003(void);
 static esp_err_t read_sensor_s8(void);
+static esp_err_t read_sensor_s8_async(void);
+static void update_sensor_health(sensor_id_t id);
 
 /* Sensor operations table indexed by sensor_id_t */
 static const sensor_ops_t s_sensor_ops[SENSOR_ID_MAX] = {
@@ -140,6 +149,7 @@ static const sensor_ops_t s_sensor_ops[SENSOR_ID_MAX] = {
         .disable = sgp41_driver_disable,
         .reset   = sgp41_driver_reset,
         .read    = read_sensor_sgp41,
+        .retry_count = sgp41_driver_get_retry_count,
         .name    = "SGP41",
         .id_name = "sgp41",
         .nvs_cadence_key = "cad_sgp41",
@@ -158,6 +168,7 @@ static const sensor_ops_t s_sensor_ops[SENSOR_ID_MAX] = {
         .disable = s8_driver_disable,
         .reset   = s8_driver_reset,
         .read    = read_sensor_s8,
+        .read_async = read_sensor_s8_async,
         .name    = "S8",
         .id_name = "s8",
         .nvs_cadence_key = "cad_s8",
@@ -183,11 +194,60 @@ static const uint32_t s_warmup_ms[SENSOR_ID_MAX] = {
     [SENSOR_ID_S8]      = CONFIG_IAQ_WARMUP_S8_MS,
 };
 
+/* Mark (or clear) the fused values of a sensor as suspect. Caller must hold the iaq_data lock.
+ * Suspect values stay valid and published; history tags them so charts can flag the span. */
+static void set_sensor_suspect_locked(iaq_data_t *data, sensor_id_t id, bool suspect)
+{
+    switch (id) {
+        case SENSOR_ID_SHT45:
+            data->suspect.temp_c = suspect;
+            data->suspect.rh_pct = suspect;
+            break;
+        case SENSOR_ID_BMP280:
+            data->suspect.pressure_pa = suspect;
+            break;
+        case SENSOR_ID_SGP41:
+            data->suspect.voc_index = suspect;
+            data->suspect.nox_index = suspect;
+            break;
+        case SENSOR_ID_PMS5003:
+            data->suspect.pm1_ugm3 = suspect;
+            data->suspect.pm25_ugm3 = suspect;
+            data->suspect.pm10_ugm3 = suspect;
+            break;
+        case SENSOR_ID_S8:
+            data->suspect.co2_ppm = suspect;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Forget fault-monitor state. fault_flags, health_score and the suspect mirror in
+ * iaq_data are only ever cleared together (suspect by the caller, under the data lock). */
+static void clear_sensor_faults_runtime(sensor_id_t id)
+{
+    sensor_health_reset(id);
+    portENTER_CRITICAL(&s_runtime_spinlock);
+    s_runtime[id].fault_flags = 0;
+    s_runtime[id].health_score = SENSOR_HEALTH_SCORE_MAX;
+    portEXIT_CRITICAL(&s_runtime_spinlock);
+
+    /* The SHT45/BMP280 disagreement state is shared: resetting either side
+     * drops DISAGREE, so republish the partner as well */
+    if (id == SENSOR_ID_SHT45) {
+        update_sensor_health(SENSOR_ID_BMP280);
+    } else if (id == SENSOR_ID_BMP280) {
+        update_sensor_health(SENSOR_ID_SHT45);
+    }
+}
+
 /* Invalidate data for a specific sensor: clear valid flags and set values to sentinels.
  * This ensures downstream publishers/UI do not display stale or default zeros
  * during ERROR/DISABLED/recovery windows. */
 static void invalidate_sensor_data(sensor_id_t id)
 {
+    clear_sensor_faults_runtime(id);
     IAQ_DATA_WITH_LOCK() {
         iaq_data_t *data = iaq_data_get();
         switch (id) {
@@ -226,17 +286,19 @@ static void invalidate_sensor_data(sensor_id_t id)
             default:
                 break;
         }
+        set_sensor_suspect_locked(data, id, false);
     }
 }
 
 /* Forward declarations */
 static const char* sensor_id_to_string(sensor_id_t id);
 
-typedef enum { CMD_READ = 0, CMD_RESET, CMD_CALIBRATE, CMD_DISABLE, CMD_ENABLE } sensor_cmd_type_t;
+typedef enum { CMD_READ = 0, CMD_RESET, CMD_CALIBRATE, CMD_DISABLE, CMD_ENABLE, CMD_READ_DONE } sensor_cmd_type_t;
 typedef struct {
     sensor_cmd_type_t type;
     sensor_id_t id;
-    int value;
+    int value;                /* CMD_READ_DONE: esp_err_t of the read */
+    float sample;             /* CMD_READ_DONE: value read */
     QueueHandle_t resp_queue; /* optional: where to send esp_err_t result */
 } sensor_cmd_t;
 
@@ -255,8 +317,17 @@ static bool s_cadence_from_nvs[SENSOR_ID_MAX] = {0};
 #define NVS_NAMESPACE "sensor_cfg"
 
 /* Periodic timers for fusion and metrics processing */
-static esp_timer_handle_t s_fusion_timer = NULL;
-static esp_timer_handle_t s_metrics_timer = NULL;
+static periodic_work_handle_t s_fusion_timer = NULL;
+static periodic_work_handle_t s_metrics_timer = NULL;
+
+/* Processing pipeline task: the timers above only post work bits to it */
+#define PROC_WORK_FUSION    BIT0
+#define PROC_WORK_METRICS   BIT1
+#define PROC_WORK_STOP      BIT2
+
+static TaskHandle_t s_proc_task_handle = NULL;
+static int64_t s_proc_posted_us = 0;    /* Oldest unserviced post, 0 = none */
+static portMUX_TYPE s_proc_lock = portMUX_INITIALIZER_UNLOCKED;
 
 static uint32_t load_cadence_ms(const char *key, uint32_t def_ms, bool *from_nvs)
 {
@@ -337,6 +408,7 @@ static void transition_to_state(sensor_id_t id, sensor_state_t new_state)
                  sensor_coordinator_state_to_string(old_state),
                  sensor_coordinator_state_to_string(new_state));
         s_runtime[id].state = new_state;
+        blackbox_record_event(BLACKBOX_EVENT_SENSOR_STATE, (uint8_t)id, (uint8_t)old_state, (uint8_t)new_state, 0);
 
         /* On transition to WARMING, set warm-up deadline */
         if (new_state == SENSOR_STATE_WARMING) {
@@ -348,6 +420,14 @@ static void transition_to_state(sensor_id_t id, sensor_state_t new_state)
             s_runtime[id].error_count = 0;
         }
 
+        /* Signal history is meaningless across ERROR/DISABLED/re-warm-up */
+        if (old_state == SENSOR_STATE_READY) {
+            clear_sensor_faults_runtime(id);
+            IAQ_DATA_WITH_LOCK() {
+                set_sensor_suspect_locked(iaq_data_get(), id, false);
+            }
+        }
+
         /* Invalidate data in states where values are not trustworthy */
         if (new_state == SENSOR_STATE_ERROR || new_state == SENSOR_STATE_DISABLED) {
             invalidate_sensor_data(id);
@@ -390,6 +470,104 @@ static esp_err_t reset_sensor(sensor_id_t id)
 }
 
 
+/**
+ * Publish fault monitor results for a sensor after a successful read.
+ * Logs on flag changes only; the suspect state in iaq_data is re-derived from
+ * the current flags on every call so the two cannot drift apart.
+ */
+static void update_sensor_health(sensor_id_t id)
+{
+    uint8_t flags = sensor_health_get_flags(id);
+    uint8_t score = sensor_health_get_score(id);
+    uint8_t prev = s_runtime[id].fault_flags;
+
+    portENTER_CRITICAL(&s_runtime_spinlock);
+    s_runtime[id].fault_flags = flags;
+    s_runtime[id].health_score = score;
+    portEXIT_CRITICAL(&s_runtime_spinlock);
+
+    IAQ_DATA_WITH_LOCK() {
+        set_sensor_suspect_locked(iaq_data_get(), id, flags != 0);
+    }
+
+    if (flags == prev) return;
+    if (flags & ~prev) {
+        ESP_LOGW(TAG, "%s fault monitors: flags=0x%02x score=%u",
+                 sensor_id_to_string(id), flags, score);
+    } else {
+        ESP_LOGI(TAG, "%s fault monitors: flags=0x%02x score=%u",
+                 sensor_id_to_string(id), flags, score);
+    }
+}
+
+/* ===== Per-sensor read statistics =====
+ * Written on the coordinator task, copied out under s_runtime_spinlock. */
+static sensor_stats_t s_stats[SENSOR_ID_MAX];
+static uint32_t s_retry_seen[SENSOR_ID_MAX];
+static const uint32_t s_latency_bounds_ms[SENSOR_LATENCY_BUCKETS - 1] = SENSOR_LATENCY_BOUNDS_MS;
+
+#define STATS_EWMA_SHIFT 3  /* Each new sample weighs 1/8 */
+
+static inline uint32_t stats_ewma(uint32_t avg, uint32_t sample, bool first)
+{
+    if (first) return sample;
+    return (uint32_t)((int64_t)avg + (((int64_t)sample - (int64_t)avg) >> STATS_EWMA_SHIFT));
+}
+
+/* Account one driver read that started at t0_us. Call before the result is
+ * stored, while last_read_us still holds the previous good read. */
+static void record_read_stats(sensor_id_t id, esp_err_t ret, int64_t t0_us)
+{
+    if (ret == ESP_ERR_NOT_SUPPORTED) return;  /* Skipped, e.g. SGP41 conditioning */
+
+    int64_t now_us = esp_timer_get_time();
+    uint32_t dur_us = (uint32_t)(now_us - t0_us);
+    int bucket = 0;
+    while (bucket < SENSOR_LATENCY_BUCKETS - 1 && dur_us / 1000U >= s_latency_bounds_ms[bucket]) {
+        bucket++;
+    }
+    uint32_t retries = 0;
+    if (s_sensor_ops[id].retry_count) {
+        uint32_t total = s_sensor_ops[id].retry_count();
+        retries = total - s_retry_seen[id];
+        s_retry_seen[id] = total;
+    }
+    int64_t prev_ok_us = s_runtime[id].last_read_us;
+
+    portENTER_CRITICAL(&s_runtime_spinlock);
+    sensor_stats_t *st = &s_stats[id];
+    st->reads++;
+    if (ret == ESP_OK) {
+        if (prev_ok_us > 0) {
+            uint32_t interval_ms = (uint32_t)((now_us - prev_ok_us) / 1000);
+            st->interval_avg_ms = stats_ewma(st->interval_avg_ms, interval_ms, st->interval_avg_ms == 0);
+        }
+        st->ok++;
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        st->err_timeout++;
+    } else if (ret == ESP_ERR_INVALID_CRC || ret == ESP_ERR_INVALID_RESPONSE) {
+        st->err_crc++;
+    } else {
+        st->err_other++;
+    }
+    st->retries += retries;
+    st->latency_hist[bucket]++;
+    st->latency_last_us = dur_us;
+    if (dur_us > st->latency_max_us) st->latency_max_us = dur_us;
+    portEXIT_CRITICAL(&s_runtime_spinlock);
+}
+
+/* How late a scheduled read started relative to its due tick */
+static void record_schedule_jitter(sensor_id_t id, TickType_t late_ticks)
+{
+    uint32_t late_ms = (uint32_t)(late_ticks * portTICK_PERIOD_MS);
+    portENTER_CRITICAL(&s_runtime_spinlock);
+    sensor_stats_t *st = &s_stats[id];
+    st->jitter_avg_ms = stats_ewma(st->jitter_avg_ms, late_ms, st->reads == 0);
+    if (late_ms > st->jitter_max_ms) st->jitter_max_ms = late_ms;
+    portEXIT_CRITICAL(&s_runtime_spinlock);
+}
+
 /* ===== Per-Sensor Read Handlers ===== */
 
 static esp_err_t read_sensor_mcu(void)
@@ -399,9 +577,10 @@ static esp_err_t read_sensor_mcu(void)
     }
 
     float temp_c = 0.0f;
-    uint64_t t0 = iaq_prof_tic();
+    int64_t t0 = esp_timer_get_time();
     esp_err_t ret = mcu_temp_driver_read_celsius(&temp_c);
-    iaq_prof_toc(IAQ_METRIC_SENSOR_MCU_READ, t0);
+    iaq_prof_toc(IAQ_METRIC_SENSOR_MCU_READ, (uint64_t)t0);
+    record_read_stats(SENSOR_ID_MCU, ret, t0);
 
     if (ret == ESP_OK) {
         IAQ_DATA_WITH_LOCK() {
@@ -412,6 +591,8 @@ static esp_err_t read_sensor_mcu(void)
         }
         s_runtime[SENSOR_ID_MCU].last_read_us = esp_timer_get_time();
         s_runtime[SENSOR_ID_MCU].error_count = 0;
+        sensor_health_observe(HEALTH_CH_MCU_TEMP, temp_c, s_runtime[SENSOR_ID_MCU].last_read_us);
+        update_sensor_health(SENSOR_ID_MCU);
         ESP_LOGD(TAG, "MCU temp: %.1f C", temp_c);
     } else {
         s_runtime[SENSOR_ID_MCU].error_count++;
@@ -431,9 +612,10 @@ static esp_err_t read_sensor_sht45(void)
     }
 
     float temp_c = 0.0f, humidity_rh = 0.0f;
-    uint64_t t0 = iaq_prof_tic();
+    int64_t t0 = esp_timer_get_time();
     esp_err_t ret = sht45_driver_read(&temp_c, &humidity_rh);
-    iaq_prof_toc(IAQ_METRIC_SENSOR_SHT45_READ, t0);
+    iaq_prof_toc(IAQ_METRIC_SENSOR_SHT45_READ, (uint64_t)t0);
+    record_read_stats(SENSOR_ID_SHT45, ret, t0);
 
     if (ret == ESP_OK) {
         IAQ_DATA_WITH_LOCK() {
@@ -446,6 +628,10 @@ static esp_err_t read_sensor_sht45(void)
         }
         s_runtime[SENSOR_ID_SHT45].last_read_us = esp_timer_get_time();
         s_runtime[SENSOR_ID_SHT45].error_count = 0;
+        sensor_health_observe(HEALTH_CH_SHT45_TEMP, temp_c, s_runtime[SENSOR_ID_SHT45].last_read_us);
+        sensor_health_observe(HEALTH_CH_SHT45_RH, humidity_rh, s_runtime[SENSOR_ID_SHT45].last_read_us);
+        update_sensor_health(SENSOR_ID_SHT45);
+        update_sensor_health(SENSOR_ID_BMP280);  /* shares the disagreement flag */
         ESP_LOGD(TAG, "SHT45: %.1f C, %.1f %%RH", temp_c, humidity_rh);
     } else if (ret != ESP_ERR_NOT_SUPPORTED) {
         s_runtime[SENSOR_ID_SHT45].error_count++;
@@ -465,9 +651,10 @@ static esp_err_t read_sensor_bmp280(void)
     }
 
     float pressure_hpa = 0.0f, temp_c = 0.0f;
-    uint64_t t0 = iaq_prof_tic();
+    int64_t t0 = esp_timer_get_time();
     esp_err_t ret = bmp280_driver_read(&pressure_hpa, &temp_c);
-    iaq_prof_toc(IAQ_METRIC_SENSOR_BMP280_READ, t0);
+    iaq_prof_toc(IAQ_METRIC_SENSOR_BMP280_READ, (uint64_t)t0);
+    record_read_stats(SENSOR_ID_BMP280, ret, t0);
 
     if (ret == ESP_OK) {
         IAQ_DATA_WITH_LOCK() {
@@ -478,6 +665,10 @@ static esp_err_t read_sensor_bmp280(void)
         }
         s_runtime[SENSOR_ID_BMP280].last_read_us = esp_timer_get_time();
         s_runtime[SENSOR_ID_BMP280].error_count = 0;
+        sensor_health_observe(HEALTH_CH_BMP280_PRESSURE, pressure_hpa, s_runtime[SENSOR_ID_BMP280].last_read_us);
+        sensor_health_observe(HEALTH_CH_BMP280_TEMP, temp_c, s_runtime[SENSOR_ID_BMP280].last_read_us);
+        update_sensor_health(SENSOR_ID_BMP280);
+        update_sensor_health(SENSOR_ID_SHT45);   /* shares the disagreement flag */
         ESP_LOGD(TAG, "BMP280: %.1f hPa, %.1f C", pressure_hpa, temp_c);
     } else if (ret != ESP_ERR_NOT_SUPPORTED) {
         s_runtime[SENSOR_ID_BMP280].error_count++;
@@ -505,9 +696,10 @@ static esp_err_t read_sensor_sgp41(void)
     }
 
     uint16_t voc_index = 0, nox_index = 0;
-    uint64_t t0 = iaq_prof_tic();
+    int64_t t0 = esp_timer_get_time();
     esp_err_t ret = sgp41_driver_read(&voc_index, &nox_index, temp_c, humidity_rh);
-    iaq_prof_toc(IAQ_METRIC_SENSOR_SGP41_READ, t0);
+    iaq_prof_toc(IAQ_METRIC_SENSOR_SGP41_READ, (uint64_t)t0);
+    record_read_stats(SENSOR_ID_SGP41, ret, t0);
 
     if (ret == ESP_OK) {
         IAQ_DATA_WITH_LOCK() {
@@ -520,6 +712,9 @@ static esp_err_t read_sensor_sgp41(void)
         }
         s_runtime[SENSOR_ID_SGP41].last_read_us = esp_timer_get_time();
         s_runtime[SENSOR_ID_SGP41].error_count = 0;
+        sensor_health_observe(HEALTH_CH_SGP41_VOC, (float)voc_index, s_runtime[SENSOR_ID_SGP41].last_read_us);
+        sensor_health_observe(HEALTH_CH_SGP41_NOX, (float)nox_index, s_runtime[SENSOR_ID_SGP41].last_read_us);
+        update_sensor_health(SENSOR_ID_SGP41);
         ESP_LOGD(TAG, "SGP41: VOC=%u, NOx=%u", voc_index, nox_index);
     } else if (ret != ESP_ERR_NOT_SUPPORTED) {
         s_runtime[SENSOR_ID_SGP41].error_count++;
@@ -539,9 +734,10 @@ static esp_err_t read_sensor_pms5003(void)
     }
 
     float pm1_0 = 0.0f, pm2_5 = 0.0f, pm10 = 0.0f;
-    uint64_t t0 = iaq_prof_tic();
+    int64_t t0 = esp_timer_get_time();
     esp_err_t ret = pms5003_driver_read(&pm1_0, &pm2_5, &pm10);
-    iaq_prof_toc(IAQ_METRIC_SENSOR_PMS5003_READ, t0);
+    iaq_prof_toc(IAQ_METRIC_SENSOR_PMS5003_READ, (uint64_t)t0);
+    record_read_stats(SENSOR_ID_PMS5003, ret, t0);
 
     if (ret == ESP_OK) {
         IAQ_DATA_WITH_LOCK() {
@@ -556,6 +752,10 @@ static esp_err_t read_sensor_pms5003(void)
         }
         s_runtime[SENSOR_ID_PMS5003].last_read_us = esp_timer_get_time();
         s_runtime[SENSOR_ID_PMS5003].error_count = 0;
+        sensor_health_observe(HEALTH_CH_PM1, pm1_0, s_runtime[SENSOR_ID_PMS5003].last_read_us);
+        sensor_health_observe(HEALTH_CH_PM25, pm2_5, s_runtime[SENSOR_ID_PMS5003].last_read_us);
+        sensor_health_observe(HEALTH_CH_PM10, pm10, s_runtime[SENSOR_ID_PMS5003].last_read_us);
+        update_sensor_health(SENSOR_ID_PMS5003);
         ESP_LOGD(TAG, "PMS5003: PM1.0=%.0f, PM2.5=%.0f, PM10=%.0f ug/m3", pm1_0, pm2_5, pm10);
     } else if (ret != ESP_ERR_NOT_SUPPORTED) {
         s_runtime[SENSOR_ID_PMS5003].error_count++;
@@ -568,17 +768,13 @@ static esp_err_t read_sensor_pms5003(void)
     return ret;
 }
 
-static esp_err_t read_sensor_s8(void)
+/* Store an S8 result; runs on the coordinator task for both read paths */
+static esp_err_t store_s8_result(esp_err_t ret, float co2_ppm)
 {
     if (s_runtime[SENSOR_ID_S8].state != SENSOR_STATE_READY) {
-        return ESP_ERR_INVALID_STATE;
+        return ESP_ERR_INVALID_STATE;  /* Disabled or reset while the read was in flight */
     }
 
-    float co2_ppm = 0.0f;
-    uint64_t t0 = iaq_prof_tic();
-    esp_err_t ret = s8_driver_read_co2(&co2_ppm);
-    iaq_prof_toc(IAQ_METRIC_SENSOR_S8_READ, t0);
-
     if (ret == ESP_OK) {
         IAQ_DATA_WITH_LOCK() {
             iaq_data_t *data = iaq_data_get();
@@ -588,6 +784,8 @@ static esp_err_t read_sensor_s8(void)
         }
         s_runtime[SENSOR_ID_S8].last_read_us = esp_timer_get_time();
         s_runtime[SENSOR_ID_S8].error_count = 0;
+        sensor_health_observe(HEALTH_CH_CO2, co2_ppm, s_runtime[SENSOR_ID_S8].last_read_us);
+        update_sensor_health(SENSOR_ID_S8);
         ESP_LOGD(TAG, "S8 CO2: %.0f ppm", co2_ppm);
     } else if (ret != ESP_ERR_NOT_SUPPORTED) {
         s_runtime[SENSOR_ID_S8].error_count++;
@@ -600,34 +798,111 @@ static esp_err_t read_sensor_s8(void)
     return ret;
 }
 
+static esp_err_t read_sensor_s8(void)
+{
+    if (s_runtime[SENSOR_ID_S8].state != SENSOR_STATE_READY) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    float co2_ppm = 0.0f;
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t ret = s8_driver_read_co2(&co2_ppm);
+    iaq_prof_toc(IAQ_METRIC_SENSOR_S8_READ, (uint64_t)t0);
+    record_read_stats(SENSOR_ID_S8, ret, t0);
+
+    return store_s8_result(ret, co2_ppm);
+}
+
+/* Scheduled S8 reads complete on the S8 Modbus task and are handed back
+ * through the command queue, so the coordinator never waits on the UART. */
+static volatile bool s_s8_read_pending = false;
+static int64_t s_s8_read_t0 = 0;
+
+static void s8_read_done(esp_err_t err, float co2_ppm, void *ctx)
+{
+    (void)ctx;
+    sensor_cmd_t done = { .type = CMD_READ_DONE, .id = SENSOR_ID_S8, .value = err, .sample = co2_ppm };
+    if (!s_cmd_queue || xQueueSend(s_cmd_queue, &done, 0) != pdTRUE) {
+        s_s8_read_pending = false;  /* Dropped; the next scheduled read retries */
+    }
+}
+
+static esp_err_t read_sensor_s8_async(void)
+{
+    if (s_runtime[SENSOR_ID_S8].state != SENSOR_STATE_READY) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_s8_read_pending) {
+        return ESP_ERR_NOT_FINISHED;  /* Previous read still on the bus */
+    }
+
+    s_s8_read_pending = true;
+    s_s8_read_t0 = esp_timer_get_time();
+    esp_err_t ret = s8_driver_read_co2_async(s8_read_done, NULL);
+    if (ret != ESP_OK) {
+        s_s8_read_pending = false;
+        if (ret != ESP_ERR_NOT_FINISHED) {
+            record_read_stats(SENSOR_ID_S8, ret, s_s8_read_t0);
+            (void)store_s8_result(ret, NAN);
+        }
+    }
+    return ret;
+}
+
+/* Hand work to the processing task. Runs on the esp_timer task, so it must stay O(1). */
+static void proc_post(uint32_t work)
+{
+    TaskHandle_t task = s_proc_task_handle;
+    if (!task) return;
+    portENTER_CRITICAL(&s_proc_lock);
+    if (s_proc_posted_us == 0) s_proc_posted_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&s_proc_lock);
+    xTaskNotify(task, work, eSetBits);
+}
+
+/* Fusion tick (1 Hz) */
+static void fusion_timer_callback(void *arg)
+{
+    proc_post(PROC_WORK_FUSION);
+}
+
+/* Metrics tick (0.2 Hz / every 5 seconds) */
+static void metrics_timer_callback(void *arg)
+{
+    proc_post(PROC_WORK_METRICS);
+}
+
 /**
- * Fusion timer callback (runs at 1 Hz).
- * Applies cross-sensor compensations to raw sensor data.
+ * Fusion stage: apply cross-sensor compensations to raw sensor data, then
+ * append a snapshot to history outside the data lock.
  */
-static void fusion_timer_callback(void *arg)
+static void proc_run_fusion(void)
 {
+    static iaq_data_t s_snapshot;   /* Processing task only; keeps the copy off its stack */
     iaq_prof_ctx_t p = iaq_prof_start(IAQ_METRIC_FUSION_TICK);
-    iaq_data_t snapshot = (iaq_data_t){0};
     bool have_snapshot = false;
     if (iaq_data_lock(0)) {
+        iaq_prof_ctx_t apply = iaq_prof_start(IAQ_METRIC_FUSION_APPLY);
         iaq_data_t *data = iaq_data_get();
         fusion_apply(data);
-        snapshot = *data;
+        s_snapshot = *data;
         have_snapshot = true;
         iaq_data_unlock();
+        iaq_prof_end(apply);
     }
     if (have_snapshot) {
-        iaq_history_append(&snapshot);
+        iaq_prof_ctx_t append = iaq_prof_start(IAQ_METRIC_HISTORY_APPEND);
+        iaq_history_append(&s_snapshot);
+        iaq_prof_end(append);
     }
     iaq_prof_end(p);
 }
 
 /**
- * Metrics timer callback (runs at 0.2 Hz / every 5 seconds).
- * Calculates all derived metrics (AQI, comfort, trends).
- * Metrics are calculated and stored in iaq_data; MQTT publishing uses timer-based intervals.
+ * Metrics stage: calculate all derived metrics (AQI, comfort, trends) into
+ * iaq_data; MQTT publishing uses its own timer-based intervals.
  */
-static void metrics_timer_callback(void *arg)
+static void proc_run_metrics(void)
 {
     iaq_prof_ctx_t p = iaq_prof_start(IAQ_METRIC_METRICS_TICK);
     if (iaq_data_lock(0)) {
@@ -638,6 +913,32 @@ static void metrics_timer_callback(void *arg)
     iaq_prof_end(p);
 }
 
+/**
+ * Processing pipeline task.
+ * Runs fusion, history append and metrics in order for each posted tick.
+ * Ticks that arrive while a stage is running coalesce into one pass.
+ */
+static void processing_task(void *arg)
+{
+    for (;;) {
+        uint32_t work = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &work, portMAX_DELAY);
+        if (work & PROC_WORK_STOP) break;
+
+        portENTER_CRITICAL(&s_proc_lock);
+        int64_t posted_us = s_proc_posted_us;
+        s_proc_posted_us = 0;
+        portEXIT_CRITICAL(&s_proc_lock);
+        if (posted_us) iaq_prof_toc(IAQ_METRIC_PROC_LATENCY, (uint64_t)posted_us);
+
+        if (work & PROC_WORK_FUSION) proc_run_fusion();
+        if (work & PROC_WORK_METRICS) proc_run_metrics();
+    }
+
+    s_proc_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
 /**
  * Sensor coordinator task.
  * Manages sensor state machine, warm-up periods, and periodic reads.
@@ -813,6 +1114,15 @@ static void sensor_coordinator_task(void *arg)
                         invalidate_sensor_data(cmd.id);
                     }
                     break;
+                case CMD_READ_DONE:
+                    /* Completion of an asynchronous scheduled read */
+                    if (cmd.id == SENSOR_ID_S8) {
+                        s_s8_read_pending = false;
+                        iaq_prof_toc(IAQ_METRIC_SENSOR_S8_READ, (uint64_t)s_s8_read_t0);
+                        record_read_stats(SENSOR_ID_S8, (esp_err_t)cmd.value, s_s8_read_t0);
+                        op_res = store_s8_result((esp_err_t)cmd.value, cmd.sample);
+                    }
+                    break;
                 case CMD_CALIBRATE:
                     /* Calibration is sensor-specific (only S8 supports it currently) */
                     if (cmd.id == SENSOR_ID_S8) {
@@ -866,8 +1176,12 @@ static void sensor_coordinator_task(void *arg)
                 s_schedule[i].enabled &&
                 (int32_t)(now - s_schedule[i].next_due) >= 0) {
 
+                record_schedule_jitter((sensor_id_t)i, now - s_schedule[i].next_due);
+
                 /* Dispatch to read handler via ops table */
-                if (s_sensor_ops[i].read) {
+                if (s_sensor_ops[i].read_async) {
+                    (void)s_sensor_ops[i].read_async();
+                } else if (s_sensor_ops[i].read) {
                     (void)s_sensor_ops[i].read();
                 }
 
@@ -903,6 +1217,7 @@ esp_err_t sensor_coordinator_init(iaq_system_context_t *ctx)
     for (int i = 0; i < SENSOR_ID_MAX; ++i) {
         memset(&s_runtime[i], 0, sizeof(sensor_runtime_t));
         s_runtime[i].state = SENSOR_STATE_UNINIT;
+        s_runtime[i].health_score = SENSOR_HEALTH_SCORE_MAX;
 
         /* Initialize auto-recovery tracking */
         s_recovery[i].last_retry_us = 0;
@@ -910,6 +1225,9 @@ esp_err_t sensor_coordinator_init(iaq_system_context_t *ctx)
         s_recovery[i].next_retry_delay_ms = RECOVERY_INITIAL_DELAY_MS;
     }
 
+    /* Fault monitors start clean; fed from the read handlers below */
+    sensor_health_init();
+
     /* Create command queue */
     s_cmd_queue = xQueueCreate(CMD_QUEUE_DEPTH, sizeof(sensor_cmd_t));
     if (s_cmd_queue == NULL) {
@@ -1034,25 +1352,29 @@ esp_err_t sensor_coordinator_init(iaq_system_context_t *ctx)
     }
 
     /* Create periodic timer for fusion (1 Hz) */
-    const esp_timer_create_args_t fusion_timer_args = {
+    const periodic_work_args_t fusion_timer_args = {
         .callback = fusion_timer_callback,
-        .name = "fusion"
+        .name = "fusion",
+        .subsystem = "sensor",
+        .slack_ms = SLACK_MS_FUSION,
     };
-    ret = esp_timer_create(&fusion_timer_args, &s_fusion_timer);
+    ret = periodic_sched_create(&fusion_timer_args, &s_fusion_timer);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create fusion timer: %s", esp_err_to_name(ret));
         return ret;
     }
 
     /* Create periodic timer for metrics (0.2 Hz / 5 seconds) */
-    const esp_timer_create_args_t metrics_timer_args = {
+    const periodic_work_args_t metrics_timer_args = {
         .callback = metrics_timer_callback,
-        .name = "metrics"
+        .name = "metrics",
+        .subsystem = "sensor",
+        .slack_ms = SLACK_MS_METRICS,
     };
-    ret = esp_timer_create(&metrics_timer_args, &s_metrics_timer);
+    ret = periodic_sched_create(&metrics_timer_args, &s_metrics_timer);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create metrics timer: %s", esp_err_to_name(ret));
-        esp_timer_delete(s_fusion_timer);
+        periodic_sched_delete(s_fusion_timer);
         s_fusion_timer = NULL;
         return ret;
     }
@@ -1099,9 +1421,19 @@ esp_err_t sensor_coordinator_start(void)
     /* Register task for stack HWM reporting */
     iaq_profiler_register_task("sensor_coord", s_sensor_task_handle, TASK_STACK_SENSOR_COORDINATOR);
 
+    /* Processing pipeline; without it the timers below have nothing to post to */
+    if (xTaskCreatePinnedToCore(processing_task, "iaq_proc", TASK_STACK_PROCESSING, NULL,
+                                TASK_PRIORITY_PROCESSING, &s_proc_task_handle,
+                                TASK_CORE_PROCESSING) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create processing task; fusion and metrics disabled");
+        s_proc_task_handle = NULL;
+    } else {
+        iaq_profiler_register_task("iaq_proc", s_proc_task_handle, TASK_STACK_PROCESSING);
+    }
+
     /* Start fusion timer */
     if (s_fusion_timer) {
-        esp_err_t timer_ret = esp_timer_start_periodic(s_fusion_timer, FUSION_TIMER_PERIOD_US);
+        esp_err_t timer_ret = periodic_sched_start(s_fusion_timer, FUSION_TIMER_PERIOD_US, FUSION_TIMER_PERIOD_US);
         if (timer_ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to start fusion timer: %s", esp_err_to_name(timer_ret));
         } else {
@@ -1111,7 +1443,7 @@ esp_err_t sensor_coordinator_start(void)
 
     /* Start metrics timer */
     if (s_metrics_timer) {
-        esp_err_t timer_ret = esp_timer_start_periodic(s_metrics_timer, METRICS_TIMER_PERIOD_US);
+        esp_err_t timer_ret = periodic_sched_start(s_metrics_timer, METRICS_TIMER_PERIOD_US, METRICS_TIMER_PERIOD_US);
         if (timer_ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to start metrics timer: %s", esp_err_to_name(timer_ret));
         } else {
@@ -1138,12 +1470,16 @@ esp_err_t sensor_coordinator_stop(void)
         (void)xQueueSend(s_cmd_queue, &wake_cmd, 0);
     }
 
-    /* Stop timers */
+    /* Stop timers, then the processing task they post to */
     if (s_fusion_timer) {
-        esp_timer_stop(s_fusion_timer);
+        periodic_sched_stop(s_fusion_timer);
     }
     if (s_metrics_timer) {
-        esp_timer_stop(s_metrics_timer);
+        periodic_sched_stop(s_metrics_timer);
+    }
+    if (s_proc_task_handle) {
+        iaq_profiler_unregister_task(s_proc_task_handle);
+        xTaskNotify(s_proc_task_handle, PROC_WORK_STOP, eSetBits);
     }
 
     /* Wait for task to finish */
@@ -1305,6 +1641,10 @@ esp_err_t sensor_coordinator_get_runtime_info(sensor_id_t id, sensor_runtime_inf
     out_info->warmup_deadline_us = s_runtime[id].warmup_deadline_us;
     out_info->last_read_us = s_runtime[id].last_read_us;
     out_info->error_count = s_runtime[id].error_count;
+    out_info->fault_flags = s_runtime[id].fault_flags;
+    out_info->health_score = s_runtime[id].health_score;
+    out_info->cadence_ms = s_cadence_ms[id];
+    out_info->stats = s_stats[id];
     portEXIT_CRITICAL(&s_runtime_spinlock);
 
     return ESP_OK;
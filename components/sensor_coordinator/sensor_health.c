@@ -0,0 +1,277 @@
+/* components/sensor_coordinator/sensor_health.c */
+#include "sensor_health.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "iaq_config.h"
+
+static const char *TAG = "SENSOR_HEALTH";
+
+#ifdef CONFIG_IAQ_FAULT_DETECTION_ENABLE
+#define FAULT_DETECTION_ENABLED 1
+#define FAULT_WINDOW_SAMPLES    CONFIG_IAQ_FAULT_WINDOW_SAMPLES
+#define FAULT_STUCK_SAMPLES     CONFIG_IAQ_FAULT_STUCK_SAMPLES
+#else
+#define FAULT_DETECTION_ENABLED 0
+#define FAULT_WINDOW_SAMPLES    32
+#define FAULT_STUCK_SAMPLES     60
+#endif
+
+/* Which monitors apply to a channel */
+#define CHECK_FLATLINE  (1u << 0)
+#define CHECK_STUCK     (1u << 1)
+#define CHECK_STEP      (1u << 2)
+
+/* STEP is latched for this many samples so a single glitch stays visible
+ * long enough to be published (MQTT/health poll intervals are much slower). */
+#define STEP_HOLD_SAMPLES       8
+
+/* Quantized channels (reporting step >= noise floor) sit on one value for
+ * hours in a steady room, so STUCK needs the value unchanged for this long
+ * instead of FAULT_STUCK_SAMPLES samples */
+#define QUANTIZED_STUCK_WINDOW_US   (6LL * 3600 * 1000000)
+
+/* SHT45/BMP280 temperature pairing: ignore a partner sample older than this */
+#define TEMP_PAIR_MAX_AGE_US    (30 * 1000000LL)
+#define TEMP_DELTA_EWMA_ALPHA   0.1f
+
+/* Score penalties per active fault */
+#define PENALTY_FLATLINE        30
+#define PENALTY_STUCK           50
+#define PENALTY_STEP            20
+#define PENALTY_DISAGREE        25
+
+/**
+ * Static per-channel thresholds.
+ * noise_floor: stddev (EWMA) below which the signal is considered flat.
+ * max_rate:    plausible |dx/dt| in units per second.
+ * min_level:   flatline/stuck only flagged when |value| exceeds this
+ *              (a clean room legitimately reads PM 0 for hours).
+ * resolution:  reporting step of the driver (0 = finer than the sensor's own
+ *              noise). When it is >= noise_floor the channel is quantized:
+ *              FLATLINE is skipped and STUCK uses QUANTIZED_STUCK_WINDOW_US.
+ */
+typedef struct {
+    sensor_id_t sensor;
+    uint8_t checks;
+    float noise_floor;
+    float max_rate;
+    float min_level;
+    float resolution;
+} health_channel_cfg_t;
+
+static const health_channel_cfg_t s_channel_cfg[HEALTH_CH_MAX] = {
+    /* MCU sensor is coarse and slow: long identical runs are normal */
+    [HEALTH_CH_MCU_TEMP]        = { SENSOR_ID_MCU,     CHECK_STEP,                               0.0f,    2.0f,   0.0f, 0.0f },
+    [HEALTH_CH_SHT45_TEMP]      = { SENSOR_ID_SHT45,   CHECK_FLATLINE | CHECK_STUCK | CHECK_STEP, 0.002f,  1.0f,   0.0f, 0.0f },
+    [HEALTH_CH_SHT45_RH]        = { SENSOR_ID_SHT45,   CHECK_FLATLINE | CHECK_STUCK | CHECK_STEP, 0.005f,  10.0f,  0.0f, 0.0f },
+    [HEALTH_CH_BMP280_PRESSURE] = { SENSOR_ID_BMP280,  CHECK_FLATLINE | CHECK_STUCK | CHECK_STEP, 0.002f,  2.0f,   0.0f, 0.0f },
+    [HEALTH_CH_BMP280_TEMP]     = { SENSOR_ID_BMP280,  CHECK_STUCK | CHECK_STEP,                  0.0f,    1.0f,   0.0f, 0.0f },
+    /* Gas indices sit at their baseline (100 / 1) for hours by design */
+    [HEALTH_CH_SGP41_VOC]       = { SENSOR_ID_SGP41,   CHECK_STEP,                               0.0f,    250.0f, 0.0f, 1.0f },
+    [HEALTH_CH_SGP41_NOX]       = { SENSOR_ID_SGP41,   CHECK_STEP,                               0.0f,    250.0f, 0.0f, 1.0f },
+    /* PMS5003 and S8 report whole ug/m3 / ppm */
+    [HEALTH_CH_PM1]             = { SENSOR_ID_PMS5003, CHECK_FLATLINE | CHECK_STUCK | CHECK_STEP, 0.05f,   200.0f, 2.0f, 1.0f },
+    [HEALTH_CH_PM25]            = { SENSOR_ID_PMS5003, CHECK_FLATLINE | CHECK_STUCK | CHECK_STEP, 0.05f,   200.0f, 2.0f, 1.0f },
+    [HEALTH_CH_PM10]            = { SENSOR_ID_PMS5003, CHECK_FLATLINE | CHECK_STUCK | CHECK_STEP, 0.05f,   200.0f, 2.0f, 1.0f },
+    [HEALTH_CH_CO2]             = { SENSOR_ID_S8,      CHECK_FLATLINE | CHECK_STUCK | CHECK_STEP, 0.2f,    100.0f, 1.0f, 1.0f },
+};
+
+/* Online state per channel (EWMA mean/variance + run counters) */
+typedef struct {
+    float mean;
+    float var;
+    float last_value;
+    int64_t last_us;
+    int64_t same_since_us;
+    uint32_t samples;
+    uint16_t same_count;
+    uint8_t step_hold;
+    uint8_t flags;
+} health_channel_state_t;
+
+static health_channel_state_t s_channels[HEALTH_CH_MAX];
+
+/* Cross-sensor temperature agreement */
+static float s_sht45_temp_c = NAN;
+static int64_t s_sht45_temp_us = 0;
+static float s_temp_delta_ewma = NAN;
+static float s_temp_disagree_c = 4.0f;
+static bool s_temp_disagree = false;
+
+static const float s_ewma_alpha = 1.0f / (float)FAULT_WINDOW_SAMPLES;
+
+static void channel_reset(sensor_health_channel_t ch)
+{
+    memset(&s_channels[ch], 0, sizeof(s_channels[ch]));
+    s_channels[ch].last_value = NAN;
+}
+
+void sensor_health_init(void)
+{
+    for (int ch = 0; ch < HEALTH_CH_MAX; ++ch) {
+        channel_reset((sensor_health_channel_t)ch);
+    }
+    s_sht45_temp_c = NAN;
+    s_sht45_temp_us = 0;
+    s_temp_delta_ewma = NAN;
+    s_temp_disagree = false;
+
+#ifdef CONFIG_IAQ_FAULT_DETECTION_ENABLE
+    float thr = (float)atof(CONFIG_IAQ_FAULT_TEMP_DISAGREE_C);
+    if (isfinite(thr) && thr > 0.0f) {
+        s_temp_disagree_c = thr;
+    }
+    ESP_LOGI(TAG, "Fault monitors enabled (window=%d, stuck=%d, temp disagree=%.1f C)",
+             FAULT_WINDOW_SAMPLES, FAULT_STUCK_SAMPLES, s_temp_disagree_c);
+#else
+    ESP_LOGI(TAG, "Fault monitors disabled");
+#endif
+}
+
+void sensor_health_reset(sensor_id_t id)
+{
+    if (id < 0 || id >= SENSOR_ID_MAX) return;
+    for (int ch = 0; ch < HEALTH_CH_MAX; ++ch) {
+        if (s_channel_cfg[ch].sensor == id) {
+            channel_reset((sensor_health_channel_t)ch);
+        }
+    }
+    if (id == SENSOR_ID_SHT45 || id == SENSOR_ID_BMP280) {
+        if (id == SENSOR_ID_SHT45) {
+            s_sht45_temp_c = NAN;
+            s_sht45_temp_us = 0;
+        }
+        s_temp_delta_ewma = NAN;
+        s_temp_disagree = false;
+    }
+}
+
+static void update_temp_agreement(float bmp280_c, int64_t now_us)
+{
+    if (isnan(s_sht45_temp_c) || (now_us - s_sht45_temp_us) > TEMP_PAIR_MAX_AGE_US) {
+        return;
+    }
+    float delta = s_sht45_temp_c - bmp280_c;
+    if (isnan(s_temp_delta_ewma)) {
+        s_temp_delta_ewma = delta;
+    } else {
+        s_temp_delta_ewma += TEMP_DELTA_EWMA_ALPHA * (delta - s_temp_delta_ewma);
+    }
+    /* Hysteresis: clear at 75% of the threshold to avoid flapping */
+    float mag = fabsf(s_temp_delta_ewma);
+    if (!s_temp_disagree && mag > s_temp_disagree_c) {
+        s_temp_disagree = true;
+        ESP_LOGW(TAG, "SHT45/BMP280 temperature disagreement: %.2f C", s_temp_delta_ewma);
+    } else if (s_temp_disagree && mag < s_temp_disagree_c * 0.75f) {
+        s_temp_disagree = false;
+    }
+}
+
+void sensor_health_observe(sensor_health_channel_t ch, float value, int64_t now_us)
+{
+    if (!FAULT_DETECTION_ENABLED) return;
+    if (ch < 0 || ch >= HEALTH_CH_MAX || !isfinite(value)) return;
+
+    const health_channel_cfg_t *cfg = &s_channel_cfg[ch];
+    health_channel_state_t *st = &s_channels[ch];
+
+    if (st->samples == 0) {
+        st->mean = value;
+        st->var = 0.0f;
+        st->same_count = 1;
+        st->same_since_us = now_us;
+    } else {
+        /* Rate of change against the previous sample */
+        if ((cfg->checks & CHECK_STEP) && now_us > st->last_us) {
+            float dt_s = (float)(now_us - st->last_us) / 1e6f;
+            if (dt_s < 1.0f) dt_s = 1.0f;  /* forced reads can arrive back-to-back */
+            if (fabsf(value - st->last_value) / dt_s > cfg->max_rate) {
+                st->step_hold = STEP_HOLD_SAMPLES;
+            }
+        }
+
+        /* Bit-identical repeats */
+        if (value == st->last_value) {
+            if (st->same_count < UINT16_MAX) st->same_count++;
+        } else {
+            st->same_count = 1;
+            st->same_since_us = now_us;
+        }
+
+        /* Exponentially weighted mean/variance (West 1979 incremental form) */
+        float diff = value - st->mean;
+        float incr = s_ewma_alpha * diff;
+        st->mean += incr;
+        st->var = (1.0f - s_ewma_alpha) * (st->var + diff * incr);
+    }
+    if (st->samples < UINT32_MAX) st->samples++;
+    st->last_value = value;
+    st->last_us = now_us;
+
+    uint8_t flags = 0;
+    bool above_level = fabsf(value) > cfg->min_level;
+    bool quantized = cfg->resolution > 0.0f && cfg->resolution >= cfg->noise_floor;
+    if ((cfg->checks & CHECK_FLATLINE) && above_level && !quantized &&
+        st->samples >= (uint32_t)FAULT_WINDOW_SAMPLES &&
+        sqrtf(st->var) < cfg->noise_floor) {
+        flags |= SENSOR_FAULT_FLATLINE;
+    }
+    if ((cfg->checks & CHECK_STUCK) && above_level) {
+        bool stuck = quantized
+            ? st->same_count >= FAULT_STUCK_SAMPLES &&
+              (now_us - st->same_since_us) >= QUANTIZED_STUCK_WINDOW_US
+            : st->same_count >= FAULT_STUCK_SAMPLES;
+        if (stuck) flags |= SENSOR_FAULT_STUCK;
+    }
+    if (st->step_hold > 0) {
+        flags |= SENSOR_FAULT_STEP;
+        st->step_hold--;
+    }
+    st->flags = flags;
+
+    if (ch == HEALTH_CH_SHT45_TEMP) {
+        s_sht45_temp_c = value;
+        s_sht45_temp_us = now_us;
+    } else if (ch == HEALTH_CH_BMP280_TEMP) {
+        update_temp_agreement(value, now_us);
+    }
+}
+
+uint8_t sensor_health_get_flags(sensor_id_t id)
+{
+    if (id < 0 || id >= SENSOR_ID_MAX) return 0;
+    uint8_t flags = 0;
+    for (int ch = 0; ch < HEALTH_CH_MAX; ++ch) {
+        if (s_channel_cfg[ch].sensor == id) {
+            flags |= s_channels[ch].flags;
+        }
+    }
+    if (s_temp_disagree && (id == SENSOR_ID_SHT45 || id == SENSOR_ID_BMP280)) {
+        flags |= SENSOR_FAULT_DISAGREE;
+    }
+    return flags;
+}
+
+uint8_t sensor_health_get_score(sensor_id_t id)
+{
+    uint8_t flags = sensor_health_get_flags(id);
+    int score = SENSOR_HEALTH_SCORE_MAX;
+    if (flags & SENSOR_FAULT_FLATLINE) score -= PENALTY_FLATLINE;
+    if (flags & SENSOR_FAULT_STUCK)    score -= PENALTY_STUCK;
+    if (flags & SENSOR_FAULT_STEP)     score -= PENALTY_STEP;
+    if (flags & SENSOR_FAULT_DISAGREE) score -= PENALTY_DISAGREE;
+    return (uint8_t)(score < 0 ? 0 : score);
+}
+
+const char* sensor_health_fault_to_string(uint8_t flag)
+{
+    switch (flag) {
+        case SENSOR_FAULT_FLATLINE: return "flatline";
+        case SENSOR_FAULT_STUCK:    return "stuck";
+        case SENSOR_FAULT_STEP:     return "step";
+        case SENSOR_FAULT_DISAGREE: return "disagree";
+        default:                    return NULL;
+    }
+}
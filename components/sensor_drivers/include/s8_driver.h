@@ -4,6 +4,7 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +35,19 @@ esp_err_t s8_driver_init(void);
  */
 esp_err_t s8_driver_read_co2(float *out_co2_ppm);
 
+/** Completion for s8_driver_read_co2_async(); co2_ppm is NAN on error. */
+typedef void (*s8_co2_cb_t)(esp_err_t err, float co2_ppm, void *ctx);
+
+/**
+ * Queue a CO2 read and return immediately. The callback runs on the S8
+ * Modbus task: keep it short and do not call blocking S8 APIs from it.
+ * Only one asynchronous read may be outstanding.
+ *
+ * @return ESP_OK if queued, ESP_ERR_NOT_FINISHED if a read is still pending,
+ *         ESP_ERR_NO_MEM if the transaction queue is full
+ */
+esp_err_t s8_driver_read_co2_async(s8_co2_cb_t cb, void *ctx);
+
 /**
  * Calibrate CO2 sensor to a known reference value.
  *
@@ -51,6 +65,8 @@ esp_err_t s8_driver_reset(void);
 
 /**
  * Deinitialize the S8 driver and release UART resources.
+ * Queued requests complete with ESP_ERR_INVALID_STATE; the request in flight
+ * finishes first. Must not be called from an S8 completion callback.
  *
  * @return ESP_OK on success, error code otherwise
  */
@@ -61,6 +61,9 @@ esp_err_t sgp41_driver_conditioning_tick(float temp_c, float humidity_rh);
  */
 bool sgp41_driver_is_reporting_ready(void);
 
+/** Cumulative one-shot I2C retries taken by sgp41_driver_read() since boot. */
+uint32_t sgp41_driver_get_retry_count(void);
+
 /**
  * Disable the SGP41 sensor (stub - no hardware sleep mode).
  *
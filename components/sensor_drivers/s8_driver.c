@@ -6,7 +6,11 @@
 #include "esp_timer.h"
 #include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "pm_guard.h"
+#include "iaq_config.h"
+#include "iaq_profiler.h"
 #include <math.h>
 #include <string.h>
 
@@ -44,11 +48,15 @@ typedef enum {
     S8_MB_FN_WRITE_SINGLE = 0x06,
 } s8_mb_fn_t;
 
+#define S8_MB_MAX_REGS      6   /* Registers per read request (device limit) */
+#define S8_MB_QUEUE_LEN     8   /* Pending transactions */
+
+/* Low-level request/response helpers below run only on the Modbus task */
 static esp_err_t s8_mb_read_regs(s8_mb_fn_t fn, uint16_t start_addr, uint16_t quantity,
                                  uint8_t *out_payload, size_t out_size, size_t *out_len)
 {
     if (!s_initialized) return ESP_ERR_INVALID_STATE;
-    if (quantity == 0 || quantity > 6) return ESP_ERR_INVALID_ARG; /* device limit */
+    if (quantity == 0 || quantity > S8_MB_MAX_REGS) return ESP_ERR_INVALID_ARG;
 
     pm_guard_lock_no_sleep();
     pm_guard_lock_bus();
@@ -125,6 +133,7 @@ exit:
 
 static esp_err_t s8_mb_write_single(uint16_t reg_addr, uint16_t value)
 {
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
     pm_guard_lock_no_sleep();
     pm_guard_lock_bus();
     esp_err_t err = ESP_OK;
@@ -182,7 +191,255 @@ exit:
     return err;
 }
 
-/* Request/response implemented inline in read_co2() using UART event queue */
+/* ===== Transaction engine =====
+ * One task owns the UART. Callers queue transactions and are completed
+ * through a callback on that task. Queued reads with the same function code
+ * whose combined span fits in one request are sent as one read, gap
+ * registers included and discarded, so e.g. meter status (IR1) and CO2 (IR4)
+ * cost a single IR1..IR4 round-trip. Modbus RTU
+ * allows one outstanding request per bus, so requests are serialized here
+ * instead of in every caller. */
+
+typedef void (*s8_mb_cb_t)(esp_err_t err, const uint8_t *regs, size_t len, void *ctx);
+
+typedef struct {
+    s8_mb_fn_t fn;
+    uint16_t addr;
+    uint16_t arg;               /* Quantity for reads, value for writes */
+    s8_mb_cb_t cb;
+    void *ctx;
+} s8_mb_txn_t;
+
+static s8_mb_txn_t s_mb_ring[S8_MB_QUEUE_LEN];
+static size_t s_mb_head = 0, s_mb_count = 0;
+static portMUX_TYPE s_mb_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_mb_task = NULL;
+static bool s_mb_closing = false;               /* Deinit: refuse new work, task exits when idle */
+static SemaphoreHandle_t s_mb_exited = NULL;    /* Given by the task right before it deletes itself */
+
+/* Queue transactions atomically (all or none) so they can be merged */
+static esp_err_t s8_mb_submit(const s8_mb_txn_t *txns, size_t n)
+{
+    bool queued = false;
+    bool closing;
+    portENTER_CRITICAL(&s_mb_lock);
+    closing = s_mb_closing || !s_mb_task;
+    if (!closing && s_mb_count + n <= S8_MB_QUEUE_LEN) {
+        for (size_t i = 0; i < n; i++) {
+            s_mb_ring[(s_mb_head + s_mb_count + i) % S8_MB_QUEUE_LEN] = txns[i];
+        }
+        s_mb_count += n;
+        queued = true;
+        /* Under the lock so s8_mb_stop() cannot delete the task in between */
+        xTaskNotifyGive(s_mb_task);
+    }
+    portEXIT_CRITICAL(&s_mb_lock);
+    if (closing) return ESP_ERR_INVALID_STATE;
+    return queued ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+/* Pop the next transaction plus any queued reads whose registers fit in the
+ * same request span (at most S8_MB_MAX_REGS from lowest to highest), in order. Returns the number taken (0 if idle). */
+static size_t s8_mb_take_batch(s8_mb_txn_t *batch, size_t max, uint16_t *lo, uint16_t *hi)
+{
+    size_t n = 0;
+    portENTER_CRITICAL(&s_mb_lock);
+    while (s_mb_count > 0 && n < max) {
+        const s8_mb_txn_t *t = &s_mb_ring[s_mb_head];
+        if (n == 0) {
+            *lo = t->addr;
+            *hi = (uint16_t)(t->addr + (t->fn == S8_MB_FN_WRITE_SINGLE ? 1 : t->arg));
+        } else {
+            if (batch[0].fn == S8_MB_FN_WRITE_SINGLE || t->fn != batch[0].fn) break;
+            uint16_t t_hi = (uint16_t)(t->addr + t->arg);
+            uint16_t m_lo = t->addr < *lo ? t->addr : *lo;
+            uint16_t m_hi = t_hi > *hi ? t_hi : *hi;
+            if (m_hi - m_lo > S8_MB_MAX_REGS) break;
+            *lo = m_lo;
+            *hi = m_hi;
+        }
+        batch[n++] = *t;
+        s_mb_head = (s_mb_head + 1) % S8_MB_QUEUE_LEN;
+        s_mb_count--;
+    }
+    portEXIT_CRITICAL(&s_mb_lock);
+    return n;
+}
+
+static void s8_mb_task(void *arg)
+{
+    (void)arg;
+    s8_mb_txn_t batch[S8_MB_QUEUE_LEN];
+    uint8_t regs[S8_MB_MAX_REGS * 2];
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint16_t lo = 0, hi = 0;
+        size_t n;
+        while ((n = s8_mb_take_batch(batch, S8_MB_QUEUE_LEN, &lo, &hi)) > 0) {
+            uint64_t t0 = iaq_prof_tic();
+            esp_err_t err;
+            size_t len = 0;
+            if (batch[0].fn == S8_MB_FN_WRITE_SINGLE) {
+                err = s8_mb_write_single(batch[0].addr, batch[0].arg);
+            } else {
+                err = s8_mb_read_regs(batch[0].fn, lo, (uint16_t)(hi - lo), regs, sizeof(regs), &len);
+                if (err == ESP_OK && len != (size_t)(hi - lo) * 2) err = ESP_ERR_INVALID_RESPONSE;
+            }
+            iaq_prof_toc(IAQ_METRIC_SENSOR_S8_MODBUS, t0);
+            if (n > 1) {
+                ESP_LOGD(TAG, "Merged %u reads into regs 0x%04X..0x%04X", (unsigned)n, lo, (unsigned)(hi - 1));
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                if (!batch[i].cb) continue;
+                if (err != ESP_OK || batch[i].fn == S8_MB_FN_WRITE_SINGLE) {
+                    batch[i].cb(err, NULL, 0, batch[i].ctx);
+                } else {
+                    batch[i].cb(ESP_OK, regs + (batch[i].addr - lo) * 2, (size_t)batch[i].arg * 2, batch[i].ctx);
+                }
+            }
+        }
+
+        portENTER_CRITICAL(&s_mb_lock);
+        bool closing = s_mb_closing;
+        portEXIT_CRITICAL(&s_mb_lock);
+        if (closing) {
+            xSemaphoreGive(s_mb_exited);
+            vTaskDelete(NULL);
+        }
+    }
+}
+
+/* Stop the Modbus task before the UART goes away: refuse new work, fail
+ * everything still queued, then wait for the transaction in flight (bounded
+ * by UART timeouts) and for the task to exit. */
+static void s8_mb_stop(void)
+{
+    if (!s_mb_task) return;
+
+    s8_mb_txn_t pending[S8_MB_QUEUE_LEN];
+    size_t n = 0;
+    StaticSemaphore_t exit_buf;
+    s_mb_exited = xSemaphoreCreateBinaryStatic(&exit_buf);
+
+    portENTER_CRITICAL(&s_mb_lock);
+    s_mb_closing = true;
+    while (s_mb_count > 0) {
+        pending[n++] = s_mb_ring[s_mb_head];
+        s_mb_head = (s_mb_head + 1) % S8_MB_QUEUE_LEN;
+        s_mb_count--;
+    }
+    portEXIT_CRITICAL(&s_mb_lock);
+
+    for (size_t i = 0; i < n; i++) {
+        if (pending[i].cb) pending[i].cb(ESP_ERR_INVALID_STATE, NULL, 0, pending[i].ctx);
+    }
+
+    xTaskNotifyGive(s_mb_task);
+    xSemaphoreTake(s_mb_exited, portMAX_DELAY);
+    vSemaphoreDelete(s_mb_exited);
+    iaq_profiler_unregister_task(s_mb_task);
+
+    portENTER_CRITICAL(&s_mb_lock);
+    s_mb_task = NULL;
+    s_mb_exited = NULL;
+    s_mb_closing = false;
+    portEXIT_CRITICAL(&s_mb_lock);
+}
+
+/* Blocking wrappers for callers that need the answer (init, diag, config) */
+typedef struct {
+    SemaphoreHandle_t done;
+    esp_err_t err;
+    uint8_t regs[S8_MB_MAX_REGS * 2];
+    size_t len;
+} s8_mb_wait_t;
+
+static void s8_mb_wait_cb(esp_err_t err, const uint8_t *regs, size_t len, void *ctx)
+{
+    s8_mb_wait_t *w = (s8_mb_wait_t *)ctx;
+    w->err = err;
+    w->len = 0;
+    if (err == ESP_OK && regs && len <= sizeof(w->regs)) {
+        memcpy(w->regs, regs, len);
+        w->len = len;
+    }
+    xSemaphoreGive(w->done);
+}
+
+/* Run transactions as one submission (so reads merge) and wait for all of
+ * them. The Modbus task always completes, each step being bounded by UART
+ * timeouts, so the wait is unbounded. Must not be called from a callback. */
+static esp_err_t s8_mb_run(s8_mb_txn_t *txns, s8_mb_wait_t *waits, size_t n)
+{
+    StaticSemaphore_t sem_buf;
+    SemaphoreHandle_t done = xSemaphoreCreateCountingStatic(n, 0, &sem_buf);
+    for (size_t i = 0; i < n; i++) {
+        waits[i].done = done;
+        waits[i].err = ESP_FAIL;
+        waits[i].len = 0;
+        txns[i].cb = s8_mb_wait_cb;
+        txns[i].ctx = &waits[i];
+    }
+    esp_err_t err = s8_mb_submit(txns, n);
+    if (err == ESP_OK) {
+        for (size_t i = 0; i < n; i++) {
+            xSemaphoreTake(done, portMAX_DELAY);
+        }
+    }
+    vSemaphoreDelete(done);
+    return err;
+}
+
+static esp_err_t s8_mb_read_sync(s8_mb_fn_t fn, uint16_t addr, uint16_t quantity, uint8_t *out, size_t *out_len)
+{
+    s8_mb_txn_t t = { .fn = fn, .addr = addr, .arg = quantity };
+    s8_mb_wait_t w;
+    esp_err_t err = s8_mb_run(&t, &w, 1);
+    if (err != ESP_OK) return err;
+    if (w.err == ESP_OK) {
+        memcpy(out, w.regs, w.len);
+        if (out_len) *out_len = w.len;
+    }
+    return w.err;
+}
+
+static esp_err_t s8_mb_write_sync(uint16_t reg_addr, uint16_t value)
+{
+    s8_mb_txn_t t = { .fn = S8_MB_FN_WRITE_SINGLE, .addr = reg_addr, .arg = value };
+    s8_mb_wait_t w;
+    esp_err_t err = s8_mb_run(&t, &w, 1);
+    return err != ESP_OK ? err : w.err;
+}
+
+static inline uint16_t s8_reg_u16(const uint8_t *p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+/* Single outstanding asynchronous CO2 read */
+static s8_co2_cb_t s_co2_cb = NULL;
+static void *s_co2_ctx = NULL;
+static volatile bool s_co2_busy = false;
+
+static void s8_co2_done(esp_err_t err, const uint8_t *regs, size_t len, void *ctx)
+{
+    (void)ctx;
+    float ppm = NAN;
+    if (err == ESP_OK && len == 2) {
+        ppm = (float)s8_reg_u16(regs);
+    } else if (err == ESP_OK) {
+        err = ESP_ERR_INVALID_RESPONSE;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "S8 read failed: %s", esp_err_to_name(err));
+    }
+    s8_co2_cb_t cb = s_co2_cb;
+    void *cb_ctx = s_co2_ctx;
+    s_co2_busy = false;
+    if (cb) cb(err, ppm, cb_ctx);
+}
 
 esp_err_t s8_driver_init(void)
 {
@@ -205,12 +462,24 @@ esp_err_t s8_driver_init(void)
     (void)uart_set_rx_full_threshold(s_uart_port, 7);
     (void)uart_set_rx_timeout(s_uart_port, 2);
 
+    if (!s_mb_task) {
+        BaseType_t ok = xTaskCreatePinnedToCore(s8_mb_task, "s8_modbus", TASK_STACK_S8_MODBUS, NULL,
+                                                TASK_PRIORITY_S8_MODBUS, &s_mb_task, TASK_CORE_S8_MODBUS);
+        if (ok != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create S8 Modbus task");
+            s_mb_task = NULL;
+            (void)uart_bus_deinit(uart_port);
+            return ESP_ERR_NO_MEM;
+        }
+        iaq_profiler_register_task("s8_modbus", s_mb_task, TASK_STACK_S8_MODBUS);
+    }
+
     s_initialized = true;
 
     /* Read serial number */
-    uint8_t payload[8]; size_t len = 0;
+    uint8_t payload[S8_MB_MAX_REGS * 2]; size_t len = 0;
     uint32_t serial = 0;
-    if (s8_mb_read_regs(S8_MB_FN_READ_INPUT, /*addr*/(uint16_t)(S8_IR_SENSOR_ID_HIGH_REG - 1), /*qty*/2, payload, sizeof(payload), &len) == ESP_OK && len == 4) {
+    if (s8_mb_read_sync(S8_MB_FN_READ_INPUT, /*addr*/(uint16_t)(S8_IR_SENSOR_ID_HIGH_REG - 1), /*qty*/2, payload, &len) == ESP_OK && len == 4) {
         serial = ((uint32_t)payload[0] << 8) | payload[1];
         serial = (serial << 16) | (((uint32_t)payload[2] << 8) | payload[3]);
     }
@@ -221,12 +490,12 @@ esp_err_t s8_driver_init(void)
 
     /* Align sensor ABC with Kconfig: force disable if not enabled; set period if enabled */
 #ifdef CONFIG_IAQ_S8_ENABLE_ABC
-    esp_err_t abc_err = s8_mb_write_single((uint16_t)(S8_HR_ABC_PERIOD_REG - 1), (uint16_t)CONFIG_IAQ_S8_ABC_PERIOD_HOURS);
+    esp_err_t abc_err = s8_mb_write_sync((uint16_t)(S8_HR_ABC_PERIOD_REG - 1), (uint16_t)CONFIG_IAQ_S8_ABC_PERIOD_HOURS);
     if (abc_err != ESP_OK) {
         ESP_LOGW(TAG, "Failed to set S8 ABC period to %d hours: %s", CONFIG_IAQ_S8_ABC_PERIOD_HOURS, esp_err_to_name(abc_err));
     }
 #else
-    esp_err_t abc_err = s8_mb_write_single((uint16_t)(S8_HR_ABC_PERIOD_REG - 1), 0x0000);
+    esp_err_t abc_err = s8_mb_write_sync((uint16_t)(S8_HR_ABC_PERIOD_REG - 1), 0x0000);
     if (abc_err != ESP_OK) {
         ESP_LOGW(TAG, "Failed to disable S8 ABC: %s", esp_err_to_name(abc_err));
     }
@@ -234,7 +503,7 @@ esp_err_t s8_driver_init(void)
 
     /* Re-read ABC period for accurate log */
     uint16_t abc_period = 0;
-    if (s8_mb_read_regs(S8_MB_FN_READ_HOLDING, /*addr*/(uint16_t)(S8_HR_ABC_PERIOD_REG - 1), /*qty*/1, payload, sizeof(payload), &len) == ESP_OK && len == 2) {
+    if (s8_mb_read_sync(S8_MB_FN_READ_HOLDING, /*addr*/(uint16_t)(S8_HR_ABC_PERIOD_REG - 1), /*qty*/1, payload, &len) == ESP_OK && len == 2) {
         abc_period = ((uint16_t)payload[0] << 8) | payload[1];
     }
 
@@ -257,16 +526,40 @@ esp_err_t s8_driver_read_co2(float *out_co2_ppm)
 #ifdef CONFIG_IAQ_SIMULATION
     return sensor_sim_read_co2(out_co2_ppm);
 #else
-    uint8_t payload[8]; size_t len = 0;
-    esp_err_t err = s8_mb_read_regs(S8_MB_FN_READ_INPUT, /*addr*/(uint16_t)(S8_IR_CO2_SPACE_REG - 1), /*qty*/1, payload, sizeof(payload), &len);
+    uint8_t payload[S8_MB_MAX_REGS * 2]; size_t len = 0;
+    esp_err_t err = s8_mb_read_sync(S8_MB_FN_READ_INPUT, /*addr*/(uint16_t)(S8_IR_CO2_SPACE_REG - 1), /*qty*/1, payload, &len);
     if (err != ESP_OK || len != 2) {
         ESP_LOGW(TAG, "S8 read failed: %s (len=%u)", esp_err_to_name(err), (unsigned)len);
         *out_co2_ppm = NAN;
         return (err == ESP_OK ? ESP_ERR_INVALID_RESPONSE : err);
     }
-    uint16_t ppm = ((uint16_t)payload[0] << 8) | payload[1];
-    *out_co2_ppm = (float)ppm;
+    *out_co2_ppm = (float)s8_reg_u16(payload);
+    return ESP_OK;
+#endif
+}
+
+esp_err_t s8_driver_read_co2_async(s8_co2_cb_t cb, void *ctx)
+{
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
+    if (!cb) return ESP_ERR_INVALID_ARG;
+
+#ifdef CONFIG_IAQ_SIMULATION
+    float ppm = NAN;
+    esp_err_t sim_err = sensor_sim_read_co2(&ppm);
+    cb(sim_err, ppm, ctx);
     return ESP_OK;
+#else
+    if (s_co2_busy) return ESP_ERR_NOT_FINISHED;
+    s_co2_busy = true;
+    s_co2_cb = cb;
+    s_co2_ctx = ctx;
+    s8_mb_txn_t t = {
+        .fn = S8_MB_FN_READ_INPUT, .addr = (uint16_t)(S8_IR_CO2_SPACE_REG - 1), .arg = 1,
+        .cb = s8_co2_done, .ctx = NULL,
+    };
+    esp_err_t err = s8_mb_submit(&t, 1);
+    if (err != ESP_OK) s_co2_busy = false;
+    return err;
 #endif
 }
 
@@ -284,17 +577,17 @@ esp_err_t s8_driver_calibrate_co2(int target_ppm)
     }
 
     /* Clear acknowledgement register HR1 */
-    esp_err_t err = s8_mb_write_single((uint16_t)(S8_HR_ACK_REG - 1), 0x0000);
+    esp_err_t err = s8_mb_write_sync((uint16_t)(S8_HR_ACK_REG - 1), 0x0000);
     if (err != ESP_OK) return err;
     /* Write command 0x7C06 to HR2 */
     uint16_t cmd = ((uint16_t)S8_CMD_CODE << 8) | (uint16_t)S8_CMD_PARAM_BG_CAL;
-    err = s8_mb_write_single((uint16_t)(S8_HR_CMD_REG - 1), cmd);
+    err = s8_mb_write_sync((uint16_t)(S8_HR_CMD_REG - 1), cmd);
     if (err != ESP_OK) return err;
 
     /* Read acknowledgement HR1 (optional) */
-    uint8_t payload[8]; size_t len = 0;
-    if (s8_mb_read_regs(S8_MB_FN_READ_HOLDING, (uint16_t)(S8_HR_ACK_REG - 1), 1, payload, sizeof(payload), &len) == ESP_OK && len == 2) {
-        uint16_t ack = ((uint16_t)payload[0] << 8) | payload[1];
+    uint8_t payload[S8_MB_MAX_REGS * 2]; size_t len = 0;
+    if (s8_mb_read_sync(S8_MB_FN_READ_HOLDING, (uint16_t)(S8_HR_ACK_REG - 1), 1, payload, &len) == ESP_OK && len == 2) {
+        uint16_t ack = s8_reg_u16(payload);
         ESP_LOGI(TAG, "S8 background calibration ack=0x%04X", ack);
     }
     return ESP_OK;
@@ -319,7 +612,11 @@ esp_err_t s8_driver_deinit(void)
     if (!s_initialized) {
         return ESP_OK;
     }
+    if (s_mb_task && xTaskGetCurrentTaskHandle() == s_mb_task) {
+        return ESP_ERR_INVALID_STATE; /* From a completion callback: would wait for itself */
+    }
 
+    s8_mb_stop();
     esp_err_t ret = uart_bus_deinit(s_uart_port);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to deinitialize UART: %s", esp_err_to_name(ret));
@@ -353,24 +650,29 @@ esp_err_t s8_driver_get_diag(s8_diag_t *out)
     if (!out) return ESP_ERR_INVALID_ARG;
     memset(out, 0, sizeof(*out));
 
-    uint8_t payload[16]; size_t len = 0;
-    /* Meter status (IR1) */
-    if (s8_mb_read_regs(S8_MB_FN_READ_INPUT, (uint16_t)(S8_IR_METER_STATUS_REG - 1), 1, payload, sizeof(payload), &len) == ESP_OK && len == 2) {
-        out->meter_status = ((uint16_t)payload[0] << 8) | payload[1];
+    /* Submitted together: meter status and CO2 merge into one IR1..IR4 read */
+    enum { DIAG_STATUS, DIAG_CO2, DIAG_SERIAL, DIAG_ABC, DIAG_COUNT };
+    s8_mb_txn_t t[DIAG_COUNT] = {
+        [DIAG_STATUS] = { .fn = S8_MB_FN_READ_INPUT,   .addr = (uint16_t)(S8_IR_METER_STATUS_REG - 1),   .arg = 1 },
+        [DIAG_CO2]    = { .fn = S8_MB_FN_READ_INPUT,   .addr = (uint16_t)(S8_IR_CO2_SPACE_REG - 1),      .arg = 1 },
+        [DIAG_SERIAL] = { .fn = S8_MB_FN_READ_INPUT,   .addr = (uint16_t)(S8_IR_SENSOR_ID_HIGH_REG - 1), .arg = 2 },
+        [DIAG_ABC]    = { .fn = S8_MB_FN_READ_HOLDING, .addr = (uint16_t)(S8_HR_ABC_PERIOD_REG - 1),     .arg = 1 },
+    };
+    s8_mb_wait_t w[DIAG_COUNT];
+    esp_err_t err = s8_mb_run(t, w, DIAG_COUNT);
+    if (err != ESP_OK) return err;
+
+    if (w[DIAG_STATUS].err == ESP_OK && w[DIAG_STATUS].len == 2) {
+        out->meter_status = s8_reg_u16(w[DIAG_STATUS].regs);
     }
-    /* CO2 (IR4) */
-    if (s8_mb_read_regs(S8_MB_FN_READ_INPUT, (uint16_t)(S8_IR_CO2_SPACE_REG - 1), 1, payload, sizeof(payload), &len) == ESP_OK && len == 2) {
-        out->co2_ppm = (uint16_t)(((uint16_t)payload[0] << 8) | payload[1]);
+    if (w[DIAG_CO2].err == ESP_OK && w[DIAG_CO2].len == 2) {
+        out->co2_ppm = s8_reg_u16(w[DIAG_CO2].regs);
     }
-    /* Serial number (IR30+IR31) */
-    if (s8_mb_read_regs(S8_MB_FN_READ_INPUT, (uint16_t)(S8_IR_SENSOR_ID_HIGH_REG - 1), 2, payload, sizeof(payload), &len) == ESP_OK && len == 4) {
-        uint32_t sn = ((uint32_t)payload[0] << 8) | payload[1];
-        sn = (sn << 16) | (((uint32_t)payload[2] << 8) | payload[3]);
-        out->serial_number = sn;
+    if (w[DIAG_SERIAL].err == ESP_OK && w[DIAG_SERIAL].len == 4) {
+        out->serial_number = ((uint32_t)s8_reg_u16(w[DIAG_SERIAL].regs) << 16) | s8_reg_u16(w[DIAG_SERIAL].regs + 2);
     }
-    /* ABC period (HR32) */
-    if (s8_mb_read_regs(S8_MB_FN_READ_HOLDING, (uint16_t)(S8_HR_ABC_PERIOD_REG - 1), 1, payload, sizeof(payload), &len) == ESP_OK && len == 2) {
-        out->abc_period_hours = ((uint16_t)payload[0] << 8) | payload[1];
+    if (w[DIAG_ABC].err == ESP_OK && w[DIAG_ABC].len == 2) {
+        out->abc_period_hours = s8_reg_u16(w[DIAG_ABC].regs);
         out->abc_enabled = (out->abc_period_hours > 0);
     }
     out->modbus_addr = s_slave_addr;
@@ -381,12 +683,12 @@ esp_err_t s8_driver_get_diag(s8_diag_t *out)
 esp_err_t s8_driver_set_abc_period(uint16_t hours)
 {
     if (!s_initialized) return ESP_ERR_INVALID_STATE;
-    return s8_mb_write_single((uint16_t)(S8_HR_ABC_PERIOD_REG - 1), hours);
+    return s8_mb_write_sync((uint16_t)(S8_HR_ABC_PERIOD_REG - 1), hours);
 }
 
 esp_err_t s8_driver_set_abc_enabled(bool enable, uint16_t period_hours)
 {
     if (!s_initialized) return ESP_ERR_INVALID_STATE;
     uint16_t val = enable ? (period_hours > 0 ? period_hours : 180) : 0;
-    return s8_mb_write_single((uint16_t)(S8_HR_ABC_PERIOD_REG - 1), val);
+    return s8_mb_write_sync((uint16_t)(S8_HR_ABC_PERIOD_REG - 1), val);
 }
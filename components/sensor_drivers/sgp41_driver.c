@@ -23,6 +23,7 @@ static GasIndexAlgorithmParams s_nox_params;
 static int64_t s_init_time_us = 0;
 static uint8_t s_cond_err_streak = 0;
 static bool s_cond_warned = false;
+static uint32_t s_retry_count = 0;  /* One-shot I2C retries in sgp41_driver_read() */
 /* No persistence: keep driver lean */
 
 #define SGP41_I2C_ADDR 0x59
@@ -104,6 +105,11 @@ esp_err_t sgp41_driver_init(void)
     return ESP_OK;
 }
 
+uint32_t sgp41_driver_get_retry_count(void)
+{
+    return s_retry_count;
+}
+
 bool sgp41_driver_is_reporting_ready(void)
 {
     if (!s_initialized || s_dev == NULL) return false;
@@ -202,6 +208,7 @@ esp_err_t sgp41_driver_read(uint16_t *out_voc_index, uint16_t *out_nox_index,
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "SGP41 transmit failed: %s", esp_err_to_name(ret));
         // One-shot retry on transient error
+        s_retry_count++;
         ret = i2c_master_transmit(s_dev, tx, sizeof(tx), CONFIG_IAQ_I2C_TIMEOUT_MS);
         if (ret != ESP_OK) goto exit_tx;
     }
@@ -216,6 +223,7 @@ esp_err_t sgp41_driver_read(uint16_t *out_voc_index, uint16_t *out_nox_index,
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "SGP41 receive failed: %s", esp_err_to_name(ret));
         // One-shot retry
+        s_retry_count++;
         ret = i2c_master_receive(s_dev, rx, sizeof(rx), CONFIG_IAQ_I2C_TIMEOUT_MS);
         if (ret != ESP_OK) goto exit_rx;
     }
@@ -0,0 +1,84 @@
+/* components/system_context/include/periodic_sched.h */
+#ifndef PERIODIC_SCHED_H
+#define PERIODIC_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Coalescing scheduler for periodic work.
+ *
+ * All registered work shares one one-shot esp_timer. Each work item has a
+ * period and a slack: the longest it may run after its due time. The timer
+ * is armed for the earliest (due + slack) and every item that is already due
+ * at that point runs in the same wake-up, so work with compatible tolerances
+ * settles onto common wake-ups instead of waking the CPU on its own phase.
+ * Missed periods are skipped, never replayed.
+ *
+ * Callbacks run in the esp_timer task, like esp_timer callbacks: keep them
+ * short and hand real work to a task.
+ */
+
+#define PERIODIC_SCHED_MAX_WORK         16
+#define PERIODIC_SCHED_MAX_SUBSYSTEMS   8
+
+typedef struct periodic_work *periodic_work_handle_t;
+
+typedef void (*periodic_work_cb_t)(void *arg);
+
+typedef struct {
+    periodic_work_cb_t callback;
+    void *arg;
+    const char *name;           /* Work name for logs ("mqtt_state") */
+    const char *subsystem;      /* Wake-up accounting group ("mqtt"), static string */
+    uint32_t slack_ms;          /* How late the work may run to share a wake-up */
+} periodic_work_args_t;
+
+/** Wake-ups of the last complete minute for one subsystem. */
+typedef struct {
+    const char *subsystem;
+    uint32_t wakeups;           /* Wake-ups in which this subsystem ran work */
+    uint32_t runs;              /* Work callbacks run */
+} periodic_sched_subsys_stats_t;
+
+/**
+ * Register a work item (stopped).
+ *
+ * @return ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM if the work or subsystem table
+ *         is full, or the esp_timer error on first use
+ */
+esp_err_t periodic_sched_create(const periodic_work_args_t *args, periodic_work_handle_t *out);
+
+/**
+ * Start (or restart) a work item: first run after first_delay_us, then every
+ * period_us. Safe to call from any task.
+ */
+esp_err_t periodic_sched_start(periodic_work_handle_t work, uint64_t first_delay_us, uint64_t period_us);
+
+/** Stop a work item. ESP_ERR_INVALID_STATE if it was not running. */
+esp_err_t periodic_sched_stop(periodic_work_handle_t work);
+
+/** Stop and unregister a work item. */
+esp_err_t periodic_sched_delete(periodic_work_handle_t work);
+
+bool periodic_sched_is_active(periodic_work_handle_t work);
+
+/**
+ * Per-subsystem wake-ups and runs over the last complete minute.
+ *
+ * @param out          Array of at least PERIODIC_SCHED_MAX_SUBSYSTEMS entries
+ * @param total_wakeups Distinct scheduler wake-ups in that minute (optional)
+ * @return Number of entries written
+ */
+int periodic_sched_get_stats(periodic_sched_subsys_stats_t *out, int max, uint32_t *total_wakeups);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERIODIC_SCHED_H */
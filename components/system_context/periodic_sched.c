@@ -0,0 +1,302 @@
+/* components/system_context/periodic_sched.c */
+#include "periodic_sched.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "PSCHED";
+
+#define STATS_WINDOW_US     (60LL * 1000000LL)
+
+struct periodic_work {
+    bool in_use;
+    bool active;
+    periodic_work_cb_t callback;
+    void *arg;
+    const char *name;
+    uint8_t subsystem;
+    int64_t slack_us;
+    int64_t period_us;
+    int64_t next_due_us;
+};
+
+typedef struct {
+    uint32_t wakeups;
+    uint32_t runs;
+} subsys_counts_t;
+
+static struct periodic_work s_work[PERIODIC_SCHED_MAX_WORK];
+static const char *s_subsystems[PERIODIC_SCHED_MAX_SUBSYSTEMS];
+static int s_subsystem_count = 0;
+
+static SemaphoreHandle_t s_lock = NULL;
+static portMUX_TYPE s_init_mux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_timer = NULL;
+
+/* Wake-up accounting: the minute being counted and the last complete one */
+static int64_t s_stats_minute = 0;
+static subsys_counts_t s_cur[PERIODIC_SCHED_MAX_SUBSYSTEMS];
+static subsys_counts_t s_last[PERIODIC_SCHED_MAX_SUBSYSTEMS];
+static uint32_t s_cur_wakeups = 0;
+static uint32_t s_last_wakeups = 0;
+
+static void sched_timer_cb(void *arg);
+
+static esp_err_t ensure_init(void)
+{
+    if (s_lock) {
+        return ESP_OK;
+    }
+
+    SemaphoreHandle_t lock = xSemaphoreCreateMutex();
+    if (!lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_timer_handle_t timer = NULL;
+    const esp_timer_create_args_t args = {
+        .callback = sched_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "psched",
+    };
+    esp_err_t err = esp_timer_create(&args, &timer);
+    if (err != ESP_OK) {
+        vSemaphoreDelete(lock);
+        ESP_LOGE(TAG, "Failed to create timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    bool won = false;
+    portENTER_CRITICAL(&s_init_mux);
+    if (!s_lock) {
+        s_timer = timer;
+        s_lock = lock;
+        won = true;
+    }
+    portEXIT_CRITICAL(&s_init_mux);
+
+    if (!won) {
+        esp_timer_delete(timer);
+        vSemaphoreDelete(lock);
+    }
+    return ESP_OK;
+}
+
+/* Caller holds s_lock */
+static void stats_roll(int64_t now_us)
+{
+    int64_t minute = now_us / STATS_WINDOW_US;
+    if (minute == s_stats_minute) {
+        return;
+    }
+    if (minute == s_stats_minute + 1) {
+        memcpy(s_last, s_cur, sizeof(s_last));
+        s_last_wakeups = s_cur_wakeups;
+    } else {
+        /* A whole minute passed without a wake-up */
+        memset(s_last, 0, sizeof(s_last));
+        s_last_wakeups = 0;
+    }
+    memset(s_cur, 0, sizeof(s_cur));
+    s_cur_wakeups = 0;
+    s_stats_minute = minute;
+}
+
+/* Caller holds s_lock. Arm the timer for the earliest deadline of any active work. */
+static void rearm_locked(int64_t now_us)
+{
+    int64_t deadline = INT64_MAX;
+    for (int i = 0; i < PERIODIC_SCHED_MAX_WORK; i++) {
+        const struct periodic_work *w = &s_work[i];
+        if (w->in_use && w->active && w->next_due_us + w->slack_us < deadline) {
+            deadline = w->next_due_us + w->slack_us;
+        }
+    }
+
+    esp_timer_stop(s_timer);
+    if (deadline == INT64_MAX) {
+        return;
+    }
+    int64_t delay_us = deadline - now_us;
+    esp_err_t err = esp_timer_start_once(s_timer, delay_us > 0 ? (uint64_t)delay_us : 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to arm timer: %s", esp_err_to_name(err));
+    }
+}
+
+static void sched_timer_cb(void *arg)
+{
+    struct {
+        periodic_work_cb_t callback;
+        void *arg;
+    } due[PERIODIC_SCHED_MAX_WORK];
+    int n_due = 0;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    stats_roll(now);
+
+    bool ran_subsystem[PERIODIC_SCHED_MAX_SUBSYSTEMS] = { 0 };
+    for (int i = 0; i < PERIODIC_SCHED_MAX_WORK; i++) {
+        struct periodic_work *w = &s_work[i];
+        if (!w->in_use || !w->active || w->next_due_us > now) {
+            continue;
+        }
+        due[n_due].callback = w->callback;
+        due[n_due].arg = w->arg;
+        n_due++;
+
+        /* Stay on the period grid; skip periods that were missed entirely */
+        w->next_due_us += w->period_us;
+        if (w->next_due_us <= now) {
+            int64_t missed = (now - w->next_due_us) / w->period_us + 1;
+            w->next_due_us += missed * w->period_us;
+        }
+
+        s_cur[w->subsystem].runs++;
+        if (!ran_subsystem[w->subsystem]) {
+            ran_subsystem[w->subsystem] = true;
+            s_cur[w->subsystem].wakeups++;
+        }
+    }
+    if (n_due > 0) {
+        s_cur_wakeups++;
+    }
+    rearm_locked(now);
+    xSemaphoreGive(s_lock);
+
+    for (int i = 0; i < n_due; i++) {
+        due[i].callback(due[i].arg);
+    }
+}
+
+static int find_or_add_subsystem(const char *name)
+{
+    for (int i = 0; i < s_subsystem_count; i++) {
+        if (strcmp(s_subsystems[i], name) == 0) {
+            return i;
+        }
+    }
+    if (s_subsystem_count >= PERIODIC_SCHED_MAX_SUBSYSTEMS) {
+        return -1;
+    }
+    s_subsystems[s_subsystem_count] = name;
+    return s_subsystem_count++;
+}
+
+esp_err_t periodic_sched_create(const periodic_work_args_t *args, periodic_work_handle_t *out)
+{
+    if (!args || !args->callback || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ensure_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int subsystem = find_or_add_subsystem(args->subsystem ? args->subsystem : "other");
+    struct periodic_work *slot = NULL;
+    for (int i = 0; i < PERIODIC_SCHED_MAX_WORK && subsystem >= 0; i++) {
+        if (!s_work[i].in_use) {
+            slot = &s_work[i];
+            break;
+        }
+    }
+    if (slot) {
+        *slot = (struct periodic_work) {
+            .in_use = true,
+            .callback = args->callback,
+            .arg = args->arg,
+            .name = args->name ? args->name : "?",
+            .subsystem = (uint8_t)subsystem,
+            .slack_us = (int64_t)args->slack_ms * 1000,
+        };
+    }
+    xSemaphoreGive(s_lock);
+
+    if (!slot) {
+        ESP_LOGE(TAG, "No room for work '%s'", args->name ? args->name : "?");
+        return ESP_ERR_NO_MEM;
+    }
+    *out = slot;
+    return ESP_OK;
+}
+
+esp_err_t periodic_sched_start(periodic_work_handle_t work, uint64_t first_delay_us, uint64_t period_us)
+{
+    if (!work || period_us == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    work->period_us = (int64_t)period_us;
+    work->next_due_us = now + (int64_t)first_delay_us;
+    work->active = true;
+    rearm_locked(now);
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+esp_err_t periodic_sched_stop(periodic_work_handle_t work)
+{
+    if (!work) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool was_active = work->active;
+    work->active = false;
+    if (was_active) {
+        rearm_locked(esp_timer_get_time());
+    }
+    xSemaphoreGive(s_lock);
+    return was_active ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t periodic_sched_delete(periodic_work_handle_t work)
+{
+    if (!work) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool was_active = work->active;
+    memset(work, 0, sizeof(*work));
+    if (was_active) {
+        rearm_locked(esp_timer_get_time());
+    }
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+bool periodic_sched_is_active(periodic_work_handle_t work)
+{
+    return work && work->active;
+}
+
+int periodic_sched_get_stats(periodic_sched_subsys_stats_t *out, int max, uint32_t *total_wakeups)
+{
+    if (total_wakeups) {
+        *total_wakeups = 0;
+    }
+    if (!s_lock || !out || max <= 0) {
+        return 0;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    stats_roll(esp_timer_get_time());
+    int n = s_subsystem_count < max ? s_subsystem_count : max;
+    for (int i = 0; i < n; i++) {
+        out[i].subsystem = s_subsystems[i];
+        out[i].wakeups = s_last[i].wakeups;
+        out[i].runs = s_last[i].runs;
+    }
+    if (total_wakeups) {
+        *total_wakeups = s_last_wakeups;
+    }
+    xSemaphoreGive(s_lock);
+    return n;
+}
@@ -25,6 +25,9 @@ void web_console_set_server(httpd_handle_t server);
 /* Reset client state after server restart. */
 void web_console_reset_clients(void);
 
+/* Whether a console session or log viewer is open (lock-free hint). */
+bool web_console_has_clients(void);
+
 /* URI descriptors to be registered by web_portal. */
 extern const httpd_uri_t web_console_uri_log;
 extern const httpd_uri_t web_console_uri_console;
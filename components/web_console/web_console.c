@@ -84,6 +84,11 @@ void web_console_reset_clients(void)
     web_console_reset_log_state();
 }
 
+bool web_console_has_clients(void)
+{
+    return s_initialized && (web_console_console_has_sessions() || web_console_log_has_clients());
+}
+
 void web_console_stop(void)
 {
     if (!s_initialized) return;
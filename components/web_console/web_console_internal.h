@@ -28,6 +28,12 @@
 #ifndef CONFIG_IAQ_WEB_CONSOLE_LOG_LINE_MAX
 #define CONFIG_IAQ_WEB_CONSOLE_LOG_LINE_MAX 512
 #endif
+#ifndef CONFIG_IAQ_WEB_CONSOLE_MAX_SESSIONS
+#define CONFIG_IAQ_WEB_CONSOLE_MAX_SESSIONS 3
+#endif
+#ifndef CONFIG_IAQ_WEB_CONSOLE_CMD_WORKERS
+#define CONFIG_IAQ_WEB_CONSOLE_CMD_WORKERS 2
+#endif
 
 /* Mutex timeout for non-blocking operations (ms).
  * Prevents hangs if a bug causes mutex to not be released. */
@@ -47,5 +53,11 @@ esp_err_t web_console_console_init(void);
 void web_console_console_stop(void);
 void web_console_reset_console_state(void);
 void web_console_reset_log_state(void);
+bool web_console_console_has_sessions(void);
+bool web_console_log_has_clients(void);
+
+/* Output hook for stdout/stderr writes. Returns true if the data came from
+ * a console worker running a command and was routed to that session. */
+bool web_console_console_capture(const char *data, size_t len);
 
 #endif /* WEB_CONSOLE_INTERNAL_H */
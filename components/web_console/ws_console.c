@@ -1,4 +1,5 @@
 /* components/web_console/ws_console.c */
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
@@ -6,37 +7,208 @@
 #include "sdkconfig.h"
 #include "esp_log.h"
 #include "esp_err.h"
-#include "esp_console.h"
 #include "esp_timer.h"
 #include "esp_http_server.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 #include "iaq_profiler.h"
+#include "iaq_config.h"
+#include "console_commands.h"
 #include "web_console_internal.h"
 
 static const char *TAG = "WC_CONSOLE";
 
-static int s_console_sock = -1;
+#define MAX_SESSIONS    CONFIG_IAQ_WEB_CONSOLE_MAX_SESSIONS
+#define CMD_WORKERS     CONFIG_IAQ_WEB_CONSOLE_CMD_WORKERS
+#define PIPE_SIZE       512         /* Per-worker output buffer */
+#define PIPE_FLUSH_US   50000       /* Send complete lines at most this often */
+#define CANCEL_CHAR     '\x03'      /* Ctrl+C */
+
+typedef struct {
+    int sock;
+    bool active;
+    bool read_only;                 /* Only status/show/scan/read commands */
+    volatile bool busy;             /* A command is queued or running */
+    volatile uint32_t seq;          /* Bumped on each command, cancel and close */
+    int64_t last_cmd_time;
+} console_session_t;
+
+typedef struct {
+    int slot;
+    int sock;
+    uint32_t seq;                   /* Session seq at dispatch; stale = cancelled */
+    bool read_only;
+    char *cmd;                      /* Owned by the job */
+} console_job_t;
+
+/* Each worker owns the output pipe of the command it is running */
+typedef struct {
+    TaskHandle_t task;
+    volatile bool running;
+    bool in_flush;                  /* Output while sending goes to the log */
+    console_job_t job;
+    char pipe[PIPE_SIZE];
+    size_t pipe_len;
+    int64_t last_flush_us;
+} cmd_worker_t;
+
+static console_session_t s_sessions[MAX_SESSIONS];
+static cmd_worker_t s_workers[CMD_WORKERS];
 static SemaphoreHandle_t s_console_mutex = NULL;
-static int64_t s_last_cmd_time = 0;
+static QueueHandle_t s_job_queue = NULL;
 
-static esp_err_t send_text(httpd_req_t *req, const char *txt)
+static esp_err_t send_to_sock(int sock, const char *txt, size_t len)
 {
     httpd_handle_t server = web_console_get_server();
-    if (!req || !txt) return ESP_ERR_INVALID_ARG;
+    if (!txt) return ESP_ERR_INVALID_ARG;
     if (!server) return ESP_ERR_INVALID_STATE;
     httpd_ws_frame_t frame = {
         .type = HTTPD_WS_TYPE_TEXT,
         .payload = (uint8_t *)txt,
-        .len = strlen(txt),
+        .len = len,
     };
-    esp_err_t err = httpd_ws_send_frame_async(server, httpd_req_to_sockfd(req), &frame);
+    esp_err_t err = httpd_ws_send_frame_async(server, sock, &frame);
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "WS console send failed: %s", esp_err_to_name(err));
     }
     return err;
 }
 
+static esp_err_t send_text(httpd_req_t *req, const char *txt)
+{
+    if (!req || !txt) return ESP_ERR_INVALID_ARG;
+    return send_to_sock(httpd_req_to_sockfd(req), txt, strlen(txt));
+}
+
+/* Lock-free check used on the output path; fields are only advanced */
+static bool job_current(const console_job_t *job)
+{
+    const console_session_t *s = &s_sessions[job->slot];
+    return s->active && s->sock == job->sock && s->seq == job->seq;
+}
+
+static int session_find(int sock)
+{
+    for (int i = 0; i < MAX_SESSIONS; ++i) {
+        if (s_sessions[i].active && s_sessions[i].sock == sock) return i;
+    }
+    return -1;
+}
+
+static void session_close(console_session_t *s)
+{
+    s->active = false;
+    s->sock = -1;
+    s->busy = false;
+    s->seq++;
+    s->last_cmd_time = 0;
+}
+
+static void pipe_flush(cmd_worker_t *w)
+{
+    if (w->pipe_len == 0) return;
+    w->in_flush = true;
+    if (job_current(&w->job)) {
+        (void)send_to_sock(w->job.sock, w->pipe, w->pipe_len);
+    }
+    w->in_flush = false;
+    w->pipe_len = 0;
+    w->last_flush_us = esp_timer_get_time();
+}
+
+bool web_console_console_capture(const char *data, size_t len)
+{
+    if (!s_job_queue || !data) return false;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    cmd_worker_t *w = NULL;
+    for (int i = 0; i < CMD_WORKERS; ++i) {
+        if (s_workers[i].task && s_workers[i].task == self) {
+            w = &s_workers[i];
+            break;
+        }
+    }
+    if (!w || !w->running || w->in_flush) return false;
+    if (!job_current(&w->job)) return false; /* Cancelled: late output stays in the log */
+
+    while (len > 0) {
+        size_t n = PIPE_SIZE - w->pipe_len;
+        if (n > len) n = len;
+        memcpy(w->pipe + w->pipe_len, data, n);
+        w->pipe_len += n;
+        data += n;
+        len -= n;
+        if (w->pipe_len == PIPE_SIZE) pipe_flush(w);
+    }
+    /* Stream whole lines so slow commands show progress without a frame per printf */
+    if (w->pipe_len > 0 && w->pipe[w->pipe_len - 1] == '\n' &&
+        (esp_timer_get_time() - w->last_flush_us) >= PIPE_FLUSH_US) {
+        pipe_flush(w);
+    }
+    return true;
+}
+
+static void job_finish(const console_job_t *job, const char *tail)
+{
+    bool current = false;
+    if (s_console_mutex && xSemaphoreTake(s_console_mutex, pdMS_TO_TICKS(WC_MUTEX_TIMEOUT_MS)) == pdTRUE) {
+        current = job_current(job);
+        if (current) s_sessions[job->slot].busy = false;
+        xSemaphoreGive(s_console_mutex);
+    }
+    if (current) (void)send_to_sock(job->sock, tail, strlen(tail));
+}
+
+static void cmd_worker_task(void *arg)
+{
+    cmd_worker_t *w = (cmd_worker_t *)arg;
+    console_job_t job;
+    for (;;) {
+        if (xQueueReceive(s_job_queue, &job, portMAX_DELAY) != pdTRUE) continue;
+        if (!job_current(&job)) { /* Cancelled or closed while queued */
+            free(job.cmd);
+            continue;
+        }
+
+        uint64_t t0 = iaq_prof_tic();
+        fflush(stdout); /* Pending bytes from other tasks are not ours */
+        w->job = job;
+        w->pipe_len = 0;
+        w->last_flush_us = esp_timer_get_time();
+        w->running = true;
+
+        int rc = 0;
+        esp_err_t err = console_commands_run(job.cmd, job.read_only, &rc);
+        fflush(stdout);
+        fflush(stderr);
+        w->running = false;
+        pipe_flush(w);
+
+        char tail[96];
+        switch (err) {
+            case ESP_OK:
+                snprintf(tail, sizeof(tail), "(%d) iaq> ", rc);
+                break;
+            case ESP_ERR_NOT_ALLOWED:
+                snprintf(tail, sizeof(tail), "[read-only session: command not allowed]\r\n(1) iaq> ");
+                break;
+            case ESP_ERR_NOT_FOUND:
+                snprintf(tail, sizeof(tail), "Unrecognized command\r\n(1) iaq> ");
+                break;
+            case ESP_ERR_INVALID_SIZE:
+                snprintf(tail, sizeof(tail), "[error: command too long]\r\n(1) iaq> ");
+                break;
+            default:
+                snprintf(tail, sizeof(tail), "[error: %s]\r\n(1) iaq> ", esp_err_to_name(err));
+                break;
+        }
+        job_finish(&job, tail);
+        free(job.cmd);
+        iaq_prof_toc(IAQ_METRIC_WEB_CONSOLE_CMD, t0);
+    }
+}
+
 static void console_client_cleanup(int sock)
 {
     if (!s_console_mutex) return;
@@ -44,9 +216,9 @@ static void console_client_cleanup(int sock)
         ESP_LOGE(TAG, "Console mutex timeout in cleanup");
         return;
     }
-    if (s_console_sock == sock) {
-        s_console_sock = -1;
-        s_last_cmd_time = 0;
+    int slot = session_find(sock);
+    if (slot >= 0) {
+        session_close(&s_sessions[slot]);
         ESP_LOGI(TAG, "Console client closed: %d", sock);
     }
     xSemaphoreGive(s_console_mutex);
@@ -57,8 +229,25 @@ esp_err_t web_console_console_init(void)
     if (s_console_mutex) return ESP_OK;
     s_console_mutex = xSemaphoreCreateMutex();
     if (!s_console_mutex) return ESP_ERR_NO_MEM;
-    s_console_sock = -1;
-    s_last_cmd_time = 0;
+    for (int i = 0; i < MAX_SESSIONS; ++i) {
+        session_close(&s_sessions[i]);
+    }
+
+    /* Workers survive stop/start; jobs for closed sessions are dropped */
+    if (s_job_queue) return ESP_OK;
+    s_job_queue = xQueueCreate(MAX_SESSIONS, sizeof(console_job_t));
+    if (!s_job_queue) return ESP_ERR_NO_MEM;
+    for (int i = 0; i < CMD_WORKERS; ++i) {
+        char name[16];
+        snprintf(name, sizeof(name), "wc_cmd%d", i);
+        BaseType_t ok = xTaskCreatePinnedToCore(cmd_worker_task, name, TASK_STACK_WC_CMD, &s_workers[i],
+                                                TASK_PRIORITY_WC_CMD, &s_workers[i].task, TASK_CORE_WC_CMD);
+        if (ok != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create console worker %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+        iaq_profiler_register_task(name, s_workers[i].task, TASK_STACK_WC_CMD);
+    }
     return ESP_OK;
 }
 
@@ -68,8 +257,85 @@ void web_console_console_stop(void)
         vSemaphoreDelete(s_console_mutex);
         s_console_mutex = NULL;
     }
-    s_console_sock = -1;
-    s_last_cmd_time = 0;
+    for (int i = 0; i < MAX_SESSIONS; ++i) {
+        session_close(&s_sessions[i]);
+    }
+}
+
+bool web_console_console_has_sessions(void)
+{
+    for (int i = 0; i < MAX_SESSIONS; ++i) {
+        if (s_sessions[i].active) return true;
+    }
+    return false;
+}
+
+static void reject_busy(httpd_req_t *req)
+{
+    /* Gracefully reject with proper close code + reason */
+    static const char *reason = "Console busy";
+    uint16_t code = htons(1013); /* Try Again Later */
+    uint8_t payload[2 + sizeof("Console busy")]; /* includes NUL but len excludes */
+    memcpy(payload, &code, sizeof(code));
+    memcpy(payload + 2, reason, strlen(reason));
+    httpd_ws_frame_t closefrm = {
+        .type = HTTPD_WS_TYPE_CLOSE,
+        .payload = payload,
+        .len = 2 + strlen(reason),
+    };
+    (void)httpd_ws_send_frame(req, &closefrm);
+}
+
+/* Ctrl+C: a queued job is dropped, a running one keeps running on its
+ * worker (commands block in drivers) but its output no longer reaches
+ * the session, which gets its prompt back immediately. */
+static void cancel_command(httpd_req_t *req, int sock)
+{
+    bool was_busy = false;
+    if (xSemaphoreTake(s_console_mutex, pdMS_TO_TICKS(WC_MUTEX_TIMEOUT_MS)) == pdTRUE) {
+        int slot = session_find(sock);
+        if (slot >= 0 && s_sessions[slot].busy) {
+            s_sessions[slot].seq++;
+            s_sessions[slot].busy = false;
+            was_busy = true;
+        }
+        xSemaphoreGive(s_console_mutex);
+    }
+    send_text(req, was_busy ? "^C\r\n(130) iaq> " : "^C\r\niaq> ");
+}
+
+/* Hand the command to a worker; takes ownership of cmd */
+static void dispatch_command(httpd_req_t *req, int sock, char *cmd)
+{
+    const char *reply = NULL;
+    console_job_t job = { .slot = -1, .sock = sock, .cmd = cmd };
+
+    if (xSemaphoreTake(s_console_mutex, pdMS_TO_TICKS(WC_MUTEX_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGE(TAG, "Console mutex timeout in dispatch");
+        free(cmd);
+        return;
+    }
+    int slot = session_find(sock);
+    if (slot >= 0 && s_sessions[slot].busy) {
+        reply = "[busy: previous command still running, Ctrl+C to cancel]\r\n";
+    } else if (slot >= 0) {
+        console_session_t *s = &s_sessions[slot];
+        s->seq++;
+        s->busy = true;
+        job.slot = slot;
+        job.seq = s->seq;
+        job.read_only = s->read_only;
+        if (xQueueSend(s_job_queue, &job, 0) == pdTRUE) {
+            job.cmd = NULL; /* Worker owns it now */
+        } else {
+            s->busy = false;
+            reply = "[busy: console workers occupied, retry]\r\niaq> ";
+        }
+    }
+    xSemaphoreGive(s_console_mutex);
+
+    free(job.cmd);
+    if (reply) send_text(req, reply);
 }
 
 static esp_err_t ws_console_handler(httpd_req_t *req)
@@ -91,28 +357,33 @@ static esp_err_t ws_console_handler(httpd_req_t *req)
             ESP_LOGE(TAG, "Console mutex timeout");
             return ESP_FAIL;
         }
-        if (s_console_sock >= 0) {
-            /* Gracefully reject with proper close code + reason */
+        /* First session has full access; later ones are read-only */
+        int slot = -1;
+        bool has_control = false;
+        for (int i = 0; i < MAX_SESSIONS; ++i) {
+            if (s_sessions[i].active) {
+                has_control |= !s_sessions[i].read_only;
+            } else if (slot < 0) {
+                slot = i;
+            }
+        }
+        if (slot < 0) {
             xSemaphoreGive(s_console_mutex);
-            static const char *reason = "Console busy";
-            uint16_t code = htons(1013); /* Try Again Later */
-            uint8_t payload[2 + sizeof("Console busy")]; /* includes NUL but len excludes */
-            memcpy(payload, &code, sizeof(code));
-            memcpy(payload + 2, reason, strlen(reason));
-            httpd_ws_frame_t closefrm = {
-                .type = HTTPD_WS_TYPE_CLOSE,
-                .payload = payload,
-                .len = 2 + strlen(reason),
-            };
-            (void)httpd_ws_send_frame(req, &closefrm);
+            reject_busy(req);
             return ESP_OK;
         }
-        s_console_sock = sock;
-        s_last_cmd_time = 0;
+        console_session_t *s = &s_sessions[slot];
+        s->sock = sock;
+        s->active = true;
+        s->read_only = has_control;
+        s->busy = false;
+        s->seq++;
+        s->last_cmd_time = 0;
         xSemaphoreGive(s_console_mutex);
 
-        ESP_LOGI(TAG, "Console client connected: %d", sock);
-        return send_text(req, "Connected to IAQ Console\r\niaq> ");
+        ESP_LOGI(TAG, "Console client connected: %d%s", sock, has_control ? " (read-only)" : "");
+        return send_text(req, has_control ? "Connected to IAQ Console (read-only)\r\niaq> "
+                                          : "Connected to IAQ Console\r\niaq> ");
     }
 
     httpd_ws_frame_t frame = {0};
@@ -183,21 +454,29 @@ static esp_err_t ws_console_handler(httpd_req_t *req)
         free(frame.payload);
         return ESP_OK;
     }
-    if (frame.type != HTTPD_WS_TYPE_TEXT) {
+    if (frame.type != HTTPD_WS_TYPE_TEXT || !s_console_mutex) {
+        free(frame.payload);
+        return ESP_OK;
+    }
+
+    /* Cancel is never rate limited */
+    if (frame.payload[0] == CANCEL_CHAR) {
         free(frame.payload);
+        cancel_command(req, sock);
         return ESP_OK;
     }
 
     int64_t now = esp_timer_get_time();
-    if (s_last_cmd_time > 0) {
+    int slot = session_find(sock);
+    if (slot >= 0 && s_sessions[slot].last_cmd_time > 0) {
         int64_t min_interval = 1000000LL / CONFIG_IAQ_WEB_CONSOLE_CMD_RATE_LIMIT;
-        if ((now - s_last_cmd_time) < min_interval) {
+        if ((now - s_sessions[slot].last_cmd_time) < min_interval) {
             send_text(req, "[rate limited]\r\niaq> ");
             free(frame.payload);
             return ESP_OK;
         }
     }
-    s_last_cmd_time = now;
+    if (slot >= 0) s_sessions[slot].last_cmd_time = now;
 
     /* Strip trailing whitespace/newlines (websocat sends \n or \r\n) */
     char *cmd = (char *)frame.payload;
@@ -213,16 +492,8 @@ static esp_err_t ws_console_handler(httpd_req_t *req)
         return ESP_OK;
     }
 
-    uint64_t t0 = iaq_prof_tic();
-    int ret_code = 0;
-    esp_console_run(cmd, &ret_code);
-
-    char prompt[32];
-    snprintf(prompt, sizeof(prompt), "(%d) iaq> ", ret_code);
-    send_text(req, prompt);
-    iaq_prof_toc(IAQ_METRIC_WEB_CONSOLE_CMD, t0);
-
-    free(frame.payload);
+    /* Run on a worker; output and prompt are sent from there */
+    dispatch_command(req, sock, cmd);
     return ESP_OK;
 }
 
@@ -233,12 +504,14 @@ void web_console_reset_console_state(void)
         if (!locked) {
             ESP_LOGE(TAG, "Console mutex timeout in reset");
         }
-        s_console_sock = -1;
-        s_last_cmd_time = 0;
+        for (int i = 0; i < MAX_SESSIONS; ++i) {
+            session_close(&s_sessions[i]);
+        }
         if (locked) xSemaphoreGive(s_console_mutex);
     } else {
-        s_console_sock = -1;
-        s_last_cmd_time = 0;
+        for (int i = 0; i < MAX_SESSIONS; ++i) {
+            session_close(&s_sessions[i]);
+        }
     }
 }
 
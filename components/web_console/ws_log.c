@@ -15,6 +15,7 @@
 #include "iaq_profiler.h"
 #include "iaq_config.h"
 #include "web_console_internal.h"
+#include "ws_deflate.h"
 
 static const char *TAG = "WC_LOG";
 #define LOG_SEND_BATCH_SIZE   CONFIG_IAQ_WEB_CONSOLE_LOG_BUFFER_SIZE
@@ -32,6 +33,8 @@ typedef struct {
 typedef struct {
     int sock;
     bool active;
+    bool deflate;           /* Opted in with ?deflate=1 */
+    bool synced;            /* Has seen a RESET frame of the shared stream */
     uint32_t send_failures;
 } log_client_t;
 
@@ -47,6 +50,9 @@ static QueueHandle_t s_notify_queue = NULL;
 static TaskHandle_t s_broadcast_task = NULL;
 static bool s_exit_task = false;
 static log_client_t s_clients[CONFIG_IAQ_WEB_CONSOLE_MAX_LOG_CLIENTS] = {0};
+/* Shared context-takeover stream: log batches repeat tags and prefixes */
+static ws_deflate_t s_log_deflate;
+static volatile int s_deflate_clients = 0;
 
 static inline size_t ring_used(const log_ring_t *rb)
 {
@@ -128,7 +134,7 @@ static void ring_write(log_ring_t *rb, const char *data, size_t len)
     rb->head = (rb->head + len) % rb->size;
 }
 
-static bool log_clients_add(int sock)
+static bool log_clients_add(int sock, bool deflate)
 {
     if (!s_clients_mutex) return false;
     if (xSemaphoreTake(s_clients_mutex, pdMS_TO_TICKS(WC_MUTEX_TIMEOUT_MS)) != pdTRUE) {
@@ -140,7 +146,14 @@ static bool log_clients_add(int sock)
         if (!s_clients[i].active) {
             s_clients[i].sock = sock;
             s_clients[i].active = true;
+            s_clients[i].deflate = deflate;
+            s_clients[i].synced = false;
             s_clients[i].send_failures = 0;
+            if (deflate) {
+                s_deflate_clients++;
+                /* New dictionary so this client can join; others resync too */
+                ws_deflate_reset(&s_log_deflate);
+            }
             added = true;
             break;
         }
@@ -158,6 +171,7 @@ static void log_clients_remove(int sock)
     }
     for (int i = 0; i < CONFIG_IAQ_WEB_CONSOLE_MAX_LOG_CLIENTS; ++i) {
         if (s_clients[i].active && s_clients[i].sock == sock) {
+            if (s_clients[i].deflate) s_deflate_clients--;
             s_clients[i].active = false;
             s_clients[i].sock = -1;
             s_clients[i].send_failures = 0;
@@ -179,9 +193,18 @@ void web_console_reset_log_state(void)
         s_clients[i].sock = -1;
         s_clients[i].send_failures = 0;
     }
+    s_deflate_clients = 0;
     if (locked) xSemaphoreGive(s_clients_mutex);
 }
 
+bool web_console_log_has_clients(void)
+{
+    for (int i = 0; i < CONFIG_IAQ_WEB_CONSOLE_MAX_LOG_CLIENTS; ++i) {
+        if (s_clients[i].active) return true;
+    }
+    return false;
+}
+
 static void send_chunk_to_clients(const char *data, size_t len)
 {
     httpd_handle_t server = web_console_get_server();
@@ -193,21 +216,47 @@ static void send_chunk_to_clients(const char *data, size_t len)
         .len = len
     };
 
-    if (!s_clients_mutex) return;
+    /* Compress outside the clients mutex; only this task feeds the stream */
+    uint8_t *zframe = NULL;
+    size_t zframe_len = 0;
+    if (s_deflate_clients > 0) {
+        (void)ws_deflate_compress(&s_log_deflate, data, len, &zframe, &zframe_len);
+    } else {
+        ws_deflate_release(&s_log_deflate);
+    }
+    httpd_ws_frame_t zfrm = { .type = HTTPD_WS_TYPE_BINARY, .payload = zframe, .len = zframe_len };
+    const bool zreset = zframe && (zframe[0] & WS_DEFLATE_FLAG_RESET);
+
+    if (!s_clients_mutex) { free(zframe); return; }
     if (xSemaphoreTake(s_clients_mutex, pdMS_TO_TICKS(WC_MUTEX_TIMEOUT_MS)) != pdTRUE) {
         ESP_LOGE(TAG, "Clients mutex timeout in send_chunk");
+        free(zframe);
         return;
     }
     for (int i = 0; i < CONFIG_IAQ_WEB_CONSOLE_MAX_LOG_CLIENTS; ++i) {
         if (!s_clients[i].active) continue;
-        esp_err_t err = httpd_ws_send_frame_async(server, s_clients[i].sock, &frame);
+        /* A client joins the shared stream at its next RESET frame; until
+         * then (and for small batches) it gets plain text */
+        httpd_ws_frame_t *f = &frame;
+        if (zframe && s_clients[i].deflate) {
+            if (zreset) s_clients[i].synced = true;
+            if (s_clients[i].synced) f = &zfrm;
+        }
+        esp_err_t err = httpd_ws_send_frame_async(server, s_clients[i].sock, f);
         if (err != ESP_OK) {
             s_clients[i].send_failures++;
+            if (f == &zfrm) {
+                /* The client missed part of the shared stream and can no
+                 * longer inflate it: plain text until the next RESET frame */
+                s_clients[i].synced = false;
+                ws_deflate_reset(&s_log_deflate);
+            }
             if (s_clients[i].send_failures >= 3) {
                 ESP_LOGW(TAG, "Dropping log client %d (send failures)", s_clients[i].sock);
                 /* Don't call httpd_sess_trigger_close - the session may already be
                  * closing (e.g., client disconnect). Just mark inactive and let
                  * httpd handle the socket cleanup. */
+                if (s_clients[i].deflate) s_deflate_clients--;
                 s_clients[i].active = false;
             }
         } else {
@@ -215,6 +264,7 @@ static void send_chunk_to_clients(const char *data, size_t len)
         }
     }
     xSemaphoreGive(s_clients_mutex);
+    free(zframe);
 }
 
 static void dump_history_to_client(int sock, size_t history_end)
@@ -400,6 +450,11 @@ ssize_t __wrap__write_r(struct _reent *r, int fd, const void *data, size_t size)
     /* Call the original _write_r first to preserve behavior. */
     ssize_t ret = __real__write_r(r, fd, data, size);
 
+    /* Command output goes to the issuing console session instead. */
+    if ((fd == STDOUT_FILENO || fd == STDERR_FILENO) && web_console_console_capture(data, size)) {
+        return ret;
+    }
+
     /* Tee stdout/stderr into ring buffer. */
     if (fd == STDOUT_FILENO || fd == STDERR_FILENO) {
         /* Early boot (before mutex created): single-threaded, write directly.
@@ -423,6 +478,9 @@ esp_err_t web_console_log_init(void)
     s_ring_mutex = xSemaphoreCreateMutex();
     s_clients_mutex = xSemaphoreCreateMutex();
     s_notify_queue = xQueueCreate(4, sizeof(uint8_t));
+    if (!s_log_deflate.lock && ws_deflate_init(&s_log_deflate, true) != ESP_OK) {
+        ESP_LOGW(TAG, "Log stream compression unavailable");
+    }
     if (!s_ring_mutex || !s_clients_mutex || !s_notify_queue) {
         ESP_LOGE(TAG, "Failed to create log primitives");
         web_console_log_stop();
@@ -493,7 +551,7 @@ static esp_err_t ws_log_handler(httpd_req_t *req)
 
         /* Add client to list BEFORE sending history, so broadcast task
          * will include this client for any new logs that arrive. */
-        if (!log_clients_add(sock)) {
+        if (!log_clients_add(sock, ws_deflate_requested(req))) {
             httpd_ws_frame_t closefrm = { .type = HTTPD_WS_TYPE_CLOSE };
             (void)httpd_ws_send_frame(req, &closefrm);
             return ESP_FAIL;
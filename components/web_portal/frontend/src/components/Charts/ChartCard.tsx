@@ -1,4 +1,4 @@
-import { useMemo, type ElementType } from 'react';
+import { useLayoutEffect, useMemo, useRef, useState, type ElementType } from 'react';
 import Box from '@mui/material/Box';
 import Card from '@mui/material/Card';
 import CardContent from '@mui/material/CardContent';
@@ -25,6 +25,8 @@ import {
   computeYAxisBounds,
   formatAxisTick,
   createRelativeTimeFormatter,
+  fillSeriesData,
+  hasFiniteValue,
   resolvePaletteColor,
 } from './utils/chartUtils';
 
@@ -44,6 +46,16 @@ const METRIC_ICON_MAP: Record<MetricKey, ElementType> = {
   pm10_ugm3: GrainIcon,
 };
 
+/** One set of chart-ready columns, refilled in place */
+interface ColumnSlot {
+  x: number[];
+  avg: (number | null)[];
+  min: (number | null)[];
+  band: (number | null)[];
+}
+
+const createColumnSlot = (): ColumnSlot => ({ x: [], avg: [], min: [], band: [] });
+
 interface ChartCardProps {
   metric: MetricKey;
   range: RangeKey;
@@ -55,9 +67,12 @@ export function ChartCard({ metric, range, height = 220 }: ChartCardProps) {
   const config = METRICS[metric];
   const rangeConfig = RANGES[range];
   const { data, isLoading, windowEnd } = useChartData(metric, range);
-  const hasData = data.some((point) => point.avg != null);
+  const hasData = useMemo(() => hasFiniteValue(data.avg), [data]);
   const showMinMax = rangeConfig.useHistory && rangeConfig.showMinMax === true;
-  const hasMinMax = showMinMax && data.some((point) => point.min != null && point.max != null);
+  const hasMinMax = useMemo(
+    () => showMinMax && data.max != null && hasFiniteValue(data.min),
+    [data, showMinMax]
+  );
 
   // Relative time formatter for fixed axis labels
   const axisFormatter = useMemo(
@@ -66,31 +81,36 @@ export function ChartCard({ metric, range, height = 220 }: ChartCardProps) {
   );
 
   const { min, max } = useMemo(
-    () => computeYAxisBounds(data, config, hasMinMax),
+    () => computeYAxisBounds([data], config, hasMinMax),
     [data, config, hasMinMax]
   );
-  // Use relative time values so the axis stays fixed at -range..0
-  const dataset = useMemo(
-    () => data.map((point) => {
-      const row: { t: number; avg: number | null; min?: number | null; band?: number | null } = {
-        t: point.time - windowEnd,
-        avg: point.avg,
-      };
-      if (hasMinMax) {
-        const minValue = typeof point.min === 'number' && Number.isFinite(point.min) ? point.min : null;
-        const maxValue = typeof point.max === 'number' && Number.isFinite(point.max) ? point.max : null;
-        row.min = minValue;
-        if (minValue != null && maxValue != null) {
-          const diff = maxValue - minValue;
-          row.band = Number.isFinite(diff) && diff >= 0 ? diff : null;
-        } else {
-          row.band = null;
-        }
-      }
-      return row;
-    }),
-    [data, hasMinMax, windowEnd]
-  );
+  // Two column sets alternate between commits: an update refills the one the
+  // chart is not showing, so the chart sees new arrays without allocating any.
+  // The shown slot only changes on commit, so StrictMode re-renders refill the same one.
+  const [slots] = useState<[ColumnSlot, ColumnSlot]>(() => [createColumnSlot(), createColumnSlot()]);
+  const shownSlot = useRef(0);
+  // Relative time keeps the axis fixed at -range..0
+  const columns = useMemo(() => {
+    const slot = shownSlot.current ^ 1;
+    const out = slots[slot];
+    const n = data.time.length;
+    if (out.x.length !== n) out.x.length = n;
+    for (let i = 0; i < n; i++) out.x[i] = data.time[i] - windowEnd;
+    const avg = fillSeriesData(data.avg, out.avg);
+    if (!hasMinMax || !data.min || !data.max) {
+      return { slot, x: out.x, avg, min: null, band: null };
+    }
+    const min = fillSeriesData(data.min, out.min);
+    if (out.band.length !== n) out.band.length = n;
+    for (let i = 0; i < n; i++) {
+      const diff = data.max[i] - data.min[i];
+      out.band[i] = diff >= 0 ? diff : null; // NaN (gap) fails the comparison
+    }
+    return { slot, x: out.x, avg, min, band: out.band };
+  }, [data, hasMinMax, slots, windowEnd]);
+  useLayoutEffect(() => {
+    shownSlot.current = columns.slot;
+  }, [columns]);
   const xTicks = useMemo(() => buildXAxisTicks(rangeConfig.seconds), [rangeConfig.seconds]);
 
   const curve: 'monotoneX' = 'monotoneX';
@@ -103,7 +123,7 @@ export function ChartCard({ metric, range, height = 220 }: ChartCardProps) {
       return value.toFixed(config.decimals);
     };
     const baseSeries: LineSeries[] = [{
-      dataKey: 'avg',
+      data: columns.avg,
       label: 'Avg',
       color: seriesColor,
       curve,
@@ -111,9 +131,11 @@ export function ChartCard({ metric, range, height = 220 }: ChartCardProps) {
       disableHighlight: false,
       valueFormatter: (value: number | null) => formatValue(value),
     }];
-    if (!hasMinMax) return baseSeries;
+    if (!columns.min || !columns.band) return baseSeries;
+    const minData = columns.min;
+    const bandData = columns.band;
     const bandSeries: LineSeries = {
-      dataKey: 'band',
+      data: bandData,
       stack: 'range',
       stackOrder: 'reverse',
       area: true,
@@ -123,14 +145,14 @@ export function ChartCard({ metric, range, height = 220 }: ChartCardProps) {
       disableHighlight: true,
       label: 'Max',
       valueFormatter: (_value: number | null, context: { dataIndex: number }) => {
-        const row = dataset[context.dataIndex];
-        if (!row || row.min == null || row.band == null) return null;
-        const maxValue = row.min + row.band;
-        return formatValue(maxValue);
+        const minValue = minData[context.dataIndex];
+        const bandValue = bandData[context.dataIndex];
+        if (minValue == null || bandValue == null) return null;
+        return formatValue(minValue + bandValue);
       },
     };
     const minSeries: LineSeries = {
-      dataKey: 'min',
+      data: minData,
       stack: 'range',
       color: bandColor,
       curve,
@@ -140,7 +162,7 @@ export function ChartCard({ metric, range, height = 220 }: ChartCardProps) {
       valueFormatter: (value: number | null) => formatValue(value),
     };
     return [bandSeries, ...baseSeries, minSeries];
-  }, [bandColor, config.decimals, curve, dataset, hasMinMax, seriesColor]);
+  }, [bandColor, config.decimals, curve, columns, seriesColor]);
 
   const yAxis = useMemo(() => [{
     ...CHART_LAYOUT.yAxis,
@@ -168,10 +190,9 @@ export function ChartCard({ metric, range, height = 220 }: ChartCardProps) {
           <LineChart
             skipAnimation
             disableAxisListener
-            dataset={dataset}
             xAxis={[{
               ...CHART_LAYOUT.xAxis,
-              dataKey: 't',
+              data: columns.x,
               min: -rangeConfig.seconds,
               max: 0,
               scaleType: 'linear',
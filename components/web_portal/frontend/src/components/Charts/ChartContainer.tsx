@@ -24,7 +24,7 @@ export function ChartContainer() {
   };
 
   const rangeOptions = useMemo(
-    () => (['1m', '5m', '1h', '1d', '7d'] as RangeKey[]).map((key) => ({
+    () => (['1m', '5m', '1h', '1d', '7d', '30d', '365d'] as RangeKey[]).map((key) => ({
       key,
       label: RANGES[key].label,
     })),
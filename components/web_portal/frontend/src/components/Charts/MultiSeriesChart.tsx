@@ -16,7 +16,9 @@ import {
   computeYAxisBounds,
   formatAxisTick,
   createRelativeTimeFormatter,
+  hasFiniteValue,
   resolvePaletteColor,
+  toSeriesData,
 } from './utils/chartUtils';
 
 interface MultiSeriesChartProps {
@@ -47,7 +49,7 @@ export function MultiSeriesChart({
 
   // Use PM2.5 as the base for x-axis (most common reference)
   const baseData = pm25.data;
-  const hasData = baseData.some((point) => point.avg != null);
+  const hasData = useMemo(() => hasFiniteValue(baseData.avg), [baseData]);
   const windowEnd = pm25.windowEnd;
   const isLoading = seriesConfigs.some((entry) => entry.chart.isLoading);
 
@@ -58,7 +60,7 @@ export function MultiSeriesChart({
   );
 
   const combinedData = useMemo(
-    () => seriesConfigs.flatMap((entry) => entry.chart.data),
+    () => seriesConfigs.map((entry) => entry.chart.data),
     [seriesConfigs]
   );
   const pmYAxisConfig = useMemo<MetricConfig>(() => ({
@@ -77,34 +79,34 @@ export function MultiSeriesChart({
     [combinedData, pmYAxisConfig]
   );
 
-  // Use relative time values so the axis stays fixed at -range..0
-  const dataset = useMemo(() => {
-    const rows = new Array(baseData.length);
-    for (let i = 0; i < baseData.length; i++) {
-      const row: Record<string, number | null> & { t: number } = {
-        t: baseData[i].time - windowEnd,
-      };
-      for (const entry of seriesConfigs) {
-        row[entry.metric] = entry.chart.data[i]?.avg ?? null;
-      }
-      rows[i] = row;
-    }
-    return rows;
-  }, [baseData, seriesConfigs, windowEnd]);
+  // Relative time keeps the axis fixed at -range..0; all series share PM2.5's x column
+  const xData = useMemo(() => {
+    const n = baseData.time.length;
+    const x = new Array<number>(n);
+    for (let i = 0; i < n; i++) x[i] = baseData.time[i] - windowEnd;
+    return x;
+  }, [baseData, windowEnd]);
   const xTicks = useMemo(() => buildXAxisTicks(rangeConfig.seconds), [rangeConfig.seconds]);
 
   // Build series configuration
   const curve: 'monotoneX' = 'monotoneX';
 
   const series = useMemo(() => {
-    return seriesConfigs.map((entry) => ({
-      dataKey: entry.metric,
-      label: entry.config.label,
-      color: resolvePaletteColor(theme, entry.config.color),
-      curve,
-      showMark: false,
-    } as const));
-  }, [seriesConfigs, theme, curve]);
+    const n = baseData.time.length;
+    return seriesConfigs.map((entry) => {
+      /* Pad or trim to the base length so every series aligns with xData */
+      const avg = entry.chart.data.avg;
+      const aligned = avg.length === n ? avg : new Float32Array(n).fill(NaN);
+      if (aligned !== avg) aligned.set(avg.subarray(0, Math.min(n, avg.length)));
+      return {
+        data: toSeriesData(aligned),
+        label: entry.config.label,
+        color: resolvePaletteColor(theme, entry.config.color),
+        curve,
+        showMark: false,
+      } as const;
+    });
+  }, [baseData, seriesConfigs, theme, curve]);
 
   const yAxis = useMemo(() => [{
     ...CHART_LAYOUT.yAxis,
@@ -150,10 +152,9 @@ export function MultiSeriesChart({
             skipAnimation
             disableAxisListener
             hideLegend
-            dataset={dataset}
             xAxis={[{
               ...CHART_LAYOUT.xAxis,
-              dataKey: 't',
+              data: xData,
               min: -rangeConfig.seconds,
               max: 0,
               scaleType: 'linear',
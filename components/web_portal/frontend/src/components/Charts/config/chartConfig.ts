@@ -187,7 +187,7 @@ export const SINGLE_SERIES_CHARTS: MetricKey[] = [
 
 export const PM_SERIES: MetricKey[] = ['pm1_ugm3', 'pm25_ugm3', 'pm10_ugm3'];
 
-export type RangeKey = '1m' | '5m' | '1h' | '1d' | '7d';
+export type RangeKey = '1m' | '5m' | '1h' | '1d' | '7d' | '30d' | '365d';
 
 export const RANGES: Record<RangeKey, {
   seconds: number;
@@ -223,4 +223,21 @@ export const RANGES: Record<RangeKey, {
     historyRefreshSeconds: 150,
     showMinMax: true,
   },
+  /* Served from the hourly flash tier; it only changes once an hour */
+  '30d': {
+    seconds: 2592000,
+    label: '30 days',
+    useHistory: true,
+    mergeLiveTail: false,
+    historyRefreshSeconds: 3600,
+    showMinMax: true,
+  },
+  '365d': {
+    seconds: 31536000,
+    label: '1 year',
+    useHistory: true,
+    mergeLiveTail: false,
+    historyRefreshSeconds: 3600,
+    showMinMax: true,
+  },
 };
@@ -2,44 +2,47 @@ import { useMemo } from 'react';
 import { useAtomValue } from 'jotai';
 import { buffersVersionAtom } from '../../../store/atoms';
 import { getBuffers, getLatestTimestamp } from '../../../utils/streamBuffers';
+import { HISTORY_SENTINEL } from '../../../store/historyCache';
 import { RANGES, type MetricKey, type RangeKey } from '../config/chartConfig';
 import { useHistoryQuery } from './useHistoryQuery';
-import type { ChartDataPoint } from '../types';
-import { windowToRange } from '../utils/chartUtils';
-
-function binarySearchStart(arr: number[], target: number): number {
-  let left = 0;
-  let right = arr.length;
-  while (left < right) {
-    const mid = (left + right) >>> 1;
-    if (arr[mid] < target) {
-      left = mid + 1;
-    } else {
-      right = mid;
-    }
-  }
-  return left;
-}
+import { EMPTY_CHART_COLUMNS, type ChartColumns } from '../types';
+import { lowerBound, windowColumns } from '../utils/chartUtils';
 
-function buildLiveData(metric: MetricKey, rangeSeconds: number): ChartDataPoint[] {
+/* Live columns are views into the stream rings (no copy per update) */
+function buildLiveColumns(metric: MetricKey, rangeSeconds: number): ChartColumns {
   const { x, y } = getBuffers(metric);
-  if (x.length === 0) return [];
+  if (x.length === 0) return EMPTY_CHART_COLUMNS;
   const end = x[x.length - 1];
-  const start = end - rangeSeconds;
-  const startIdx = binarySearchStart(x, start);
-
-  const points: ChartDataPoint[] = [];
-  for (let i = startIdx; i < x.length; i++) {
-    points.push({
-      time: x[i],
-      avg: y[i] == null || Number.isNaN(y[i]) ? null : (y[i] as number),
-    });
+  const startIdx = lowerBound(x, end - rangeSeconds);
+  return { time: x.subarray(startIdx), avg: y.subarray(startIdx), min: null, max: null };
+}
+
+/* Append live samples (no min/max) after history columns */
+function concatColumns(history: ChartColumns, live: ChartColumns, liveFrom: number): ChartColumns {
+  const h = history.time.length;
+  const l = live.time.length - liveFrom;
+  if (l <= 0) return history;
+
+  const time = new Float64Array(h + l);
+  const avg = new Float32Array(h + l);
+  time.set(history.time);
+  time.set(live.time.subarray(liveFrom), h);
+  avg.set(history.avg);
+  avg.set(live.avg.subarray(liveFrom), h);
+
+  let min: Float32Array | null = null;
+  let max: Float32Array | null = null;
+  if (history.min && history.max) {
+    min = new Float32Array(h + l).fill(NaN);
+    max = new Float32Array(h + l).fill(NaN);
+    min.set(history.min);
+    max.set(history.max);
   }
-  return points;
+  return { time, avg, min, max };
 }
 
 export function useChartData(metric: MetricKey, range: RangeKey): {
-  data: ChartDataPoint[];
+  data: ChartColumns;
   isLoading: boolean;
   windowEnd: number;
 } {
@@ -50,7 +53,7 @@ export function useChartData(metric: MetricKey, range: RangeKey): {
   const fallbackNow = useMemo(() => Math.floor(Date.now() / 1000), []);
 
   const liveData = useMemo(
-    () => buildLiveData(metric, rangeConfig.seconds),
+    () => buildLiveColumns(metric, rangeConfig.seconds),
     [buffersVersion, metric, rangeConfig.seconds]
   );
 
@@ -61,29 +64,35 @@ export function useChartData(metric: MetricKey, range: RangeKey): {
     latestLiveTime
   );
 
+  /* Dequantize once per response; typed arrays keep 7-day views compact */
   const historyData = useMemo(() => {
     if (!historyResponse) return null;
     const metricHistory = historyResponse.metrics[metric];
     if (!metricHistory) return null;
 
-    const { scale, offset, buckets } = metricHistory;
+    const { scale, offset } = metricHistory;
+    const count = historyResponse.bucket_count;
     const historyEndTime = historyResponse.end_time;
-
-    const points: ChartDataPoint[] = buckets.map((bucket, index) => {
-      const time = historyEndTime - (buckets.length - index - 1) * historyResponse.resolution_s;
-      if (!bucket) {
-        return { time, avg: null, min: null, max: null };
+    const resolution = historyResponse.resolution_s;
+
+    const time = new Float64Array(count);
+    const avg = new Float32Array(count);
+    const min = new Float32Array(count);
+    const max = new Float32Array(count);
+    for (let i = 0; i < count; i++) {
+      time[i] = historyEndTime - (count - i - 1) * resolution;
+      if (metricHistory.min[i] === HISTORY_SENTINEL) {
+        avg[i] = NaN;
+        min[i] = NaN;
+        max[i] = NaN;
+        continue;
       }
-      const [min, max, avg] = bucket;
-      return {
-        time,
-        avg: (avg - offset) / scale,
-        min: (min - offset) / scale,
-        max: (max - offset) / scale,
-      };
-    });
-
-    return { points, historyEndTime };
+      avg[i] = (metricHistory.avg[i] - offset) / scale;
+      min[i] = (metricHistory.min[i] - offset) / scale;
+      max[i] = (metricHistory.max[i] - offset) / scale;
+    }
+
+    return { columns: { time, avg, min, max } as ChartColumns, historyEndTime };
   }, [historyResponse, metric]);
 
   const windowEnd = useMemo(() => {
@@ -99,20 +108,20 @@ export function useChartData(metric: MetricKey, range: RangeKey): {
     if (!rangeConfig.useHistory) {
       return liveData;
     }
-    if (!historyResponse) return [];
+    if (!historyResponse) return EMPTY_CHART_COLUMNS;
 
     if (!historyData) {
-      return windowToRange(liveData, windowEnd, rangeConfig.seconds);
+      return windowColumns(liveData, windowEnd, rangeConfig.seconds);
     }
 
     if (!mergeLiveTail) {
-      return windowToRange(historyData.points, windowEnd, rangeConfig.seconds);
+      return windowColumns(historyData.columns, windowEnd, rangeConfig.seconds);
     }
 
     // Use >= to avoid 1-point gap at boundary between history and live data
-    const liveTail = liveData.filter((point) => point.time >= historyData.historyEndTime);
-    const combined = [...historyData.points, ...liveTail];
-    return windowToRange(combined, windowEnd, rangeConfig.seconds);
+    const liveFrom = lowerBound(liveData.time, historyData.historyEndTime);
+    const combined = concatColumns(historyData.columns, liveData, liveFrom);
+    return windowColumns(combined, windowEnd, rangeConfig.seconds);
   }, [
     historyResponse,
     historyData,
@@ -1,84 +1,13 @@
 import { useEffect, useState } from 'react';
 import { useAtom } from 'jotai';
-import { METRICS, RANGES, type MetricKey, type RangeKey } from '../config/chartConfig';
+import { METRICS, RANGES, type RangeKey } from '../config/chartConfig';
 import { historyCacheAtom, historyLoadingAtom, type HistoryResponse } from '../../../store/historyCache';
 import { STREAM_BUFFER_SECONDS } from '../../../utils/streamBuffers';
+import { decodeHistory } from '../utils/historyWorker';
 
 const inFlightRanges = new Set<RangeKey>();
-
-/* Binary protocol constants */
-const HIST_BIN_MAGIC = 0x01514149;
-const SENTINEL = -32768;
-const MAX_BUCKETS = 10080; /* Sanity limit, not tied to backend config */
-
-const METRIC_ID_TO_KEY: MetricKey[] = [
-  'temp_c', 'rh_pct', 'co2_ppm', 'pressure_hpa',
-  'pm1_ugm3', 'pm25_ugm3', 'pm10_ugm3',
-  'voc_index', 'nox_index', 'mold_risk',
-  'aqi', 'comfort_score', 'iaq_score',
-];
-
-function decodeHistoryBinary(buffer: ArrayBuffer): HistoryResponse {
-  const view = new DataView(buffer);
-  const len = buffer.byteLength;
-
-  if (len < 16) {
-    throw new Error('Response too short for header');
-  }
-
-  const magic = view.getUint32(0, true);
-  if (magic !== HIST_BIN_MAGIC) {
-    throw new Error(`Invalid magic: 0x${magic.toString(16)}`);
-  }
-
-  const resolution_s = view.getUint32(4, true);
-  const end_time = view.getUint32(8, true);
-  const metricCount = view.getUint16(12, true);
-  const bucketCount = view.getUint16(14, true);
-
-  if (metricCount === 0 || metricCount > METRIC_ID_TO_KEY.length) {
-    throw new Error(`Invalid metric count: ${metricCount}`);
-  }
-  if (bucketCount > MAX_BUCKETS) {
-    throw new Error(`Invalid bucket count: ${bucketCount}`);
-  }
-
-  const expectedLen = 16 + 6 * metricCount + 6 * metricCount * bucketCount;
-  if (!Number.isSafeInteger(expectedLen) || len !== expectedLen) {
-    throw new Error(`Invalid length: got ${len}, expected ${expectedLen}`);
-  }
-
-  let offset = 16;
-
-  /* Read metric descriptors */
-  const descriptors: Array<{ key: MetricKey; scale: number; offset: number }> = [];
-  for (let i = 0; i < metricCount; i++) {
-    const id = view.getUint8(offset);
-    if (id >= METRIC_ID_TO_KEY.length) {
-      throw new Error(`Invalid metric ID: ${id}`);
-    }
-    offset += 2; // id + flags
-    const scale = view.getInt16(offset, true); offset += 2;
-    const metricOffset = view.getInt16(offset, true); offset += 2;
-    descriptors.push({ key: METRIC_ID_TO_KEY[id], scale, offset: metricOffset });
-  }
-
-  /* Read bucket data */
-  const metrics = {} as HistoryResponse['metrics'];
-  for (const desc of descriptors) {
-    const buckets: ([number, number, number] | null)[] = [];
-    for (let b = 0; b < bucketCount; b++) {
-      const min = view.getInt16(offset, true);
-      const max = view.getInt16(offset + 2, true);
-      const avg = view.getInt16(offset + 4, true);
-      offset += 6;
-      buckets.push(min === SENTINEL ? null : [min, max, avg]);
-    }
-    metrics[desc.key] = { scale: desc.scale, offset: desc.offset, buckets };
-  }
-
-  return { resolution_s, end_time, metrics };
-}
+/* Retry-After from a 429: no refetch of that range before this time (ms) */
+const retryNotBefore = new Map<RangeKey, number>();
 
 interface UseHistoryQueryResult {
   data: HistoryResponse | null;
@@ -107,6 +36,7 @@ export function useHistoryQuery(range: RangeKey | null, latestLiveTime: number |
     if (!range || !shouldFetch || loading.has(range)) return;
     if (cached && !isStale) return;
     if (inFlightRanges.has(range)) return;
+    if ((retryNotBefore.get(range) ?? 0) > Date.now()) return;
 
     const fetchHistory = async () => {
       inFlightRanges.add(range);
@@ -118,11 +48,16 @@ export function useHistoryQuery(range: RangeKey | null, latestLiveTime: number |
           range,
         });
         const res = await fetch(`/api/v1/history?${params}`);
+        if (res.status === 429) {
+          const waitSeconds = Number(res.headers.get('Retry-After')) || 5;
+          retryNotBefore.set(range, Date.now() + waitSeconds * 1000);
+        }
         if (!res.ok) {
           throw new Error(`History request failed (${res.status})`);
         }
         const buffer = await res.arrayBuffer();
-        const response = decodeHistoryBinary(buffer);
+        /* Decoded off the UI thread into columnar typed arrays */
+        const response = await decodeHistory(buffer);
         setCache((prev: Map<RangeKey, { response: HistoryResponse; fetchedAt: number }>) =>
           new Map(prev).set(range, { response, fetchedAt: Date.now() })
         );
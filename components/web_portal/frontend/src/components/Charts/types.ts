@@ -1,6 +1,17 @@
-export interface ChartDataPoint {
-  time: number; // Unix timestamp (seconds)
-  avg: number | null;
-  min?: number | null;
-  max?: number | null;
+/**
+ * Columnar chart data. All arrays have the same length; NaN marks a gap.
+ * Arrays may be subarray views into shared buffers: treat them as read-only.
+ */
+export interface ChartColumns {
+  time: Float64Array; // Unix timestamps (seconds), ascending
+  avg: Float32Array;
+  min: Float32Array | null;
+  max: Float32Array | null;
 }
+
+export const EMPTY_CHART_COLUMNS: ChartColumns = {
+  time: new Float64Array(0),
+  avg: new Float32Array(0),
+  min: null,
+  max: null,
+};
@@ -1,6 +1,6 @@
 import type { Theme } from '@mui/material/styles';
 import type { MetricConfig } from '../config/chartConfig';
-import type { ChartDataPoint } from '../types';
+import type { ChartColumns } from '../types';
 
 export function resolvePaletteColor(theme: Theme, path: string): string {
   const [paletteKey, shade] = path.split('.');
@@ -32,6 +32,7 @@ export function createRelativeTimeFormatter(rangeSeconds: number) {
       const m = Math.round((delta % 3600) / 60);
       return m > 0 ? `-${h}h${m}m` : `-${h}h`;
     }
+    if (rangeSeconds > 604800) return `-${Math.round(delta / 86400)}d`;
     const d = Math.floor(delta / 86400);
     const h = Math.round((delta % 86400) / 3600);
     return h > 0 ? `-${d}d${h}h` : `-${d}d`;
@@ -44,30 +45,32 @@ export function formatAxisTick(value: number, defaultTickLabel: string): string
 }
 
 /**
- * Computes Y-axis bounds using single-pass min/max calculation.
- * Avoids spread operator which can cause stack overflow on large arrays.
+ * Computes Y-axis bounds using single-pass min/max calculation over typed columns.
+ * NaN entries (gaps) are skipped.
  */
 export function computeYAxisBounds(
-  data: ChartDataPoint[],
+  series: ChartColumns[],
   config: MetricConfig,
   includeMinMax: boolean = false
 ): { min: number; max: number } {
-  // Single-pass min/max calculation - O(n) without stack overflow risk
+  // Single-pass min/max calculation - O(n), no intermediate arrays
   let dataMin = Infinity;
   let dataMax = -Infinity;
 
-  const addValue = (value: number | null | undefined) => {
-    if (value == null || !Number.isFinite(value)) return;
-    if (value < dataMin) dataMin = value;
-    if (value > dataMax) dataMax = value;
+  const addColumn = (values: Float32Array | null) => {
+    if (!values) return;
+    for (let i = 0; i < values.length; i++) {
+      const value = values[i];
+      if (value < dataMin) dataMin = value;
+      if (value > dataMax) dataMax = value;
+    }
   };
 
-  for (let i = 0; i < data.length; i++) {
-    const point = data[i];
-    addValue(point.avg);
+  for (const columns of series) {
+    addColumn(columns.avg);
     if (includeMinMax) {
-      addValue(point.min);
-      addValue(point.max);
+      addColumn(columns.min);
+      addColumn(columns.max);
     }
   }
 
@@ -105,13 +108,62 @@ export function computeYAxisBounds(
   return { min, max };
 }
 
-export function windowToRange(
-  data: ChartDataPoint[],
+/** First index with arr[i] >= target (arr ascending) */
+export function lowerBound(arr: ArrayLike<number>, target: number): number {
+  let left = 0;
+  let right = arr.length;
+  while (left < right) {
+    const mid = (left + right) >>> 1;
+    if (arr[mid] < target) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+/** Restrict columns to [windowEnd - rangeSeconds, windowEnd] without copying */
+export function windowColumns(
+  columns: ChartColumns,
   windowEnd: number,
   rangeSeconds: number
-): ChartDataPoint[] {
-  const windowStart = windowEnd - rangeSeconds;
-  return data.filter((point) => point.time >= windowStart && point.time <= windowEnd);
+): ChartColumns {
+  const from = lowerBound(columns.time, windowEnd - rangeSeconds);
+  const to = lowerBound(columns.time, windowEnd + 1e-6);
+  return {
+    time: columns.time.subarray(from, to),
+    avg: columns.avg.subarray(from, to),
+    min: columns.min ? columns.min.subarray(from, to) : null,
+    max: columns.max ? columns.max.subarray(from, to) : null,
+  };
+}
+
+/** True if any entry is a real value (not a NaN gap) */
+export function hasFiniteValue(values: Float32Array | null): boolean {
+  if (!values) return false;
+  for (let i = 0; i < values.length; i++) {
+    if (!Number.isNaN(values[i])) return true;
+  }
+  return false;
+}
+
+/** Convert a typed column to the (number | null)[] series shape MUI expects */
+export function toSeriesData(values: Float32Array | Float64Array): (number | null)[] {
+  return fillSeriesData(values, new Array<number | null>(values.length));
+}
+
+/** toSeriesData into an existing array, resized to fit */
+export function fillSeriesData(
+  values: Float32Array | Float64Array,
+  out: (number | null)[]
+): (number | null)[] {
+  if (out.length !== values.length) out.length = values.length;
+  for (let i = 0; i < values.length; i++) {
+    const value = values[i];
+    out[i] = Number.isNaN(value) ? null : value;
+  }
+  return out;
 }
 
 export function buildXAxisTicks(rangeSeconds: number): number[] | undefined {
@@ -121,6 +173,12 @@ export function buildXAxisTicks(rangeSeconds: number): number[] | undefined {
   if (rangeSeconds === 604800) {
     return buildTickSeries(rangeSeconds, 86400);
   }
+  if (rangeSeconds === 2592000) {
+    return buildTickSeries(rangeSeconds, 432000);
+  }
+  if (rangeSeconds === 31536000) {
+    return buildTickSeries(rangeSeconds, 2592000);
+  }
   return undefined;
 }
 
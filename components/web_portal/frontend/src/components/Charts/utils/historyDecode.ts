@@ -0,0 +1,135 @@
+import type { MetricKey } from '../config/chartConfig';
+import type { HistoryMetricColumns, HistoryResponse } from '../../../store/historyCache';
+import { METRIC_KEYS } from '../../../utils/metricKeys';
+
+/* Binary protocol constants (see web_portal.c hist_bin_header_t) */
+const HIST_BIN_MAGIC = 0x01514149;
+const DESC_FLAG_SUSPECT_BITMAP = 0x01;
+const DESC_FLAG_EXT_STATS = 0x02; /* 14-byte buckets: + stddev, first, last, tw_avg */
+const MAX_BUCKETS = 10080; /* Sanity limit, not tied to backend config */
+
+/* Wire metric ids come from the shared firmware metric table */
+const METRIC_ID_TO_KEY: readonly MetricKey[] = METRIC_KEYS;
+
+/**
+ * Decode an `application/x-iaq-history` body into columnar Int16Arrays.
+ * All value columns share one backing buffer and all suspect bitmaps share
+ * another, so a worker can transfer the whole result with two buffers.
+ */
+export function decodeHistoryBinary(buffer: ArrayBuffer): HistoryResponse {
+  const view = new DataView(buffer);
+  const len = buffer.byteLength;
+
+  if (len < 16) {
+    throw new Error('Response too short for header');
+  }
+
+  const magic = view.getUint32(0, true);
+  if (magic !== HIST_BIN_MAGIC) {
+    throw new Error(`Invalid magic: 0x${magic.toString(16)}`);
+  }
+
+  const resolution_s = view.getUint32(4, true);
+  const end_time = view.getUint32(8, true);
+  const metricCount = view.getUint16(12, true);
+  const bucketCount = view.getUint16(14, true);
+
+  if (metricCount === 0 || metricCount > METRIC_ID_TO_KEY.length) {
+    throw new Error(`Invalid metric count: ${metricCount}`);
+  }
+  if (bucketCount > MAX_BUCKETS) {
+    throw new Error(`Invalid bucket count: ${bucketCount}`);
+  }
+
+  if (len < 16 + 6 * metricCount) {
+    throw new Error('Response too short for descriptors');
+  }
+
+  let offset = 16;
+
+  /* Read metric descriptors */
+  const descriptors: Array<{ key: MetricKey; scale: number; offset: number; hasSuspect: boolean; hasExt: boolean }> = [];
+  for (let i = 0; i < metricCount; i++) {
+    const id = view.getUint8(offset);
+    if (id >= METRIC_ID_TO_KEY.length) {
+      throw new Error(`Invalid metric ID: ${id}`);
+    }
+    const flags = view.getUint8(offset + 1);
+    offset += 2; // id + flags
+    const scale = view.getInt16(offset, true); offset += 2;
+    const metricOffset = view.getInt16(offset, true); offset += 2;
+    descriptors.push({
+      key: METRIC_ID_TO_KEY[id],
+      scale,
+      offset: metricOffset,
+      hasSuspect: (flags & DESC_FLAG_SUSPECT_BITMAP) !== 0,
+      hasExt: (flags & DESC_FLAG_EXT_STATS) !== 0,
+    });
+  }
+
+  const bitmapLen = Math.ceil(bucketCount / 8);
+  const suspectMetrics = descriptors.filter((d) => d.hasSuspect).length;
+  const extMetrics = descriptors.filter((d) => d.hasExt).length;
+  const expectedLen = 16 + 6 * metricCount + 6 * metricCount * bucketCount + 8 * extMetrics * bucketCount +
+    bitmapLen * suspectMetrics;
+  if (!Number.isSafeInteger(expectedLen) || len !== expectedLen) {
+    throw new Error(`Invalid length: got ${len}, expected ${expectedLen}`);
+  }
+
+  /* De-interleave [min,max,avg(,stddev,first,last,tw_avg)] wire buckets into per-field columns */
+  const values = new Int16Array((3 * metricCount + 4 * extMetrics) * bucketCount);
+  const bitmaps = new Uint8Array(bitmapLen * suspectMetrics);
+  let bitmapOffset = 0;
+
+  let column = 0;
+  const nextColumn = () => values.subarray(bucketCount * column, bucketCount * ++column);
+
+  const metrics: HistoryResponse['metrics'] = {};
+  descriptors.forEach((desc) => {
+    const min = nextColumn();
+    const max = nextColumn();
+    const avg = nextColumn();
+    const columns: HistoryMetricColumns = { scale: desc.scale, offset: desc.offset, min, max, avg };
+    if (desc.hasExt) {
+      const ext = { stddev: nextColumn(), first: nextColumn(), last: nextColumn(), twAvg: nextColumn() };
+      for (let b = 0; b < bucketCount; b++) {
+        min[b] = view.getInt16(offset, true);
+        max[b] = view.getInt16(offset + 2, true);
+        avg[b] = view.getInt16(offset + 4, true);
+        ext.stddev[b] = view.getInt16(offset + 6, true);
+        ext.first[b] = view.getInt16(offset + 8, true);
+        ext.last[b] = view.getInt16(offset + 10, true);
+        ext.twAvg[b] = view.getInt16(offset + 12, true);
+        offset += 14;
+      }
+      columns.ext = ext;
+    } else {
+      for (let b = 0; b < bucketCount; b++) {
+        min[b] = view.getInt16(offset, true);
+        max[b] = view.getInt16(offset + 2, true);
+        avg[b] = view.getInt16(offset + 4, true);
+        offset += 6;
+      }
+    }
+    if (desc.hasSuspect) {
+      columns.suspect = bitmaps.subarray(bitmapOffset, bitmapOffset + bitmapLen);
+      columns.suspect.set(new Uint8Array(buffer, offset, bitmapLen));
+      bitmapOffset += bitmapLen;
+      offset += bitmapLen;
+    }
+    metrics[desc.key] = columns;
+  });
+
+  return { resolution_s, end_time, bucket_count: bucketCount, metrics };
+}
+
+/** Distinct backing buffers of a decoded response (for postMessage transfer) */
+export function historyTransferables(response: HistoryResponse): ArrayBuffer[] {
+  const buffers = new Set<ArrayBuffer>();
+  for (const columns of Object.values(response.metrics)) {
+    if (!columns) continue;
+    buffers.add(columns.avg.buffer as ArrayBuffer);
+    if (columns.suspect) buffers.add(columns.suspect.buffer as ArrayBuffer);
+  }
+  return [...buffers];
+}
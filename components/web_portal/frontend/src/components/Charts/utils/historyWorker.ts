@@ -0,0 +1,72 @@
+import { logger } from '../../../utils/logger';
+import type { HistoryResponse } from '../../../store/historyCache';
+import type { HistoryDecodeRequest, HistoryDecodeResult } from '../workers/historyDecoder.worker';
+import { decodeHistoryBinary } from './historyDecode';
+
+type Pending = { resolve: (r: HistoryResponse) => void; reject: (e: Error) => void };
+
+let worker: Worker | null = null;
+let workerFailed = false;
+let nextId = 1;
+const pending = new Map<number, Pending>();
+
+function failAll(error: Error): void {
+  pending.forEach((p) => p.reject(error));
+  pending.clear();
+}
+
+function getWorker(): Worker | null {
+  if (worker || workerFailed) return worker;
+  if (typeof Worker === 'undefined') {
+    workerFailed = true;
+    return null;
+  }
+  try {
+    worker = new Worker(new URL('../workers/historyDecoder.worker.ts', import.meta.url), { type: 'module' });
+  } catch (err) {
+    logger.warn('[history] Decoder worker unavailable, decoding on main thread:', err);
+    workerFailed = true;
+    return null;
+  }
+  worker.onmessage = (event: MessageEvent<HistoryDecodeResult>) => {
+    const result = event.data;
+    const entry = pending.get(result.id);
+    if (!entry) return;
+    pending.delete(result.id);
+    if ('error' in result) {
+      entry.reject(new Error(result.error));
+    } else {
+      entry.resolve(result.response);
+    }
+  };
+  worker.onerror = (event) => {
+    logger.warn('[history] Decoder worker failed:', event.message);
+    worker?.terminate();
+    worker = null;
+    workerFailed = true;
+    failAll(new Error('History decoder worker failed'));
+  };
+  return worker;
+}
+
+/**
+ * Decode a binary history body into columnar typed arrays.
+ * The buffer is transferred to the worker and must not be used afterwards.
+ * Falls back to synchronous decoding where workers are unavailable.
+ */
+export function decodeHistory(buffer: ArrayBuffer): Promise<HistoryResponse> {
+  const w = getWorker();
+  if (!w) {
+    try {
+      return Promise.resolve(decodeHistoryBinary(buffer));
+    } catch (err) {
+      return Promise.reject(err);
+    }
+  }
+  const id = nextId++;
+  return new Promise<HistoryResponse>((resolve, reject) => {
+    pending.set(id, { resolve, reject });
+    const request: HistoryDecodeRequest = { id, buffer };
+    w.postMessage(request, [buffer]);
+  });
+}
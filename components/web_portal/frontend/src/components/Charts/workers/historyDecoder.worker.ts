@@ -0,0 +1,31 @@
+/**
+ * Decodes binary history off the UI thread. Receives the raw response
+ * buffer (transferred) and posts back columnar typed arrays (transferred).
+ */
+import { decodeHistoryBinary, historyTransferables } from '../utils/historyDecode';
+import type { HistoryResponse } from '../../../store/historyCache';
+
+export interface HistoryDecodeRequest {
+  id: number;
+  buffer: ArrayBuffer;
+}
+
+export type HistoryDecodeResult =
+  | { id: number; response: HistoryResponse }
+  | { id: number; error: string };
+
+/* Minimal worker scope typing; the project compiles against the DOM lib only */
+const scope = self as unknown as {
+  onmessage: ((event: MessageEvent<HistoryDecodeRequest>) => void) | null;
+  postMessage(message: HistoryDecodeResult, transfer?: Transferable[]): void;
+};
+
+scope.onmessage = (event) => {
+  const { id, buffer } = event.data;
+  try {
+    const response = decodeHistoryBinary(buffer);
+    scope.postMessage({ id, response }, historyTransferables(response));
+  } catch (err) {
+    scope.postMessage({ id, error: err instanceof Error ? err.message : String(err) });
+  }
+};
@@ -10,9 +10,10 @@ const MAX_HISTORY = 50;
 
 /**
  * Command input field with history navigation (up/down arrows)
+ * Ctrl+C without a text selection cancels the running command
  * Disabled when console is not connected
  */
-export const CommandInput = memo(function CommandInput({ disabled, onSubmit }: CommandInputProps) {
+export const CommandInput = memo(function CommandInput({ disabled, onSubmit, onCancel }: CommandInputProps) {
   const [value, setValue] = useState('');
   const [history, setHistory] = useState<string[]>([]);
   const [historyIndex, setHistoryIndex] = useState(-1);
@@ -36,8 +37,12 @@ export const CommandInput = memo(function CommandInput({ disabled, onSubmit }: C
     });
   }, [value, onSubmit]);
 
-  const handleKeyDown = useCallback((e: React.KeyboardEvent) => {
-    if (e.key === 'Enter') {
+  const handleKeyDown = useCallback((e: React.KeyboardEvent<HTMLInputElement>) => {
+    const input = e.currentTarget;
+    if (e.ctrlKey && e.key === 'c' && onCancel && input.selectionStart === input.selectionEnd) {
+      e.preventDefault();
+      onCancel();
+    } else if (e.key === 'Enter') {
       e.preventDefault();
       handleSubmit();
     } else if (e.key === 'ArrowUp') {
@@ -66,7 +71,7 @@ export const CommandInput = memo(function CommandInput({ disabled, onSubmit }: C
         setValue(history[newIndex]);
       }
     }
-  }, [history, historyIndex, value, handleSubmit]);
+  }, [history, historyIndex, value, handleSubmit, onCancel]);
 
   const handleChange = useCallback((e: React.ChangeEvent<HTMLInputElement>) => {
     setValue(e.target.value);
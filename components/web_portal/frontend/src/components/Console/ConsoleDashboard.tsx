@@ -9,14 +9,17 @@ import { useAtom } from 'jotai';
 import { consoleTokenAtom, consoleEnabledAtom } from '../../store/atoms';
 import { useNotification } from '../../contexts/SnackbarContext';
 import { buildWsUrl } from '../../utils/constants';
+import { WsInflater, WS_DEFLATE_SUPPORTED } from '../../utils/wsInflate';
+import { logger } from '../../utils/logger';
 import { TokenDialog } from './TokenDialog';
 import { ConsoleControls } from './ConsoleControls';
 import { LogViewer } from './LogViewer';
 import { CommandInput } from './CommandInput';
-import { parseANSILine } from './utils/ansiParser';
-import type { LogEntry } from './utils/types';
+import { parseLog } from './utils/logParserWorker';
+import { LogStore } from './utils/logStore';
 
-const MAX_LINES = 1000;
+/* Lines kept for scrollback; only the visible window is rendered */
+const MAX_LINES = 20000;
 
 /**
  * Web Console Dashboard
@@ -28,21 +31,33 @@ export function ConsoleDashboard() {
   const { showNotification } = useNotification();
 
   const [tokenDialogOpen, setTokenDialogOpen] = useState(false);
-  const [entries, setEntries] = useState<LogEntry[]>([]);
-  const nextId = useRef(0);
+  const [store] = useState(() => new LogStore(MAX_LINES));
   const [autoScroll, setAutoScroll] = useState(true);
   const [consoleBusy, setConsoleBusy] = useState(false);
+  const logInflater = useRef(new WsInflater());
+
+  // Parsing runs in a worker; batches resolve in arrival order
+  const appendLines = useCallback((payload: string) => {
+    if (!payload) return;
+    parseLog(payload)
+      .then((batch) => store.append(batch))
+      .catch((err: unknown) => logger.warn('[console] Dropped log lines:', err));
+  }, [store]);
 
   // Track if we should connect based on token availability
-  const logWsUrl = token ? buildWsUrl('/ws/log', token) : null;
+  const logWsUrl = token ? buildWsUrl('/ws/log', token, WS_DEFLATE_SUPPORTED) : null;
   const consoleWsUrl = consoleEnabled && token ? buildWsUrl('/ws/console', token) : null;
 
   // Log WebSocket - always connected when token is available
   const {
-    lastMessage: logMessage,
     readyState: logReadyState,
     getWebSocket: getLogSocket,
   } = useWebSocket(logWsUrl, {
+    // Inflate in onMessage: compressed frames share one stream, none may be skipped
+    // A broken stream can't recover mid-way: reconnect to get a fresh RESET frame
+    onMessage: (event) =>
+      logInflater.current.push(event.data, appendLines, () => getLogSocket()?.close()),
+    onOpen: () => logInflater.current.reset(),
     shouldReconnect: () => true,
     reconnectAttempts: 10,
     reconnectInterval: (attemptNumber) =>
@@ -51,12 +66,13 @@ export function ConsoleDashboard() {
 
   // Console WebSocket - connected only when enabled
   const {
-    lastMessage: consoleMessage,
     readyState: consoleReadyState,
     sendMessage,
     getWebSocket: getConsoleSocket,
   } = useWebSocket(consoleWsUrl, {
     shouldReconnect: () => false, // manual reconnect only via toggle
+    // Command output streams in several frames; handle each one
+    onMessage: (event) => appendLines(event.data as string),
     onClose: (event) => {
       const busy = event.reason === 'Console busy' || event.code === 1013;
       setConsoleBusy(busy);
@@ -66,7 +82,7 @@ export function ConsoleDashboard() {
       }
       showNotification({
         message: busy
-          ? 'Console already in use by another client. Toggle again to retry.'
+          ? 'All console sessions are in use. Toggle again to retry.'
           : 'Console disconnected.',
         severity: busy ? 'warning' : 'info',
         duration: 5000,
@@ -80,40 +96,6 @@ export function ConsoleDashboard() {
     },
   });
 
-  const appendLines = useCallback((payload: string) => {
-    const newLines = payload.split(/\r?\n/).filter((line) => line.length > 0);
-    if (newLines.length === 0) return;
-
-    setEntries((prev) => {
-      let id = nextId.current;
-      const parsedEntries = newLines.map<LogEntry>((line) => ({
-        id: id++,
-        parsed: parseANSILine(line),
-      }));
-      nextId.current = id;
-
-      const combined = [...prev, ...parsedEntries];
-      if (combined.length > MAX_LINES) {
-        return combined.slice(combined.length - MAX_LINES);
-      }
-      return combined;
-    });
-  }, []);
-
-  // Process log messages
-  useEffect(() => {
-    if (!logMessage?.data) return;
-
-    appendLines(logMessage.data as string);
-  }, [appendLines, logMessage]);
-
-  // Process console messages (prompts)
-  useEffect(() => {
-    if (!consoleMessage?.data) return;
-
-    appendLines(consoleMessage.data as string);
-  }, [appendLines, consoleMessage]);
-
   // Open token dialog only when no stored token exists
   // Check localStorage directly because atomWithStorage hydrates async
   useEffect(() => {
@@ -142,11 +124,10 @@ export function ConsoleDashboard() {
   const handleTokenSave = useCallback((newToken: string) => {
     setToken(newToken);
     // Clear logs when token changes (new session)
-    setEntries([]);
-    nextId.current = 0;
+    store.clear();
     getLogSocket()?.close(1000, 'token_updated');
     getConsoleSocket()?.close(1000, 'token_updated');
-  }, [getConsoleSocket, getLogSocket, setToken]);
+  }, [getConsoleSocket, getLogSocket, setToken, store]);
 
   const handleConsoleToggle = useCallback((enabled: boolean) => {
     setConsoleEnabled(enabled);
@@ -164,6 +145,13 @@ export function ConsoleDashboard() {
     }
   }, [consoleReadyState, sendMessage]);
 
+  // Ctrl+C (ETX): the device drops the running command's output and re-prompts
+  const handleCommandCancel = useCallback(() => {
+    if (consoleReadyState === ReadyState.OPEN) {
+      sendMessage('\x03');
+    }
+  }, [consoleReadyState, sendMessage]);
+
   const handleAutoScrollChange = useCallback((enabled: boolean) => {
     setAutoScroll(enabled);
   }, []);
@@ -203,7 +191,7 @@ export function ConsoleDashboard() {
           {/* Log viewer */}
           <Box sx={{ mt: 2 }}>
             <LogViewer
-              entries={entries}
+              store={store}
               autoScroll={autoScroll}
               onAutoScrollChange={handleAutoScrollChange}
             />
@@ -214,6 +202,7 @@ export function ConsoleDashboard() {
             <CommandInput
               disabled={consoleReadyState !== ReadyState.OPEN}
               onSubmit={handleCommandSubmit}
+              onCancel={handleCommandCancel}
             />
           </Box>
         </CardContent>
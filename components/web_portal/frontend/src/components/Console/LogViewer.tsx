@@ -1,57 +1,103 @@
-import { useRef, useEffect, useCallback, memo } from 'react';
+import { useRef, useEffect, useLayoutEffect, useCallback, useState, memo } from 'react';
 import Box from '@mui/material/Box';
 import Typography from '@mui/material/Typography';
 import Chip from '@mui/material/Chip';
 import PauseIcon from '@mui/icons-material/Pause';
 import { MONOSPACE_FONT } from '../../utils/constants';
-import { hasStyle } from './utils/ansiParser';
-import type { LogViewerProps, ParsedLine } from './utils/types';
+import { decodeStyle } from './utils/ansiParser';
+import type { LogViewerProps } from './utils/types';
+
+const ROW_HEIGHT = 18;  // px; rows are single-line (no wrapping) so the list can be windowed
+const OVERSCAN = 20;    // rows rendered above/below the viewport
 
 /**
- * Render a single parsed line with ANSI styling
+ * Render a single line from its plain text and [end, styleCode] runs
  */
-const LogLine = memo(function LogLine({ segments }: { segments: ParsedLine }) {
-  return (
-    <Box component="span" sx={{ display: 'block', minHeight: '1.4em' }}>
-      {segments.map((segment, i) => {
-        if (!hasStyle(segment.style)) {
-          return <span key={i}>{segment.text}</span>;
-        }
-        return (
-          <Box
-            key={i}
-            component="span"
-            sx={{
-              color: segment.style.color,
-              fontWeight: segment.style.bold ? 'bold' : undefined,
-            }}
-          >
-            {segment.text}
-          </Box>
-        );
-      })}
-    </Box>
-  );
+const LogLine = memo(function LogLine({ text, runs, top }: { text: string; runs: Uint32Array; top: number }) {
+  const rowStyle = { position: 'absolute', top, left: 0, minWidth: '100%', height: ROW_HEIGHT } as const;
+  if (runs.length === 0) {
+    return <div style={rowStyle}>{text}</div>;
+  }
+  const segments = [];
+  let start = 0;
+  for (let k = 0; k < runs.length; k += 2) {
+    const end = runs[k];
+    const segment = text.slice(start, end);
+    start = end;
+    if (!segment) continue;
+    const style = decodeStyle(runs[k + 1]);
+    if (!style.color && !style.bold) {
+      segments.push(<span key={k}>{segment}</span>);
+      continue;
+    }
+    segments.push(
+      <Box
+        key={k}
+        component="span"
+        sx={{
+          color: style.color,
+          fontWeight: style.bold ? 'bold' : undefined,
+        }}
+      >
+        {segment}
+      </Box>
+    );
+  }
+  return <div style={rowStyle}>{segments}</div>;
 });
 
 /**
  * Log viewer component with ANSI color rendering and smart auto-scroll
- * - Parses ANSI escape sequences and renders with MUI theme colors
- * - Also colors ESP_LOG prefix lines (I/W/E/D/V) when no ANSI codes present
- * - Auto-scrolls to bottom unless user scrolls up
+ * - Renders only the rows in (and near) the viewport; the store can hold
+ *   tens of thousands of lines without growing the DOM
+ * - Store updates are coalesced to one render per animation frame
+ * - Auto-scrolls to bottom unless user scrolls up; while paused, the view
+ *   stays on the same lines as old ones are trimmed
  * - Shows indicator when auto-scroll is paused
  */
 export const LogViewer = memo(function LogViewer({
-  entries,
+  store,
   autoScroll,
   onAutoScrollChange,
 }: LogViewerProps) {
   const containerRef = useRef<HTMLDivElement>(null);
+  const [, setFrame] = useState(0);
+  const [scrollTop, setScrollTop] = useState(0);
+  const [viewportHeight, setViewportHeight] = useState(0);
+  const firstIdRef = useRef(store.firstId);
+
+  // Re-render at most once per animation frame, however fast lines arrive
+  useEffect(() => {
+    let raf = 0;
+    const unsubscribe = store.subscribe(() => {
+      if (raf) return;
+      raf = requestAnimationFrame(() => {
+        raf = 0;
+        setFrame((f) => f + 1);
+      });
+    });
+    return () => {
+      unsubscribe();
+      if (raf) cancelAnimationFrame(raf);
+    };
+  }, [store]);
+
+  // Track viewport height for windowing
+  useEffect(() => {
+    const el = containerRef.current;
+    if (!el) return;
+    setViewportHeight(el.clientHeight);
+    if (typeof ResizeObserver === 'undefined') return;
+    const observer = new ResizeObserver(() => setViewportHeight(el.clientHeight));
+    observer.observe(el);
+    return () => observer.disconnect();
+  }, []);
 
   // Handle scroll events to detect user scrolling
   const handleScroll = useCallback(() => {
     const el = containerRef.current;
     if (!el) return;
+    setScrollTop(el.scrollTop);
 
     const distanceFromBottom = el.scrollHeight - el.scrollTop - el.clientHeight;
     const pauseThreshold = 12;   // px beyond bottom to pause
@@ -64,12 +110,19 @@ export const LogViewer = memo(function LogViewer({
     }
   }, [autoScroll, onAutoScrollChange]);
 
-  // Auto-scroll to bottom when new lines arrive (if enabled)
-  useEffect(() => {
-    if (autoScroll && containerRef.current) {
-      containerRef.current.scrollTop = containerRef.current.scrollHeight;
+  // After each render: follow the tail, or compensate for trimmed lines
+  useLayoutEffect(() => {
+    const el = containerRef.current;
+    const firstId = store.firstId;
+    const trimmed = firstId - firstIdRef.current;
+    firstIdRef.current = firstId;
+    if (!el) return;
+    if (autoScroll) {
+      el.scrollTop = el.scrollHeight;
+    } else if (trimmed > 0) {
+      el.scrollTop = Math.max(0, el.scrollTop - trimmed * ROW_HEIGHT);
     }
-  }, [entries, autoScroll]);
+  });
 
   // Click handler to resume auto-scroll
   const handleResumeClick = useCallback(() => {
@@ -79,6 +132,17 @@ export const LogViewer = memo(function LogViewer({
     }
   }, [onAutoScrollChange]);
 
+  // Visible window (plus overscan) of the retained lines
+  const size = store.size;
+  const firstRow = Math.max(0, Math.floor(scrollTop / ROW_HEIGHT) - OVERSCAN);
+  const lastRow = Math.min(size, Math.ceil((scrollTop + viewportHeight) / ROW_HEIGHT) + OVERSCAN);
+  const rows = [];
+  for (let i = firstRow; i < lastRow; i++) {
+    rows.push(
+      <LogLine key={store.firstId + i} text={store.text(i)} runs={store.styleRuns(i)} top={i * ROW_HEIGHT} />
+    );
+  }
+
   return (
     <Box
       sx={{
@@ -132,9 +196,8 @@ export const LogViewer = memo(function LogViewer({
           p: 1.5,
           fontFamily: MONOSPACE_FONT,
           fontSize: '0.8125rem',
-          lineHeight: 1.4,
-          whiteSpace: 'pre-wrap',
-          wordBreak: 'break-all',
+          lineHeight: `${ROW_HEIGHT}px`,
+          whiteSpace: 'pre',
           bgcolor: 'background.default',
           // Custom scrollbar
           '&::-webkit-scrollbar': {
@@ -149,7 +212,7 @@ export const LogViewer = memo(function LogViewer({
           },
         }}
       >
-        {entries.length === 0 ? (
+        {size === 0 ? (
           <Typography
             variant="body2"
             color="text.disabled"
@@ -158,9 +221,9 @@ export const LogViewer = memo(function LogViewer({
             No logs yet...
           </Typography>
         ) : (
-          entries.map((entry) => (
-            <LogLine key={entry.id} segments={entry.parsed} />
-          ))
+          <Box sx={{ position: 'relative', height: size * ROW_HEIGHT }}>
+            {rows}
+          </Box>
         )}
       </Box>
     </Box>
@@ -1,4 +1,4 @@
-import type { ANSIStyle, ParsedSegment, ParsedLine } from './types';
+import type { ANSIStyle, ParsedSegment, ParsedLine, LogBatch } from './types';
 
 /**
  * Map ANSI color codes to MUI theme color paths
@@ -122,3 +122,57 @@ export function hasStyle(style: ANSIStyle): boolean {
 export function stripANSI(text: string): string {
   return text.replace(/\x1b\[([0-9;]*)m/g, '');
 }
+
+/* ===== Compact style codes for the columnar log store ===== */
+
+/** Distinct theme colors; a style code is (index + 1) | STYLE_BOLD, 0 = plain */
+const STYLE_COLORS: string[] = [...new Set(Object.values(ANSI_COLORS))];
+const STYLE_BOLD = 0x100;
+
+export function encodeStyle(style: ANSIStyle): number {
+  const color = style.color ? STYLE_COLORS.indexOf(style.color) + 1 : 0;
+  return color | (style.bold ? STYLE_BOLD : 0);
+}
+
+export function decodeStyle(code: number): ANSIStyle {
+  const color = code & 0xff;
+  return {
+    color: color ? STYLE_COLORS[color - 1] : undefined,
+    bold: (code & STYLE_BOLD) !== 0,
+  };
+}
+
+/**
+ * Split a log payload into lines and parse them into columnar form: plain
+ * text per line plus [end, style] run pairs for styled lines only. Runs in
+ * typed arrays so a worker can transfer them instead of cloning objects.
+ */
+export function parseLogPayload(payload: string): LogBatch {
+  const lines = payload.split(/\r?\n/).filter((line) => line.length > 0);
+  const texts: string[] = new Array(lines.length);
+  const runOffsets = new Uint32Array(lines.length + 1);
+  const runs: number[] = [];
+
+  lines.forEach((line, i) => {
+    runOffsets[i] = runs.length;
+    if (!line.includes('\x1b')) {
+      texts[i] = line;
+      return;
+    }
+    const segments = parseANSILine(line);
+    let text = '';
+    let styled = false;
+    const lineRuns: number[] = [];
+    for (const segment of segments) {
+      text += segment.text;
+      const code = encodeStyle(segment.style);
+      if (code) styled = true;
+      lineRuns.push(text.length, code);
+    }
+    texts[i] = text;
+    if (styled) runs.push(...lineRuns);
+  });
+  runOffsets[lines.length] = runs.length;
+
+  return { texts, runs: Uint32Array.from(runs), runOffsets };
+}
@@ -0,0 +1,73 @@
+import { logger } from '../../../utils/logger';
+import type { LogParseRequest, LogParseResult } from '../workers/logParser.worker';
+import { parseLogPayload } from './ansiParser';
+import type { LogBatch } from './types';
+
+type Pending = { resolve: (b: LogBatch) => void; reject: (e: Error) => void };
+
+let worker: Worker | null = null;
+let workerFailed = false;
+let nextId = 1;
+const pending = new Map<number, Pending>();
+
+function failAll(error: Error): void {
+  pending.forEach((p) => p.reject(error));
+  pending.clear();
+}
+
+function getWorker(): Worker | null {
+  if (worker || workerFailed) return worker;
+  if (typeof Worker === 'undefined') {
+    workerFailed = true;
+    return null;
+  }
+  try {
+    worker = new Worker(new URL('../workers/logParser.worker.ts', import.meta.url), { type: 'module' });
+  } catch (err) {
+    logger.warn('[console] Log parser worker unavailable, parsing on main thread:', err);
+    workerFailed = true;
+    return null;
+  }
+  worker.onmessage = (event: MessageEvent<LogParseResult>) => {
+    const result = event.data;
+    const entry = pending.get(result.id);
+    if (!entry) return;
+    pending.delete(result.id);
+    if ('error' in result) {
+      entry.reject(new Error(result.error));
+    } else {
+      entry.resolve(result.batch);
+    }
+  };
+  worker.onerror = (event) => {
+    logger.warn('[console] Log parser worker failed:', event.message);
+    worker?.terminate();
+    worker = null;
+    workerFailed = true;
+    failAll(new Error('Log parser worker failed'));
+  };
+  return worker;
+}
+
+/**
+ * Parse a log payload (one or more lines) into a columnar batch.
+ * A single worker handles requests in order, so results resolve in the
+ * order payloads were submitted. Falls back to synchronous parsing where
+ * workers are unavailable.
+ */
+export function parseLog(payload: string): Promise<LogBatch> {
+  const w = getWorker();
+  if (!w) {
+    try {
+      return Promise.resolve(parseLogPayload(payload));
+    } catch (err) {
+      return Promise.reject(err);
+    }
+  }
+  const id = nextId++;
+  return new Promise<LogBatch>((resolve, reject) => {
+    pending.set(id, { resolve, reject });
+    const request: LogParseRequest = { id, payload };
+    w.postMessage(request);
+  });
+}
@@ -0,0 +1,82 @@
+import type { LogBatch } from './types';
+
+const EMPTY_RUNS = new Uint32Array(0);
+
+/**
+ * Fixed-capacity columnar ring of parsed log lines.
+ * Appends are O(lines) with no array copies; the oldest lines are overwritten
+ * once full. Each line keeps a monotonic id (stable React key across trims).
+ * Listeners are notified synchronously; the viewer coalesces per frame.
+ */
+export class LogStore {
+  private readonly texts: string[];
+  private readonly runs: Uint32Array[];
+  private head = 0; // Next write slot
+  private count = 0;
+  private total = 0; // Lines ever appended (id of the next line)
+  private readonly listeners = new Set<() => void>();
+
+  constructor(readonly capacity: number) {
+    this.texts = new Array<string>(capacity).fill('');
+    this.runs = new Array<Uint32Array>(capacity).fill(EMPTY_RUNS);
+  }
+
+  get size(): number {
+    return this.count;
+  }
+
+  /** Id of the oldest retained line */
+  get firstId(): number {
+    return this.total - this.count;
+  }
+
+  append(batch: LogBatch): void {
+    const n = batch.texts.length;
+    if (n === 0) return;
+    // Only the newest `capacity` lines of an oversized batch can survive
+    const start = Math.max(0, n - this.capacity);
+    for (let i = start; i < n; i++) {
+      const from = batch.runOffsets[i];
+      const to = batch.runOffsets[i + 1];
+      this.texts[this.head] = batch.texts[i];
+      this.runs[this.head] = to > from ? batch.runs.subarray(from, to) : EMPTY_RUNS;
+      this.head = (this.head + 1) % this.capacity;
+    }
+    this.count = Math.min(this.capacity, this.count + n);
+    this.total += n;
+    this.notify();
+  }
+
+  clear(): void {
+    this.texts.fill('');
+    this.runs.fill(EMPTY_RUNS);
+    this.head = 0;
+    this.count = 0;
+    this.notify();
+  }
+
+  /** Slot of the i-th retained line, 0 = oldest */
+  private slot(index: number): number {
+    return (this.head - this.count + index + this.capacity) % this.capacity;
+  }
+
+  text(index: number): string {
+    return this.texts[this.slot(index)];
+  }
+
+  /** [end, styleCode] pairs, empty for unstyled lines */
+  styleRuns(index: number): Uint32Array {
+    return this.runs[this.slot(index)];
+  }
+
+  subscribe(listener: () => void): () => void {
+    this.listeners.add(listener);
+    return () => {
+      this.listeners.delete(listener);
+    };
+  }
+
+  private notify(): void {
+    this.listeners.forEach((listener) => listener());
+  }
+}
@@ -1,4 +1,5 @@
 import type { ReadyState } from 'react-use-websocket';
+import type { LogStore } from './logStore';
 
 /**
  * ANSI text styling attributes parsed from escape sequences
@@ -24,21 +25,23 @@ export interface ParsedSegment {
 export type ParsedLine = ParsedSegment[];
 
 /**
- * Parsed log entry with stable identity for rendering
+ * Parsed log lines in columnar form, as produced by the parser worker
  */
-export interface LogEntry {
-  /** Monotonic id to keep React keys stable as we trim */
-  id: number;
-  /** Parsed segments for this line */
-  parsed: ParsedLine;
+export interface LogBatch {
+  /** Line text with escape sequences removed */
+  texts: string[];
+  /** Style runs of all lines as [end, styleCode] pairs (see encodeStyle) */
+  runs: Uint32Array;
+  /** Line i owns runs[runOffsets[i] .. runOffsets[i + 1]); empty = unstyled */
+  runOffsets: Uint32Array;
 }
 
 /**
  * Props for the LogViewer component
  */
 export interface LogViewerProps {
-  /** Parsed log entries with stable ids */
-  entries: LogEntry[];
+  /** Fixed-capacity line store; the viewer subscribes to it directly */
+  store: LogStore;
   /** Whether auto-scroll is currently active */
   autoScroll: boolean;
   /** Callback when auto-scroll state changes */
@@ -53,6 +56,8 @@ export interface CommandInputProps {
   disabled: boolean;
   /** Callback when a command is submitted */
   onSubmit: (command: string) => void;
+  /** Callback for Ctrl+C (cancel the running command) */
+  onCancel?: () => void;
 }
 
 /**
@@ -0,0 +1,31 @@
+/**
+ * Parses /ws/log payloads off the UI thread. Receives raw text and posts
+ * back columnar line batches with the run arrays transferred.
+ */
+import { parseLogPayload } from '../utils/ansiParser';
+import type { LogBatch } from '../utils/types';
+
+export interface LogParseRequest {
+  id: number;
+  payload: string;
+}
+
+export type LogParseResult =
+  | { id: number; batch: LogBatch }
+  | { id: number; error: string };
+
+/* Minimal worker scope typing; the project compiles against the DOM lib only */
+const scope = self as unknown as {
+  onmessage: ((event: MessageEvent<LogParseRequest>) => void) | null;
+  postMessage(message: LogParseResult, transfer?: Transferable[]): void;
+};
+
+scope.onmessage = (event) => {
+  const { id, payload } = event.data;
+  try {
+    const batch = parseLogPayload(payload);
+    scope.postMessage({ id, batch }, [batch.runs.buffer as ArrayBuffer, batch.runOffsets.buffer as ArrayBuffer]);
+  } catch (err) {
+    scope.postMessage({ id, error: err instanceof Error ? err.message : String(err) });
+  }
+};
@@ -9,13 +9,14 @@ import { AppBar } from './AppBar';
 import { NavDrawer } from './NavDrawer';
 import { bootstrapErrorAtom } from '../../store/atoms';
 import { Dashboard } from '../Dashboard/Dashboard';
-import { HealthDashboard } from '../Health/HealthDashboard';
-import { ConfigView } from '../Config/ConfigView';
-import { PowerDashboard } from '../Power/PowerDashboard';
-import { OTADashboard } from '../OTA/OTADashboard';
-import { ConsoleDashboard } from '../Console/ConsoleDashboard';
 
-// Only lazy-load ChartContainer to keep @mui/x-charts out of initial bundle
+// Every route except the landing dashboard is its own chunk, fetched on first visit
+const HealthDashboard = lazy(() => import('../Health/HealthDashboard').then(m => ({ default: m.HealthDashboard })));
+const ConfigView = lazy(() => import('../Config/ConfigView').then(m => ({ default: m.ConfigView })));
+const PowerDashboard = lazy(() => import('../Power/PowerDashboard').then(m => ({ default: m.PowerDashboard })));
+const OTADashboard = lazy(() => import('../OTA/OTADashboard').then(m => ({ default: m.OTADashboard })));
+const ConsoleDashboard = lazy(() => import('../Console/ConsoleDashboard').then(m => ({ default: m.ConsoleDashboard })));
+// ChartContainer also keeps @mui/x-charts out of the initial bundle
 const ChartContainer = lazy(() => import('../Charts/ChartContainer').then(m => ({ default: m.ChartContainer })));
 
 export function AppShell() {
@@ -36,7 +36,7 @@ export function FrontendUpdate() {
     if (file) {
       // Validate file extension
       if (!file.name.endsWith('.bin')) {
-        showNotification({ message: 'Please select a .bin LittleFS image file', severity: 'warning' });
+        showNotification({ message: 'Please select a .bin frontend image file', severity: 'warning' });
         return;
       }
       setSelectedFile(file);
@@ -93,7 +93,7 @@ export function FrontendUpdate() {
           Frontend Update
         </Typography>
         <Typography variant="body2" color="text.secondary" sx={{ mb: 2 }}>
-          Upload a new frontend LittleFS image (www.bin) to update the web interface.
+          Upload a new frontend image (www.bin, LittleFS or asset pack) to update the web interface.
           No reboot required - just refresh the page.
         </Typography>
 
@@ -1,4 +1,4 @@
-import { useEffect } from 'react';
+import { useEffect, useRef } from 'react';
 import { useSetAtom } from 'jotai';
 import useWebSocket, { ReadyState } from 'react-use-websocket';
 import type { WSMessage } from '../api/types';
@@ -13,6 +13,7 @@ import {
 } from '../store/atoms';
 import { logger } from '../utils/logger';
 import { buildWsUrl } from '../utils/constants';
+import { WsInflater, WS_DEFLATE_SUPPORTED } from '../utils/wsInflate';
 
 /**
  * Custom hook for WebSocket connection to ESP32 device
@@ -22,6 +23,7 @@ import { buildWsUrl } from '../utils/constants';
  * - Infinite reconnection attempts
  * - Heartbeat mechanism (ping every 30s)
  * - Automatic message parsing and state updates via Jotai
+ * - Compressed frames (?deflate=1) where DecompressionStream is available
  * - Connection state management
  *
  * @returns WebSocket connection state and methods
@@ -35,10 +37,11 @@ export function useWebSocketConnection() {
   const setHealth = useSetAtom(healthAtom);
   const setPower = useSetAtom(powerAtom);
   const setOTAProgress = useSetAtom(otaProgressAtom);
+  const inflater = useRef(new WsInflater());
 
   // WebSocket connection with react-use-websocket
   const { sendMessage, lastMessage, readyState } = useWebSocket(
-    buildWsUrl('/ws'),
+    buildWsUrl('/ws', undefined, WS_DEFLATE_SUPPORTED),
     {
       // Reconnection strategy: exponential backoff with 10s cap
       shouldReconnect: () => true, // Always reconnect
@@ -49,6 +52,7 @@ export function useWebSocketConnection() {
       // Connection lifecycle callbacks
       onOpen: () => {
         logger.log('[WebSocket] Connected to ESP32');
+        inflater.current.reset();
         setWsConnected(true);
         setWsReconnecting(false);
       },
@@ -70,12 +74,14 @@ export function useWebSocketConnection() {
 
       // Message handling
       onMessage: (event) => {
-        try {
-          const message = JSON.parse(event.data) as WSMessage;
-          handleMessage(message);
-        } catch (error) {
-          logger.error('[WebSocket] Failed to parse message:', error, event.data);
-        }
+        inflater.current.push(event.data, (text) => {
+          try {
+            const message = JSON.parse(text) as WSMessage;
+            handleMessage(message);
+          } catch (error) {
+            logger.error('[WebSocket] Failed to parse message:', error, text);
+          }
+        });
       },
 
       // No app-level heartbeat; server handles protocol PING/PONG
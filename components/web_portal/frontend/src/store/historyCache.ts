@@ -1,16 +1,43 @@
 import { atom } from 'jotai';
 import type { MetricKey, RangeKey } from '../components/Charts/config/chartConfig';
 
+/**
+ * Columnar history for one metric. Values are still quantized
+ * (value = (q - offset) / scale); HISTORY_SENTINEL marks an empty bucket.
+ * The arrays are views into buffers transferred from the decoder worker.
+ */
+export interface HistoryMetricColumns {
+  scale: number;
+  offset: number;
+  min: Int16Array;
+  max: Int16Array;
+  avg: Int16Array;
+  /** LSB-first bitmap: bucket contains samples flagged by sensor fault monitors */
+  suspect?: Uint8Array;
+  /**
+   * Extended bucket stats (requested with stats=1, metrics configured on the
+   * device only). stddev is a spread: value = stddev / scale, without offset.
+   */
+  ext?: HistoryExtColumns;
+}
+
+export interface HistoryExtColumns {
+  stddev: Int16Array;
+  first: Int16Array;
+  last: Int16Array;
+  /** Mean with each sample weighted by the time since the previous one */
+  twAvg: Int16Array;
+}
+
 export interface HistoryResponse {
   resolution_s: number;
   end_time: number;
-  metrics: Record<MetricKey, {
-    scale: number;
-    offset: number;
-    buckets: ([number, number, number] | null)[];
-  }>;
+  bucket_count: number;
+  metrics: Partial<Record<MetricKey, HistoryMetricColumns>>;
 }
 
+export const HISTORY_SENTINEL = -32768;
+
 export interface CacheEntry {
   response: HistoryResponse;
   fetchedAt: number;
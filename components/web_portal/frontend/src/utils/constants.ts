@@ -33,10 +33,15 @@ export const MONOSPACE_FONT = 'Monaco, Consolas, "Liberation Mono", "Courier New
  * Handles both development (proxied) and production environments
  * @param endpoint - The WebSocket endpoint path (e.g., '/ws', '/ws/log')
  * @param token - Optional authentication token to include as query param
+ * @param deflate - Ask the device for compressed frames (see utils/wsInflate)
  */
-export function buildWsUrl(endpoint: string, token?: string): string {
+export function buildWsUrl(endpoint: string, token?: string, deflate = false): string {
   const protocol = window.location.protocol === 'https:' ? 'wss:' : 'ws:';
   const host = window.location.host;
   const base = `${protocol}//${host}${endpoint}`;
-  return token ? `${base}?token=${encodeURIComponent(token)}` : base;
+  /* deflate first: the device only scans a bounded prefix of the query */
+  const params: string[] = [];
+  if (deflate) params.push('deflate=1');
+  if (token) params.push(`token=${encodeURIComponent(token)}`);
+  return params.length > 0 ? `${base}?${params.join('&')}` : base;
 }
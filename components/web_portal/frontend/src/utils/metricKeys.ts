@@ -0,0 +1,9 @@
+/** Wire metric ids, in HISTORY_METRIC_TABLE order (iaq_history.h) */
+export const METRIC_KEYS = [
+  'temp_c', 'rh_pct', 'co2_ppm', 'pressure_hpa',
+  'pm1_ugm3', 'pm25_ugm3', 'pm10_ugm3',
+  'voc_index', 'nox_index', 'mold_risk',
+  'aqi', 'comfort_score', 'iaq_score',
+] as const;
+
+export type MetricWireKey = (typeof METRIC_KEYS)[number];
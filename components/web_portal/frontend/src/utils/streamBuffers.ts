@@ -6,27 +6,34 @@ import type { MetricKey } from '../components/Charts/config/chartConfig';
 export const STREAM_BUFFER_SECONDS = 300;
 
 /**
- * Ring buffer implementation for O(1) append/trim operations
- * Avoids O(n) array shifts that were happening 7x per second after buffer fills
+ * Mirrored typed-array ring: every sample is written twice, at `head` and
+ * `head + capacity`, so the newest `size` samples are always one contiguous
+ * run of the double-length buffer. Appends are O(1) and reading the window
+ * is a subarray view - no unwrapping copy and no per-frame garbage. Gaps are
+ * stored as NaN.
  */
-class RingBuffer {
-  private buffer: (number | null)[];
-  private head: number = 0; // Write position
+class MirroredRing<A extends Float32Array | Float64Array> {
+  private readonly data: A;
+  private head: number = 0; // Write position (primary half)
   private size: number = 0; // Current size
   private readonly capacity: number;
+  private cachedView: A | null = null;
 
-  constructor(capacity: number) {
+  constructor(capacity: number, create: (length: number) => A) {
     this.capacity = capacity;
-    this.buffer = new Array(capacity);
+    this.data = create(capacity * 2);
+    this.data.fill(NaN);
   }
 
   /** O(1) append - overwrites oldest when full */
-  push(value: number | null): void {
-    this.buffer[this.head] = value;
+  push(value: number): void {
+    this.data[this.head] = value;
+    this.data[this.head + this.capacity] = value;
     this.head = (this.head + 1) % this.capacity;
     if (this.size < this.capacity) {
       this.size++;
     }
+    this.cachedView = null;
   }
 
   /** Get current size */
@@ -34,58 +41,56 @@ class RingBuffer {
     return this.size;
   }
 
-  /** O(n) linear array extraction - only called when rendering */
-  toArray(): (number | null)[] {
-    if (this.size === 0) return [];
-    if (this.size < this.capacity) {
-      // Not full yet - return contiguous slice
-      return this.buffer.slice(0, this.size);
+  /**
+   * Oldest-to-newest samples as a view into the ring (no copy). Read-only;
+   * once the ring is full the next push overwrites the view's first element.
+   */
+  view(): A {
+    if (!this.cachedView) {
+      const end = this.head + this.capacity;
+      this.cachedView = this.data.subarray(end - this.size, end) as A;
     }
-    // Full - need to unwrap the ring
-    const tail = this.head; // Oldest element position
-    return [...this.buffer.slice(tail), ...this.buffer.slice(0, tail)];
+    return this.cachedView;
   }
 
-  /** Get latest value - O(1) */
-  latest(): number | null {
-    if (this.size === 0) return null;
-    const lastIdx = (this.head - 1 + this.capacity) % this.capacity;
-    return this.buffer[lastIdx];
+  /** Get latest value - O(1), NaN when empty */
+  latest(): number {
+    if (this.size === 0) return NaN;
+    return this.data[this.head + this.capacity - 1];
   }
 
   /** Reset buffer (for tests) */
   reset(): void {
     this.head = 0;
     this.size = 0;
-    this.buffer.fill(null);
+    this.data.fill(NaN);
+    this.cachedView = null;
   }
 }
 
+const timeRing = () => new MirroredRing(STREAM_BUFFER_CAPACITY, (n) => new Float64Array(n));
+const valueRing = () => new MirroredRing(STREAM_BUFFER_CAPACITY, (n) => new Float32Array(n));
+
 // Ring buffers for time and each metric
-const timesRing = new RingBuffer(STREAM_BUFFER_CAPACITY);
-const seriesRings: Record<MetricKey, RingBuffer> = {
-  temp_c: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  rh_pct: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  co2_ppm: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  pressure_hpa: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  voc_index: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  nox_index: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  aqi: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  comfort_score: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  pm25_ugm3: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  pm1_ugm3: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  pm10_ugm3: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  mold_risk: new RingBuffer(STREAM_BUFFER_CAPACITY),
-  iaq_score: new RingBuffer(STREAM_BUFFER_CAPACITY),
+const timesRing = timeRing();
+const seriesRings: Record<MetricKey, MirroredRing<Float32Array>> = {
+  temp_c: valueRing(),
+  rh_pct: valueRing(),
+  co2_ppm: valueRing(),
+  pressure_hpa: valueRing(),
+  voc_index: valueRing(),
+  nox_index: valueRing(),
+  aqi: valueRing(),
+  comfort_score: valueRing(),
+  pm25_ugm3: valueRing(),
+  pm1_ugm3: valueRing(),
+  pm10_ugm3: valueRing(),
+  mold_risk: valueRing(),
+  iaq_score: valueRing(),
 };
 
 /** Version counter that increments on each append - for signaling chart updates */
 let buffersVersion = 0;
-let cachedTimes: number[] = [];
-let cachedTimesVersion = -1;
-
-/** Per-metric array cache - avoids allocating new arrays on every getBuffers call */
-const cachedSeries = new Map<MetricKey, { data: (number | null)[]; version: number }>();
 
 let cachedMetrics: { mold_risk: number | null; iaq_score: number | null } = {
   mold_risk: null,
@@ -122,12 +127,12 @@ export function appendStateToBuffers(s: State): void {
     return;
   }
 
-  // Helper to sanitize numeric values
-  const sanitize = (val: number | null | undefined): number | null => {
-    if (val == null) return null;
+  // Helper to sanitize numeric values (gaps are NaN)
+  const sanitize = (val: number | null | undefined): number => {
+    if (val == null) return NaN;
     if (!Number.isFinite(val)) {
       logger.warn('[streamBuffers] Non-finite value detected:', val);
-      return null;
+      return NaN;
     }
     return val;
   };
@@ -151,17 +156,11 @@ export function appendStateToBuffers(s: State): void {
 }
 
 /**
- * Get buffers as linear arrays for chart rendering
- * Returns cached unwrapped ring buffer contents - do not mutate returned arrays
+ * Get time and value columns for chart rendering as views into the rings.
+ * No copy is made: do not mutate, and do not hold across appends.
  */
-export function getBuffers(key: MetricKey): { x: number[]; y: (number | null)[] } {
-  const cached = cachedSeries.get(key);
-  if (cached && cached.version === buffersVersion) {
-    return { x: getTimesArray(), y: cached.data };
-  }
-  const data = seriesRings[key].toArray();
-  cachedSeries.set(key, { data, version: buffersVersion });
-  return { x: getTimesArray(), y: data };
+export function getBuffers(key: MetricKey): { x: Float64Array; y: Float32Array } {
+  return { x: timesRing.view(), y: seriesRings[key].view() };
 }
 
 /**
@@ -169,19 +168,12 @@ export function getBuffers(key: MetricKey): { x: number[]; y: (number | null)[]
  */
 export function getLatest(key: MetricKey): number | null {
   const v = seriesRings[key].latest();
-  return v == null || Number.isNaN(v) ? null : (v as number);
+  return Number.isNaN(v) ? null : v;
 }
 
 export function getLatestTimestamp(): number | null {
-  return timesRing.latest();
-}
-
-export function getTimesArray(): number[] {
-  if (cachedTimesVersion !== buffersVersion) {
-    cachedTimes = timesRing.toArray() as number[];
-    cachedTimesVersion = buffersVersion;
-  }
-  return cachedTimes;
+  const t = timesRing.latest();
+  return Number.isNaN(t) ? null : t;
 }
 
 /**
@@ -198,7 +190,4 @@ export function resetBuffers(): void {
   timesRing.reset();
   (Object.keys(seriesRings) as MetricKey[]).forEach((k) => seriesRings[k].reset());
   buffersVersion = 0;
-  cachedTimes = [];
-  cachedTimesVersion = -1;
-  cachedSeries.clear();
 }
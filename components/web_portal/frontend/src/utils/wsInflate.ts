@@ -0,0 +1,91 @@
+import { logger } from './logger';
+
+/* Frame header written by components/ws_deflate (see ws_deflate.h) */
+const FLAG_RESET = 0x01;
+const FLAG_TAKEOVER = 0x02;
+const HEADER_LEN = 5;
+
+/** Browsers without DecompressionStream('deflate-raw') connect without ?deflate=1 */
+export const WS_DEFLATE_SUPPORTED = (() => {
+  if (typeof DecompressionStream === 'undefined') return false;
+  try {
+    new DecompressionStream('deflate-raw');
+    return true;
+  } catch {
+    return false;
+  }
+})();
+
+/**
+ * Decodes messages from a `?deflate=1` WebSocket. Text frames pass through;
+ * binary frames are inflated. Results are delivered in arrival order even
+ * though inflating is asynchronous.
+ */
+export class WsInflater {
+  private chain: Promise<void> = Promise.resolve();
+  private writer: WritableStreamDefaultWriter<BufferSource> | null = null;
+  private reader: ReadableStreamDefaultReader<Uint8Array> | null = null;
+
+  /**
+   * @param onError - Called after a frame failed to inflate. The shared
+   *   context is gone and later frames are dropped until the next RESET, so
+   *   callers should reconnect (the device sends a RESET to new clients).
+   */
+  push(data: unknown, onText: (text: string) => void, onError?: (error: unknown) => void): void {
+    this.chain = this.chain
+      .then(async () => {
+        if (typeof data === 'string') {
+          onText(data);
+          return;
+        }
+        const buffer = data instanceof Blob ? await data.arrayBuffer() : (data as ArrayBuffer);
+        const text = await this.inflate(new Uint8Array(buffer));
+        if (text !== null) onText(text);
+      })
+      .catch((error: unknown) => {
+        logger.warn('[WebSocket] Failed to inflate frame:', error);
+        this.reset();
+        onError?.(error);
+      });
+  }
+
+  /** Drop the shared context (socket closed or stream corrupted) */
+  reset(): void {
+    this.writer?.abort().catch(() => undefined);
+    this.writer = null;
+    this.reader = null;
+  }
+
+  private async inflate(frame: Uint8Array): Promise<string | null> {
+    if (frame.length < HEADER_LEN) throw new Error('Frame too short');
+    const flags = frame[0];
+    const size = new DataView(frame.buffer, frame.byteOffset + 1, 4).getUint32(0, true);
+    const body = frame.subarray(HEADER_LEN);
+
+    if (!(flags & FLAG_TAKEOVER)) {
+      const stream = new Blob([body]).stream().pipeThrough(new DecompressionStream('deflate-raw'));
+      return new Response(stream).text();
+    }
+
+    if (flags & FLAG_RESET) {
+      this.reset();
+      const ds = new DecompressionStream('deflate-raw');
+      this.writer = ds.writable.getWriter();
+      this.reader = ds.readable.getReader();
+    }
+    if (!this.writer || !this.reader) return null; /* Joined mid-stream; wait for a reset */
+
+    /* Each message ends in a sync flush, so exactly `size` bytes come out */
+    this.writer.write(body).catch(() => undefined); /* Errors surface via read() */
+    const out = new Uint8Array(size);
+    let filled = 0;
+    while (filled < size) {
+      const { value, done } = await this.reader.read();
+      if (done || !value) throw new Error('Inflate stream ended');
+      if (filled + value.length > size) throw new Error('Inflate overrun');
+      out.set(value, filled);
+      filled += value.length;
+    }
+    return new TextDecoder().decode(out);
+  }
+}
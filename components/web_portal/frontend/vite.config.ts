@@ -8,6 +8,24 @@ import fs from 'fs';
 // Allow custom ESP32 IP via environment variable
 const ESP32_HOST = process.env.VITE_ESP32_HOST || '192.168.4.1';
 
+// Framework packages loaded by the app shell itself (kept in one long-lived chunk)
+const VENDOR_CORE = [
+  'react',
+  'react-dom',
+  'scheduler',
+  'wouter',
+  'jotai',
+  'react-use-websocket',
+  '@emotion/react',
+  '@emotion/styled',
+  '@emotion/cache',
+  '@emotion/serialize',
+  '@emotion/utils',
+  '@mui/system',
+  '@mui/styled-engine',
+  '@mui/utils',
+];
+
 // Emit version.txt alongside built assets using package.json version + short git SHA
 const emitVersionPlugin = () => ({
   name: 'emit-version-txt',
@@ -45,6 +63,11 @@ export default defineConfig({
       algorithm: 'gzip',
       ext: '.gz',
     }),
+    // Served in preference to .gz when the client advertises br (smaller, same decode cost)
+    compression({
+      algorithm: 'brotliCompress',
+      ext: '.br',
+    }),
     emitVersionPlugin(),
   ],
 
@@ -62,8 +85,10 @@ export default defineConfig({
           if (id.includes('@mui/x-charts')) {
             return 'vendor-charts';
           }
-          // Bundle all other node_modules together
-          if (id.includes('node_modules')) {
+          // Shared core every route needs; everything else (MUI components,
+          // icons, route-only libraries) is placed by Rollup next to the
+          // routes that import it, so lazy routes don't inflate first load
+          if (VENDOR_CORE.some((pkg) => id.includes(`/node_modules/${pkg}/`))) {
             return 'vendor';
           }
         },
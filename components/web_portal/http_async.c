@@ -0,0 +1,137 @@
+/* components/web_portal/http_async.c */
+#include "http_async.h"
+
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "sdkconfig.h"
+
+#include "iaq_config.h"
+#include "iaq_profiler.h"
+
+static const char *TAG = "HTTP_ASYNC";
+
+#ifndef CONFIG_IAQ_WEB_PORTAL_ASYNC_WORKERS
+#define CONFIG_IAQ_WEB_PORTAL_ASYNC_WORKERS 2
+#endif
+#define ASYNC_WORKER_COUNT  CONFIG_IAQ_WEB_PORTAL_ASYNC_WORKERS
+#define ASYNC_QUEUE_DEPTH   4
+
+typedef struct {
+    httpd_req_t *req;               /* Async copy; owned until _complete() */
+    http_async_class_t cls;
+    esp_err_t (*handler)(httpd_req_t *req);
+} http_async_job_t;
+
+/* Max in-flight (queued + running) requests per class */
+static const uint8_t s_class_limit[HTTP_ASYNC_CLASS_MAX] = {
+    [HTTP_ASYNC_CLASS_HISTORY]   = 2,
+    [HTTP_ASYNC_CLASS_WIFI_SCAN] = 1,
+    [HTTP_ASYNC_CLASS_OTA]       = 1,
+    [HTTP_ASYNC_CLASS_SENSOR]    = 1,
+};
+
+static const char *s_class_name[HTTP_ASYNC_CLASS_MAX] = {
+    [HTTP_ASYNC_CLASS_HISTORY]   = "history",
+    [HTTP_ASYNC_CLASS_WIFI_SCAN] = "wifi_scan",
+    [HTTP_ASYNC_CLASS_OTA]       = "ota",
+    [HTTP_ASYNC_CLASS_SENSOR]    = "sensor",
+};
+
+static QueueHandle_t s_queue = NULL;
+static TaskHandle_t s_workers[ASYNC_WORKER_COUNT];
+static uint8_t s_inflight[HTTP_ASYNC_CLASS_MAX];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool class_acquire(http_async_class_t cls)
+{
+    bool ok = false;
+    portENTER_CRITICAL(&s_lock);
+    if (s_inflight[cls] < s_class_limit[cls]) {
+        s_inflight[cls]++;
+        ok = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return ok;
+}
+
+static void class_release(http_async_class_t cls)
+{
+    portENTER_CRITICAL(&s_lock);
+    if (s_inflight[cls] > 0) s_inflight[cls]--;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static void async_worker_task(void *arg)
+{
+    (void)arg;
+    http_async_job_t job;
+    for (;;) {
+        if (xQueueReceive(s_queue, &job, portMAX_DELAY) != pdTRUE) continue;
+        ESP_LOGD(TAG, "Running %s request %s", s_class_name[job.cls], job.req->uri);
+        job.handler(job.req);
+        if (httpd_req_async_handler_complete(job.req) != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to complete async %s request", s_class_name[job.cls]);
+        }
+        class_release(job.cls);
+    }
+}
+
+esp_err_t http_async_init(void)
+{
+    if (s_queue) return ESP_OK;
+
+    s_queue = xQueueCreate(ASYNC_QUEUE_DEPTH, sizeof(http_async_job_t));
+    if (!s_queue) return ESP_ERR_NO_MEM;
+
+    for (int i = 0; i < ASYNC_WORKER_COUNT; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "httpd_async%d", i);
+        BaseType_t ok = xTaskCreatePinnedToCore(async_worker_task, name, TASK_STACK_WEB_ASYNC, NULL,
+                                                TASK_PRIORITY_WEB_ASYNC, &s_workers[i], TASK_CORE_WEB_SERVER);
+        if (ok != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create async worker %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+        iaq_profiler_register_task(name, s_workers[i], TASK_STACK_WEB_ASYNC);
+    }
+    ESP_LOGI(TAG, "Async request pool started (%d workers)", ASYNC_WORKER_COUNT);
+    return ESP_OK;
+}
+
+bool http_async_in_worker(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < ASYNC_WORKER_COUNT; i++) {
+        if (s_workers[i] == self) return true;
+    }
+    return false;
+}
+
+esp_err_t http_async_submit(httpd_req_t *req, http_async_class_t cls, esp_err_t (*handler)(httpd_req_t *req))
+{
+    if (!s_queue) return ESP_ERR_INVALID_STATE;
+    if (cls < 0 || cls >= HTTP_ASYNC_CLASS_MAX || !handler) return ESP_ERR_INVALID_ARG;
+
+    if (!class_acquire(cls)) {
+        ESP_LOGW(TAG, "Busy: %s limit (%u) reached", s_class_name[cls], s_class_limit[cls]);
+        return ESP_ERR_NO_MEM;
+    }
+
+    http_async_job_t job = { .req = NULL, .cls = cls, .handler = handler };
+    esp_err_t err = httpd_req_async_handler_begin(req, &job.req);
+    if (err != ESP_OK) {
+        class_release(cls);
+        return err;
+    }
+    if (xQueueSend(s_queue, &job, 0) != pdTRUE) {
+        httpd_req_async_handler_complete(job.req);
+        class_release(cls);
+        ESP_LOGW(TAG, "Busy: async queue full");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,174 @@
+/* components/web_portal/http_chunk_writer.c */
+#include "http_chunk_writer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "miniz.h"
+
+static const char *TAG = "HTTP_CHUNK";
+
+#define ACCEPT_ENCODING_BUFSIZE 256
+
+/* Greedy parsing with few probes: text rows compress well without deep search */
+#define DEFLATE_FLAGS (TDEFL_GREEDY_PARSING_FLAG | 16)
+
+static const uint8_t s_gzip_header[10] = {
+    0x1f, 0x8b, 0x08, 0x00,     /* magic, CM=deflate, no flags */
+    0x00, 0x00, 0x00, 0x00,     /* mtime unknown */
+    0x00, 0xff,                 /* XFL, OS unknown */
+};
+
+static bool send_out(http_chunk_writer_t *w)
+{
+    if (w->out_len == 0) return true;
+    if (httpd_resp_send_chunk(w->req, (const char *)w->out, w->out_len) != ESP_OK) {
+        w->error = true;
+        return false;
+    }
+    w->out_len = 0;
+    return true;
+}
+
+static bool put_raw(http_chunk_writer_t *w, const void *data, size_t len)
+{
+    const uint8_t *src = data;
+    while (len > 0) {
+        if (w->out_len == sizeof(w->out) && !send_out(w)) return false;
+        size_t n = sizeof(w->out) - w->out_len;
+        if (n > len) n = len;
+        memcpy(&w->out[w->out_len], src, n);
+        w->out_len += n;
+        src += n;
+        len -= n;
+    }
+    return true;
+}
+
+/* Feed input to the compressor, draining its output straight into w->out */
+static bool deflate_feed(http_chunk_writer_t *w, const uint8_t *src, size_t len, tdefl_flush flush)
+{
+    tdefl_compressor *comp = w->deflate;
+    for (;;) {
+        if (w->out_len == sizeof(w->out) && !send_out(w)) return false;
+        size_t in_size = len;
+        size_t out_size = sizeof(w->out) - w->out_len;
+        tdefl_status st = tdefl_compress(comp, src, &in_size, &w->out[w->out_len], &out_size, flush);
+        if (st < TDEFL_STATUS_OKAY) {
+            ESP_LOGE(TAG, "deflate failed (%d)", (int)st);
+            w->error = true;
+            return false;
+        }
+        src += in_size;
+        len -= in_size;
+        w->out_len += out_size;
+        if (flush == TDEFL_FINISH) {
+            if (st == TDEFL_STATUS_DONE) return true;
+        } else if (len == 0 && w->out_len < sizeof(w->out)) {
+            return true;
+        }
+    }
+}
+
+esp_err_t http_chunk_writer_init(http_chunk_writer_t *w, httpd_req_t *req, bool gzip)
+{
+    memset(w, 0, sizeof(*w));
+    w->req = req;
+    if (!gzip) return ESP_OK;
+
+    tdefl_compressor *comp = heap_caps_malloc(sizeof(tdefl_compressor), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!comp) {
+        ESP_LOGW(TAG, "No memory for deflate state; sending uncompressed");
+        return ESP_ERR_NO_MEM;
+    }
+    if (tdefl_init(comp, NULL, NULL, DEFLATE_FLAGS) != TDEFL_STATUS_OKAY) {
+        heap_caps_free(comp);
+        return ESP_FAIL;
+    }
+    w->deflate = comp;
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    return put_raw(w, s_gzip_header, sizeof(s_gzip_header)) ? ESP_OK : ESP_FAIL;
+}
+
+bool http_chunk_writer_write(http_chunk_writer_t *w, const void *data, size_t len)
+{
+    if (w->error) return false;
+    if (len == 0) return true;
+    if (!w->deflate) return put_raw(w, data, len);
+
+    w->crc32 = esp_rom_crc32_le(w->crc32, data, len);
+    w->in_bytes += (uint32_t)len;
+    return deflate_feed(w, data, len, TDEFL_NO_FLUSH);
+}
+
+bool http_chunk_writer_finish(http_chunk_writer_t *w)
+{
+    if (w->error) return false;
+    if (w->deflate) {
+        if (!deflate_feed(w, NULL, 0, TDEFL_FINISH)) return false;
+        uint8_t trailer[8];
+        for (int i = 0; i < 4; i++) {
+            trailer[i] = (uint8_t)(w->crc32 >> (8 * i));
+            trailer[4 + i] = (uint8_t)(w->in_bytes >> (8 * i));
+        }
+        if (!put_raw(w, trailer, sizeof(trailer))) return false;
+    }
+    if (!send_out(w)) return false;
+    return httpd_resp_send_chunk(w->req, NULL, 0) == ESP_OK;
+}
+
+void http_chunk_writer_deinit(http_chunk_writer_t *w)
+{
+    if (w->deflate) {
+        heap_caps_free(w->deflate);
+        w->deflate = NULL;
+    }
+}
+
+uint8_t http_accepted_encodings(httpd_req_t *req)
+{
+    size_t ae_len = httpd_req_get_hdr_value_len(req, "Accept-Encoding");
+    if (ae_len == 0 || ae_len >= ACCEPT_ENCODING_BUFSIZE) return 0;
+    char ae[ACCEPT_ENCODING_BUFSIZE];
+    if (httpd_req_get_hdr_value_str(req, "Accept-Encoding", ae, sizeof(ae)) != ESP_OK) return 0;
+
+    uint8_t accepted = 0;
+    uint8_t refused = 0;
+    bool wildcard = false;
+    char *saveptr = NULL;
+    for (char *tok = strtok_r(ae, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        while (*tok == ' ' || *tok == '\t') tok++;
+        const char *params = strchr(tok, ';');
+        size_t name_len = params ? (size_t)(params - tok) : strlen(tok);
+        while (name_len > 0 && (tok[name_len - 1] == ' ' || tok[name_len - 1] == '\t')) name_len--;
+
+        bool zero_q = false;
+        if (params) {
+            const char *q = strstr(params, "q=");
+            if (q && strtof(q + 2, NULL) <= 0.0f) zero_q = true;
+        }
+
+        uint8_t coding = 0;
+        if (name_len == 4 && strncasecmp(tok, "gzip", 4) == 0) {
+            coding = HTTP_ENCODING_GZIP;
+        } else if (name_len == 2 && strncasecmp(tok, "br", 2) == 0) {
+            coding = HTTP_ENCODING_BR;
+        } else if (name_len == 1 && tok[0] == '*') {
+            wildcard = !zero_q;
+            continue;
+        }
+        if (zero_q) refused |= coding;
+        else accepted |= coding;
+    }
+    if (wildcard) accepted |= HTTP_ENCODING_GZIP | HTTP_ENCODING_BR;
+    return (uint8_t)(accepted & ~refused);
+}
+
+bool http_accepts_gzip(httpd_req_t *req)
+{
+    return (http_accepted_encodings(req) & HTTP_ENCODING_GZIP) != 0;
+}
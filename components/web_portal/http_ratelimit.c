@@ -0,0 +1,212 @@
+/* components/web_portal/http_ratelimit.c */
+#include "http_ratelimit.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "lwip/sockets.h"
+#include "sdkconfig.h"
+
+#include "iaq_profiler.h"
+
+static const char *TAG = "HTTP_RL";
+
+#ifndef CONFIG_IAQ_WEB_PORTAL_RATE_LIMIT_API_RPS
+#define CONFIG_IAQ_WEB_PORTAL_RATE_LIMIT_API_RPS 5
+#endif
+#ifndef CONFIG_IAQ_WEB_PORTAL_RATE_LIMIT_API_BURST
+#define CONFIG_IAQ_WEB_PORTAL_RATE_LIMIT_API_BURST 20
+#endif
+
+#define RL_MAX_CLIENTS      8       /* Tracked addresses; least recently seen is evicted */
+#define RL_PRIORITY_FACTOR  2       /* Dashboard buckets are this much larger and faster */
+#define RL_MILLI            1000U   /* Tokens are kept in thousandths */
+#define RL_MAX_PRIORITY     8       /* Distinct dashboard addresses tracked */
+
+typedef struct {
+    uint16_t burst;                 /* Bucket size (requests) */
+    uint16_t per_min;               /* Refill rate (requests per minute) */
+} rl_param_t;
+
+static const rl_param_t s_params[HTTP_RATELIMIT_CLASS_MAX] = {
+    [HTTP_RATELIMIT_CLASS_API]       = { CONFIG_IAQ_WEB_PORTAL_RATE_LIMIT_API_BURST,
+                                         CONFIG_IAQ_WEB_PORTAL_RATE_LIMIT_API_RPS * 60 },
+    /* Sized against the dashboard: one request per history range (1h/1d/7d/
+     * 30d/365d, all metrics at once), cycling through every range twice plus
+     * a page reload within a minute, then 150 s refreshes per open range */
+    [HTTP_RATELIMIT_CLASS_HISTORY]   = { 20, 30 },
+    [HTTP_RATELIMIT_CLASS_WIFI_SCAN] = { 2, 4 },
+    [HTTP_RATELIMIT_CLASS_SENSOR]    = { 3, 20 },
+    [HTTP_RATELIMIT_CLASS_WS]        = { 4, 6 },
+};
+
+static const char *s_class_name[HTTP_RATELIMIT_CLASS_MAX] = {
+    [HTTP_RATELIMIT_CLASS_API]       = "api",
+    [HTTP_RATELIMIT_CLASS_HISTORY]   = "history",
+    [HTTP_RATELIMIT_CLASS_WIFI_SCAN] = "wifi_scan",
+    [HTTP_RATELIMIT_CLASS_SENSOR]    = "sensor",
+    [HTTP_RATELIMIT_CLASS_WS]        = "ws",
+};
+
+typedef struct {
+    bool used;
+    http_ratelimit_addr_t addr;
+    int64_t last_us;                                /* Last refill (and LRU key) */
+    uint32_t tokens[HTTP_RATELIMIT_CLASS_MAX];      /* Milli-tokens */
+    uint8_t warned;                                 /* Per-class bit: rejection already logged */
+} rl_entry_t;
+
+/* Addresses with open dashboard sessions, one reference per session */
+typedef struct {
+    http_ratelimit_addr_t addr;
+    uint8_t refs;
+} rl_priority_t;
+
+static rl_entry_t s_entries[RL_MAX_CLIENTS];
+static rl_priority_t s_priority[RL_MAX_PRIORITY];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+bool http_ratelimit_peer(int sockfd, http_ratelimit_addr_t *out)
+{
+    if (!out) return false;
+    struct sockaddr_storage ss;
+    socklen_t len = sizeof(ss);
+    if (getpeername(sockfd, (struct sockaddr *)&ss, &len) != 0) return false;
+
+    memset(out, 0, sizeof(*out));
+    if (ss.ss_family == AF_INET) {
+        const struct sockaddr_in *in = (const struct sockaddr_in *)&ss;
+        out->b[10] = 0xff;
+        out->b[11] = 0xff;
+        memcpy(&out->b[12], &in->sin_addr.s_addr, 4);
+        return true;
+    }
+#if CONFIG_LWIP_IPV6
+    if (ss.ss_family == AF_INET6) {
+        const struct sockaddr_in6 *in6 = (const struct sockaddr_in6 *)&ss;
+        memcpy(out->b, &in6->sin6_addr, sizeof(out->b));
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool http_ratelimit_addr_eq(const http_ratelimit_addr_t *a, const http_ratelimit_addr_t *b)
+{
+    return memcmp(a->b, b->b, sizeof(a->b)) == 0;
+}
+
+/* Caller holds s_lock */
+static rl_priority_t *priority_lookup(const http_ratelimit_addr_t *addr)
+{
+    for (int i = 0; i < RL_MAX_PRIORITY; i++) {
+        if (s_priority[i].refs && http_ratelimit_addr_eq(&s_priority[i].addr, addr)) return &s_priority[i];
+    }
+    return NULL;
+}
+
+void http_ratelimit_priority_hold(const http_ratelimit_addr_t *addr)
+{
+    if (!addr) return;
+    portENTER_CRITICAL(&s_lock);
+    rl_priority_t *p = priority_lookup(addr);
+    for (int i = 0; i < RL_MAX_PRIORITY && !p; i++) {
+        if (!s_priority[i].refs) {
+            p = &s_priority[i];
+            p->addr = *addr;
+        }
+    }
+    if (p && p->refs < UINT8_MAX) p->refs++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void http_ratelimit_priority_release(const http_ratelimit_addr_t *addr)
+{
+    if (!addr) return;
+    portENTER_CRITICAL(&s_lock);
+    rl_priority_t *p = priority_lookup(addr);
+    if (p) p->refs--;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+/* Caller holds s_lock. New entries start with full buckets. */
+static rl_entry_t *entry_lookup(const http_ratelimit_addr_t *addr, int64_t now)
+{
+    rl_entry_t *victim = &s_entries[0];
+    for (int i = 0; i < RL_MAX_CLIENTS; i++) {
+        rl_entry_t *e = &s_entries[i];
+        if (e->used && http_ratelimit_addr_eq(&e->addr, addr)) return e;
+        if (!e->used) {
+            if (victim->used) victim = e;
+        } else if (victim->used && e->last_us < victim->last_us) {
+            victim = e;
+        }
+    }
+    memset(victim, 0, sizeof(*victim));
+    victim->used = true;
+    victim->addr = *addr;
+    victim->last_us = now;
+    for (int c = 0; c < HTTP_RATELIMIT_CLASS_MAX; c++) {
+        victim->tokens[c] = (uint32_t)s_params[c].burst * RL_MILLI;
+    }
+    return victim;
+}
+
+bool http_ratelimit_admit(const http_ratelimit_addr_t *addr, http_ratelimit_class_t cls,
+                          uint32_t *retry_after_s)
+{
+#if CONFIG_IAQ_WEB_PORTAL_RATE_LIMIT
+    if (!addr || cls < 0 || cls >= HTTP_RATELIMIT_CLASS_MAX) return true;
+
+    const int64_t now = esp_timer_get_time();
+    bool admitted;
+    bool log_reject = false;
+    uint32_t wait_s = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    const uint32_t factor = priority_lookup(addr) ? RL_PRIORITY_FACTOR : 1;
+    const uint32_t cap = (uint32_t)s_params[cls].burst * factor * RL_MILLI;
+    const uint32_t per_min = (uint32_t)s_params[cls].per_min * factor;
+    rl_entry_t *e = entry_lookup(addr, now);
+
+    /* Refill every class from the shared timestamp: milli-tokens = us * per_min / 60000 */
+    uint64_t dt = (uint64_t)(now - e->last_us);
+    e->last_us = now;
+    for (int c = 0; c < HTTP_RATELIMIT_CLASS_MAX; c++) {
+        uint32_t c_cap = (uint32_t)s_params[c].burst * RL_PRIORITY_FACTOR * RL_MILLI;
+        uint32_t c_rate = (uint32_t)s_params[c].per_min * (c == (int)cls ? factor : 1);
+        uint64_t t = e->tokens[c] + dt * c_rate / 60000U;
+        e->tokens[c] = (uint32_t)(t > c_cap ? c_cap : t);
+    }
+    if (e->tokens[cls] > cap) e->tokens[cls] = cap;
+
+    admitted = e->tokens[cls] >= RL_MILLI;
+    if (admitted) {
+        e->tokens[cls] -= RL_MILLI;
+        e->warned &= (uint8_t)~(1U << cls);
+    } else {
+        uint32_t missing = RL_MILLI - e->tokens[cls];
+        wait_s = (uint32_t)(((uint64_t)missing * 60U + per_min * RL_MILLI - 1) / (per_min * RL_MILLI));
+        log_reject = !(e->warned & (1U << cls));
+        e->warned |= (uint8_t)(1U << cls);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (admitted) return true;
+
+    if (wait_s < 1) wait_s = 1;
+    if (retry_after_s) *retry_after_s = wait_s;
+    /* Count rejections; the value is the Retry-After hint in ms */
+    iaq_profiler_record(IAQ_METRIC_WEB_RATE_LIMITED, wait_s * 1000U);
+    if (log_reject) {
+        ESP_LOGW(TAG, "Rate limiting %s requests (%u/min, burst %u)", s_class_name[cls],
+                 (unsigned)per_min, (unsigned)(cap / RL_MILLI));
+    }
+    return false;
+#else
+    (void)addr; (void)cls; (void)retry_after_s;
+    return true;
+#endif
+}
@@ -0,0 +1,41 @@
+/* components/web_portal/include/http_async.h */
+#ifndef HTTP_ASYNC_H
+#define HTTP_ASYNC_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+/**
+ * Endpoint classes for offloaded handlers. Each class has its own
+ * concurrency limit so one slow workload cannot occupy every worker.
+ */
+typedef enum {
+    HTTP_ASYNC_CLASS_HISTORY = 0,   /* History streaming/export (aggregation) */
+    HTTP_ASYNC_CLASS_WIFI_SCAN,     /* Blocking Wi-Fi scan */
+    HTTP_ASYNC_CLASS_OTA,           /* Firmware/frontend uploads (long flash writes) */
+    HTTP_ASYNC_CLASS_SENSOR,        /* Synchronous sensor reads */
+    HTTP_ASYNC_CLASS_MAX
+} http_async_class_t;
+
+/**
+ * Start the worker pool (CONFIG_IAQ_WEB_PORTAL_ASYNC_WORKERS tasks).
+ * Safe to call more than once.
+ */
+esp_err_t http_async_init(void);
+
+/** True when called from one of the async worker tasks. */
+bool http_async_in_worker(void);
+
+/**
+ * Detach a request from the httpd task and run handler(req) on a worker.
+ * The handler is re-entered with the async copy of the request; it should
+ * check http_async_in_worker() to avoid offloading again.
+ *
+ * @return ESP_OK if queued (the httpd task must return ESP_OK immediately),
+ *         ESP_ERR_INVALID_STATE if the pool is not running (serve inline),
+ *         ESP_ERR_NO_MEM if the class limit or queue is full (reply 503).
+ */
+esp_err_t http_async_submit(httpd_req_t *req, http_async_class_t cls, esp_err_t (*handler)(httpd_req_t *req));
+
+#endif /* HTTP_ASYNC_H */
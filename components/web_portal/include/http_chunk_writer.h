@@ -0,0 +1,62 @@
+/* components/web_portal/include/http_chunk_writer.h */
+#ifndef HTTP_CHUNK_WRITER_H
+#define HTTP_CHUNK_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#define HTTP_CHUNK_WRITER_BUF_SIZE 1024
+
+/**
+ * Buffered chunked-response writer with optional streaming gzip.
+ *
+ * Output is staged in a fixed buffer and sent with httpd_resp_send_chunk()
+ * whenever it fills, so the full body is never held in memory. When gzip is
+ * enabled the deflate state (~300 KB) lives in PSRAM for the lifetime of the
+ * writer only.
+ */
+typedef struct {
+    httpd_req_t *req;
+    void *deflate;          /* tdefl_compressor*, NULL = identity encoding */
+    uint32_t crc32;         /* gzip trailer: CRC-32 of uncompressed data */
+    uint32_t in_bytes;      /* gzip trailer: uncompressed size mod 2^32 */
+    size_t out_len;
+    bool error;             /* Send failed (client gone); further writes are no-ops */
+    uint8_t out[HTTP_CHUNK_WRITER_BUF_SIZE];
+} http_chunk_writer_t;
+
+/**
+ * Prepare a writer. With gzip=true, also sets "Content-Encoding: gzip";
+ * call before any other response header is committed.
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the compressor could not be allocated
+ *         (the writer is then valid in identity mode).
+ */
+esp_err_t http_chunk_writer_init(http_chunk_writer_t *w, httpd_req_t *req, bool gzip);
+
+/** Append bytes to the response body. Returns false once the client is gone. */
+bool http_chunk_writer_write(http_chunk_writer_t *w, const void *data, size_t len);
+
+/** Flush compressor/trailer and terminate the chunked response. */
+bool http_chunk_writer_finish(http_chunk_writer_t *w);
+
+/** Release compressor memory (safe after finish or on abort). */
+void http_chunk_writer_deinit(http_chunk_writer_t *w);
+
+/* Content codings understood by http_accepted_encodings() */
+#define HTTP_ENCODING_GZIP  0x01
+#define HTTP_ENCODING_BR    0x02
+
+/**
+ * Parse Accept-Encoding into HTTP_ENCODING_* bits. Codings with q=0 are
+ * excluded; "*" accepts every coding not excluded explicitly.
+ */
+uint8_t http_accepted_encodings(httpd_req_t *req);
+
+/** True if the request's Accept-Encoding header accepts gzip. */
+bool http_accepts_gzip(httpd_req_t *req);
+
+#endif /* HTTP_CHUNK_WRITER_H */
@@ -0,0 +1,51 @@
+/* components/web_portal/include/http_ratelimit.h */
+#ifndef HTTP_RATELIMIT_H
+#define HTTP_RATELIMIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Endpoint classes for admission control. Each client address gets one
+ * token bucket per class, so polling /state fast does not use up the
+ * budget for history or scans.
+ */
+typedef enum {
+    HTTP_RATELIMIT_CLASS_API = 0,       /* Cheap JSON endpoints (state, health, config) */
+    HTTP_RATELIMIT_CLASS_HISTORY,       /* History query/export (aggregation, PSRAM reads) */
+    HTTP_RATELIMIT_CLASS_WIFI_SCAN,     /* Radio scan (disturbs STA traffic) */
+    HTTP_RATELIMIT_CLASS_SENSOR,        /* Sensor actions (bus traffic, sensor locks) */
+    HTTP_RATELIMIT_CLASS_WS,            /* WebSocket handshakes */
+    HTTP_RATELIMIT_CLASS_MAX
+} http_ratelimit_class_t;
+
+/** Client address key (IPv4 stored as v4-mapped IPv6). */
+typedef struct {
+    uint8_t b[16];
+} http_ratelimit_addr_t;
+
+/** Resolve the peer address of an open socket. */
+bool http_ratelimit_peer(int sockfd, http_ratelimit_addr_t *out);
+
+/** True if both addresses are equal. */
+bool http_ratelimit_addr_eq(const http_ratelimit_addr_t *a, const http_ratelimit_addr_t *b);
+
+/**
+ * Mark an address as a priority client (the dashboard) while it holds an open
+ * session. Calls nest: one hold per session, released when it closes.
+ */
+void http_ratelimit_priority_hold(const http_ratelimit_addr_t *addr);
+void http_ratelimit_priority_release(const http_ratelimit_addr_t *addr);
+
+/**
+ * Take one token from the client's bucket for this class.
+ * Priority clients get larger buckets that refill faster.
+ * Only a spinlock is taken; no data locks, no allocation.
+ *
+ * @param retry_after_s Set to seconds until a token is available when rejected
+ * @return true if the request may proceed
+ */
+bool http_ratelimit_admit(const http_ratelimit_addr_t *addr, http_ratelimit_class_t cls,
+                          uint32_t *retry_after_s);
+
+#endif /* HTTP_RATELIMIT_H */
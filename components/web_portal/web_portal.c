@@ -6,6 +6,7 @@
 #include <strings.h>
 #include <time.h>
 #include <ctype.h>
+#include <stdarg.h>
 #include "esp_log.h"
 #include "esp_littlefs.h"
 #include "esp_timer.h"
@@ -23,11 +24,14 @@
 #include "lwip/inet.h"
 #include "esp_ota_ops.h"
 #include "esp_partition.h"
+#include "esp_random.h"
+#include "mbedtls/pk.h"
 
 #include "iaq_config.h"
 #include "iaq_data.h"
 #include "iaq_json.h"
 #include "iaq_history.h"
+#include "iaq_record.h"
 #include "wifi_manager.h"
 #include "mqtt_manager.h"
 #include "sensor_coordinator.h"
@@ -37,9 +41,17 @@
 #include "web_portal.h"
 #include "iaq_profiler.h"
 #include "pm_guard.h"
+#include "periodic_sched.h"
+#include "wifi_ps_policy.h"
 #include "power_board.h"
 #include "ota_manager.h"
 #include "web_console.h"
+#include "http_chunk_writer.h"
+#include "http_async.h"
+#include "http_ratelimit.h"
+#include "ws_deflate.h"
+#include "blackbox.h"
+#include "www_pack.h"
 
 static const char *TAG = "WEB_PORTAL";
 
@@ -48,7 +60,6 @@ static const char *TAG = "WEB_PORTAL";
 
 /* Buffer size constants */
 #define WEB_MAX_JSON_BODY_SIZE      4096    /* Max size for JSON request bodies */
-#define WEB_ACCEPT_ENCODING_BUFSIZE 256     /* Buffer for Accept-Encoding header */
 #define WEB_MAX_TLS_CERT_SIZE       40960   /* Max size for TLS cert/key files */
 #define OTA_UPLOAD_CHUNK_SIZE       4096    /* Chunk size for OTA uploads */
 #ifndef CONFIG_IAQ_WEB_PORTAL_STATIC_CHUNK_SIZE
@@ -60,7 +71,7 @@ static const char *TAG = "WEB_PORTAL";
 
 /* Minimum stack size: base overhead + static chunk buffer + safety margin
  * Base covers: HTTPD framework, TLS (if HTTPS), handler locals (path buffers, stat structs)
- * static_handler uses ~800 bytes beyond chunk for path[128+], gz_path[132+], cc[64], stats */
+ * static_handler uses ~800 bytes beyond chunk for path[128+], enc_path[132+], cc[64], stats */
 #define WEB_HTTPD_STACK_BASE    6144
 #define WEB_HTTPD_STACK_MARGIN  1024
 #define WEB_HTTPD_STACK_MIN     (WEB_HTTPD_STACK_BASE + WEB_STATIC_CHUNK_SIZE + WEB_HTTPD_STACK_MARGIN)
@@ -73,7 +84,11 @@ static const char *TAG = "WEB_PORTAL";
 typedef struct {
     int sock;  /* socket fd */
     bool active;
+    bool deflate;  /* Opted in with ?deflate=1 */
+    bool has_peer;
+    http_ratelimit_addr_t peer;  /* Dashboard clients get rate-limit priority */
     int64_t last_pong_us;
+    int64_t ping_sent_us;  /* Outstanding PING, for round-trip time */
 } ws_client_t;
 
 /* ws_async_arg removed (no longer needed) */
@@ -84,11 +99,13 @@ static volatile bool s_portal_restart_pending = false;
 static iaq_system_context_t *s_ctx = NULL;
 static ws_client_t s_ws_clients[MAX_WS_CLIENTS];
 static SemaphoreHandle_t s_ws_mutex;
+static ws_deflate_t s_ws_deflate;  /* Per-message: each broadcast compressed independently */
 static TaskHandle_t s_httpd_task_handle = NULL;
+static volatile bool s_ota_active = false;  /* Upload running; read by the Wi-Fi power-save probe */
 
-static esp_timer_handle_t s_ws_state_timer = NULL;
-static esp_timer_handle_t s_ws_metrics_timer = NULL;
-static esp_timer_handle_t s_ws_health_timer = NULL;
+static periodic_work_handle_t s_ws_state_timer = NULL;
+static periodic_work_handle_t s_ws_metrics_timer = NULL;
+static periodic_work_handle_t s_ws_health_timer = NULL;
 static bool s_ws_timers_running = false;
 static dns_server_handle_t s_dns = NULL;
 
@@ -102,16 +119,33 @@ static void dhcp_set_captiveportal_uri(void);
 static esp_err_t http_404_error_handler(httpd_req_t *req, httpd_err_code_t err);
 
 /* Helpers */
+/* Free a client slot (s_ws_mutex held). An address with an open /ws session
+ * is the dashboard: the rate limiter keeps its own copy of that set. */
+static void ws_client_release_locked(ws_client_t *c)
+{
+    if (c->has_peer) http_ratelimit_priority_release(&c->peer);
+    c->active = false;
+    c->has_peer = false;
+    c->sock = -1;
+    c->last_pong_us = 0;
+}
+
 static void ws_clients_init(void)
 {
+    for (int i = 0; i < MAX_WS_CLIENTS; ++i) {
+        if (s_ws_clients[i].active) ws_client_release_locked(&s_ws_clients[i]);
+    }
     memset(s_ws_clients, 0, sizeof(s_ws_clients));
     if (!s_ws_mutex) s_ws_mutex = xSemaphoreCreateMutex();
     if (!s_ws_mutex) {
         ESP_LOGE(TAG, "WS: failed to create mutex");
     }
+    if (!s_ws_deflate.lock && ws_deflate_init(&s_ws_deflate, false) != ESP_OK) {
+        ESP_LOGW(TAG, "WS: compression unavailable");
+    }
 }
 
-static bool ws_clients_add(int sock)
+static bool ws_clients_add(int sock, bool deflate)
 {
     if (!s_ws_mutex) return false;
     xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
@@ -121,7 +155,11 @@ static bool ws_clients_add(int sock)
         if (!s_ws_clients[i].active) {
             s_ws_clients[i].sock = sock;
             s_ws_clients[i].active = true;
+            s_ws_clients[i].deflate = deflate;
+            s_ws_clients[i].has_peer = http_ratelimit_peer(sock, &s_ws_clients[i].peer);
+            if (s_ws_clients[i].has_peer) http_ratelimit_priority_hold(&s_ws_clients[i].peer);
             s_ws_clients[i].last_pong_us = esp_timer_get_time();
+            s_ws_clients[i].ping_sent_us = 0;
             added = true;
             break;
         }
@@ -137,9 +175,9 @@ static bool ws_clients_add(int sock)
     xSemaphoreGive(s_ws_mutex);
     if (need_start) {
         ESP_LOGI(TAG, "WS: first client, starting timers");
-        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_start_periodic(s_ws_state_timer, 1000 * 1000));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_start_periodic(s_ws_metrics_timer, 5 * 1000 * 1000));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_start_periodic(s_ws_health_timer, 1 * 1000 * 1000));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_start(s_ws_state_timer, 1000 * 1000, 1000 * 1000));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_start(s_ws_metrics_timer, 5 * 1000 * 1000, 5 * 1000 * 1000));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_start(s_ws_health_timer, 1 * 1000 * 1000, 1 * 1000 * 1000));
     }
     return added;
 }
@@ -150,9 +188,7 @@ static void ws_clients_remove(int sock)
     xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
     for (int i = 0; i < MAX_WS_CLIENTS; ++i) {
         if (s_ws_clients[i].active && s_ws_clients[i].sock == sock) {
-            s_ws_clients[i].active = false;
-            s_ws_clients[i].sock = -1;
-            s_ws_clients[i].last_pong_us = 0;
+            ws_client_release_locked(&s_ws_clients[i]);
             /* Ask httpd to close the session (safe from any task) */
             if (s_server && sock >= 0) {
                 httpd_sess_trigger_close(s_server, sock);
@@ -169,9 +205,9 @@ static void ws_clients_remove(int sock)
     xSemaphoreGive(s_ws_mutex);
     if (need_stop) {
         ESP_LOGI(TAG, "WS: last client gone, stopping timers");
-        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_stop(s_ws_state_timer));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_stop(s_ws_metrics_timer));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_stop(s_ws_health_timer));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_stop(s_ws_state_timer));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_stop(s_ws_metrics_timer));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_stop(s_ws_health_timer));
     }
 }
 
@@ -197,9 +233,11 @@ static void ws_broadcast_json(const char *type, cJSON *payload)
 
     /* Copy active client sockets under mutex, then release before sending */
     int active_socks[MAX_WS_CLIENTS];
+    bool active_deflate[MAX_WS_CLIENTS];
     int stale_socks[MAX_WS_CLIENTS];
     int active_count = 0;
     int stale_count = 0;
+    bool any_deflate = false;
 
     if (s_ws_mutex) xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
     for (int i = 0; i < MAX_WS_CLIENTS; ++i) {
@@ -208,11 +246,11 @@ static void ws_broadcast_json(const char *type, cJSON *payload)
         if (httpd_ws_get_fd_info(s_server, sock) != HTTPD_WS_CLIENT_WEBSOCKET) {
             ESP_LOGD(TAG, "WS fd %d not in WEBSOCKET state during broadcast; removing", sock);
             stale_socks[stale_count++] = sock;
-            s_ws_clients[i].active = false;
-            s_ws_clients[i].sock = -1;
-            s_ws_clients[i].last_pong_us = 0;
+            ws_client_release_locked(&s_ws_clients[i]);
             continue;
         }
+        active_deflate[active_count] = s_ws_clients[i].deflate;
+        any_deflate |= s_ws_clients[i].deflate;
         active_socks[active_count++] = sock;
     }
     if (s_ws_mutex) xSemaphoreGive(s_ws_mutex);
@@ -224,17 +262,29 @@ static void ws_broadcast_json(const char *type, cJSON *payload)
         }
     }
 
-    /* Send to all active clients WITHOUT holding mutex */
+    /* Compress once for all opted-in clients; small messages stay plain */
     size_t txt_len = strlen(txt);
+    uint8_t *zframe = NULL;
+    size_t zframe_len = 0;
+    if (any_deflate) {
+        (void)ws_deflate_compress(&s_ws_deflate, txt, txt_len, &zframe, &zframe_len);
+    } else {
+        ws_deflate_release(&s_ws_deflate);
+    }
+
+    /* Send to all active clients WITHOUT holding mutex */
     httpd_ws_frame_t frame = { .type = HTTPD_WS_TYPE_TEXT, .payload = (uint8_t*)txt, .len = txt_len };
+    httpd_ws_frame_t zfrm = { .type = HTTPD_WS_TYPE_BINARY, .payload = zframe, .len = zframe_len };
     for (int i = 0; i < active_count; ++i) {
-        esp_err_t er = httpd_ws_send_frame_async(s_server, active_socks[i], &frame);
+        httpd_ws_frame_t *f = (zframe && active_deflate[i]) ? &zfrm : &frame;
+        esp_err_t er = httpd_ws_send_frame_async(s_server, active_socks[i], f);
         if (er != ESP_OK) {
             ESP_LOGW(TAG, "WS: broadcast to %d failed: %s, removing client", active_socks[i], esp_err_to_name(er));
             ws_clients_remove(active_socks[i]);
         }
     }
 
+    free(zframe);
     free(txt);
     iaq_prof_toc(IAQ_METRIC_WEB_WS_BROADCAST, t0);
 }
@@ -314,6 +364,8 @@ static cJSON* build_ota_progress_json(ota_type_t type, ota_state_t state, uint8_
 static void ota_progress_ws_cb(ota_type_t type, ota_state_t state, uint8_t progress,
                                size_t received, size_t total, const char *error_msg)
 {
+    s_ota_active = (state == OTA_STATE_RECEIVING || state == OTA_STATE_VALIDATING);
+
     static ota_type_t last_type = OTA_TYPE_NONE;
     static ota_state_t last_state = OTA_STATE_IDLE;
     static uint8_t last_progress = 255;
@@ -379,20 +431,17 @@ static void ws_ping_and_prune(void)
         if (httpd_ws_get_fd_info(s_server, sock) != HTTPD_WS_CLIENT_WEBSOCKET) {
             ESP_LOGD(TAG, "WS fd %d not in WEBSOCKET state during ping; removing", sock);
             stale_socks[stale_count++] = sock;
-            s_ws_clients[i].active = false;
-            s_ws_clients[i].sock = -1;
-            s_ws_clients[i].last_pong_us = 0;
+            ws_client_release_locked(&s_ws_clients[i]);
             continue;
         }
         int64_t last = s_ws_clients[i].last_pong_us;
         if (last > 0 && (now - last) > ((int64_t)CONFIG_IAQ_WEB_PORTAL_WS_PONG_TIMEOUT_SEC * 1000000LL)) {
             ESP_LOGW(TAG, "WS: client %d stale (> %ds), removing", sock, CONFIG_IAQ_WEB_PORTAL_WS_PONG_TIMEOUT_SEC);
             stale_socks[stale_count++] = sock;
-            s_ws_clients[i].active = false;
-            s_ws_clients[i].sock = -1;
-            s_ws_clients[i].last_pong_us = 0;
+            ws_client_release_locked(&s_ws_clients[i]);
             continue;
         }
+        s_ws_clients[i].ping_sent_us = now;
         ping_socks[ping_count++] = sock;
     }
     xSemaphoreGive(s_ws_mutex);
@@ -434,6 +483,10 @@ static void ws_health_timer_cb(void *arg)
     }
 }
 
+/* Wi-Fi power-save demand probes (esp_timer task; must not block) */
+static bool ps_probe_dashboard(void) { return s_ws_timers_running; }
+static bool ps_probe_ota(void) { return s_ota_active; }
+
 /* Coalesced health push: schedule a one-shot send a short time in the future
  * to batch multiple state changes into a single snapshot. */
 /* No coalescing needed with 1 Hz health updates */
@@ -459,7 +512,9 @@ static void set_status_code(httpd_req_t *req, int status)
         case 404: httpd_resp_set_status(req, "404 Not Found"); break;
         case 409: httpd_resp_set_status(req, "409 Conflict"); break;
         case 413: httpd_resp_set_status(req, "413 Payload Too Large"); break;
+        case 429: httpd_resp_set_status(req, "429 Too Many Requests"); break;
         case 500: httpd_resp_set_status(req, "500 Internal Server Error"); break;
+        case 503: httpd_resp_set_status(req, "503 Service Unavailable"); break;
         default:  httpd_resp_set_status(req, "400 Bad Request"); break;
     }
 }
@@ -489,6 +544,48 @@ static void respond_error(httpd_req_t *req, int status, const char *code, const
     respond_json(req, root, status);
 }
 
+/* Run a slow handler on the async pool so the httpd task keeps serving.
+ * Returns true when the request was handed off or rejected as busy (the
+ * caller returns ESP_OK), false when it should be served inline. */
+static bool offload_request(httpd_req_t *req, http_async_class_t cls, esp_err_t (*handler)(httpd_req_t *req))
+{
+    if (http_async_in_worker()) return false;
+    esp_err_t r = http_async_submit(req, cls, handler);
+    if (r == ESP_OK) return true;
+    if (r == ESP_ERR_NO_MEM) {
+        httpd_resp_set_hdr(req, "Retry-After", "2");
+        respond_error(req, 503, "BUSY", "Server busy, retry shortly");
+        return true;
+    }
+    return false; /* Pool unavailable: serve inline as before */
+}
+
+/* Token-bucket admission per client address and endpoint class. Offloaded
+ * requests were admitted before the hand-off, so workers skip the check. */
+static bool rate_limit_admit(httpd_req_t *req, http_ratelimit_class_t cls, uint32_t *retry_after_s)
+{
+    if (http_async_in_worker()) return true;
+    http_ratelimit_addr_t peer;
+    if (!http_ratelimit_peer(httpd_req_to_sockfd(req), &peer)) return true;
+    return http_ratelimit_admit(&peer, cls, retry_after_s);
+}
+
+/* Returns true when the request was rejected with 429. The body is a
+ * constant so an abusive client costs no JSON building or data locks. */
+static bool rate_limited(httpd_req_t *req, http_ratelimit_class_t cls)
+{
+    uint32_t retry_s = 1;
+    if (rate_limit_admit(req, cls, &retry_s)) return false;
+    char retry[12];
+    snprintf(retry, sizeof(retry), "%u", (unsigned)retry_s);
+    set_cors(req);
+    set_status_code(req, 429);
+    httpd_resp_set_hdr(req, "Retry-After", retry);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, "{\"error\":{\"code\":\"RATE_LIMITED\",\"message\":\"Too many requests\",\"status\":429}}");
+    return true;
+}
+
 static esp_err_t api_options_handler(httpd_req_t *req)
 {
     set_cors(req);
@@ -561,6 +658,109 @@ static bool is_captive_probe_request(const char *uri)
     return false;
 }
 
+/* Precompressed sibling of path the client accepts, best first.
+ * Writes the sibling path to out and returns the Content-Encoding token. */
+static const char *static_pick_encoded(const char *path, uint8_t encodings, char *out, size_t out_len)
+{
+    static const struct {
+        uint8_t encoding;
+        const char *suffix;
+        const char *token;
+    } variants[] = {
+        { HTTP_ENCODING_BR,   ".br", "br" },
+        { HTTP_ENCODING_GZIP, ".gz", "gzip" },
+    };
+    for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        if (!(encodings & variants[i].encoding)) continue;
+        snprintf(out, out_len, "%s%s", path, variants[i].suffix);
+        struct stat st;
+        if (stat(out, &st) == 0 && st.st_size > 0) return variants[i].token;
+    }
+    return NULL;
+}
+
+/* Caching: long TTL for hashed assets, no-cache for HTML, default otherwise */
+static void static_set_cache_control(httpd_req_t *req, const char *uri, bool is_html, char *cc, size_t cc_len)
+{
+    if (strncmp(uri, "/assets/", 8) == 0) {
+        snprintf(cc, cc_len, "public, max-age=%d, immutable", 31536000); /* 1 year */
+    } else if (is_html) {
+        snprintf(cc, cc_len, "no-cache");
+    } else {
+        snprintf(cc, cc_len, "public, max-age=%d", CONFIG_IAQ_WEB_PORTAL_STATIC_MAX_AGE_SEC);
+    }
+    httpd_resp_set_hdr(req, "Cache-Control", cc);
+}
+
+static bool static_etag_matches(httpd_req_t *req, const char *etag)
+{
+    char inm[96];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) != ESP_OK) return false;
+    return strcmp(inm, "*") == 0 || strstr(inm, etag) != NULL;
+}
+
+/* Serve uri from the mapped asset pack: one index lookup, body sent straight
+ * from flash. Caller holds a www_pack acquire. Returns false if not found. */
+static bool static_send_pack(httpd_req_t *req, const char *uri, uint8_t encodings)
+{
+    static const struct {
+        www_pack_encoding_t variant;
+        uint8_t encoding;
+        const char *token;
+        const char *etag_suffix;
+    } variants[] = {
+        { WWW_PACK_ENC_BR,   HTTP_ENCODING_BR,   "br",   "-br" },
+        { WWW_PACK_ENC_GZIP, HTTP_ENCODING_GZIP, "gzip", "-gz" },
+    };
+
+    www_pack_asset_t asset;
+    bool fallback_html = false;
+    size_t uri_len = strcspn(uri, "?");
+    if (!www_pack_find(uri, uri_len, &asset)) {
+        /* SPA history fallback for navigation requests, 404 for assets */
+        if (memchr(uri, '.', uri_len) != NULL) return false;
+        if (!www_pack_find("/index.html", strlen("/index.html"), &asset)) return false;
+        fallback_html = true;
+    }
+
+    const uint8_t *body = asset.variants[WWW_PACK_ENC_IDENTITY].data;
+    size_t body_len = asset.variants[WWW_PACK_ENC_IDENTITY].size;
+    const char *content_encoding = NULL;
+    const char *etag_suffix = "";
+    for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        if (!(encodings & variants[i].encoding) || asset.variants[variants[i].variant].size == 0) continue;
+        body = asset.variants[variants[i].variant].data;
+        body_len = asset.variants[variants[i].variant].size;
+        content_encoding = variants[i].token;
+        etag_suffix = variants[i].etag_suffix;
+        break;
+    }
+    if (body_len == 0) return false; /* Only encodings the client refused */
+
+    char etag[40];
+    snprintf(etag, sizeof(etag), "\"%.24s%s\"", asset.etag, etag_suffix);
+    char cc[64];
+    const char *ext = strrchr(asset.path, '.');
+    bool is_html = fallback_html || (ext && (!strcasecmp(ext, ".html") || !strcasecmp(ext, ".htm")));
+    static_set_cache_control(req, fallback_html ? "/" : asset.path, is_html, cc, sizeof(cc));
+    httpd_resp_set_hdr(req, "ETag", etag);
+    if (asset.variants[WWW_PACK_ENC_GZIP].size || asset.variants[WWW_PACK_ENC_BR].size) {
+        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    }
+
+    if (static_etag_matches(req, etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, NULL, 0);
+        return true;
+    }
+
+    httpd_resp_set_type(req, asset.content_type);
+    if (content_encoding) httpd_resp_set_hdr(req, "Content-Encoding", content_encoding);
+    /* Straight from the flash mapping; Content-Length, no chunk buffer */
+    httpd_resp_send(req, (const char *)body, (ssize_t)body_len);
+    return true;
+}
+
 static esp_err_t static_handler(httpd_req_t *req)
 {
     uint64_t t0 = iaq_prof_tic();
@@ -581,64 +781,45 @@ static esp_err_t static_handler(httpd_req_t *req)
         return ESP_OK;
     }
     if (strcmp(uri, "/") == 0) uri = "/index.html"; /* SPA entry */
-    snprintf(path, sizeof(path), WEB_MOUNT_POINT "%s", uri);
 
-    /* Determine if client accepts gzip */
-    bool client_accepts_gzip = false;
-    size_t ae_len = httpd_req_get_hdr_value_len(req, "Accept-Encoding");
-    if (ae_len > 0 && ae_len < WEB_ACCEPT_ENCODING_BUFSIZE) {
-        char ae[WEB_ACCEPT_ENCODING_BUFSIZE];
-        if (httpd_req_get_hdr_value_str(req, "Accept-Encoding", ae, sizeof(ae)) == ESP_OK) {
-            if (strstr(ae, "gzip") != NULL) client_accepts_gzip = true;
-        }
+    /* Content negotiation over precompressed variants: br, then gzip, then identity */
+    uint8_t encodings = http_accepted_encodings(req);
+    if (www_pack_acquire()) {
+        bool sent = static_send_pack(req, uri, encodings);
+        www_pack_release();
+        if (!sent) respond_error(req, 404, "NOT_FOUND", "Resource not found");
+        iaq_prof_toc(IAQ_METRIC_WEB_STATIC, t0);
+        return ESP_OK;
     }
 
-    /* Prefer precompressed .gz variant when supported and available */
-    char gz_path[sizeof(path) + 4];
-    snprintf(gz_path, sizeof(gz_path), "%s.gz", path);
-
+    snprintf(path, sizeof(path), WEB_MOUNT_POINT "%s", uri);
+    char enc_path[sizeof(path) + 4];
     const char *serve_path = path; /* default */
-    bool serve_gzip = false;
+    const char *content_encoding = static_pick_encoded(path, encodings, enc_path, sizeof(enc_path));
     bool serve_fallback_html = false; /* SPA history fallback */
+    if (content_encoding) serve_path = enc_path;
 
     struct stat st_orig;
-    struct stat st_gz;
-
     bool orig_ok = (stat(path, &st_orig) == 0 && st_orig.st_size > 0);
-    bool gz_ok = false;
-    if (client_accepts_gzip) {
-        gz_ok = (stat(gz_path, &st_gz) == 0 && st_gz.st_size > 0);
-        if (gz_ok) {
-            serve_path = gz_path;
-            serve_gzip = true;
-        }
-    }
 
     /* If file not found, implement SPA history API fallback: serve index.html
      * for navigation requests (paths with no extension), so `/config` reloads
      * load the app instead of 404. Keep 404 for missing assets. */
-    if (!orig_ok && !serve_gzip) {
+    if (!orig_ok && !content_encoding) {
         bool has_dot = (strchr(uri, '.') != NULL);
         if (!has_dot) {
-            /* Fallback to /index.html (or .gz if available and accepted) */
+            /* Fallback to /index.html (or a precompressed variant if accepted) */
             static char index_path[sizeof(WEB_MOUNT_POINT) + 16];
-            static char index_gz_path[sizeof(WEB_MOUNT_POINT) + 20];
+            static char index_enc_path[sizeof(WEB_MOUNT_POINT) + 20];
             snprintf(index_path, sizeof(index_path), WEB_MOUNT_POINT "/index.html");
-            snprintf(index_gz_path, sizeof(index_gz_path), WEB_MOUNT_POINT "/index.html.gz");
             struct stat st_idx;
-            struct stat st_idx_gz;
             bool idx_ok = (stat(index_path, &st_idx) == 0 && st_idx.st_size > 0);
-            bool idx_gz_ok = false;
-            if (client_accepts_gzip) {
-                idx_gz_ok = (stat(index_gz_path, &st_idx_gz) == 0 && st_idx_gz.st_size > 0);
-            }
-            if (idx_gz_ok) {
-                serve_path = index_gz_path;
-                serve_gzip = true;
+            content_encoding = static_pick_encoded(index_path, encodings, index_enc_path, sizeof(index_enc_path));
+            if (content_encoding) {
+                serve_path = index_enc_path;
                 serve_fallback_html = true;
             } else if (idx_ok) {
                 serve_path = index_path;
-                serve_gzip = false;
                 serve_fallback_html = true;
             } else {
                 /* No index.html available: return 404 as before */
@@ -665,27 +846,19 @@ static esp_err_t static_handler(httpd_req_t *req)
     if (serve_fallback_html) {
         httpd_resp_set_type(req, "text/html");
     } else {
-        /* Based on original (non-.gz) extension */
+        /* Based on original (non-.br/.gz) extension */
         httpd_resp_set_type(req, guess_mime_type(path));
     }
-    if (serve_gzip) {
-        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
-        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    if (content_encoding) {
+        httpd_resp_set_hdr(req, "Content-Encoding", content_encoding);
     }
+    /* Also on identity responses, or a cache could hand them to gzip/br clients */
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
 
-    /* Caching: long TTL for hashed assets, no-cache for HTML, default otherwise */
     char cc[64];
     const char *ext = strrchr(uri, '.');
     bool is_html = serve_fallback_html || (ext && (!strcasecmp(ext, ".html") || !strcasecmp(ext, ".htm"))) || strcmp(uri, "/") == 0;
-    bool is_asset = (strncmp(uri, "/assets/", 8) == 0);
-    if (is_asset) {
-        snprintf(cc, sizeof(cc), "public, max-age=%d, immutable", 31536000); /* 1 year */
-    } else if (is_html) {
-        snprintf(cc, sizeof(cc), "no-cache");
-    } else {
-        snprintf(cc, sizeof(cc), "public, max-age=%d", CONFIG_IAQ_WEB_PORTAL_STATIC_MAX_AGE_SEC);
-    }
-    httpd_resp_set_hdr(req, "Cache-Control", cc);
+    static_set_cache_control(req, uri, is_html, cc, sizeof(cc));
 
     char buf[WEB_STATIC_CHUNK_SIZE];
     size_t n;
@@ -701,6 +874,7 @@ static esp_err_t static_handler(httpd_req_t *req)
 /* ===== API handlers ===== */
 static esp_err_t api_info_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     iaq_data_t snap = {0}; IAQ_DATA_WITH_LOCK() { snap = *iaq_data_get(); }
     cJSON *root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "device_id", CONFIG_IAQ_DEVICE_ID);
@@ -768,6 +942,7 @@ static esp_err_t api_info_get(httpd_req_t *req)
 
 static esp_err_t api_state_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     uint64_t t0 = iaq_prof_tic();
     iaq_data_t s = (iaq_data_t){0}; IAQ_DATA_WITH_LOCK(){s=*iaq_data_get();}
     respond_json(req, iaq_json_build_state(&s), 200);
@@ -777,6 +952,7 @@ static esp_err_t api_state_get(httpd_req_t *req)
 
 static esp_err_t api_metrics_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     uint64_t t0 = iaq_prof_tic();
     iaq_data_t s = (iaq_data_t){0}; IAQ_DATA_WITH_LOCK(){s=*iaq_data_get();}
     respond_json(req, iaq_json_build_metrics(&s), 200);
@@ -786,44 +962,108 @@ static esp_err_t api_metrics_get(httpd_req_t *req)
 
 static esp_err_t api_health_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     uint64_t t0 = iaq_prof_tic();
     iaq_data_t s = (iaq_data_t){0}; IAQ_DATA_WITH_LOCK(){s=*iaq_data_get();}
-    respond_json(req, iaq_json_build_health(&s), 200);
+    cJSON *root = iaq_json_build_health(&s);
+    if (root) {
+        cJSON *ps = wifi_ps_policy_build_json();
+        if (ps) cJSON_AddItemToObject(root, "wifi_ps", ps);
+    }
+    respond_json(req, root, 200);
     iaq_prof_toc(IAQ_METRIC_WEB_API_HEALTH, t0);
     return ESP_OK;
 }
 
-typedef struct {
-    const char *key;
-    history_metric_id_t id;
-} history_metric_map_t;
-
-static const history_metric_map_t s_history_metric_map[] = {
-    { "temp_c", HIST_METRIC_TEMP },
-    { "rh_pct", HIST_METRIC_HUMIDITY },
-    { "co2_ppm", HIST_METRIC_CO2 },
-    { "pressure_hpa", HIST_METRIC_PRESSURE },
-    { "pm1_ugm3", HIST_METRIC_PM1 },
-    { "pm25_ugm3", HIST_METRIC_PM25 },
-    { "pm10_ugm3", HIST_METRIC_PM10 },
-    { "voc_index", HIST_METRIC_VOC },
-    { "nox_index", HIST_METRIC_NOX },
-    { "mold_risk", HIST_METRIC_MOLD_RISK },
-    { "aqi", HIST_METRIC_AQI },
-    { "comfort_score", HIST_METRIC_COMFORT },
-    { "iaq_score", HIST_METRIC_IAQ_SCORE },
-};
-
-static bool history_metric_from_key(const char *key, history_metric_id_t *out)
-{
-    if (!key || !out) return false;
-    for (size_t i = 0; i < sizeof(s_history_metric_map) / sizeof(s_history_metric_map[0]); i++) {
-        if (strcmp(key, s_history_metric_map[i].key) == 0) {
-            *out = s_history_metric_map[i].id;
-            return true;
+static cJSON *blackbox_event_json(const blackbox_event_t *ev)
+{
+    cJSON *o = cJSON_CreateObject();
+    cJSON_AddNumberToObject(o, "t_ms", (double)ev->t_ms);
+    cJSON_AddStringToObject(o, "kind", blackbox_event_kind_name(ev->kind));
+    switch (ev->kind) {
+        case BLACKBOX_EVENT_BOOT:
+            cJSON_AddStringToObject(o, "reset_reason", blackbox_reset_reason_name(ev->a));
+            cJSON_AddNumberToObject(o, "boot_count", (double)ev->value);
+            break;
+        case BLACKBOX_EVENT_SENSOR_STATE:
+            cJSON_AddStringToObject(o, "sensor", sensor_coordinator_id_to_name((sensor_id_t)ev->a));
+            cJSON_AddStringToObject(o, "from", sensor_coordinator_state_to_string((sensor_state_t)ev->b));
+            cJSON_AddStringToObject(o, "to", sensor_coordinator_state_to_string((sensor_state_t)ev->c));
+            break;
+        case BLACKBOX_EVENT_WIFI:
+        case BLACKBOX_EVENT_MQTT:
+            cJSON_AddBoolToObject(o, "connected", ev->a != 0);
+            if (ev->kind == BLACKBOX_EVENT_MQTT && ev->a) cJSON_AddNumberToObject(o, "connect_ms", (double)ev->value);
+            break;
+        default:
+            break;
+    }
+    return o;
+}
+
+/* GET /api/v1/blackbox[?source=current]: previous boot's record by default */
+static esp_err_t api_blackbox_get(httpd_req_t *req)
+{
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
+    char query[32] = {0};
+    char source[12] = {0};
+    bool current = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "source", source, sizeof(source)) == ESP_OK) {
+        if (strcmp(source, "current") == 0) {
+            current = true;
+        } else if (strcmp(source, "previous") != 0) {
+            respond_error(req, 400, "INVALID_ARG", "source must be 'previous' or 'current'");
+            return ESP_OK;
         }
     }
-    return false;
+
+    const blackbox_dump_t *d = NULL;
+    blackbox_dump_t *owned = NULL;
+    if (current) {
+        esp_err_t err = blackbox_capture_current(&owned);
+        if (err == ESP_ERR_NO_MEM) { respond_error(req, 503, "NO_MEM", "Out of memory"); return ESP_OK; }
+        d = owned;
+    } else {
+        blackbox_get_previous(&d);
+    }
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "source", current ? "current" : "previous");
+    cJSON_AddBoolToObject(root, "available", d != NULL);
+    if (d) {
+        cJSON_AddNumberToObject(root, "boot_count", (double)d->boot_count);
+        cJSON_AddStringToObject(root, "reset_reason", blackbox_reset_reason_name(d->reset_reason));
+        cJSON_AddNumberToObject(root, "last_ms", (double)d->last_ms);
+        if (d->wall_s > 0) cJSON_AddNumberToObject(root, "last_wall_time", (double)d->wall_s);
+
+        cJSON *logs = cJSON_AddArrayToObject(root, "logs");
+        for (size_t i = 0; i < d->log_count; i++) {
+            cJSON *o = cJSON_CreateObject();
+            char level[2] = { d->logs[i].level, '\0' };
+            cJSON_AddNumberToObject(o, "t_ms", (double)d->logs[i].t_ms);
+            cJSON_AddStringToObject(o, "level", level);
+            cJSON_AddStringToObject(o, "text", d->logs[i].text);
+            cJSON_AddItemToArray(logs, o);
+        }
+        cJSON *events = cJSON_AddArrayToObject(root, "events");
+        for (size_t i = 0; i < d->event_count; i++) {
+            cJSON_AddItemToArray(events, blackbox_event_json(&d->events[i]));
+        }
+        cJSON *spans = cJSON_AddArrayToObject(root, "spans");
+        for (size_t i = 0; i < d->span_count; i++) {
+            cJSON *o = cJSON_CreateObject();
+            const char *name = iaq_profiler_metric_name(d->spans[i].metric);
+            cJSON_AddNumberToObject(o, "t_ms", (double)d->spans[i].t_ms);
+            if (name) cJSON_AddStringToObject(o, "metric", name);
+            else cJSON_AddNumberToObject(o, "metric", (double)d->spans[i].metric);
+            cJSON_AddNumberToObject(o, "value", (double)d->spans[i].value);
+            cJSON_AddItemToArray(spans, o);
+        }
+    }
+    blackbox_free_dump(owned);
+    respond_json(req, root, 200);
+    return ESP_OK;
 }
 
 static bool parse_range_seconds(const char *range, int64_t *out_seconds)
@@ -878,6 +1118,10 @@ static void url_decode_inplace(char *str)
 #define HIST_STREAM_BUF_SIZE 1024
 #define HIST_STREAM_BATCH 128
 
+/* Metric descriptor flags */
+#define HIST_DESC_FLAG_SUSPECT_BITMAP 0x01  /* ceil(bucket_count/8) suspect bits follow the metric's buckets */
+#define HIST_DESC_FLAG_EXT_STATS      0x02  /* Buckets are 14 bytes: min/max/avg + stddev/first/last/tw_avg */
+
 typedef struct __attribute__((packed)) {
     uint32_t magic;
     uint32_t resolution_s;
@@ -906,6 +1150,10 @@ typedef struct {
     uint8_t out_buf[HIST_STREAM_BUF_SIZE];
     size_t out_len;
     bool error;
+    uint8_t *suspect_bits;      /* Per-metric bitmap, LSB-first (NULL = not sent) */
+    uint16_t suspect_len;       /* Bitmap size in bytes */
+    uint16_t bucket_count;
+    uint16_t buckets_done;      /* Buckets written for the current metric */
 } hist_stream_ctx_t;
 
 static bool hist_flush(hist_stream_ctx_t *ctx)
@@ -944,6 +1192,17 @@ static bool hist_header_cb(
 {
     hist_stream_ctx_t *ctx = user_ctx;
 
+    /* Suspect bitmap is optional: skip it (and clear the flag) if it cannot be allocated */
+    ctx->bucket_count = params->bucket_count;
+    ctx->suspect_len = (uint16_t)((params->bucket_count + 7) / 8);
+    if (ctx->suspect_len > 0) {
+        ctx->suspect_bits = calloc(1, ctx->suspect_len);
+    }
+    for (int i = 0; i < metric_count; i++) {
+        ctx->descs[i].flags = ctx->suspect_bits ? HIST_DESC_FLAG_SUSPECT_BITMAP : 0;
+        if (params->ext_mask & (1u << metrics[i])) ctx->descs[i].flags |= HIST_DESC_FLAG_EXT_STATS;
+    }
+
     /* Send header */
     hist_bin_header_t hdr = {
         .magic = HIST_BIN_MAGIC,
@@ -962,18 +1221,48 @@ static bool hist_bucket_cb(
     history_metric_id_t metric,
     uint16_t bucket_idx,
     const history_bucket_wire_t *buckets,
+    const uint8_t *flags,
+    const history_bucket_ext_wire_t *ext,
     uint16_t bucket_count,
     void *user_ctx)
 {
     hist_stream_ctx_t *ctx = user_ctx;
     (void)metric;
-    (void)bucket_idx;
 
-    return hist_write(ctx, buckets, bucket_count * sizeof(*buckets));
+    if (ext) {
+        for (uint16_t i = 0; i < bucket_count; i++) {
+            if (!hist_write(ctx, &buckets[i], sizeof(*buckets)) ||
+                !hist_write(ctx, &ext[i], sizeof(*ext))) {
+                return false;
+            }
+        }
+    } else if (!hist_write(ctx, buckets, bucket_count * sizeof(*buckets))) {
+        return false;
+    }
+    if (!ctx->suspect_bits) return true;
+
+    for (uint16_t i = 0; i < bucket_count; i++) {
+        uint16_t idx = bucket_idx + i;
+        if ((flags[i] & HISTORY_BUCKET_FLAG_SUSPECT) && idx < ctx->bucket_count) {
+            ctx->suspect_bits[idx >> 3] |= (uint8_t)(1u << (idx & 7));
+        }
+    }
+    ctx->buckets_done += bucket_count;
+
+    /* Metric complete: emit its bitmap and reset for the next metric */
+    if (ctx->buckets_done >= ctx->bucket_count) {
+        if (!hist_write(ctx, ctx->suspect_bits, ctx->suspect_len)) return false;
+        memset(ctx->suspect_bits, 0, ctx->suspect_len);
+        ctx->buckets_done = 0;
+    }
+    return true;
 }
 
 static esp_err_t api_history_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_HISTORY)) return ESP_OK;
+    if (offload_request(req, HTTP_ASYNC_CLASS_HISTORY, api_history_get)) return ESP_OK;
+
     /* === Query parsing === */
     char query[256];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) {
@@ -1006,6 +1295,10 @@ static esp_err_t api_history_get(httpd_req_t *req)
         end_s = strtoll(end_buf, NULL, 10);
     }
 
+    char stats_buf[4];
+    bool want_stats = httpd_query_key_value(query, "stats", stats_buf, sizeof(stats_buf)) == ESP_OK &&
+                      strcmp(stats_buf, "1") == 0;
+
     if (range_s > 0) {
         if (end_s <= 0) end_s = time(NULL);
         start_s = end_s - range_s;
@@ -1026,7 +1319,7 @@ static esp_err_t api_history_get(httpd_req_t *req)
             return ESP_OK;
         }
         history_metric_id_t id;
-        if (!history_metric_from_key(tok, &id)) {
+        if (!iaq_history_metric_from_key(tok, &id)) {
             respond_error(req, 400, "BAD_METRIC", "Unknown metric key");
             return ESP_OK;
         }
@@ -1065,15 +1358,27 @@ static esp_err_t api_history_get(httpd_req_t *req)
     memcpy(ctx.descs, descs, metric_count * sizeof(hist_bin_metric_desc_t));
 
     history_bucket_wire_t scratch[HIST_STREAM_BATCH];
+    uint8_t flags_scratch[HIST_STREAM_BATCH];
+
+    /* Extended stats are opt-in; their batch buffer stays off the handler stack */
+    history_bucket_ext_wire_t *ext_scratch = NULL;
+    for (int i = 0; want_stats && i < metric_count; i++) {
+        if (iaq_history_metric_has_ext_stats(metrics[i])) {
+            ext_scratch = malloc(HIST_STREAM_BATCH * sizeof(*ext_scratch));
+            break;
+        }
+    }
 
     esp_err_t ret = iaq_history_stream(
         metrics, metric_count,
         start_s, end_s, 0,
-        scratch, HIST_STREAM_BATCH,
+        scratch, flags_scratch, ext_scratch, HIST_STREAM_BATCH,
         hist_header_cb,
         hist_bucket_cb,
         &ctx
     );
+    free(ext_scratch);
+    free(ctx.suspect_bits);
 
     if (ctx.error) {
         /* Client disconnected - nothing more to do */
@@ -1095,8 +1400,303 @@ static esp_err_t api_history_get(httpd_req_t *req)
     return ESP_OK;
 }
 
+/* ═══════════════════════════════════════════════════════════════════════════
+ * History Export (CSV / NDJSON / iaq_record, optionally gzip)
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define HIST_EXPORT_LINE_MAX 1024
+
+typedef struct {
+    http_chunk_writer_t out;
+    bool ndjson;
+    bool record;                    /* iaq_record stream: avg/min/max columns per metric */
+    bool schema_sent;
+    iaq_record_schema_t schema;
+    iaq_record_state_t state;
+    int metric_count;
+    const char *keys[HISTORY_METRIC_COUNT];
+    history_metric_scale_t scales[HISTORY_METRIC_COUNT];
+    char line[HIST_EXPORT_LINE_MAX];
+    size_t line_len;
+} hist_export_ctx_t;
+
+static void __attribute__((format(printf, 2, 3)))
+hist_line_append(hist_export_ctx_t *ctx, const char *fmt, ...)
+{
+    if (ctx->line_len >= sizeof(ctx->line)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(&ctx->line[ctx->line_len], sizeof(ctx->line) - ctx->line_len, fmt, ap);
+    va_end(ap);
+    if (n > 0) ctx->line_len += (size_t)n;
+}
+
+/* Dequantize with as many decimals as the metric's scale carries */
+static void hist_line_append_value(hist_export_ctx_t *ctx, int16_t q, const history_metric_scale_t *scale)
+{
+    if (q == HISTORY_SENTINEL) {
+        if (ctx->ndjson) hist_line_append(ctx, "null");
+        return;
+    }
+    int decimals = scale->scale == 1 ? 0 : scale->scale == 10 ? 1 : 2;
+    float value = (float)(q - scale->offset) / (float)scale->scale;
+    hist_line_append(ctx, "%.*f", decimals, value);
+}
+
+static bool hist_export_row_cb(
+    int64_t time_s,
+    uint32_t resolution_s,
+    const history_bucket_wire_t *values,
+    const uint8_t *flags,
+    int metric_count,
+    void *user_ctx)
+{
+    hist_export_ctx_t *ctx = user_ctx;
+    (void)resolution_s;
+    ctx->line_len = 0;
+
+    if (ctx->ndjson) {
+        hist_line_append(ctx, "{\"t\":%lld", (long long)time_s);
+        for (int m = 0; m < metric_count; m++) {
+            hist_line_append(ctx, ",\"%s\":[", ctx->keys[m]);
+            hist_line_append_value(ctx, values[m].avg, &ctx->scales[m]);
+            hist_line_append(ctx, ",");
+            hist_line_append_value(ctx, values[m].min, &ctx->scales[m]);
+            hist_line_append(ctx, ",");
+            hist_line_append_value(ctx, values[m].max, &ctx->scales[m]);
+            hist_line_append(ctx, "]");
+        }
+        bool first = true;
+        for (int m = 0; m < metric_count; m++) {
+            if (!(flags[m] & HISTORY_BUCKET_FLAG_SUSPECT)) continue;
+            hist_line_append(ctx, "%s\"%s\"", first ? ",\"suspect\":[" : ",", ctx->keys[m]);
+            first = false;
+        }
+        hist_line_append(ctx, "%s", first ? "}\n" : "]}\n");
+    } else {
+        hist_line_append(ctx, "%lld", (long long)time_s);
+        for (int m = 0; m < metric_count; m++) {
+            hist_line_append(ctx, ",");
+            hist_line_append_value(ctx, values[m].avg, &ctx->scales[m]);
+            hist_line_append(ctx, ",");
+            hist_line_append_value(ctx, values[m].min, &ctx->scales[m]);
+            hist_line_append(ctx, ",");
+            hist_line_append_value(ctx, values[m].max, &ctx->scales[m]);
+        }
+        hist_line_append(ctx, ",");
+        bool first = true;
+        for (int m = 0; m < metric_count; m++) {
+            if (!(flags[m] & HISTORY_BUCKET_FLAG_SUSPECT)) continue;
+            hist_line_append(ctx, first ? "%s" : " %s", ctx->keys[m]);
+            first = false;
+        }
+        hist_line_append(ctx, "\n");
+    }
+
+    if (ctx->line_len >= sizeof(ctx->line)) {
+        ESP_LOGW(TAG, "Export row truncated");
+        return false;
+    }
+    return http_chunk_writer_write(&ctx->out, ctx->line, ctx->line_len);
+}
+
+_Static_assert(HIST_EXPORT_LINE_MAX >= IAQ_RECORD_SCHEMA_MAX_SIZE(IAQ_RECORD_MAX_COLUMNS) &&
+               HIST_EXPORT_LINE_MAX >= IAQ_RECORD_MAX_SIZE(IAQ_RECORD_MAX_COLUMNS),
+               "Export line buffer too small for iaq_record output");
+
+/* The schema goes out with the first row, once the tier resolution is known */
+static bool hist_export_record_schema(hist_export_ctx_t *ctx, uint32_t period_s)
+{
+    ctx->schema_sent = true;
+    ctx->schema.period_s = period_s;
+    size_t n = iaq_record_schema_write(&ctx->schema, (uint8_t *)ctx->line, sizeof(ctx->line));
+    return n > 0 && http_chunk_writer_write(&ctx->out, ctx->line, n);
+}
+
+static bool hist_export_record_cb(
+    int64_t time_s,
+    uint32_t resolution_s,
+    const history_bucket_wire_t *values,
+    const uint8_t *flags,
+    int metric_count,
+    void *user_ctx)
+{
+    hist_export_ctx_t *ctx = user_ctx;
+    if (!ctx->schema_sent && !hist_export_record_schema(ctx, resolution_s)) return false;
+
+    int16_t q[IAQ_RECORD_MAX_COLUMNS];
+    uint8_t suspect[IAQ_RECORD_BITMAP_LEN(IAQ_RECORD_MAX_COLUMNS)] = {0};
+    for (int m = 0; m < metric_count; m++) {
+        /* Column order follows iaq_record_field_t: avg, min, max */
+        q[3 * m] = values[m].avg;
+        q[3 * m + 1] = values[m].min;
+        q[3 * m + 2] = values[m].max;
+        if (flags[m] & HISTORY_BUCKET_FLAG_SUSPECT) {
+            for (int c = 3 * m; c < 3 * m + 3; c++) suspect[c >> 3] |= (uint8_t)(1u << (c & 7));
+        }
+    }
+    size_t n = iaq_record_encode(&ctx->schema, &ctx->state, time_s, q, suspect,
+                                 (uint8_t *)ctx->line, sizeof(ctx->line));
+    return n > 0 && http_chunk_writer_write(&ctx->out, ctx->line, n);
+}
+
+static esp_err_t api_history_export_get(httpd_req_t *req)
+{
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_HISTORY)) return ESP_OK;
+    if (offload_request(req, HTTP_ASYNC_CLASS_HISTORY, api_history_export_get)) return ESP_OK;
+
+    /* === Query parsing (same range semantics as /api/v1/history) === */
+    char query[320] = {0};
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+
+    history_metric_id_t metrics[HISTORY_METRIC_COUNT];
+    int metric_count = 0;
+    char metrics_buf[192];
+    if (httpd_query_key_value(query, "metrics", metrics_buf, sizeof(metrics_buf)) == ESP_OK) {
+        url_decode_inplace(metrics_buf);
+        char *saveptr = NULL;
+        for (char *tok = strtok_r(metrics_buf, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+            if (metric_count >= HISTORY_METRIC_COUNT) {
+                respond_error(req, 400, "TOO_MANY_METRICS", "Metrics list too long");
+                return ESP_OK;
+            }
+            if (!iaq_history_metric_from_key(tok, &metrics[metric_count])) {
+                respond_error(req, 400, "BAD_METRIC", "Unknown metric key");
+                return ESP_OK;
+            }
+            metric_count++;
+        }
+    } else {
+        /* Default: every metric, in table order */
+        for (int i = 0; i < HISTORY_METRIC_COUNT; i++) {
+            metrics[metric_count++] = (history_metric_id_t)i;
+        }
+    }
+    if (metric_count == 0) {
+        respond_error(req, 400, "NO_METRICS", "Empty metrics list");
+        return ESP_OK;
+    }
+
+    char buf[24];
+    int64_t range_s = 0, start_s = 0, end_s = 0;
+    if (httpd_query_key_value(query, "range", buf, sizeof(buf)) == ESP_OK &&
+        !parse_range_seconds(buf, &range_s)) {
+        respond_error(req, 400, "BAD_RANGE", "Invalid range format");
+        return ESP_OK;
+    }
+    if (httpd_query_key_value(query, "start", buf, sizeof(buf)) == ESP_OK) {
+        start_s = strtoll(buf, NULL, 10);
+    }
+    if (httpd_query_key_value(query, "end", buf, sizeof(buf)) == ESP_OK) {
+        end_s = strtoll(buf, NULL, 10);
+    }
+    if (end_s <= 0) end_s = time(NULL);
+    if (range_s > 0) {
+        start_s = end_s - range_s;
+    } else if (start_s <= 0) {
+        respond_error(req, 400, "BAD_RANGE", "Provide range or start");
+        return ESP_OK;
+    }
+
+    int tier = -1;
+    if (httpd_query_key_value(query, "tier", buf, sizeof(buf)) == ESP_OK) {
+        char *endp = NULL;
+        long t = strtol(buf, &endp, 10);
+        if (endp == buf || *endp != '\0' || t < 0 || t > 3) {
+            respond_error(req, 400, "BAD_TIER", "tier must be 0, 1, 2 or 3");
+            return ESP_OK;
+        }
+        if (t == 3 && !iaq_history_long_term_available()) {
+            respond_error(req, 404, "NO_LONG_TERM", "Long-term history is not available");
+            return ESP_OK;
+        }
+        tier = (int)t;
+    }
+
+    bool ndjson = false;
+    bool record = false;
+    if (httpd_query_key_value(query, "format", buf, sizeof(buf)) == ESP_OK) {
+        if (strcmp(buf, "ndjson") == 0) {
+            ndjson = true;
+        } else if (strcmp(buf, "rec") == 0) {
+            record = true;
+        } else if (strcmp(buf, "csv") != 0) {
+            respond_error(req, 400, "BAD_FORMAT", "format must be csv, ndjson or rec");
+            return ESP_OK;
+        }
+    }
+
+    /* Context holds the output and line buffers; keep it off the httpd stack */
+    hist_export_ctx_t *ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        respond_error(req, 500, "NO_MEM", "Out of memory");
+        return ESP_OK;
+    }
+    ctx->ndjson = ndjson;
+    ctx->record = record;
+    ctx->metric_count = metric_count;
+    if (record && iaq_record_schema_init(&ctx->schema, metrics, metric_count, IAQ_RECORD_FIELDS_BUCKET,
+                                         IAQ_RECORD_FLAG_SUSPECT, 0) != ESP_OK) {
+        free(ctx);
+        respond_error(req, 500, "RECORD_SCHEMA_FAILED", "Cannot build record schema");
+        return ESP_OK;
+    }
+    for (int i = 0; i < metric_count; i++) {
+        ctx->keys[i] = iaq_history_metric_key(metrics[i]);
+        if (!ctx->keys[i] || !iaq_history_metric_scale(metrics[i], &ctx->scales[i])) {
+            free(ctx);
+            respond_error(req, 500, "HISTORY_SCALE_FAILED", "Missing metric scale");
+            return ESP_OK;
+        }
+    }
+
+    /* === Streaming response === */
+    set_cors(req);
+    httpd_resp_set_type(req, record ? "application/x-iaq-record"
+                           : ndjson ? "application/x-ndjson" : "text/csv; charset=utf-8");
+    httpd_resp_set_hdr(req, "Content-Disposition", record
+                       ? "attachment; filename=\"iaq-history.iqr\""
+                       : ndjson
+                       ? "attachment; filename=\"iaq-history.ndjson\""
+                       : "attachment; filename=\"iaq-history.csv\"");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    http_chunk_writer_init(&ctx->out, req, http_accepts_gzip(req));
+
+    bool ok = true;
+    if (!ndjson && !record) {
+        ctx->line_len = 0;
+        hist_line_append(ctx, "time");
+        for (int m = 0; m < metric_count; m++) {
+            hist_line_append(ctx, ",%s,%s_min,%s_max", ctx->keys[m], ctx->keys[m], ctx->keys[m]);
+        }
+        hist_line_append(ctx, ",suspect\n");
+        ok = http_chunk_writer_write(&ctx->out, ctx->line, ctx->line_len);
+    }
+    if (ok) {
+        esp_err_t ret = iaq_history_export_rows(metrics, metric_count, tier, start_s, end_s,
+                                                record ? hist_export_record_cb : hist_export_row_cb, ctx);
+        ok = (ret == ESP_OK);
+        /* An empty range still yields a valid (schema-only) record stream */
+        if (ok && record && !ctx->schema_sent) ok = hist_export_record_schema(ctx, 0);
+        if (!ok && !ctx->out.error) {
+            ESP_LOGW(TAG, "History export aborted: %s", esp_err_to_name(ret));
+        }
+    }
+    if (ok) {
+        http_chunk_writer_finish(&ctx->out);
+    } else {
+        /* No terminating chunk: a closed connection mid-body is the only way
+         * the client can tell a truncated export from a complete one */
+        httpd_sess_trigger_close(req->handle, httpd_req_to_sockfd(req));
+    }
+    http_chunk_writer_deinit(&ctx->out);
+    free(ctx);
+    return ESP_OK;
+}
+
 static esp_err_t api_ota_info_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     ota_version_info_t info = {0};
     if (ota_manager_get_version_info(&info) != ESP_OK) {
         respond_error(req, 500, "OTA_INFO", "Failed to read OTA info");
@@ -1134,6 +1734,8 @@ static esp_err_t api_ota_info_get(httpd_req_t *req)
 
 static esp_err_t api_ota_firmware_post(httpd_req_t *req)
 {
+    if (offload_request(req, HTTP_ASYNC_CLASS_OTA, api_ota_firmware_post)) return ESP_OK;
+
     ota_runtime_info_t rt = {0};
     (void)ota_manager_get_runtime(&rt);
     if (rt.pending_verify) {
@@ -1212,6 +1814,8 @@ static esp_err_t api_ota_firmware_post(httpd_req_t *req)
 
 static esp_err_t api_ota_frontend_post(httpd_req_t *req)
 {
+    if (offload_request(req, HTTP_ASYNC_CLASS_OTA, api_ota_frontend_post)) return ESP_OK;
+
     if (ota_manager_is_busy()) {
         respond_error(req, 409, "OTA_BUSY", "Another OTA update is in progress");
         return ESP_OK;
@@ -1281,6 +1885,7 @@ static esp_err_t api_ota_frontend_post(httpd_req_t *req)
 
 static esp_err_t api_ota_rollback_post(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     if (ota_manager_is_busy()) {
         respond_error(req, 409, "OTA_BUSY", "OTA update in progress");
         return ESP_OK;
@@ -1305,6 +1910,7 @@ static esp_err_t api_ota_rollback_post(httpd_req_t *req)
 
 static esp_err_t api_ota_abort_post(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     ota_runtime_info_t rt = {0};
     (void)ota_manager_get_runtime(&rt);
     if (rt.state == OTA_STATE_IDLE) {
@@ -1330,6 +1936,7 @@ static esp_err_t api_ota_abort_post(httpd_req_t *req)
 
 static esp_err_t api_power_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     respond_json(req, iaq_json_build_power(), 200);
     return ESP_OK;
 }
@@ -1345,6 +1952,7 @@ static bool power_guard(httpd_req_t *req)
 
 static esp_err_t api_power_outputs_post(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     cJSON *root = NULL;
     if (!read_req_json(req, &root)) { respond_error(req, 400, "BAD_JSON", "Invalid JSON"); return ESP_OK; }
     if (!power_guard(req)) { cJSON_Delete(root); return ESP_OK; }
@@ -1368,6 +1976,7 @@ static esp_err_t api_power_outputs_post(httpd_req_t *req)
 
 static esp_err_t api_power_charger_post(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     cJSON *root = NULL;
     if (!read_req_json(req, &root)) { respond_error(req, 400, "BAD_JSON", "Invalid JSON"); return ESP_OK; }
     if (!power_guard(req)) { cJSON_Delete(root); return ESP_OK; }
@@ -1389,6 +1998,7 @@ static esp_err_t api_power_charger_post(httpd_req_t *req)
 
 static esp_err_t api_power_alarms_post(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     cJSON *root = NULL;
     if (!read_req_json(req, &root)) { respond_error(req, 400, "BAD_JSON", "Invalid JSON"); return ESP_OK; }
     if (!power_guard(req)) { cJSON_Delete(root); return ESP_OK; }
@@ -1410,6 +2020,7 @@ static esp_err_t api_power_alarms_post(httpd_req_t *req)
 
 static esp_err_t api_power_action_post(httpd_req_t *req, const char *action)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     if (!power_guard(req)) return ESP_OK;
     esp_err_t ret = ESP_ERR_INVALID_ARG;
     if (strcmp(action, "ship") == 0) ret = power_board_enter_ship_mode();
@@ -1428,6 +2039,7 @@ static esp_err_t api_power_cycle_post(httpd_req_t *req) { return api_power_actio
 
 static esp_err_t api_wifi_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     cJSON *root = cJSON_CreateObject();
     cJSON_AddBoolToObject(root, "provisioned", wifi_manager_is_provisioned());
     wifi_mode_t mode = wifi_manager_get_mode();
@@ -1443,6 +2055,7 @@ static esp_err_t api_wifi_get(httpd_req_t *req)
 
 static esp_err_t api_sensors_cadence_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     uint64_t t0 = iaq_prof_tic();
     uint32_t ms[SENSOR_ID_MAX] = {0};
     bool from_nvs[SENSOR_ID_MAX] = {0};
@@ -1477,6 +2090,7 @@ static bool parse_sensor_name(const char *name, sensor_id_t *out)
 
 static esp_err_t api_sensor_action(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_SENSOR)) return ESP_OK;
     uint64_t t0 = iaq_prof_tic();
     const char *uri = req->uri; // /api/v1/sensor/<id>/<action>
     const char *p = strstr(uri, "/api/v1/sensor/");
@@ -1494,6 +2108,11 @@ static esp_err_t api_sensor_action(httpd_req_t *req)
 
     esp_err_t r = ESP_OK;
     if (strcasecmp(action, "read") == 0) {
+        /* Synchronous read blocks up to 3 s; re-entered on a worker */
+        if (offload_request(req, HTTP_ASYNC_CLASS_SENSOR, api_sensor_action)) {
+            iaq_prof_toc(IAQ_METRIC_WEB_API_SENSOR_ACTION, t0);
+            return ESP_OK;
+        }
         r = sensor_coordinator_force_read_sync(id, 3000);
     } else if (strcasecmp(action, "reset") == 0) {
         r = sensor_coordinator_reset(id);
@@ -1545,6 +2164,9 @@ static const char* authmode_to_str(wifi_auth_mode_t m)
 
 static esp_err_t api_wifi_scan_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_WIFI_SCAN)) return ESP_OK;
+    if (offload_request(req, HTTP_ASYNC_CLASS_WIFI_SCAN, api_wifi_scan_get)) return ESP_OK;
+
     uint64_t t0 = iaq_prof_tic();
     uint16_t max_aps = CONFIG_IAQ_WEB_PORTAL_WIFI_SCAN_LIMIT;
     /* Query params: ?limit=&offset= */
@@ -1593,6 +2215,7 @@ static esp_err_t api_wifi_scan_get(httpd_req_t *req)
 
 static esp_err_t api_wifi_post(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     uint64_t t0 = iaq_prof_tic();
     cJSON *root = NULL;
     if (!read_req_json(req, &root)) { respond_error(req, 400, "INVALID_JSON", "Failed to parse JSON body"); iaq_prof_toc(IAQ_METRIC_WEB_API_WIFI_POST, t0); return ESP_OK; }
@@ -1617,6 +2240,7 @@ static esp_err_t api_wifi_post(httpd_req_t *req)
 
 static esp_err_t api_wifi_restart_post(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     wifi_manager_stop(); vTaskDelay(pdMS_TO_TICKS(500)); wifi_manager_start();
     cJSON *ok = cJSON_CreateObject(); cJSON_AddStringToObject(ok, "status", "restarting");
     respond_json(req, ok, 200);
@@ -1625,6 +2249,7 @@ static esp_err_t api_wifi_restart_post(httpd_req_t *req)
 
 static esp_err_t api_mqtt_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     cJSON *root = cJSON_CreateObject();
     char url[128] = {0};
     mqtt_manager_get_broker_url(url, sizeof(url));
@@ -1637,6 +2262,7 @@ static esp_err_t api_mqtt_get(httpd_req_t *req)
 
 static esp_err_t api_mqtt_post(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     uint64_t t0 = iaq_prof_tic();
     cJSON *root = NULL;
     if (!read_req_json(req, &root)) { respond_error(req, 400, "INVALID_JSON", "Failed to parse JSON body"); iaq_prof_toc(IAQ_METRIC_WEB_API_MQTT_POST, t0); return ESP_OK; }
@@ -1666,6 +2292,7 @@ static void restart_deferred(void *arg)
 
 static esp_err_t api_device_restart(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     cJSON *ok = cJSON_CreateObject(); cJSON_AddStringToObject(ok, "status", "restarting");
     respond_json(req, ok, 200);
     xTaskCreate(restart_deferred, "reboot", 2048, NULL, 1, NULL);
@@ -1675,12 +2302,21 @@ static esp_err_t api_device_restart(httpd_req_t *req)
 /* Sensors overview (same structure as health.sensors) */
 static esp_err_t api_sensors_get(httpd_req_t *req)
 {
+    if (rate_limited(req, HTTP_RATELIMIT_CLASS_API)) return ESP_OK;
     uint64_t t0 = iaq_prof_tic();
     iaq_data_t snap = (iaq_data_t){0}; IAQ_DATA_WITH_LOCK(){ snap = *iaq_data_get(); }
     cJSON *root = iaq_json_build_health(&snap);
     /* Extract just sensors */
     cJSON *sensors = cJSON_DetachItemFromObject(root, "sensors");
     cJSON_Delete(root);
+    /* Read statistics are only served here, not in /health or the WS feed */
+    for (int i = 0; sensors && i < SENSOR_ID_MAX; ++i) {
+        cJSON *sj = cJSON_GetObjectItem(sensors, sensor_coordinator_id_to_name((sensor_id_t)i));
+        sensor_runtime_info_t info;
+        if (!sj || sensor_coordinator_get_runtime_info((sensor_id_t)i, &info) != ESP_OK) continue;
+        cJSON *stats = iaq_json_build_sensor_stats(&info);
+        if (stats) cJSON_AddItemToObject(sj, "stats", stats);
+    }
     cJSON *wrap = cJSON_CreateObject();
     cJSON_AddItemToObject(wrap, "sensors", sensors ? sensors : cJSON_CreateObject());
     respond_json(req, wrap, 200);
@@ -1694,9 +2330,13 @@ static esp_err_t ws_handler(httpd_req_t *req)
     if (req->method == HTTP_GET) {
         /* Handshake -> add client */
         int sock = httpd_req_to_sockfd(req);
-        bool added = ws_clients_add(sock);
+        /* The 101 is already sent, so a client over its handshake budget is
+         * closed the same way as one over capacity */
+        uint32_t retry_s = 0;
+        bool admitted = rate_limit_admit(req, HTTP_RATELIMIT_CLASS_WS, &retry_s);
+        bool added = admitted && ws_clients_add(sock, ws_deflate_requested(req));
         if (!added) {
-            ESP_LOGW(TAG, "WS client rejected (capacity reached): %d", sock);
+            ESP_LOGW(TAG, "WS client rejected (%s): %d", admitted ? "capacity reached" : "rate limited", sock);
             /* Politely close: send CLOSE then drop session */
             httpd_ws_frame_t closefrm = { 0 };
             closefrm.type = HTTPD_WS_TYPE_CLOSE;
@@ -1733,14 +2373,23 @@ static esp_err_t ws_handler(httpd_req_t *req)
     if (frame.type == HTTPD_WS_TYPE_PONG) {
         int sock = httpd_req_to_sockfd(req);
         if (s_ws_mutex) {
+            int64_t now = esp_timer_get_time();
+            int64_t rtt_us = -1;
             xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
             for (int i = 0; i < MAX_WS_CLIENTS; ++i) {
                 if (s_ws_clients[i].active && s_ws_clients[i].sock == sock) {
-                    s_ws_clients[i].last_pong_us = esp_timer_get_time();
+                    s_ws_clients[i].last_pong_us = now;
+                    if (s_ws_clients[i].ping_sent_us > 0) {
+                        rtt_us = now - s_ws_clients[i].ping_sent_us;
+                        s_ws_clients[i].ping_sent_us = 0;
+                    }
                     break;
                 }
             }
             xSemaphoreGive(s_ws_mutex);
+            if (rtt_us >= 0) {
+                wifi_ps_policy_note_rtt((uint32_t)(rtt_us / 1000));
+            }
         }
         if (frame.len == 0) {
             /* Fast-path: no payload to read */
@@ -1846,31 +2495,53 @@ esp_err_t web_portal_init(iaq_system_context_t *ctx)
     if (!ctx) return ESP_ERR_INVALID_ARG;
     s_ctx = ctx;
 
-    /* Mount LittleFS (partition label 'www') */
-    esp_vfs_littlefs_conf_t conf = {
-        .base_path = WEB_MOUNT_POINT,
-        .partition_label = "www",
-        .format_if_mount_failed = true,
-        .dont_mount = false,
-    };
-    esp_err_t r = esp_vfs_littlefs_register(&conf);
-    if (r != ESP_OK) {
-        ESP_LOGW(TAG, "LittleFS mount failed: %s (portal will serve API only)", esp_err_to_name(r));
+    /* Map the packed asset image if the partition holds one, else mount LittleFS */
+    esp_err_t r = www_pack_mount(CONFIG_IAQ_OTA_WWW_PARTITION_LABEL);
+    if (r == ESP_OK) {
+        ESP_LOGI(TAG, "Serving frontend from packed image on '%s'", CONFIG_IAQ_OTA_WWW_PARTITION_LABEL);
     } else {
-        size_t total=0, used=0; if (esp_littlefs_info(conf.partition_label, &total, &used) == ESP_OK) {
-            ESP_LOGI(TAG, "LittleFS mounted at %s (%u/%u bytes)", WEB_MOUNT_POINT, (unsigned)used, (unsigned)total);
+        if (r != ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGW(TAG, "Asset pack unusable: %s, trying LittleFS", esp_err_to_name(r));
+        }
+        esp_vfs_littlefs_conf_t conf = {
+            .base_path = WEB_MOUNT_POINT,
+            .partition_label = CONFIG_IAQ_OTA_WWW_PARTITION_LABEL,
+            .format_if_mount_failed = true,
+            .dont_mount = false,
+        };
+        r = esp_vfs_littlefs_register(&conf);
+        if (r != ESP_OK) {
+            ESP_LOGW(TAG, "LittleFS mount failed: %s (portal will serve API only)", esp_err_to_name(r));
+        } else {
+            size_t total=0, used=0; if (esp_littlefs_info(conf.partition_label, &total, &used) == ESP_OK) {
+                ESP_LOGI(TAG, "LittleFS mounted at %s (%u/%u bytes)", WEB_MOUNT_POINT, (unsigned)used, (unsigned)total);
+            }
         }
     }
 
     ws_clients_init();
 
-    /* Timers */
-    const esp_timer_create_args_t t_state = { .callback = &ws_state_timer_cb, .name = "ws_state" };
-    const esp_timer_create_args_t t_metrics = { .callback = &ws_metrics_timer_cb, .name = "ws_metrics" };
-    const esp_timer_create_args_t t_health = { .callback = &ws_health_timer_cb, .name = "ws_health" };
-    ESP_ERROR_CHECK(esp_timer_create(&t_state, &s_ws_state_timer));
-    ESP_ERROR_CHECK(esp_timer_create(&t_metrics, &s_ws_metrics_timer));
-    ESP_ERROR_CHECK(esp_timer_create(&t_health, &s_ws_health_timer));
+    r = http_async_init();
+    if (r != ESP_OK) {
+        ESP_LOGW(TAG, "Async request pool unavailable: %s (slow handlers run inline)", esp_err_to_name(r));
+    }
+
+    /* Timers (coalesced with the other periodic work; see periodic_sched.h) */
+    if (!s_ws_state_timer) {
+        const periodic_work_args_t t_state = { .callback = &ws_state_timer_cb, .name = "ws_state", .subsystem = "ws", .slack_ms = SLACK_MS_WS_PUSH };
+        const periodic_work_args_t t_metrics = { .callback = &ws_metrics_timer_cb, .name = "ws_metrics", .subsystem = "ws", .slack_ms = SLACK_MS_WS_METRICS };
+        const periodic_work_args_t t_health = { .callback = &ws_health_timer_cb, .name = "ws_health", .subsystem = "ws", .slack_ms = SLACK_MS_WS_PUSH };
+        ESP_ERROR_CHECK(periodic_sched_create(&t_state, &s_ws_state_timer));
+        ESP_ERROR_CHECK(periodic_sched_create(&t_metrics, &s_ws_metrics_timer));
+        ESP_ERROR_CHECK(periodic_sched_create(&t_health, &s_ws_health_timer));
+    }
+
+    /* Tell the Wi-Fi power-save policy when someone is using the portal */
+    wifi_ps_policy_register_probe(WIFI_PS_DEMAND_DASHBOARD, ps_probe_dashboard);
+#if CONFIG_IAQ_WEB_CONSOLE_ENABLE
+    wifi_ps_policy_register_probe(WIFI_PS_DEMAND_CONSOLE, web_console_has_clients);
+#endif
+    wifi_ps_policy_register_probe(WIFI_PS_DEMAND_OTA, ps_probe_ota);
 
     /* React to connectivity events for snappier updates */
     ESP_ERROR_CHECK(esp_event_handler_register(IAQ_EVENT, IAQ_EVENT_WIFI_CONNECTED, &iaq_evt_handler, NULL));
@@ -1883,6 +2554,76 @@ esp_err_t web_portal_init(iaq_system_context_t *ctx)
     return ESP_OK;
 }
 
+/* === HTTPS handshake profiling ===
+ * The ClientHello hook and the session-create callback both run on the
+ * httpd task while it completes one handshake, so plain statics suffice. */
+#if CONFIG_IAQ_PROFILING && CONFIG_ESP_HTTPS_SERVER_CERT_SELECT_HOOK
+static uint64_t s_tls_hs_start_us = 0;
+static size_t s_tls_hs_heap_before = 0;
+
+static int https_client_hello_cb(mbedtls_ssl_context *ssl)
+{
+    (void)ssl;
+    s_tls_hs_start_us = iaq_prof_tic();
+    s_tls_hs_heap_before = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    return 0; /* Keep the configured certificate */
+}
+
+static void https_session_cb(esp_https_server_user_cb_arg_t *arg)
+{
+    if (!arg || arg->user_cb_state != HTTPD_SSL_USER_CB_SESS_CREATE || s_tls_hs_start_us == 0) return;
+    iaq_prof_toc(IAQ_METRIC_WEB_TLS_HANDSHAKE, s_tls_hs_start_us);
+    size_t heap_after = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    if (s_tls_hs_heap_before > heap_after) {
+        iaq_profiler_record(IAQ_METRIC_WEB_TLS_SESSION_RAM, (uint32_t)(s_tls_hs_heap_before - heap_after));
+    }
+    s_tls_hs_start_us = 0;
+}
+#endif
+
+#if MBEDTLS_VERSION_MAJOR < 4
+static int tls_key_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    (void)ctx;
+    esp_fill_random(buf, len);
+    return 0;
+}
+#endif
+
+/* Algorithm of a PEM private key, whatever the container (PKCS#1, SEC1 or
+ * PKCS#8 "BEGIN PRIVATE KEY"). MBEDTLS_PK_NONE if it does not parse. */
+static mbedtls_pk_type_t tls_key_type(const unsigned char *key, size_t len)
+{
+    mbedtls_pk_context pk;
+    mbedtls_pk_init(&pk);
+#if MBEDTLS_VERSION_MAJOR >= 4
+    int ret = mbedtls_pk_parse_key(&pk, key, len, NULL, 0);
+#else
+    int ret = mbedtls_pk_parse_key(&pk, key, len, NULL, 0, tls_key_rng, NULL);
+#endif
+    mbedtls_pk_type_t type = (ret == 0) ? mbedtls_pk_get_type(&pk) : MBEDTLS_PK_NONE;
+    mbedtls_pk_free(&pk);
+    return type;
+}
+
+/* Copy a PEM file out of the asset pack, NUL-terminated; length includes the NUL */
+static char *pack_load_pem(const char *path, size_t *len)
+{
+    if (!www_pack_acquire()) return NULL;
+    char *out = NULL;
+    www_pack_asset_t asset;
+    if (www_pack_find(path, strlen(path), &asset)) {
+        size_t l = asset.variants[WWW_PACK_ENC_IDENTITY].size;
+        if (l > 0 && l < WEB_MAX_TLS_CERT_SIZE && (out = malloc(l + 1)) != NULL) {
+            memcpy(out, asset.variants[WWW_PACK_ENC_IDENTITY].data, l);
+            out[l] = '\0';
+            *len = l + 1;
+        }
+    }
+    www_pack_release();
+    return out;
+}
+
 esp_err_t web_portal_start(void)
 {
     if (s_server) return ESP_OK;
@@ -1896,7 +2637,7 @@ esp_err_t web_portal_start(void)
         scfg.httpd.uri_match_fn = httpd_uri_match_wildcard;
         /* Default LRU purge behavior */
         scfg.httpd.lru_purge_enable = true;
-        scfg.httpd.max_uri_handlers = 32; /* increased for power endpoints */
+        scfg.httpd.max_uri_handlers = 40; /* power, history export and web console endpoints */
         /* Moderate simultaneous handshake pressure */
         scfg.httpd.backlog_conn = 3;
         /* Cap HTTPD sockets so other services (MQTT/SNTP/DNS) keep room */
@@ -1913,7 +2654,10 @@ esp_err_t web_portal_start(void)
         /* Attempt reading from /www/cert.pem and /www/key.pem */
         char *file_cert = NULL, *file_key = NULL;
         size_t file_cert_len = 0, file_key_len = 0;
-        {
+        if (www_pack_is_mounted()) {
+            file_cert = pack_load_pem("/cert.pem", &file_cert_len);
+            file_key = pack_load_pem("/key.pem", &file_key_len);
+        } else {
             FILE *cf = fopen(WEB_MOUNT_POINT "/cert.pem", "rb");
             if (cf) {
                 fseek(cf, 0, SEEK_END); long l = ftell(cf); fseek(cf, 0, SEEK_SET);
@@ -1939,7 +2683,7 @@ esp_err_t web_portal_start(void)
         if (file_cert && file_key) {
             cert_ptr = (const unsigned char *)file_cert; cert_len = file_cert_len;
             key_ptr  = (const unsigned char *)file_key;  key_len  = file_key_len;
-            ESP_LOGI(TAG, "HTTPS: using cert/key from LittleFS (%u/%u bytes)", (unsigned)cert_len, (unsigned)key_len);
+            ESP_LOGI(TAG, "HTTPS: using cert/key from %s (%u/%u bytes)", www_pack_is_mounted() ? "asset pack" : "LittleFS", (unsigned)cert_len, (unsigned)key_len);
         } else {
             cert_ptr = (const unsigned char *)servercert_pem_start;
             cert_len = (size_t)(servercert_pem_end - servercert_pem_start);
@@ -1952,6 +2696,21 @@ esp_err_t web_portal_start(void)
         scfg.servercert_len = cert_len;
         scfg.prvtkey_pem = key_ptr;
         scfg.prvtkey_len = key_len;
+        mbedtls_pk_type_t key_type = tls_key_type(key_ptr, key_len);
+        if (key_type == MBEDTLS_PK_NONE) {
+            ESP_LOGE(TAG, "HTTPS: server key could not be parsed");
+        } else if (key_type == MBEDTLS_PK_RSA) {
+            ESP_LOGW(TAG, "HTTPS: RSA server key; an ECDSA P-256 key makes handshakes several times cheaper");
+        }
+
+        /* Resumed sessions skip the key exchange (browsers reconnect often, e.g. WS) */
+#if CONFIG_ESP_TLS_SERVER_SESSION_TICKETS
+        scfg.session_tickets = true;
+#endif
+#if CONFIG_IAQ_PROFILING && CONFIG_ESP_HTTPS_SERVER_CERT_SELECT_HOOK
+        scfg.cert_select_cb = https_client_hello_cb;
+        scfg.user_cb = https_session_cb;
+#endif
 
         scfg.httpd.recv_wait_timeout = 30;
         ESP_LOGD(TAG, "HTTPS httpd cfg: port=%d, recv_to=%d, send_to=%d, backlog=%d, max_socks=%d, max_uris=%d",
@@ -1979,7 +2738,7 @@ esp_err_t web_portal_start(void)
         cfg.uri_match_fn = httpd_uri_match_wildcard;
         /* Default LRU purge behavior */
         cfg.lru_purge_enable = true;
-        cfg.max_uri_handlers = 32; /* increased for power endpoints */
+        cfg.max_uri_handlers = 40; /* power, history export and web console endpoints */
         /* Moderate simultaneous pending connects to limit spikes */
         cfg.backlog_conn = 3;
         /* Cap HTTPD sockets so other services (MQTT/SNTP/DNS) keep room */
@@ -2015,7 +2774,9 @@ esp_err_t web_portal_start(void)
     const httpd_uri_t uri_state = { .uri = "/api/v1/state", .method = HTTP_GET, .handler = api_state_get, .user_ctx = NULL };
     const httpd_uri_t uri_metrics = { .uri = "/api/v1/metrics", .method = HTTP_GET, .handler = api_metrics_get, .user_ctx = NULL };
     const httpd_uri_t uri_health = { .uri = "/api/v1/health", .method = HTTP_GET, .handler = api_health_get, .user_ctx = NULL };
+    const httpd_uri_t uri_blackbox = { .uri = "/api/v1/blackbox", .method = HTTP_GET, .handler = api_blackbox_get, .user_ctx = NULL };
     const httpd_uri_t uri_history = { .uri = "/api/v1/history", .method = HTTP_GET, .handler = api_history_get, .user_ctx = NULL };
+    const httpd_uri_t uri_history_export = { .uri = "/api/v1/history/export", .method = HTTP_GET, .handler = api_history_export_get, .user_ctx = NULL };
     const httpd_uri_t uri_ota_info = { .uri = "/api/v1/ota/info", .method = HTTP_GET, .handler = api_ota_info_get, .user_ctx = NULL };
     const httpd_uri_t uri_ota_firmware = { .uri = "/api/v1/ota/firmware", .method = HTTP_POST, .handler = api_ota_firmware_post, .user_ctx = NULL };
     const httpd_uri_t uri_ota_frontend = { .uri = "/api/v1/ota/frontend", .method = HTTP_POST, .handler = api_ota_frontend_post, .user_ctx = NULL };
@@ -2052,7 +2813,9 @@ esp_err_t web_portal_start(void)
     httpd_register_uri_handler(s_server, &uri_state);
     httpd_register_uri_handler(s_server, &uri_metrics);
     httpd_register_uri_handler(s_server, &uri_health);
+    httpd_register_uri_handler(s_server, &uri_blackbox);
     httpd_register_uri_handler(s_server, &uri_history);
+    httpd_register_uri_handler(s_server, &uri_history_export);
     httpd_register_uri_handler(s_server, &uri_ota_info);
     httpd_register_uri_handler(s_server, &uri_ota_firmware);
     httpd_register_uri_handler(s_server, &uri_ota_frontend);
@@ -2124,9 +2887,9 @@ esp_err_t web_portal_stop(void)
         iaq_profiler_unregister_task(s_httpd_task_handle);
         s_httpd_task_handle = NULL;
     }
-    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_stop(s_ws_state_timer));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_stop(s_ws_metrics_timer));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_stop(s_ws_health_timer));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_stop(s_ws_state_timer));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_stop(s_ws_metrics_timer));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(periodic_sched_stop(s_ws_health_timer));
 #if CONFIG_IAQ_WEB_CONSOLE_ENABLE
     web_console_set_server(NULL);
     web_console_reset_clients();
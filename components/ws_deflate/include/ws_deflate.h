@@ -0,0 +1,75 @@
+/* components/ws_deflate/include/ws_deflate.h */
+#ifndef WS_DEFLATE_H
+#define WS_DEFLATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compressed WebSocket messages for clients that connect with `?deflate=1`.
+ *
+ * esp_http_server cannot negotiate RFC 7692 (no Sec-WebSocket-Extensions
+ * response header, no RSV1 bit), so compressed messages travel as binary
+ * frames with a 5-byte header:
+ *
+ *   [0]    flags (WS_DEFLATE_FLAG_*)
+ *   [1..4] uncompressed length, little-endian
+ *   [5..]  raw deflate data (RFC 1951)
+ *
+ * Per-message streams end with a final block. Context-takeover streams end
+ * each message with a sync flush (00 00 ff ff) and continue the same
+ * dictionary in the next frame until a frame carries WS_DEFLATE_FLAG_RESET.
+ * Messages below the size threshold are sent as plain text frames.
+ */
+#define WS_DEFLATE_FLAG_RESET       0x01    /* Start a new inflate context */
+#define WS_DEFLATE_FLAG_TAKEOVER    0x02    /* Keep the context for the next frame */
+#define WS_DEFLATE_HEADER_LEN       5
+
+typedef struct {
+    void *comp;                     /* tdefl_compressor in PSRAM; NULL until first use */
+    SemaphoreHandle_t lock;
+    bool context_takeover;
+    volatile bool reset_pending;    /* Set by ws_deflate_reset(), applied on next compress */
+    bool over_cap_logged;
+} ws_deflate_t;
+
+/**
+ * Prepare a shared stream. No compressor memory is allocated yet.
+ * Use one stream per send path, shared by all of its clients: each allocated
+ * compressor costs ~300 KB of PSRAM and at most two exist at a time.
+ */
+esp_err_t ws_deflate_init(ws_deflate_t *z, bool context_takeover);
+
+/** Restart the dictionary on the next message (a new subscriber joined). */
+void ws_deflate_reset(ws_deflate_t *z);
+
+/**
+ * Compress one message into a newly allocated frame (caller frees).
+ *
+ * @return ESP_OK with *frame set,
+ *         ESP_ERR_INVALID_SIZE if the message is below the threshold or did
+ *         not shrink (send it as text), ESP_ERR_NO_MEM / ESP_FAIL on error.
+ */
+esp_err_t ws_deflate_compress(ws_deflate_t *z, const void *data, size_t len,
+                              uint8_t **frame, size_t *frame_len);
+
+/** Free the compressor state (no opted-in clients left). */
+void ws_deflate_release(ws_deflate_t *z);
+
+/** True if the handshake request opted in with `deflate=1` and it is enabled. */
+bool ws_deflate_requested(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WS_DEFLATE_H */
@@ -0,0 +1,181 @@
+/* components/ws_deflate/ws_deflate.c */
+#include "ws_deflate.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "miniz.h"
+#include "sdkconfig.h"
+#include "iaq_profiler.h"
+
+static const char *TAG = "WS_DEFLATE";
+
+#ifndef CONFIG_IAQ_WEB_PORTAL_WS_DEFLATE_MIN_BYTES
+#define CONFIG_IAQ_WEB_PORTAL_WS_DEFLATE_MIN_BYTES 256
+#endif
+
+/* Greedy parsing with few probes: JSON and log text compress well without deep search */
+#define DEFLATE_FLAGS (TDEFL_GREEDY_PARSING_FLAG | 16)
+
+/* Compressors allocated at once. A stream is shared by every client of its
+ * send path (/ws broadcast, /ws/log), so this is one per path; a stream
+ * created beyond it sends plain frames instead of taking another ~300 KB. */
+#define WS_DEFLATE_MAX_STREAMS  2
+
+static portMUX_TYPE s_count_lock = portMUX_INITIALIZER_UNLOCKED;
+static int s_comp_count = 0;
+
+static bool reserve_stream(void)
+{
+    bool ok;
+    portENTER_CRITICAL(&s_count_lock);
+    ok = s_comp_count < WS_DEFLATE_MAX_STREAMS;
+    if (ok) s_comp_count++;
+    portEXIT_CRITICAL(&s_count_lock);
+    return ok;
+}
+
+static void unreserve_stream(void)
+{
+    portENTER_CRITICAL(&s_count_lock);
+    if (s_comp_count > 0) s_comp_count--;
+    portEXIT_CRITICAL(&s_count_lock);
+}
+
+esp_err_t ws_deflate_init(ws_deflate_t *z, bool context_takeover)
+{
+    if (!z) return ESP_ERR_INVALID_ARG;
+    memset(z, 0, sizeof(*z));
+    z->context_takeover = context_takeover;
+    z->lock = xSemaphoreCreateMutex();
+    return z->lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void ws_deflate_reset(ws_deflate_t *z)
+{
+    if (z) z->reset_pending = true;
+}
+
+/* Run one message through the compressor, growing the frame as needed */
+static esp_err_t compress_into(tdefl_compressor *comp, const uint8_t *src, size_t len, tdefl_flush flush,
+                               uint8_t **out, size_t *cap, size_t *out_len)
+{
+    for (;;) {
+        size_t in_size = len;
+        size_t out_size = *cap - *out_len;
+        tdefl_status st = tdefl_compress(comp, src, &in_size, *out + *out_len, &out_size, flush);
+        if (st < TDEFL_STATUS_OKAY) {
+            ESP_LOGE(TAG, "deflate failed (%d)", (int)st);
+            return ESP_FAIL;
+        }
+        src += in_size;
+        len -= in_size;
+        *out_len += out_size;
+        bool full = (*out_len == *cap);
+        if (flush == TDEFL_FINISH ? st == TDEFL_STATUS_DONE : (len == 0 && !full)) return ESP_OK;
+        if (full) {
+            size_t new_cap = *cap + *cap / 2;
+            uint8_t *grown = realloc(*out, new_cap);
+            if (!grown) return ESP_ERR_NO_MEM;
+            *out = grown;
+            *cap = new_cap;
+        }
+    }
+}
+
+esp_err_t ws_deflate_compress(ws_deflate_t *z, const void *data, size_t len,
+                              uint8_t **frame, size_t *frame_len)
+{
+    if (!z || !z->lock || !data || !frame || !frame_len) return ESP_ERR_INVALID_ARG;
+    if (len < CONFIG_IAQ_WEB_PORTAL_WS_DEFLATE_MIN_BYTES) return ESP_ERR_INVALID_SIZE;
+
+    uint64_t t0 = iaq_prof_tic();
+    xSemaphoreTake(z->lock, portMAX_DELAY);
+
+    if (!z->comp) {
+        if (!reserve_stream()) {
+            xSemaphoreGive(z->lock);
+            if (!z->over_cap_logged) {
+                ESP_LOGW(TAG, "More than %d compressed streams; sending uncompressed", WS_DEFLATE_MAX_STREAMS);
+                z->over_cap_logged = true;
+            }
+            return ESP_ERR_NO_MEM;
+        }
+        z->comp = heap_caps_malloc(sizeof(tdefl_compressor), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!z->comp) {
+            unreserve_stream();
+            xSemaphoreGive(z->lock);
+            ESP_LOGW(TAG, "No memory for deflate state; sending uncompressed");
+            return ESP_ERR_NO_MEM;
+        }
+        z->reset_pending = true;
+    }
+
+    uint8_t flags = z->context_takeover ? WS_DEFLATE_FLAG_TAKEOVER : 0;
+    if (!z->context_takeover || z->reset_pending) {
+        /* Per-message streams skip clearing the hash table; matches are still
+         * verified against the current window, so output stays valid */
+        int tflags = DEFLATE_FLAGS | (z->context_takeover ? 0 : TDEFL_NONDETERMINISTIC_PARSING_FLAG);
+        tdefl_init(z->comp, NULL, NULL, tflags);
+        z->reset_pending = false;
+        flags |= WS_DEFLATE_FLAG_RESET;
+    }
+
+    size_t cap = WS_DEFLATE_HEADER_LEN + len / 2 + 64;
+    size_t out_len = WS_DEFLATE_HEADER_LEN;
+    uint8_t *out = malloc(cap);
+    esp_err_t err = out ? ESP_OK : ESP_ERR_NO_MEM;
+    if (err == ESP_OK) {
+        err = compress_into(z->comp, data, len, z->context_takeover ? TDEFL_SYNC_FLUSH : TDEFL_FINISH,
+                            &out, &cap, &out_len);
+    }
+    if (err != ESP_OK && z->context_takeover) {
+        z->reset_pending = true; /* Dictionary no longer matches what clients saw */
+    }
+    xSemaphoreGive(z->lock);
+
+    if (err != ESP_OK) {
+        free(out);
+        return err;
+    }
+    if (!z->context_takeover && out_len >= len) {
+        free(out); /* Incompressible: plain text is smaller */
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    out[0] = flags;
+    for (int i = 0; i < 4; i++) out[1 + i] = (uint8_t)((uint32_t)len >> (8 * i));
+    *frame = out;
+    *frame_len = out_len;
+
+    iaq_prof_toc(IAQ_METRIC_WEB_WS_DEFLATE, t0);
+    iaq_profiler_record(IAQ_METRIC_WEB_WS_DEFLATE_PCT, (uint32_t)((out_len * 100U) / len));
+    return ESP_OK;
+}
+
+void ws_deflate_release(ws_deflate_t *z)
+{
+    if (!z || !z->lock || !z->comp) return;
+    xSemaphoreTake(z->lock, portMAX_DELAY);
+    heap_caps_free(z->comp);
+    z->comp = NULL;
+    unreserve_stream();
+    xSemaphoreGive(z->lock);
+}
+
+bool ws_deflate_requested(httpd_req_t *req)
+{
+#if CONFIG_IAQ_WEB_PORTAL_WS_DEFLATE
+    char query[256];
+    char val[4];
+    /* A long auth token may truncate the copy; clients put deflate=1 first */
+    esp_err_t r = httpd_req_get_url_query_str(req, query, sizeof(query));
+    if (r != ESP_OK && r != ESP_ERR_HTTPD_RESULT_TRUNC) return false;
+    if (httpd_query_key_value(query, "deflate", val, sizeof(val)) != ESP_OK) return false;
+    return strcmp(val, "1") == 0;
+#else
+    (void)req;
+    return false;
+#endif
+}
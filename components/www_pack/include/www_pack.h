@@ -0,0 +1,121 @@
+/* components/www_pack/include/www_pack.h */
+#ifndef WWW_PACK_H
+#define WWW_PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Read-only packed asset bundle for the frontend partition.
+ *
+ * The whole image is memory-mapped from flash and assets are served straight
+ * from the mapping: no VFS, no stat/fopen/fread, no copies. Built by
+ * mkwwwpack.py from the www/ directory; a frontend update writes one image.
+ *
+ * Layout (little-endian, all offsets from the image start):
+ *
+ *   header   32 bytes, see www_pack_header_t
+ *   index    entry_count x www_pack_entry_t, sorted by (path hash, path)
+ *   strings  NUL-terminated paths, content types and ETags
+ *   data     asset blobs, 4-byte aligned
+ *
+ * One entry holds every precompressed variant of a path (identity, .gz,
+ * .br), so negotiation is a single lookup. Lookup is a binary search over
+ * the FNV-1a hash of the path. The CRC covers everything after the header
+ * and is checked on mount, so a torn update is never served.
+ */
+#define WWW_PACK_MAGIC          "IQWP"
+#define WWW_PACK_VERSION        1
+
+typedef enum {
+    WWW_PACK_ENC_IDENTITY = 0,
+    WWW_PACK_ENC_GZIP,
+    WWW_PACK_ENC_BR,
+    WWW_PACK_ENC_COUNT
+} www_pack_encoding_t;
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t entry_size;        /* sizeof(www_pack_entry_t) */
+    uint32_t entry_count;
+    uint32_t strings_offset;
+    uint32_t data_offset;
+    uint32_t image_size;
+    uint32_t crc32;             /* CRC-32 of bytes [sizeof(header), image_size) */
+    uint32_t reserved;
+} www_pack_header_t;
+
+typedef struct {
+    uint32_t hash;              /* FNV-1a of the path */
+    uint32_t path;              /* String offsets */
+    uint32_t content_type;
+    uint32_t etag;              /* Unquoted */
+    struct {
+        uint32_t offset;
+        uint32_t size;          /* 0 = variant absent */
+    } variants[WWW_PACK_ENC_COUNT];
+} www_pack_entry_t;
+
+/** One asset resolved against the mapped image (valid while acquired). */
+typedef struct {
+    const char *path;
+    const char *content_type;
+    const char *etag;
+    struct {
+        const uint8_t *data;
+        size_t size;            /* 0 = variant absent */
+    } variants[WWW_PACK_ENC_COUNT];
+} www_pack_asset_t;
+
+/**
+ * Map and validate the image on a partition.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE (already mapped),
+ *         ESP_ERR_NOT_FOUND (no partition), ESP_ERR_NOT_SUPPORTED (no pack
+ *         magic, e.g. a LittleFS image), ESP_ERR_INVALID_VERSION,
+ *         ESP_ERR_INVALID_SIZE / ESP_ERR_INVALID_CRC (corrupt or torn image)
+ */
+esp_err_t www_pack_mount(const char *partition_label);
+
+/**
+ * Unmap the image once in-flight readers are done.
+ *
+ * @return ESP_ERR_TIMEOUT if readers did not finish in time (still mapped and serving)
+ */
+esp_err_t www_pack_unmount(void);
+
+bool www_pack_is_mounted(void);
+
+/**
+ * Pin the mapping for a lookup and the send that follows.
+ * Every successful acquire must be paired with www_pack_release().
+ */
+bool www_pack_acquire(void);
+void www_pack_release(void);
+
+/** Find an asset by path ("/index.html"). The caller must hold an acquire. */
+bool www_pack_find(const char *path, size_t path_len, www_pack_asset_t *out);
+
+/**
+ * Copy an asset's identity variant into buf and NUL-terminate it.
+ *
+ * @return ESP_ERR_NOT_FOUND if not mounted or no identity variant,
+ *         ESP_ERR_INVALID_SIZE if it does not fit into cap - 1 bytes
+ */
+esp_err_t www_pack_read_file(const char *path, char *buf, size_t cap, size_t *out_len);
+
+/** Image size and entry count of the mounted pack. */
+esp_err_t www_pack_get_info(size_t *image_size, uint32_t *entry_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WWW_PACK_H */
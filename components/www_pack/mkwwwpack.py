@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# components/www_pack/mkwwwpack.py
+"""Build a www_pack image (see include/www_pack.h) from a directory.
+
+Every file becomes an asset at its relative path ("/assets/app.js"). Siblings
+with a .gz or .br suffix are stored as precompressed variants of the same
+asset instead of separate entries.
+
+    mkwwwpack.py www/ build/www.bin [--size 0x200000]
+"""
+
+import argparse
+import hashlib
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b'IQWP'
+VERSION = 1
+HEADER_FMT = '<4sHHIIIIII'
+ENTRY_FMT = '<IIII' + 'II' * 3
+HEADER_SIZE = struct.calcsize(HEADER_FMT)
+ENTRY_SIZE = struct.calcsize(ENTRY_FMT)
+
+# Variant index = www_pack_encoding_t
+ENCODING_SUFFIXES = {'.gz': 1, '.br': 2}
+
+# Keep in sync with guess_mime_type() in web_portal.c
+MIME_TYPES = {
+    '.html': 'text/html', '.htm': 'text/html',
+    '.css': 'text/css',
+    '.js': 'application/javascript',
+    '.json': 'application/json',
+    '.svg': 'image/svg+xml',
+    '.png': 'image/png',
+    '.jpg': 'image/jpeg', '.jpeg': 'image/jpeg',
+    '.woff2': 'font/woff2',
+    '.wasm': 'application/wasm',
+    '.ico': 'image/x-icon',
+    '.txt': 'text/plain',
+}
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def mime_type(path):
+    ext = os.path.splitext(path)[1].lower()
+    if not ext:
+        return 'text/plain'
+    return MIME_TYPES.get(ext, 'application/octet-stream')
+
+
+def collect(base_dir):
+    """Map asset path -> [identity, gzip, br] contents (None = absent)."""
+    assets = {}
+    for root, dirs, files in os.walk(base_dir):
+        dirs.sort()
+        for name in sorted(files):
+            full = os.path.join(root, name)
+            rel = '/' + os.path.relpath(full, base_dir).replace(os.sep, '/')
+            stem, suffix = os.path.splitext(rel)
+            variant = ENCODING_SUFFIXES.get(suffix.lower(), 0)
+            path = stem if variant else rel
+            with open(full, 'rb') as f:
+                data = f.read()
+            if not data:
+                continue
+            assets.setdefault(path, [None, None, None])[variant] = data
+    return assets
+
+
+def build(assets):
+    paths = sorted(assets, key=lambda p: (fnv1a(p.encode()), p))
+
+    strings = bytearray()
+    string_offsets = {}
+
+    def add_string(s):
+        if s not in string_offsets:
+            string_offsets[s] = len(strings)
+            strings.extend(s.encode() + b'\0')
+        return string_offsets[s]
+
+    rows = []
+    for path in paths:
+        variants = assets[path]
+        # ETag identifies the representation; encoded variants get a suffix when served
+        reference = next(v for v in variants if v is not None)
+        etag = hashlib.sha256(reference).hexdigest()[:16]
+        rows.append((path, add_string(path), add_string(mime_type(path)), add_string(etag)))
+
+    strings_offset = HEADER_SIZE + ENTRY_SIZE * len(paths)
+    data_offset = strings_offset + len(strings)
+    data_offset += -data_offset % 4
+
+    data = bytearray()
+    entries = bytearray()
+    for path, path_off, type_off, etag_off in rows:
+        fields = [fnv1a(path.encode()), strings_offset + path_off,
+                  strings_offset + type_off, strings_offset + etag_off]
+        for blob in assets[path]:
+            if blob is None:
+                fields += [0, 0]
+                continue
+            data.extend(b'\0' * (-len(data) % 4))
+            fields += [data_offset + len(data), len(blob)]
+            data.extend(blob)
+        entries.extend(struct.pack(ENTRY_FMT, *fields))
+
+    body = bytearray(entries)
+    body.extend(strings)
+    body.extend(b'\0' * (data_offset - strings_offset - len(strings)))
+    body.extend(data)
+    image_size = HEADER_SIZE + len(body)
+    header = struct.pack(HEADER_FMT, MAGIC, VERSION, ENTRY_SIZE, len(paths),
+                         strings_offset, data_offset, image_size,
+                         zlib.crc32(body) & 0xFFFFFFFF, 0)
+    return header + bytes(body)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('base_dir')
+    parser.add_argument('output')
+    parser.add_argument('--size', type=lambda s: int(s, 0), default=0,
+                        help='partition size; fail if the image does not fit')
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.base_dir):
+        sys.exit(f'mkwwwpack: {args.base_dir} is not a directory')
+    assets = collect(args.base_dir)
+    image = build(assets)
+    if args.size and len(image) > args.size:
+        sys.exit(f'mkwwwpack: image is {len(image)} bytes, partition holds {args.size}')
+
+    with open(args.output, 'wb') as f:
+        f.write(image)
+    print(f'mkwwwpack: {len(assets)} assets, {len(image)} bytes -> {args.output}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,45 @@
+# components/www_pack/project_include.cmake
+
+set(WWW_PACK_TOOL "${CMAKE_CURRENT_LIST_DIR}/mkwwwpack.py")
+
+# www_pack_create_partition_image(<partition> <base_dir> [FLASH_IN_PROJECT] [DEPENDS <targets>])
+#
+# Pack base_dir into a www_pack image sized for <partition>, with the same
+# flash targets as littlefs_create_partition_image.
+function(www_pack_create_partition_image partition base_dir)
+    set(options FLASH_IN_PROJECT)
+    set(multi DEPENDS)
+    cmake_parse_arguments(arg "${options}" "" "${multi}" "${ARGN}")
+
+    idf_build_get_property(python PYTHON)
+    get_filename_component(base_dir_full_path ${base_dir} ABSOLUTE)
+
+    partition_table_get_partition_info(size "--partition-name ${partition}" "size")
+    partition_table_get_partition_info(offset "--partition-name ${partition}" "offset")
+
+    if("${size}" AND "${offset}")
+        set(image_file ${CMAKE_BINARY_DIR}/${partition}.bin)
+
+        add_custom_target(${partition}_bin ALL
+            COMMAND ${python} ${WWW_PACK_TOOL} ${base_dir_full_path} ${image_file} --size ${size}
+            DEPENDS ${arg_DEPENDS}
+            VERBATIM
+        )
+        set_property(DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}" APPEND PROPERTY
+            ADDITIONAL_CLEAN_FILES ${image_file})
+
+        idf_component_get_property(main_args esptool_py FLASH_ARGS)
+        idf_component_get_property(sub_args esptool_py FLASH_SUB_ARGS)
+        esptool_py_flash_target(${partition}-flash "${main_args}" "${sub_args}")
+        esptool_py_flash_target_image(${partition}-flash "${partition}" "${offset}" "${image_file}")
+        add_dependencies(${partition}-flash ${partition}_bin)
+
+        if(arg_FLASH_IN_PROJECT)
+            esptool_py_flash_target_image(flash "${partition}" "${offset}" "${image_file}")
+            add_dependencies(flash ${partition}_bin)
+        endif()
+    else()
+        message(FATAL_ERROR "Failed to create www_pack image for partition '${partition}'. "
+                            "Check the partition table for an entry with that name.")
+    endif()
+endfunction()
@@ -0,0 +1,242 @@
+/* components/www_pack/www_pack.c */
+#include "www_pack.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+static const char *TAG = "WWW_PACK";
+
+#define WWW_PACK_UNMOUNT_WAIT_MS    5000
+
+_Static_assert(sizeof(www_pack_header_t) == 32, "www_pack header layout");
+_Static_assert(sizeof(www_pack_entry_t) == 40, "www_pack entry layout");
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static const uint8_t *s_image = NULL;
+static esp_partition_mmap_handle_t s_map;
+static bool s_mounted = false;
+static int s_readers = 0;
+
+static inline const www_pack_header_t *pack_header(void)
+{
+    return (const www_pack_header_t *)s_image;
+}
+
+static inline const www_pack_entry_t *pack_entries(void)
+{
+    return (const www_pack_entry_t *)(s_image + sizeof(www_pack_header_t));
+}
+
+static uint32_t fnv1a(const char *s, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool string_ok(const www_pack_header_t *hdr, uint32_t off)
+{
+    return off >= hdr->strings_offset && off < hdr->data_offset;
+}
+
+/* Bounds-check everything lookups dereference, so they need no checks */
+static bool pack_validate(const uint8_t *image, const www_pack_header_t *hdr)
+{
+    uint64_t index_end = sizeof(*hdr) + (uint64_t)hdr->entry_count * sizeof(www_pack_entry_t);
+    if (hdr->entry_size != sizeof(www_pack_entry_t) || index_end > hdr->strings_offset ||
+        hdr->strings_offset >= hdr->data_offset || hdr->data_offset > hdr->image_size) {
+        return false;
+    }
+    /* Last string must be terminated; every string offset is then safe */
+    if (image[hdr->data_offset - 1] != '\0') return false;
+
+    const www_pack_entry_t *entries = (const www_pack_entry_t *)(image + sizeof(*hdr));
+    for (uint32_t i = 0; i < hdr->entry_count; i++) {
+        const www_pack_entry_t *e = &entries[i];
+        if (!string_ok(hdr, e->path) || !string_ok(hdr, e->content_type) || !string_ok(hdr, e->etag)) {
+            return false;
+        }
+        if (i > 0 && entries[i - 1].hash > e->hash) return false;
+        for (int v = 0; v < WWW_PACK_ENC_COUNT; v++) {
+            if (e->variants[v].size == 0) continue;
+            if (e->variants[v].offset < hdr->data_offset ||
+                (uint64_t)e->variants[v].offset + e->variants[v].size > hdr->image_size) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+esp_err_t www_pack_mount(const char *partition_label)
+{
+    if (s_image) return ESP_ERR_INVALID_STATE;
+
+    /* Any subtype: the pack may live in a partition declared as littlefs */
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partition_label);
+    if (!part) return ESP_ERR_NOT_FOUND;
+
+    www_pack_header_t hdr;
+    esp_err_t r = esp_partition_read(part, 0, &hdr, sizeof(hdr));
+    if (r != ESP_OK) return r;
+    if (memcmp(hdr.magic, WWW_PACK_MAGIC, sizeof(hdr.magic)) != 0) return ESP_ERR_NOT_SUPPORTED;
+    if (hdr.version != WWW_PACK_VERSION) {
+        ESP_LOGW(TAG, "Unsupported pack version %u", (unsigned)hdr.version);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (hdr.image_size <= sizeof(hdr) || hdr.image_size > part->size) return ESP_ERR_INVALID_SIZE;
+
+    const void *ptr = NULL;
+    esp_partition_mmap_handle_t map;
+    r = esp_partition_mmap(part, 0, hdr.image_size, ESP_PARTITION_MMAP_DATA, &ptr, &map);
+    if (r != ESP_OK) {
+        ESP_LOGE(TAG, "mmap of %u bytes failed: %s", (unsigned)hdr.image_size, esp_err_to_name(r));
+        return r;
+    }
+    const uint8_t *image = (const uint8_t *)ptr;
+
+    uint32_t crc = esp_rom_crc32_le(0, image + sizeof(hdr), hdr.image_size - sizeof(hdr));
+    if (crc != hdr.crc32) {
+        ESP_LOGE(TAG, "CRC mismatch (0x%08x != 0x%08x), image torn or corrupt",
+                 (unsigned)crc, (unsigned)hdr.crc32);
+        esp_partition_munmap(map);
+        return ESP_ERR_INVALID_CRC;
+    }
+    if (!pack_validate(image, &hdr)) {
+        ESP_LOGE(TAG, "Malformed pack index");
+        esp_partition_munmap(map);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_image = image;
+    s_map = map;
+    s_mounted = true;
+    portEXIT_CRITICAL(&s_lock);
+    ESP_LOGI(TAG, "Mapped '%s': %u assets, %u bytes", part->label,
+             (unsigned)hdr.entry_count, (unsigned)hdr.image_size);
+    return ESP_OK;
+}
+
+esp_err_t www_pack_unmount(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool was_mapped = (s_image != NULL);
+    s_mounted = false; /* No new readers */
+    portEXIT_CRITICAL(&s_lock);
+    if (!was_mapped) return ESP_OK;
+
+    for (int waited = 0; ; waited += 10) {
+        portENTER_CRITICAL(&s_lock);
+        int readers = s_readers;
+        portEXIT_CRITICAL(&s_lock);
+        if (readers == 0) break;
+        if (waited >= WWW_PACK_UNMOUNT_WAIT_MS) {
+            ESP_LOGW(TAG, "%d reader(s) still active, keeping the mapping", readers);
+            portENTER_CRITICAL(&s_lock);
+            s_mounted = true; /* Image is intact, keep serving it */
+            portEXIT_CRITICAL(&s_lock);
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    esp_partition_munmap(s_map);
+    portENTER_CRITICAL(&s_lock);
+    s_image = NULL;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+bool www_pack_is_mounted(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool mounted = s_mounted;
+    portEXIT_CRITICAL(&s_lock);
+    return mounted;
+}
+
+bool www_pack_acquire(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool ok = s_mounted;
+    if (ok) s_readers++;
+    portEXIT_CRITICAL(&s_lock);
+    return ok;
+}
+
+void www_pack_release(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    if (s_readers > 0) s_readers--;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+bool www_pack_find(const char *path, size_t path_len, www_pack_asset_t *out)
+{
+    if (!path || !out || !s_image) return false;
+    const www_pack_header_t *hdr = pack_header();
+    const www_pack_entry_t *entries = pack_entries();
+    uint32_t hash = fnv1a(path, path_len);
+
+    /* Lower bound of hash, then walk the (rare) collisions */
+    uint32_t lo = 0, hi = hdr->entry_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (entries[mid].hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+    for (uint32_t i = lo; i < hdr->entry_count && entries[i].hash == hash; i++) {
+        const www_pack_entry_t *e = &entries[i];
+        const char *name = (const char *)s_image + e->path;
+        if (strncmp(name, path, path_len) != 0 || name[path_len] != '\0') continue;
+
+        out->path = name;
+        out->content_type = (const char *)s_image + e->content_type;
+        out->etag = (const char *)s_image + e->etag;
+        for (int v = 0; v < WWW_PACK_ENC_COUNT; v++) {
+            out->variants[v].size = e->variants[v].size;
+            out->variants[v].data = e->variants[v].size ? s_image + e->variants[v].offset : NULL;
+        }
+        return true;
+    }
+    return false;
+}
+
+esp_err_t www_pack_read_file(const char *path, char *buf, size_t cap, size_t *out_len)
+{
+    if (!path || !buf || cap == 0) return ESP_ERR_INVALID_ARG;
+    if (!www_pack_acquire()) return ESP_ERR_NOT_FOUND;
+
+    esp_err_t r = ESP_OK;
+    www_pack_asset_t asset;
+    if (!www_pack_find(path, strlen(path), &asset) || asset.variants[WWW_PACK_ENC_IDENTITY].size == 0) {
+        r = ESP_ERR_NOT_FOUND;
+    } else if (asset.variants[WWW_PACK_ENC_IDENTITY].size >= cap) {
+        r = ESP_ERR_INVALID_SIZE;
+    } else {
+        size_t len = asset.variants[WWW_PACK_ENC_IDENTITY].size;
+        memcpy(buf, asset.variants[WWW_PACK_ENC_IDENTITY].data, len);
+        buf[len] = '\0';
+        if (out_len) *out_len = len;
+    }
+    www_pack_release();
+    return r;
+}
+
+esp_err_t www_pack_get_info(size_t *image_size, uint32_t *entry_count)
+{
+    if (!www_pack_acquire()) return ESP_ERR_INVALID_STATE;
+    if (image_size) *image_size = pack_header()->image_size;
+    if (entry_count) *entry_count = pack_header()->entry_count;
+    www_pack_release();
+    return ESP_OK;
+}
@@ -27,9 +27,11 @@
 #include "web_portal.h"
 #include "web_console.h"
 #include "pm_guard.h"
+#include "periodic_sched.h"
 #include "power_board.h"
 #include "ota_manager.h"
 #include "log_control.h"
+#include "blackbox.h"
 
 static const char *TAG = "IAQ_MAIN";
 
@@ -37,7 +39,7 @@ static const char *TAG = "IAQ_MAIN";
 static iaq_system_context_t g_system_ctx;
 
 /* Timer for periodic system status updates (console logging + metrics) */
-static esp_timer_handle_t system_status_timer;
+static periodic_work_handle_t system_status_timer;
 
 /**
  * System status timer callback - updates system metrics and logs to console.
@@ -76,6 +78,7 @@ static void iaq_event_handler(void *arg, esp_event_base_t event_base,
         switch (event_id) {
             case IAQ_EVENT_WIFI_CONNECTED:
                 ESP_LOGI(TAG, "WiFi connected event received");
+                blackbox_record_event(BLACKBOX_EVENT_WIFI, 1, 0, 0, 0);
 
                 /* Start MQTT if configured and not already connected */
                 if (mqtt_manager_is_configured() && !mqtt_manager_is_connected()) {
@@ -86,6 +89,7 @@ static void iaq_event_handler(void *arg, esp_event_base_t event_base,
 
             case IAQ_EVENT_WIFI_DISCONNECTED:
                 ESP_LOGD(TAG, "WiFi disconnected event received");
+                blackbox_record_event(BLACKBOX_EVENT_WIFI, 0, 0, 0, 0);
                 break;
 
             default:
@@ -99,6 +103,9 @@ static void iaq_event_handler(void *arg, esp_event_base_t event_base,
  */
 static esp_err_t init_core_system(void)
 {
+    /* First, so the boot banner and everything after it lands in the black box */
+    blackbox_init();
+
     ESP_LOGI(TAG, "=== IAQ Monitor v%d.%d.%d Starting ===",
              IAQ_VERSION_MAJOR, IAQ_VERSION_MINOR, IAQ_VERSION_PATCH);
 
@@ -239,18 +246,20 @@ void app_main(void)
 
     /* Create and start system status timer BEFORE mqtt_manager_init to prevent race */
     ESP_LOGI(TAG, "Creating system status timer");
-    const esp_timer_create_args_t system_status_timer_args = {
+    const periodic_work_args_t system_status_timer_args = {
         .callback = &system_status_timer_callback,
-        .name = "system_status"
+        .name = "system_status",
+        .subsystem = "system",
+        .slack_ms = SLACK_MS_SYSTEM_STATUS,
     };
-    ESP_ERROR_CHECK(esp_timer_create(&system_status_timer_args, &system_status_timer));
+    ESP_ERROR_CHECK(periodic_sched_create(&system_status_timer_args, &system_status_timer));
     uint64_t status_interval_ms = STATUS_PUBLISH_INTERVAL_MS;
 #ifdef CONFIG_IAQ_PROFILING
     if (CONFIG_IAQ_PROFILING && CONFIG_IAQ_PROFILING_INTERVAL_SEC > 0) {
         status_interval_ms = (uint64_t)CONFIG_IAQ_PROFILING_INTERVAL_SEC * 1000ULL;
     }
 #endif
-    ESP_ERROR_CHECK(esp_timer_start_periodic(system_status_timer, status_interval_ms * 1000ULL));
+    ESP_ERROR_CHECK(periodic_sched_start(system_status_timer, status_interval_ms * 1000ULL, status_interval_ms * 1000ULL));
 
     /* Call timer callback once immediately to populate initial values before MQTT init */
     system_status_timer_callback(NULL);